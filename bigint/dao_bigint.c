@@ -29,6 +29,7 @@
 #include<stdlib.h>
 #include<string.h>
 #include<ctype.h>
+#include<stdint.h>
 #include<assert.h>
 #include"daoStdtype.h"
 #include"daoValue.h"
@@ -36,9 +37,54 @@
 #include"daoVmspace.h"
 #include"daoThread.h"
 
-#define LONG_BITS 8
-#define LONG_BASE 256
-#define LONG_MASK 255
+#ifdef UNIX
+#include<unistd.h>
+#endif
+
+/*
+// Digits (limbs) are native machine words: 64 bits with the products and
+// carries in unsigned __int128 where the compiler supports it, otherwise
+// 32 bits with 64 bit products and carries. Define DAO_BIGINT_LIMB32 to use
+// the 32 bit limbs on all platforms.
+*/
+#if defined(__SIZEOF_INT128__) && !defined(DAO_BIGINT_LIMB32)
+typedef uint64_t           limb_t;
+typedef unsigned __int128  dlimb_t;
+#define LONG_BITS 64
+#else
+typedef uint32_t  limb_t;
+typedef uint64_t  dlimb_t;
+#define LONG_BITS 32
+#endif
+#define LONG_MASK ((limb_t)-1)
+
+/*
+// Operand sizes (in limbs) to switch from schoolbook multiplication (squaring)
+// to Karatsuba multiplication (squaring), and from Karatsuba to NTT;
+// and the product size (in limbs) to run the NTTs in parallel.
+// Measured with 64 bit limbs on x86-64 using benchmark.dao; they can be
+// redefined at compiling to compare the algorithms around the thresholds.
+*/
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD      32
+#endif
+#ifndef BIGINT_KARATSUBA_SQR_THRESHOLD
+#define BIGINT_KARATSUBA_SQR_THRESHOLD  48
+#endif
+#ifndef BIGINT_NTT_THRESHOLD
+#define BIGINT_NTT_THRESHOLD            6144
+#endif
+#ifndef BIGINT_NTT_THREAD_THRESHOLD
+#define BIGINT_NTT_THREAD_THRESHOLD     16384
+#endif
+
+/*
+// Size (in limbs) to switch from the base conversion by limb sized chunks
+// to the divide-and-conquer conversion over the powers of the base.
+*/
+#ifndef BIGINT_CONVERT_THRESHOLD
+#define BIGINT_CONVERT_THRESHOLD        64
+#endif
 
 typedef signed char        schar_t;
 typedef struct DaoxBigInt  DaoxBigInt;
@@ -49,7 +95,7 @@ struct DaoxBigInt
 {
 	DAO_CSTRUCT_COMMON;
 
-	uchar_t  *data;
+	limb_t   *data;
 	uchar_t   base;
 	schar_t   sign;
 	ushort_t  offset;
@@ -65,8 +111,8 @@ DAO_DLL void DaoxBigInt_Clear( DaoxBigInt *self );
 
 DAO_DLL void DaoxBigInt_Copy( DaoxBigInt *z, DaoxBigInt *x );
 DAO_DLL void DaoxBigInt_Resize( DaoxBigInt *self, daoint size );
-DAO_DLL void DaoxBigInt_PushBack( DaoxBigInt *self, uchar_t it );
-DAO_DLL void DaoxBigInt_PushFront( DaoxBigInt *self, uchar_t it );
+DAO_DLL void DaoxBigInt_PushBack( DaoxBigInt *self, limb_t it );
+DAO_DLL void DaoxBigInt_PushFront( DaoxBigInt *self, limb_t it );
 DAO_DLL int DaoxBigInt_Compare( DaoxBigInt *x, DaoxBigInt *y );
 DAO_DLL void DaoxBigInt_Move( DaoxBigInt *z, DaoxBigInt *x );
 DAO_DLL void DaoxBigInt_Add( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y );
@@ -74,6 +120,10 @@ DAO_DLL void DaoxBigInt_Sub( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y );
 DAO_DLL void DaoxBigInt_Mul( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *b );
 DAO_DLL void DaoxBigInt_Div( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigInt *r );
 DAO_DLL void DaoxBigInt_Pow( DaoxBigInt *z, DaoxBigInt *x, daoint n, DaoxBigIntBuffer *b );
+DAO_DLL void DaoxBigInt_PowMod( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *e, DaoxBigInt *m, DaoxBigIntBuffer *b );
+DAO_DLL void DaoxBigInt_GCD( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *b );
+DAO_DLL void DaoxBigInt_ExtGCD( DaoxBigInt *g, DaoxBigInt *s, DaoxBigInt *t, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *b );
+DAO_DLL int DaoxBigInt_ModInverse( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *m, DaoxBigIntBuffer *b );
 DAO_DLL void DaoxBigInt_AddInt( DaoxBigInt *z, DaoxBigInt *x, daoint y, DaoxBigInt *buf );
 DAO_DLL void DaoxBigInt_MulInt( DaoxBigInt *z, DaoxBigInt *x, daoint y );
 DAO_DLL void DaoxBigInt_Flip( DaoxBigInt *self );
@@ -100,46 +150,98 @@ DAO_DLL daoint DaoxBigInt_NormCount( DaoxBigInt *self );
 #define DaoxBigInt_Append  DaoxBigInt_PushBack
 
 
+/*
+// Scratch space for the arithmetic; and the cached table of the powers of
+// a base for base conversion: powers[k] = base^(d*2^k), where base^d is the
+// largest power of the base in a limb, with recips[k] as the reciprocal of
+// powers[k] for Barrett division (computed when needed).
+*/
 struct DaoxBigIntBuffer
 {
-	DList *coms;
+	DList *words;
+	DList *limbs;
 	DList *ints;
+	DList *powers;
+	DList *recips;
+	int    powerBase;
 };
 static DaoxBigIntBuffer* DaoxBigIntBuffer_New()
 {
 	DaoxBigIntBuffer *self = (DaoxBigIntBuffer*) dao_malloc( sizeof(DaoxBigIntBuffer) );
-	self->coms = DList_New(0);
+	self->words = DList_New(0);
+	self->limbs = DList_New(0);
 	self->ints = DList_New(0);
+	self->powers = DList_New(0);
+	self->recips = DList_New(0);
+	self->powerBase = 0;
 	return self;
 }
+static void DaoxBigIntBuffer_ClearPowers( DaoxBigIntBuffer *self )
+{
+	int i;
+	for(i=0; i<self->powers->size; ++i){
+		DaoxBigInt_Delete( (DaoxBigInt*) self->powers->items.pVoid[i] );
+		if( self->recips->items.pVoid[i] ){
+			DaoxBigInt_Delete( (DaoxBigInt*) self->recips->items.pVoid[i] );
+		}
+	}
+	DList_Clear( self->powers );
+	DList_Clear( self->recips );
+	self->powerBase = 0;
+}
 static void DaoxBigIntBuffer_Delete( DaoxBigIntBuffer *self )
 {
 	int i;
-	for(i=0; i<self->coms->size; ++i){
-		DArray_Delete( (DArray*) self->coms->items.pVoid[i] );
+	DaoxBigIntBuffer_ClearPowers( self );
+	for(i=0; i<self->words->size; ++i){
+		DArray_Delete( (DArray*) self->words->items.pVoid[i] );
+	}
+	for(i=0; i<self->limbs->size; ++i){
+		DArray_Delete( (DArray*) self->limbs->items.pVoid[i] );
 	}
 	for(i=0; i<self->ints->size; ++i){
 		DaoxBigInt_Delete( (DaoxBigInt*) self->ints->items.pVoid[i] );
 	}
-	DList_Delete( self->coms );
+	DList_Delete( self->words );
+	DList_Delete( self->limbs );
 	DList_Delete( self->ints );
+	DList_Delete( self->powers );
+	DList_Delete( self->recips );
 	dao_free( self );
 }
 static DArray* DaoxBigIntBuffer_NewVector( DaoxBigIntBuffer *self )
 {
-	DArray *vec;
-	if( self->coms->size ) return (DArray*) DList_PopBack( self->coms );
-	return DArray_New( sizeof(dao_complex) );
+	if( self->words->size ) return (DArray*) DList_PopBack( self->words );
+	return DArray_New( sizeof(uint_t) );
+}
+/* Scratch space of at least "size" limbs: */
+static DArray* DaoxBigIntBuffer_NewLimbs( DaoxBigIntBuffer *self, daoint size )
+{
+	DArray *limbs;
+	if( self->limbs->size ){
+		limbs = (DArray*) DList_PopBack( self->limbs );
+	}else{
+		limbs = DArray_New( sizeof(limb_t) );
+	}
+	DArray_Reserve( limbs, size + 1 );
+	return limbs;
 }
 static DaoxBigInt* DaoxBigIntBuffer_NewBigInt( DaoxBigIntBuffer *self )
 {
 	DaoxBigInt *bigint;
-	if( self->ints->size ) return (DaoxBigInt*) DList_PopBack( self->ints );
-	return DaoxBigInt_New();
+	if( self->ints->size == 0 ) return DaoxBigInt_New();
+	bigint = (DaoxBigInt*) DList_PopBack( self->ints );
+	bigint->sign = 1;
+	bigint->size = 0;
+	return bigint;
 }
 static void DaoxBigIntBuffer_FreeVector( DaoxBigIntBuffer *self, DArray *vec )
 {
-	DList_Append( self->coms, vec );
+	DList_Append( self->words, vec );
+}
+static void DaoxBigIntBuffer_FreeLimbs( DaoxBigIntBuffer *self, DArray *limbs )
+{
+	DList_Append( self->limbs, limbs );
 }
 static void DaoxBigIntBuffer_FreeBigInt( DaoxBigIntBuffer *self, DaoxBigInt *bigint )
 {
@@ -147,50 +249,653 @@ static void DaoxBigIntBuffer_FreeBigInt( DaoxBigIntBuffer *self, DaoxBigInt *big
 }
 
 
-#define PI2 6.283185307179586
+/*
+// Operations on limb arrays (least significant limb first).
+// Unless stated otherwise, the output may be the same array as an input,
+// but must not partially overlap with it.
+*/
+static int DaoxLimb_LeadingZeros( limb_t x )
+{
+	if( x == 0 ) return LONG_BITS;
+#if defined(__GNUC__)
+	if( sizeof(limb_t) == sizeof(unsigned long long) ) return __builtin_clzll( x );
+	return __builtin_clz( x );
+#else
+	int n = 0;
+	while( (x & ((limb_t)1 << (LONG_BITS-1))) == 0 ) x <<= 1, n += 1;
+	return n;
+#endif
+}
+/* The reciprocal floor((B*B-1)/d) - B of a normalized limb d (B = 2^LONG_BITS): */
+static limb_t DaoxLimb_Reciprocal( limb_t d )
+{
+	return (limb_t) (((((dlimb_t) ~d) << LONG_BITS) | LONG_MASK) / d);
+}
+/* (u1*B + u0) / d for a normalized d with u1 < d, using its reciprocal v: */
+static limb_t DaoxLimb_Div2By1( limb_t u1, limb_t u0, limb_t d, limb_t v, limb_t *r )
+{
+	dlimb_t q = (dlimb_t) v * u1 + ((((dlimb_t) u1) << LONG_BITS) | u0);
+	limb_t q1 = (limb_t)(q >> LONG_BITS) + 1;
+	limb_t q0 = (limb_t) q;
+	limb_t rem = u0 - q1 * d;
+	if( rem > q0 ){
+		q1 -= 1;
+		rem += d;
+	}
+	if( rem >= d ){
+		q1 += 1;
+		rem -= d;
+	}
+	*r = rem;
+	return q1;
+}
+static int DaoxLimbs_Compare( const limb_t *x, daoint nx, const limb_t *y, daoint ny )
+{
+	while( nx > 0 && x[nx-1] == 0 ) nx --;
+	while( ny > 0 && y[ny-1] == 0 ) ny --;
+	if( nx != ny ) return nx > ny ? 1 : -1;
+	while( nx > 0 && x[nx-1] == y[nx-1] ) nx --;
+	if( nx == 0 ) return 0;
+	return x[nx-1] > y[nx-1] ? 1 : -1;
+}
+/* z[0,n) = x[0,n) + y[0,n) + carry; return the carry: */
+static limb_t DaoxLimbs_AddN( limb_t *z, const limb_t *x, const limb_t *y, daoint n, limb_t carry )
+{
+	daoint i;
+	for(i=0; i<n; ++i){
+		limb_t s = x[i] + carry;
+		carry = s < carry;
+		z[i] = s + y[i];
+		carry += z[i] < s;
+	}
+	return carry;
+}
+/* z[0,n) = x[0,n) - y[0,n) - borrow; return the borrow: */
+static limb_t DaoxLimbs_SubN( limb_t *z, const limb_t *x, const limb_t *y, daoint n, limb_t borrow )
+{
+	daoint i;
+	for(i=0; i<n; ++i){
+		limb_t a = x[i], b = y[i];
+		limb_t d = a - b;
+		limb_t b2 = a < b;
+		z[i] = d - borrow;
+		borrow = b2 | (d < borrow);
+	}
+	return borrow;
+}
+/* z[0,n) += y; return the carry: */
+static limb_t DaoxLimbs_Add1( limb_t *z, daoint n, limb_t y )
+{
+	daoint i;
+	for(i=0; i<n && y; ++i){
+		z[i] += y;
+		y = z[i] < y;
+	}
+	return y;
+}
+/* z[0,nx) = x[0,nx) + y[0,ny) with nx >= ny; return the carry: */
+static limb_t DaoxLimbs_Add( limb_t *z, const limb_t *x, daoint nx, const limb_t *y, daoint ny )
+{
+	limb_t carry = DaoxLimbs_AddN( z, x, y, ny, 0 );
+	if( z != x ) memmove( z + ny, x + ny, (nx - ny) * sizeof(limb_t) );
+	return DaoxLimbs_Add1( z + ny, nx - ny, carry );
+}
+/* z[0,nx) = x[0,nx) - y[0,ny) with nx >= ny; return the borrow: */
+static limb_t DaoxLimbs_Sub( limb_t *z, const limb_t *x, daoint nx, const limb_t *y, daoint ny )
+{
+	limb_t borrow = DaoxLimbs_SubN( z, x, y, ny, 0 );
+	daoint i;
+	for(i=ny; i<nx; ++i){
+		z[i] = x[i] - borrow;
+		borrow = x[i] < borrow;
+		if( borrow == 0 && z == x ) break;
+	}
+	return borrow;
+}
+/* z[0,n) = x[0,n) * y; return the carry: */
+static limb_t DaoxLimbs_Mul1( limb_t *z, const limb_t *x, daoint n, limb_t y )
+{
+	limb_t carry = 0;
+	daoint i;
+	for(i=0; i<n; ++i){
+		dlimb_t t = (dlimb_t) x[i] * y + carry;
+		z[i] = (limb_t) t;
+		carry = (limb_t)(t >> LONG_BITS);
+	}
+	return carry;
+}
+/* z[0,n) += x[0,n) * y; return the carry: */
+static limb_t DaoxLimbs_MulAdd1( limb_t *z, const limb_t *x, daoint n, limb_t y )
+{
+	limb_t carry = 0;
+	daoint i;
+	for(i=0; i<n; ++i){
+		dlimb_t t = (dlimb_t) x[i] * y + z[i] + carry;
+		z[i] = (limb_t) t;
+		carry = (limb_t)(t >> LONG_BITS);
+	}
+	return carry;
+}
+/* z[0,n) -= x[0,n) * y; return the borrow: */
+static limb_t DaoxLimbs_MulSub1( limb_t *z, const limb_t *x, daoint n, limb_t y )
+{
+	limb_t carry = 0;
+	daoint i;
+	for(i=0; i<n; ++i){
+		dlimb_t t = (dlimb_t) x[i] * y + carry;
+		limb_t lo = (limb_t) t;
+		limb_t zi = z[i];
+		carry = (limb_t)(t >> LONG_BITS);
+		z[i] = zi - lo;
+		carry += zi < lo;
+	}
+	return carry;
+}
+/* z[0,n) = x[0,n) / y; return the remainder: */
+static limb_t DaoxLimbs_Div1( limb_t *z, const limb_t *x, daoint n, limb_t y )
+{
+	int s = DaoxLimb_LeadingZeros( y );
+	limb_t d = y << s;
+	limb_t v = DaoxLimb_Reciprocal( d );
+	limb_t r = 0;
+	daoint i;
+
+	if( n == 0 ) return 0;
+	if( s == 0 ){
+		for(i=n-1; i>=0; --i) z[i] = DaoxLimb_Div2By1( r, x[i], d, v, & r );
+		return r;
+	}
+	/* Divide x * 2^s by y * 2^s: */
+	r = x[n-1] >> (LONG_BITS - s);
+	for(i=n-1; i>0; --i){
+		limb_t u0 = (x[i] << s) | (x[i-1] >> (LONG_BITS - s));
+		z[i] = DaoxLimb_Div2By1( r, u0, d, v, & r );
+	}
+	z[0] = DaoxLimb_Div2By1( r, x[0] << s, d, v, & r );
+	return r >> s;
+}
+/* z[0,n) = x[0,n) << s with 0 < s < LONG_BITS; return the shifted out bits: */
+static limb_t DaoxLimbs_ShiftLeft( limb_t *z, const limb_t *x, daoint n, int s )
+{
+	limb_t out = x[n-1] >> (LONG_BITS - s);
+	daoint i;
+	for(i=n-1; i>0; --i) z[i] = (x[i] << s) | (x[i-1] >> (LONG_BITS - s));
+	z[0] = x[0] << s;
+	return out;
+}
+/* z[0,n) = x[0,n) >> s with 0 < s < LONG_BITS: */
+static void DaoxLimbs_ShiftRight( limb_t *z, const limb_t *x, daoint n, int s )
+{
+	daoint i;
+	for(i=0; i+1<n; ++i) z[i] = (x[i] >> s) | (x[i+1] << (LONG_BITS - s));
+	z[n-1] = x[n-1] >> s;
+}
+/*
+// Knuth's algorithm D: q[0,nu-nv] = u / v and r[0,nv) = u % v,
+// where nu >= nv >= 2 and v[nv-1] != 0; "r" may be NULL.
+// The work space must hold nu+nv+1 limbs; q and r must not overlap u and v.
+*/
+static void DaoxLimbs_DivRem( limb_t *q, limb_t *r, const limb_t *u, daoint nu, const limb_t *v, daoint nv, limb_t *work )
+{
+	limb_t *un = work, *vn = work + nu + 1;
+	limb_t d, d2, inv;
+	daoint j;
+	int s = DaoxLimb_LeadingZeros( v[nv-1] );
+
+	if( s ){
+		DaoxLimbs_ShiftLeft( vn, v, nv, s );
+		un[nu] = DaoxLimbs_ShiftLeft( un, u, nu, s );
+	}else{
+		memcpy( vn, v, nv * sizeof(limb_t) );
+		memcpy( un, u, nu * sizeof(limb_t) );
+		un[nu] = 0;
+	}
+	d = vn[nv-1];
+	d2 = vn[nv-2];
+	inv = DaoxLimb_Reciprocal( d );
+	for(j=nu-nv; j>=0; --j){
+		limb_t u2 = un[j+nv], u1 = un[j+nv-1], u0 = un[j+nv-2];
+		limb_t qhat, rhat, borrow;
+		int overflow = 0;
+		/* Estimate the quotient digit from the leading limbs: */
+		if( u2 >= d ){
+			qhat = LONG_MASK;
+			rhat = u1 + d;
+			overflow = rhat < d;
+		}else{
+			qhat = DaoxLimb_Div2By1( u2, u1, d, inv, & rhat );
+		}
+		while( ! overflow && (dlimb_t) qhat * d2 > ((((dlimb_t) rhat) << LONG_BITS) | u0) ){
+			qhat -= 1;
+			rhat += d;
+			overflow = rhat < d;
+		}
+		borrow = DaoxLimbs_MulSub1( un + j, vn, nv, qhat );
+		un[j+nv] = u2 - borrow;
+		if( u2 < borrow ){ /* The estimate was one too large: */
+			qhat -= 1;
+			un[j+nv] += DaoxLimbs_AddN( un + j, un + j, vn, nv, 0 );
+		}
+		q[j] = qhat;
+	}
+	if( r == NULL ) return;
+	if( s ){
+		DaoxLimbs_ShiftRight( r, un, nv, s );
+		r[nv-1] |= un[nv] << (LONG_BITS - s);
+	}else{
+		memcpy( r, un, nv * sizeof(limb_t) );
+	}
+}
+/* z[0,nx+ny) = x[0,nx) * y[0,ny); z must not overlap x and y: */
+static void DaoxLimbs_MulSchool( limb_t *z, const limb_t *x, daoint nx, const limb_t *y, daoint ny )
+{
+	daoint j;
+	z[nx] = DaoxLimbs_Mul1( z, x, nx, y[0] );
+	for(j=1; j<ny; ++j) z[nx+j] = DaoxLimbs_MulAdd1( z + j, x, nx, y[j] );
+}
+/* z[0,2n) = x[0,n)^2; z must not overlap x: */
+static void DaoxLimbs_SqrSchool( limb_t *z, const limb_t *x, daoint n )
+{
+	limb_t carry = 0;
+	daoint i;
+
+	/* The products x[i]*x[j] with i < j: */
+	memset( z, 0, 2 * n * sizeof(limb_t) );
+	for(i=0; i+1<n; ++i) z[n+i] = DaoxLimbs_MulAdd1( z + 2*i + 1, x + i + 1, n - i - 1, x[i] );
+	/* Doubled, plus the squares x[i]*x[i]: */
+	DaoxLimbs_ShiftLeft( z, z, 2*n, 1 );
+	for(i=0; i<n; ++i){
+		dlimb_t p = (dlimb_t) x[i] * x[i];
+		dlimb_t s = (dlimb_t) z[2*i] + (limb_t) p + carry;
+		z[2*i] = (limb_t) s;
+		s = (dlimb_t) z[2*i+1] + (limb_t)(p >> LONG_BITS) + (limb_t)(s >> LONG_BITS);
+		z[2*i+1] = (limb_t) s;
+		carry = (limb_t)(s >> LONG_BITS);
+	}
+}
+/* z[0,n) = |x[0,nx) - y[0,n)| with nx <= n; return -1 if x < y, otherwise 1: */
+static int DaoxLimbs_AbsDiff( limb_t *z, const limb_t *x, daoint nx, const limb_t *y, daoint n )
+{
+	if( DaoxLimbs_Compare( x, nx, y, n ) < 0 ){
+		DaoxLimbs_Sub( z, y, n, x, nx );
+		return -1;
+	}
+	DaoxLimbs_SubN( z, x, y, nx, 0 );
+	memset( z + nx, 0, (n - nx) * sizeof(limb_t) );
+	return 1;
+}
+/* The work space (in limbs) used by DaoxLimbs_Karatsuba(): */
+static daoint DaoxLimbs_KaratsubaSize( daoint n )
+{
+	daoint size = 0;
+	while( n >= BIGINT_KARATSUBA_THRESHOLD ){
+		n -= n / 2;
+		size += 4 * n;
+	}
+	return size;
+}
+/*
+// Karatsuba multiplication: z[0,2n) = x[0,n) * y[0,n), or the square of x
+// if x and y are the same array. With x = x1*B^m + x0 and y = y1*B^m + y0,
+//   x*y = x1*y1*B^2m + (x1*y1 + x0*y0 - (x0 - x1)*(y0 - y1))*B^m + x0*y0;
+// z must not overlap x and y.
+*/
+static void DaoxLimbs_Karatsuba( limb_t *z, const limb_t *x, const limb_t *y, daoint n, limb_t *work )
+{
+	daoint m = n / 2, h = n - m;
+	limb_t *dx = work, *dy = work + h, *t = work + 2*h, *next = work + 4*h;
+	limb_t carry, top;
+	int sign;
+
+	if( x == y && n < BIGINT_KARATSUBA_SQR_THRESHOLD ){
+		DaoxLimbs_SqrSchool( z, x, n );
+		return;
+	}else if( n < BIGINT_KARATSUBA_THRESHOLD ){
+		DaoxLimbs_MulSchool( z, x, n, y, n );
+		return;
+	}
+	sign = DaoxLimbs_AbsDiff( dx, x, m, x + m, h );
+	if( x == y ){
+		sign = 1;
+		DaoxLimbs_Karatsuba( t, dx, dx, h, next );
+	}else{
+		sign *= DaoxLimbs_AbsDiff( dy, y, m, y + m, h );
+		DaoxLimbs_Karatsuba( t, dx, dy, h, next );
+	}
+	DaoxLimbs_Karatsuba( z, x, y, m, next );
+	DaoxLimbs_Karatsuba( z + 2*m, x + m, y + m, h, next );
+
+	/* t = x1*y1 + x0*y0 -/+ t, with the highest limb in "top": */
+	if( sign > 0 ){
+		top = - DaoxLimbs_Sub( t, z + 2*m, 2*h, t, 2*h );
+	}else{
+		top = DaoxLimbs_Add( t, t, 2*h, z + 2*m, 2*h );
+	}
+	top += DaoxLimbs_Add( t, t, 2*h, z, 2*m );
+
+	carry = DaoxLimbs_Add( z + m, z + m, m + 2*h, t, 2*h );
+	DaoxLimbs_Add1( z + m + 2*h, m, top + carry );
+}
+/* The work space (in limbs) used by DaoxLimbs_Mul(): */
+static daoint DaoxLimbs_MulSize( daoint nx, daoint ny )
+{
+	daoint size, size2;
+	if( nx < ny ){
+		daoint n = nx;
+		nx = ny;  ny = n;
+	}
+	if( ny < BIGINT_KARATSUBA_THRESHOLD ) return 0;
+	if( nx == ny ) return DaoxLimbs_KaratsubaSize( nx );
+	size = 2*ny + DaoxLimbs_KaratsubaSize( ny );
+	if( nx % ny ){
+		size2 = DaoxLimbs_MulSize( ny, nx % ny );
+		if( size2 > size ) size = size2;
+	}
+	return size;
+}
+/*
+// z[0,nx+ny) = x[0,nx) * y[0,ny): schoolbook multiplication for small operands,
+// and Karatsuba multiplication over the blocks of the longer operand otherwise;
+// z must not overlap x and y.
+*/
+static void DaoxLimbs_Mul( limb_t *z, const limb_t *x, daoint nx, const limb_t *y, daoint ny, limb_t *work )
+{
+	daoint i, r;
+
+	if( nx < ny ){
+		const limb_t *t = x;
+		daoint n = nx;
+		x = y;  y = t;
+		nx = ny;  ny = n;
+	}
+	if( x == y && nx == ny && nx < BIGINT_KARATSUBA_SQR_THRESHOLD ){
+		DaoxLimbs_SqrSchool( z, x, nx );
+		return;
+	}else if( ny < BIGINT_KARATSUBA_THRESHOLD ){
+		DaoxLimbs_MulSchool( z, x, nx, y, ny );
+		return;
+	}else if( nx == ny ){
+		DaoxLimbs_Karatsuba( z, x, y, nx, work );
+		return;
+	}
+	r = nx % ny;
+	if( r ){
+		DaoxLimbs_Mul( z, y, ny, x, r, work );
+	}else{
+		memset( z, 0, ny * sizeof(limb_t) );
+	}
+	memset( z + r + ny, 0, (nx - r) * sizeof(limb_t) );
+	for(i=r; i<nx; i+=ny){
+		DaoxLimbs_Karatsuba( work, x + i, y, ny, work + 2*ny );
+		DaoxLimbs_Add( z + i, z + i, nx + ny - i, work, 2*ny );
+	}
+}
+/*
+// Number theoretic transforms (NTT) for the multiplication of huge integers.
+//
+// The operands are cut into 32 bit pieces, and the convolution of the pieces
+// is computed modulo three primes p = k*2^n+1 below 2^31, then recovered
+// exactly with the Chinese remainder theorem. The transforms use Montgomery
+// multiplication with R = 2^32. A product of up to 2^BIGINT_NTT_MAX_BITS
+// pieces has coefficients below 2^24 * 2^64, which is less than the product
+// of the primes (about 2^92.6); larger products are computed over blocks.
+*/
+#define BIGINT_NTT_MAX_BITS  25
+#define BIGINT_NTT_PIECES    (sizeof(limb_t) / sizeof(uint_t))
+
+#define DaoxLimbs_Piece( x, i ) \
+	((uint_t)((x)[(i)/BIGINT_NTT_PIECES] >> (32*((i)%BIGINT_NTT_PIECES))))
+
+static const uint_t daox_ntt_primes[3][2] =
+{
+	{ 2013265921, 31 },  /* 15*2^27+1, primitive root 31; */
+	{ 1811939329, 13 },  /* 27*2^26+1, primitive root 13; */
+	{ 2113929217,  5 }   /* 63*2^25+1, primitive root 5; */
+};
 
-#define dao_complex_mul(z,x,y) { dao_complex tmp; \
-	tmp.real=x.real*y.real-x.imag*y.imag; \
-	tmp.imag=x.real*y.imag+x.imag*y.real; z = tmp; }
-#define complex_init(c,r,i) { c.real=r; c.imag=i; }
+typedef struct DaoxNtt  DaoxNtt;
+
+struct DaoxNtt
+{
+	uint_t   prime;
+	uint_t   pinv;   /* -1/prime mod 2^32; */
+	uint_t   r2;     /* 2^64 mod prime; */
+	uint_t   root;
+	uint_t  *x;      /* the transform of x, and the convolution at the end; */
+	uint_t  *y;      /* the transform of y, unused for squaring; */
+	uint_t  *roots;  /* roots[h+j] = w^j (Montgomery form) for the size 2h transform; */
+	daoint   size;   /* transform size; */
+
+	const limb_t  *xlimbs;
+	const limb_t  *ylimbs;
+	daoint         xpieces;
+	daoint         ypieces;
+};
 
-void dao_fft16( dao_complex data[], daoint M, int inv )
+static uint_t DaoxNtt_PowMod( uint_t a, uint64_t e, uint_t p )
 {
-	daoint d, i, j, k, m, S, B, D, N = 1<<M;
-	double expo = PI2 / (double) N;
-	dao_complex wn = { 0.0, 0.0 };
-	dao_complex wi, wj, ws, tmp;
+	uint64_t r = 1, b = a % p;
+	for(; e; e >>= 1){
+		if( e & 1 ) r = r * b % p;
+		b = b * b % p;
+	}
+	return r;
+}
+/* t*2^-32 mod p, for t < p*2^32: */
+static uint_t DaoxNtt_Reduce( DaoxNtt *self, uint64_t t )
+{
+	uint_t m = (uint_t) t * self->pinv;
+	uint_t u = (t + (uint64_t) m * self->prime) >> 32;
+	return u >= self->prime ? u - self->prime : u;
+}
+static void DaoxNtt_Init( DaoxNtt *self, uint_t prime, uint_t root, daoint size )
+{
+	uint_t inv = prime; /* Newton iteration for 1/prime mod 2^32: */
+	int i;
+	for(i=0; i<5; ++i) inv *= 2 - prime * inv;
+	self->prime = prime;
+	self->pinv = - inv;
+	self->r2 = ((uint64_t)1 << 63) % prime * 2 % prime;
+	self->root = root;
+	self->size = size;
+}
+static void DaoxNtt_MakeRoots( DaoxNtt *self )
+{
+	daoint i, h, n = self->size;
+	uint_t *roots = self->roots;
+	uint_t w = DaoxNtt_PowMod( self->root, (self->prime - 1) / n, self->prime );
+
+	w = DaoxNtt_Reduce( self, (uint64_t) w * self->r2 );
+	roots[1] = DaoxNtt_Reduce( self, self->r2 ); /* R mod p; */
+	if( n == 2 ) return;
+	h = n >> 1;
+	roots[h] = roots[1];
+	for(i=1; i<h; ++i) roots[h+i] = DaoxNtt_Reduce( self, (uint64_t) roots[h+i-1] * w );
+	for(h>>=1; h>1; h>>=1){
+		for(i=0; i<h; ++i) roots[h+i] = roots[2*h+2*i];
+	}
+}
+/* Forward transform with output in bit reversed order: */
+static void DaoxNtt_Forward( DaoxNtt *self, uint_t *a )
+{
+	daoint i, j, h, n = self->size;
+	uint_t p = self->prime;
+	for(h=n>>1; h; h>>=1){
+		uint_t *w = self->roots + h;
+		for(i=0; i<n; i+=2*h){
+			uint_t *a0 = a + i, *a1 = a + i + h;
+			for(j=0; j<h; ++j){
+				uint_t u = a0[j], v = a1[j];
+				uint_t s = u + v;
+				a0[j] = s >= p ? s - p : s;
+				a1[j] = DaoxNtt_Reduce( self, (uint64_t)(u + p - v) * w[j] );
+			}
+		}
+	}
+}
+/*
+// Inverse transform (without scaling) with input in bit reversed order,
+// using w^-j = -w^(h-j) for the size 2h transform:
+*/
+static void DaoxNtt_Inverse( DaoxNtt *self, uint_t *a )
+{
+	daoint i, j, h, n = self->size;
+	uint_t p = self->prime;
+	for(h=1; h<n; h<<=1){
+		uint_t *w = self->roots + h;
+		for(i=0; i<n; i+=2*h){
+			uint_t *a0 = a + i, *a1 = a + i + h;
+			for(j=0; j<h; ++j){
+				uint_t u = a0[j], v = a1[j], s;
+				if( j ) v = DaoxNtt_Reduce( self, (uint64_t)(p - v) * w[h-j] );
+				s = u + v;
+				a0[j] = s >= p ? s - p : s;
+				a1[j] = u >= v ? u - v : u + p - v;
+			}
+		}
+	}
+}
+static void DaoxNtt_Load( DaoxNtt *self, uint_t *a, const limb_t *x, daoint pieces )
+{
+	daoint i;
+	for(i=0; i<pieces; ++i) a[i] = DaoxLimbs_Piece( x, i ) % self->prime;
+	memset( a + pieces, 0, (self->size - pieces) * sizeof(uint_t) );
+}
+/* The cyclic convolution of the pieces of x and y modulo the prime: */
+static void DaoxNtt_Run( void *p )
+{
+	DaoxNtt *self = (DaoxNtt*) p;
+	daoint i, n = self->size;
+	uint_t scale = DaoxNtt_PowMod( n % self->prime, self->prime - 2, self->prime );
 
-	wn.real = cos( 0.5 * PI2 );  wn.imag = inv * sin( 0.5 * PI2 );
-	assert( abs(inv) == 1 );
-	D = N >> 1;
-	for(i=0; i<N; i++){ /* even/odd permutation */
-		k = 0; j = i; m = D;
-		while( j ){
-			if( j & 0x1 ) k += m;
-			j >>= 1; m >>= 1;
+	DaoxNtt_MakeRoots( self );
+	DaoxNtt_Load( self, self->x, self->xlimbs, self->xpieces );
+	DaoxNtt_Forward( self, self->x );
+	if( self->ylimbs != NULL ){
+		DaoxNtt_Load( self, self->y, self->ylimbs, self->ypieces );
+		DaoxNtt_Forward( self, self->y );
+		for(i=0; i<n; ++i) self->x[i] = DaoxNtt_Reduce( self, (uint64_t) self->x[i] * self->y[i] );
+	}else{
+		for(i=0; i<n; ++i) self->x[i] = DaoxNtt_Reduce( self, (uint64_t) self->x[i] * self->x[i] );
+	}
+	DaoxNtt_Inverse( self, self->x );
+	/* Undo the factor 1/R from the pointwise products and the factor n: */
+	scale = DaoxNtt_Reduce( self, (uint64_t) scale * self->r2 );
+	scale = DaoxNtt_Reduce( self, (uint64_t) scale * self->r2 );
+	for(i=0; i<n; ++i) self->x[i] = DaoxNtt_Reduce( self, (uint64_t) self->x[i] * scale );
+}
+static int DaoxNtt_GetTaskCount( daoint limbs )
+{
+	int tasks = 1;
+#if defined(DAO_WITH_THREAD) && defined(UNIX)
+	if( limbs >= BIGINT_NTT_THREAD_THRESHOLD ) tasks = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	return tasks >= 3 ? 3 : 1;
+}
+/* Run the three transforms, in parallel for huge operands: */
+static void DaoxNtt_Execute( DaoxNtt ntts[3], int ntask )
+{
+	int i;
+#ifdef DAO_WITH_THREAD
+	DThread threads[2];
+	if( ntask == 3 ){
+		for(i=0; i<2; ++i){
+			DThread_Init( & threads[i] );
+			DThread_Start( & threads[i], DaoxNtt_Run, & ntts[i] );
 		}
-		if( i < k ) tmp = data[k], data[k] = data[i], data[i] = tmp;
-	}
-	for(m=0; m<M; m++){ /* levels */
-		B = 1<<m;     /* butterfly size */
-		S = 1<<(m+1); /* DFT size */
-		D = N>>(m+1); /* number of DFTs */
-		complex_init( ws, cos( expo * D ), inv * sin( expo * D ) );
-		complex_init( wi, 1.0, 0.0 );
-		for(k=0; k<B; k++){ /* for k-th butterfly */
-			dao_complex_mul( wj, wi, wn );
-			for(d=0; d<D; d++){ /* in each DFT */
-				i = d * S + k;  j = i + B;
-				tmp = data[i];
-				dao_complex_mul( data[i], data[j], wi );
-				dao_complex_mul( data[j], data[j], wj );
-				data[i].real += tmp.real; data[i].imag += tmp.imag;
-				data[j].real += tmp.real; data[j].imag += tmp.imag;
+		DaoxNtt_Run( & ntts[2] );
+		for(i=0; i<2; ++i){
+			DThread_Join( & threads[i] );
+			DThread_Destroy( & threads[i] );
+		}
+		return;
+	}
+#endif
+	for(i=0; i<3; ++i) DaoxNtt_Run( & ntts[i] );
+}
+static uint_t* DaoxNtt_NewVector( DaoxBigIntBuffer *buffer, DArray *vectors[], int *count, daoint size )
+{
+	DArray *vector = DaoxBigIntBuffer_NewVector( buffer );
+	DArray_Reserve( vector, size );
+	vectors[ (*count)++ ] = vector;
+	return vector->data.uints;
+}
+/*
+// z[0,nx+ny) = x[0,nx) * y[0,ny) by number theoretic transforms;
+// z must not overlap x and y.
+*/
+static void DaoxLimbs_MulNTT( limb_t *z, const limb_t *x, daoint nx, const limb_t *y, daoint ny, DaoxBigIntBuffer *buffer )
+{
+	DaoxNtt ntts[3];
+	DArray *vectors[9];
+	daoint npx = nx * BIGINT_NTT_PIECES;
+	daoint npy = ny * BIGINT_NTT_PIECES;
+	daoint maxsize = (daoint)1 << BIGINT_NTT_MAX_BITS;
+	daoint i, j, k, n = 2;
+	uint64_t p1 = daox_ntt_primes[0][0];
+	uint64_t p2 = daox_ntt_primes[1][0];
+	uint64_t p3 = daox_ntt_primes[2][0];
+	uint64_t inv12, inv123, carry = 0;
+	int square = x == y && nx == ny;
+	int ntask, count = 0;
+
+	if( npx + npy > maxsize ){ /* Multiply blocks of half the maximum size: */
+		daoint m = (maxsize >> 1) / BIGINT_NTT_PIECES;
+		DArray *work = DaoxBigIntBuffer_NewLimbs( buffer, 2*m );
+		limb_t *w = (limb_t*) work->data.base;
+		memset( z, 0, (nx + ny) * sizeof(limb_t) );
+		for(i=0; i<nx; i+=m){
+			daoint bx = nx - i < m ? nx - i : m;
+			for(j=0; j<ny; j+=m){
+				daoint by = ny - j < m ? ny - j : m;
+				DaoxLimbs_MulNTT( w, x + i, bx, y + j, by, buffer );
+				DaoxLimbs_Add( z + i + j, z + i + j, nx + ny - i - j, w, bx + by );
 			}
-			dao_complex_mul( wi, wi, ws );
 		}
+		DaoxBigIntBuffer_FreeLimbs( buffer, work );
+		return;
 	}
+
+	while( n < npx + npy - 1 ) n <<= 1;
+	ntask = DaoxNtt_GetTaskCount( nx + ny );
+	for(i=0; i<3; ++i){
+		DaoxNtt *ntt = ntts + i;
+		DaoxNtt_Init( ntt, daox_ntt_primes[i][0], daox_ntt_primes[i][1], n );
+		ntt->xlimbs = x;
+		ntt->ylimbs = square ? NULL : y;
+		ntt->xpieces = npx;
+		ntt->ypieces = npy;
+		ntt->x = DaoxNtt_NewVector( buffer, vectors, & count, n );
+		if( i && ntask == 1 ){ /* Sequential transforms share these: */
+			ntt->y = ntts[0].y;
+			ntt->roots = ntts[0].roots;
+			continue;
+		}
+		ntt->y = square ? NULL : DaoxNtt_NewVector( buffer, vectors, & count, n );
+		ntt->roots = DaoxNtt_NewVector( buffer, vectors, & count, n );
+	}
+	DaoxNtt_Execute( ntts, ntask );
+
+	/* Chinese remainder theorem in Garner's form: c = c1 + p1*(c2 + p2*c3): */
+	inv12 = DaoxNtt_PowMod( p1 % p2, p2 - 2, p2 );
+	inv123 = DaoxNtt_PowMod( p1 * p2 % p3, p3 - 2, p3 );
+	memset( z, 0, (nx + ny) * sizeof(limb_t) );
+	for(k=0; k<npx+npy; ++k){
+		uint64_t c1 = 0, c2 = 0, c3 = 0, c, lo, hi, s;
+		if( k < n ){
+			c1 = ntts[0].x[k];
+			c2 = (ntts[1].x[k] + p2 - c1 % p2) % p2 * inv12 % p2;
+			c3 = (c1 + c2 * p1) % p3;
+			c3 = (ntts[2].x[k] + p3 - c3) % p3 * inv123 % p3;
+		}
+		c = c2 + c3 * p2;
+		lo = (c & 0xffffffff) * p1 + c1;
+		hi = (c >> 32) * p1 + (lo >> 32);
+		s = (lo & 0xffffffff) + (carry & 0xffffffff);
+		z[k/BIGINT_NTT_PIECES] |= (limb_t)(s & 0xffffffff) << (32*(k%BIGINT_NTT_PIECES));
+		carry = hi + (carry >> 32) + (s >> 32);
+	}
+	for(i=0; i<count; ++i) DaoxBigIntBuffer_FreeVector( buffer, vectors[i] );
 }
 
 
@@ -199,6 +904,12 @@ void dao_fft16( dao_complex data[], daoint M, int inv )
 DMutex  mutex_long_sharing;
 #endif
 
+/*
+// The limbs are stored in a reference counted buffer, with the count
+// in the first limb, followed by "offset" free limbs before the data.
+*/
+#define DaoxBigInt_Buffer( self ) ((self)->data ? (self)->data - (self)->offset - 1 : NULL)
+
 DaoxBigInt* DaoxBigInt_New()
 {
 	DaoxBigInt *self = (DaoxBigInt*) dao_calloc( 1, sizeof(DaoxBigInt) );
@@ -209,18 +920,18 @@ DaoxBigInt* DaoxBigInt_New()
 }
 void DaoxBigInt_Delete( DaoxBigInt *self )
 {
-	uint_t *pbuf;
+	limb_t *pbuf;
 	DaoxBigInt_Detach( self );
-	pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
+	pbuf = DaoxBigInt_Buffer( self );
 	if( pbuf ) dao_free( pbuf );
 	DaoCstruct_Free( (DaoCstruct*) self );
 	dao_free( self );
 }
 void DaoxBigInt_Clear( DaoxBigInt *self )
 {
-	uint_t *pbuf;
+	limb_t *pbuf;
 	DaoxBigInt_Detach( self );
-	pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
+	pbuf = DaoxBigInt_Buffer( self );
 	if( pbuf ) dao_free( pbuf );
 	self->data = NULL;
 	self->offset = 0;
@@ -228,11 +939,11 @@ void DaoxBigInt_Clear( DaoxBigInt *self )
 }
 void DaoxBigInt_Detach( DaoxBigInt *self /* , int extrasize  TODO */ )
 {
-	uint_t *pbuf2, *pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
+	limb_t *pbuf2, *pbuf = DaoxBigInt_Buffer( self );
 	if( pbuf == NULL ){
-		pbuf = (uint_t*) dao_malloc( sizeof(uint_t) );
+		pbuf = (limb_t*) dao_malloc( sizeof(limb_t) );
 		pbuf[0] = 1;
-		self->data = (uchar_t*)(pbuf + 1);
+		self->data = pbuf + 1;
 	}
 	if( pbuf[0] == 1 ) return;
 #ifdef DAO_WITH_THREAD
@@ -240,10 +951,10 @@ void DaoxBigInt_Detach( DaoxBigInt *self /* , int extrasize  TODO */ )
 #endif
 	if( pbuf[0] >1 ){
 		pbuf[0] -= 1;
-		pbuf2 = (uint_t*) dao_malloc( sizeof(uint_t) + self->bufSize * sizeof(uchar_t) );
+		pbuf2 = (limb_t*) dao_malloc( (self->bufSize + 1) * sizeof(limb_t) );
 		pbuf2[0] = 1;
-		memcpy( (uchar_t*)(pbuf2+1) + self->offset, self->data, self->size * sizeof(uchar_t) );
-		self->data = (uchar_t*)(pbuf2 + 1) + self->offset;
+		memcpy( pbuf2 + 1 + self->offset, self->data, self->size * sizeof(limb_t) );
+		self->data = pbuf2 + 1 + self->offset;
 	}
 #ifdef DAO_WITH_THREAD
 	DMutex_Unlock( & mutex_long_sharing );
@@ -251,59 +962,57 @@ void DaoxBigInt_Detach( DaoxBigInt *self /* , int extrasize  TODO */ )
 }
 void DaoxBigInt_Resize( DaoxBigInt *self, daoint size )
 {
-	daoint i;
-	uint_t *pbuf;
+	limb_t *pbuf;
 	DaoxBigInt_Detach( self );
-	pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
+	pbuf = DaoxBigInt_Buffer( self );
 	if( size == self->size && self->bufSize >0 ) return;
 	if( self->offset ){
 		daoint min = size > self->size ? self->size : size;
-		memmove( pbuf + 1, self->data, min * sizeof(uchar_t) );
-		self->data = (uchar_t*)(pbuf + 1);
+		memmove( pbuf + 1, self->data, min * sizeof(limb_t) );
+		self->data = pbuf + 1;
 		self->offset = 0;
 	}
 	if( size > self->bufSize || size < self->bufSize /2 ){
 		self->bufSize = size;
-		pbuf = (uint_t*)dao_realloc( pbuf, self->bufSize*sizeof(uchar_t) + sizeof(int) );
-		self->data = (uchar_t*)(pbuf + 1);
+		pbuf = (limb_t*)dao_realloc( pbuf, (self->bufSize + 1)*sizeof(limb_t) );
+		self->data = pbuf + 1;
 	}
 	self->size = size;
 }
 void DaoxBigInt_Reserve( DaoxBigInt *self, daoint size )
 {
-	daoint i;
-	uint_t *pbuf;
+	limb_t *pbuf;
 	DaoxBigInt_Detach( self );
 	if( size + self->offset <= self->bufSize ) return;
-	pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
-	pbuf = (uint_t*)dao_realloc( pbuf, (size + self->offset)*sizeof(uchar_t) + sizeof(int) );
-	self->data = (uchar_t*)(pbuf + 1) + self->offset;
+	pbuf = DaoxBigInt_Buffer( self );
+	pbuf = (limb_t*)dao_realloc( pbuf, (size + self->offset + 1)*sizeof(limb_t) );
+	self->data = pbuf + 1 + self->offset;
 	self->bufSize = size + self->offset;
 }
-void DaoxBigInt_PushBack( DaoxBigInt *self, uchar_t it )
+void DaoxBigInt_PushBack( DaoxBigInt *self, limb_t it )
 {
-	uint_t *pbuf;
+	limb_t *pbuf;
 	DaoxBigInt_Detach( self );
-	pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
+	pbuf = DaoxBigInt_Buffer( self );
 	if( self->size + self->offset + 1 > self->bufSize ){
 		self->bufSize += self->bufSize/5 + 1;
-		pbuf = (uint_t*)dao_realloc( pbuf, self->bufSize*sizeof(uchar_t) + sizeof(int) );
-		self->data = (uchar_t*)(pbuf + 1) + self->offset;
+		pbuf = (limb_t*)dao_realloc( pbuf, (self->bufSize + 1)*sizeof(limb_t) );
+		self->data = pbuf + 1 + self->offset;
 	}
 	self->data[ self->size ] = it;
 	self->size ++;
 }
-void DaoxBigInt_PushFront( DaoxBigInt *self, uchar_t it )
+void DaoxBigInt_PushFront( DaoxBigInt *self, limb_t it )
 {
 	DaoxBigInt_Detach( self );
 	if( self->offset == 0 ){
-		uint_t *pbuf = (uint_t*)(self->data ? self->data - self->offset - sizeof(uint_t) : NULL);
-		uint_t offset = self->bufSize/5 + 1;
+		limb_t *pbuf = DaoxBigInt_Buffer( self );
+		daoint offset = self->bufSize/5 + 1;
 		self->offset = offset < 0xffff ? offset : 0xffff;
 		self->bufSize += self->offset;
-		pbuf = (uint_t*) dao_realloc( pbuf, self->bufSize*sizeof(uchar_t) + sizeof(uint_t) );
-		self->data = (uchar_t*)(pbuf + 1) + self->offset;
-		memmove( self->data, pbuf + 1, self->size*sizeof(uchar_t) );
+		pbuf = (limb_t*) dao_realloc( pbuf, (self->bufSize + 1)*sizeof(limb_t) );
+		self->data = pbuf + 1 + self->offset;
+		memmove( self->data, pbuf + 1, self->size*sizeof(limb_t) );
 	}
 	self->offset --;
 	self->data --;
@@ -324,16 +1033,7 @@ void DaoxBigInt_Normalize2( DaoxBigInt *self )
 }
 int DaoxBigInt_UCompare( DaoxBigInt *x, DaoxBigInt *y )
 {
-	daoint nx = x->size;
-	daoint ny = y->size;
-	uchar_t *dx = x->data;
-	uchar_t *dy = y->data;
-	while( nx >0 && dx[nx-1] ==0 ) nx --;
-	while( ny >0 && dy[ny-1] ==0 ) ny --;
-	if( nx > ny ) return 1; else if( nx < ny ) return -1;
-	while( nx > 0 && dx[nx-1] == dy[ny-1] ) nx --, ny --;
-	if( nx == 0 ) return 0;
-	return ( dx[nx-1] > dy[ny-1] ) ? 1 : -1;
+	return DaoxLimbs_Compare( x->data, x->size, y->data, y->size );
 }
 int DaoxBigInt_Compare( DaoxBigInt *x, DaoxBigInt *y )
 {
@@ -349,24 +1049,20 @@ int DaoxBigInt_CompareToZero( DaoxBigInt *self )
 }
 int DaoxBigInt_CompareToInteger( DaoxBigInt *self, daoint x )
 {
-	daoint i, n = self->size - 1, m = - 1 + (sizeof(daoint)*8) / LONG_BITS;
+	limb_t digits[ sizeof(size_t) / sizeof(limb_t) + 1 ];
+	size_t y = x < 0 ? - (size_t) x : (size_t) x;
+	daoint m = 0;
 	if( self->sign < 0 && x > 0 ) return -1;
 	if( self->sign > 0 && x < 0 ) return  1;
-	x = abs( x );
-	while( m > 0 && ((x>>(m*LONG_BITS)) & LONG_MASK) ==0 ) m -= 1;
-	while( n > 0 && self->data[n] == 0 ) n -= 1; /* bit array has leading 0 */
-	if( n > m ) return self->sign;
-	if( n < m ) return - self->sign;
-	for(i=m; i>=0; i--){
-		uchar_t d = (x>>(i*LONG_BITS)) & LONG_MASK;
-		if( self->data[i] > d ) return self->sign;
-		if( self->data[i] < d ) return - self->sign;
+	for(; y; y = (sizeof(size_t) > sizeof(limb_t)) ? (y >> (LONG_BITS/2)) >> (LONG_BITS/2) : 0){
+		digits[m++] = (limb_t) y;
 	}
-	return 0;
+	return self->sign * DaoxLimbs_Compare( self->data, self->size, digits, m );
 }
 int DaoxBigInt_CompareToDouble( DaoxBigInt *self, double x )
 {
 	double prod, frac;
+	daoint n = self->size;
 	int i, expon, bit, bit2, res;
 
 	if( self->sign > 0 && x < 0 ) return 1;
@@ -379,10 +1075,10 @@ int DaoxBigInt_CompareToDouble( DaoxBigInt *self, double x )
 		return self->sign;
 	}
 
-	for(i=self->size*LONG_BITS-1; i>=expon; i--){ /* check extra bits */
-		bit = (self->data[i/LONG_BITS] & (1<<(i%LONG_BITS)))>>(i%LONG_BITS);
-		if( bit ) return self->sign;
-	}
+	/* check extra bits */
+	while( n && self->data[n-1] == 0 ) n -= 1;
+	for(i=n-1; i>expon/LONG_BITS; i--) if( self->data[i] ) return self->sign;
+	if( expon/LONG_BITS < n && (self->data[expon/LONG_BITS] >> (expon%LONG_BITS)) ) return self->sign;
 
 	/* compare integer part bit by bit */
 	while( expon ){
@@ -390,8 +1086,8 @@ int DaoxBigInt_CompareToDouble( DaoxBigInt *self, double x )
 		prod = frac * 2;
 		bit = (int) prod;
 		frac = prod - bit;
-		bit2 = (self->data[expon/LONG_BITS] & (1<<(expon%LONG_BITS)))>>(expon%LONG_BITS);
-		if( bit != bit2 ) return bit - bit2;
+		bit2 = expon/LONG_BITS < n ? (self->data[expon/LONG_BITS] >> (expon%LONG_BITS)) & 1 : 0;
+		if( bit != bit2 ) return (bit2 - bit) * self->sign;
 	}
 	/* integer part is equal: */
 	if( frac ) return - self->sign;
@@ -399,8 +1095,8 @@ int DaoxBigInt_CompareToDouble( DaoxBigInt *self, double x )
 }
 void DaoxBigInt_Move( DaoxBigInt *z, DaoxBigInt *x )
 {
-	uint_t *zbuf = (uint_t*)(z->data ? z->data - z->offset - sizeof(uint_t) : NULL);
-	uint_t *xbuf = (uint_t*)(x->data ? x->data - x->offset - sizeof(uint_t) : NULL);
+	limb_t *zbuf = DaoxBigInt_Buffer( z );
+	limb_t *xbuf = DaoxBigInt_Buffer( x );
 	if( z == x || zbuf == xbuf ) return;
 #ifdef DAO_WITH_THREAD
 	DMutex_Lock( & mutex_long_sharing );
@@ -428,17 +1124,15 @@ void DaoxBigInt_Copy( DaoxBigInt *z, DaoxBigInt *x )
 	if( nx+nx < nz || nz < nx ) DaoxBigInt_Resize( z, nx );
 	z->sign = x->sign;
 	z->base = x->base;
-	memmove( z->data, x->data, nx * sizeof(uchar_t) );
+	memmove( z->data, x->data, nx * sizeof(limb_t) );
 	z->size = nx;
 	if( x->base != 2 ) DaoxBigInt_Normalize2( z );
 }
 
 void DaoxBigInt_UAdd( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 {
-	uchar_t *dx, *dy, *dz;
-	daoint nx = x->size;
-	daoint ny = y->size;
-	daoint i, sum = 0;
+	limb_t carry;
+	daoint nx, ny;
 	DaoxBigInt_Detach( z );
 	if( x->size > y->size ){
 		DaoxBigInt *tmp = x;
@@ -446,31 +1140,15 @@ void DaoxBigInt_UAdd( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 	}
 	nx = x->size;
 	ny = y->size;
-	if( z->bufSize <= ny ) DaoxBigInt_Resize( z, ny );
-	dx = x->data;
-	dy = y->data;
-	dz = z->data;
-	for(i=0; i<nx; i++){
-		sum += dx[i] + dy[i];
-		dz[i] = sum & LONG_MASK;
-		sum = sum >> LONG_BITS;
-	}
-	for(i=nx; i<ny; i++){
-		sum += dy[i];
-		dz[i] = sum & LONG_MASK;
-		sum = sum >> LONG_BITS;
-	}
-	z->size = ny;
-	while( sum ){
-		DaoxBigInt_Append( z, sum & LONG_MASK );
-		sum = sum >> LONG_BITS;
-	}
+	DaoxBigInt_Reserve( z, ny + 1 );
+	carry = DaoxLimbs_Add( z->data, y->data, ny, x->data, nx );
+	z->data[ny] = carry;
+	z->size = ny + (carry != 0);
 }
 /* x must be larger than y: */
 static void LongSub3( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 {
-	uchar_t *dx, *dy, *dz;
-	daoint i, nx, ny, sub = 1;
+	daoint nx, ny;
 
 	DaoxBigInt_Normalize2( x );
 	DaoxBigInt_Normalize2( y );
@@ -478,29 +1156,9 @@ static void LongSub3( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 	ny = y->size;
 	assert( DaoxBigInt_UCompare( x, y ) >=0 );
 	DaoxBigInt_Detach( z );
-	if( z->bufSize < nx ) DaoxBigInt_Resize( z, nx );
-	dx = x->data;
-	dy = y->data;
-	dz = z->data;
-	for(i=0; i<ny; i++){
-		/* sub = LONG_BASE + dx[i] - dy[i] - (1-sub); */
-#if 0
-		if( i >= nx ){
-			printf( "error %li %li  %i\n", nx, ny, dy[i] );
-			DaoxBigInt_Print( x, NULL );
-			DaoxBigInt_Print( y, NULL );
-		}
-#endif
-		sub += (LONG_BASE -1) + dx[i] - dy[i];
-		dz[i] = sub & LONG_MASK;
-		sub = sub >> LONG_BITS;
-	}
-	for(i=ny; i<nx; i++){
-		sub += (LONG_BASE -1) + dx[i];
-		dz[i] = sub & LONG_MASK;
-		sub = sub >> LONG_BITS;
-	}
-	while( nx && dz[ nx-1 ] ==0 ) nx --;
+	DaoxBigInt_Reserve( z, nx );
+	DaoxLimbs_Sub( z->data, x->data, nx, y->data, ny );
+	while( nx && z->data[ nx-1 ] ==0 ) nx --;
 	z->size = nx;
 }
 static int LongSub2( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y ) /* unsigned */
@@ -540,216 +1198,77 @@ void DaoxBigInt_Sub( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 		z->sign = -1;
 	}
 }
-static void DaoxBigInt_MulAdd( DaoxBigInt *z, DaoxBigInt *x, uchar_t y, short m );
-void DaoxBigInt_UMulDigitX( DaoxBigInt *z, DaoxBigInt *x, uchar_t digit );
-static void DaoxBigInt_UMulSimple( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
-{
-	daoint i, n = x->size + y->size;
-	DaoxBigInt_Detach( z );
-	if( z == x || z == y ){
-		DaoxBigIntBuffer *inbuf = buffer;
-		DaoxBigInt *z2;
-		if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
-		z2 = DaoxBigIntBuffer_NewBigInt( buffer );
-		DaoxBigInt_UMulSimple( z2, x, y, buffer );
-		DaoxBigInt_Move( z, z2 );
-		DaoxBigIntBuffer_FreeBigInt( buffer, z2 );
-		if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
-		return;
-	}
-	if( z->bufSize < n ) DaoxBigInt_Reserve( z, n );
-	z->size = n;
-	memset( z->data, 0, z->size * sizeof(uchar_t) );
-	for(i=0; i<x->size; i++) DaoxBigInt_MulAdd( z, y, x->data[i], i );
-}
-static void DaoxBigInt_Split( DaoxBigInt *x, DaoxBigInt *x1, DaoxBigInt *x0, daoint m )
-{
-	daoint size = x->size;
-	DaoxBigInt_Detach( x0 );
-	DaoxBigInt_Detach( x1 );
-	memmove( x0->data, x->data, m * sizeof(uchar_t) );
-	memmove( x1->data, x->data + m, (size-m) * sizeof(uchar_t) );
-	x0->size = m;
-	x1->size = size - m;
-}
-static void LongCat( DaoxBigInt *z, DaoxBigInt *x1, daoint m, DaoxBigInt *x0 )
-{
-	/* z might be the same object as x1: */
-	daoint n = x1->size;
-	DaoxBigInt_Detach( z );
-	if( z->bufSize < n + m + 1 ) DaoxBigInt_Reserve( z, n + m + 1 );
-	memmove( z->data + m, x1->data, n * sizeof(uchar_t) );
-	memset( z->data, 0, m * sizeof(uchar_t) );
-	z->size = m + n;
-	DaoxBigInt_UAdd( z, z, x0 );
-}
-static void LongMulSum( DaoxBigInt *z, DaoxBigInt *z2, DaoxBigInt *z1, DaoxBigInt *z0, int m )
-{
-	daoint n = m + z1->size;
-	DaoxBigInt_Detach( z );
-	DaoxBigInt_Detach( z1 );
-	if( z2 ) n = z2->size + m + m;
-	if( z->bufSize <= n ) DaoxBigInt_Reserve( z, n );
-	memmove( z->data, z0->data, z0->size * sizeof(uchar_t) );
-	if( z2 ) memmove( z->data + (m+m), z2->data, z2->size *sizeof(uchar_t) );
-	if( z1->bufSize <= z1->size+m ) DaoxBigInt_Reserve( z1, z1->size + m );
-	memmove( z1->data+m, z1->data, z1->size*sizeof(uchar_t) );
-	z->size = n;
-	z1->size += m;
-	DaoxBigInt_UAdd( z, z, z1 );
-}
-static void LongZ1( DaoxBigInt *z1, DaoxBigInt *z0, DaoxBigInt *z2 )
-{
-	daoint i, sub=2;
-	daoint nz1 = z1->size;
-	daoint nz0 = z0->size;
-	daoint nz2 = z2->size;
-	uchar_t *dz1 = z1->data;
-	uchar_t *dz0 = z0->data;
-	uchar_t *dz2 = z2->data;
-	DaoxBigInt_Detach( z1 );
-	if( nz0 < nz2 ){
-		nz0 = z2->size;
-		nz2 = z0->size;
-		dz0 = z2->data;
-		dz2 = z0->data;
-	}
-	for(i=0; i<nz2; i++){
-		sub += (2*LONG_BASE -2) + dz1[i] - (dz0[i] + dz2[i]);
-		dz1[i] = sub & LONG_MASK;
-		sub = sub >> LONG_BITS;
-	}
-	for(i=nz2; i<nz0; i++){
-		sub += (2*LONG_BASE -2) + dz1[i] - dz0[i];
-		dz1[i] = sub & LONG_MASK;
-		sub = sub >> LONG_BITS;
-	}
-	for(i=nz0; i<nz1; i++){
-		sub += (2*LONG_BASE -2) + dz1[i];
-		dz1[i] = sub & LONG_MASK;
-		sub = sub >> LONG_BITS;
-	}
-	while( nz1 && dz1[ nz1-1 ] ==0 ) nz1 --;
-	z1->size = nz1;
-}
-static void DaoxBigInt_UMulFFT( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
-{
-	DArray *vx = DaoxBigIntBuffer_NewVector( buffer );
-	DArray *vy = DaoxBigIntBuffer_NewVector( buffer );
-	dao_complex *cx, *cy;
-	uchar_t *dx = x->data;
-	uchar_t *dy = y->data;
-	daoint nx = x->size;
-	daoint ny = y->size;
-	daoint max = nx > ny ? nx : ny;
-	daoint i, nc = 1;
-	daoint c = 0;
-	int mc = 0;
-	while( (nc>>1) < max ) nc <<= 1, mc ++;
-	/* printf( "nc = %i, mc = %i, max = %i\n", nc, mc, max ); */
-	DArray_Reserve( vx, nc );
-	cx = cy = vx->data.complexes;
-	memset( cx, 0, nc*sizeof(dao_complex) );
-	for(i=0; i<nx; i++) cx[i].real = dx[i];
-	dao_fft16( cx, mc, -1 );
-	if( x == y ){
-		cy = cx;
-	}else{
-		DArray_Reserve( vy, nc );
-		cy = vy->data.complexes;
-		memset( cy, 0, nc*sizeof(dao_complex) );
-		for(i=0; i<ny; i++) cy[i].real = dy[i];
-		dao_fft16( cy, mc, -1 );
-	}
-	for(i=0; i<nc; i++) dao_complex_mul( cx[i], cx[i], cy[i] );
-	dao_fft16( cx, mc, 1 );
-	DaoxBigInt_Resize( z, nc );
-	memset( z->data, 0, nc*sizeof(uchar_t) );
-	for(i=0; i<nc; i++){
-		c += (daoint)(cx[i].real / nc + 0.5);
-		z->data[i] = c & LONG_MASK;
-		c = c >> LONG_BITS;
-	}
-	while( nc && z->data[nc-1] ==0 ) nc --;
-	DaoxBigInt_Resize( z, nc );
-	DaoxBigIntBuffer_FreeVector( buffer, vx );
-	DaoxBigIntBuffer_FreeVector( buffer, vy );
-}
+static void DaoxBigInt_MulAdd( DaoxBigInt *z, DaoxBigInt *x, limb_t y, daoint m );
+void DaoxBigInt_UMulDigitX( DaoxBigInt *z, DaoxBigInt *x, limb_t digit );
 void DaoxBigInt_UMul( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
 {
-	uchar_t *dx = x->data;
-	uchar_t *dy = y->data;
+	DArray *work;
+	limb_t *dz;
 	daoint nx = x->size;
 	daoint ny = y->size;
-	/*
-	   printf( "nx = %i,  ny = %i,  dep = %i\n", nx, ny, dep );
-	   DaoxBigInt_Print( x, NULL );
-	   DaoxBigInt_Print( y, NULL );
-	 */
+	daoint size = 0;
+	int alias = z == x || z == y;
+
+	while( nx && x->data[nx-1] ==0 ) nx --;
+	while( ny && y->data[ny-1] ==0 ) ny --;
+	if( nx < ny ){
+		DaoxBigInt *tmp = x;
+		daoint n = nx;
+		x = y;  y = tmp;
+		nx = ny;  ny = n;
+	}
 	DaoxBigInt_Detach( z );
-	if( (nx|ny) <= 1 ){
-		if( (nx&ny) == 1 ){
-			int prod = dx[0] * dy[0];
-			if( z->bufSize < 2 ) DaoxBigInt_Reserve( z, 2 );
-			z->data[0] = prod & LONG_MASK;
-			z->data[1] = prod >> LONG_BITS;
-			z->size = prod >> LONG_BITS ? 2 : (prod ? 1 : 0);
-		}else{
-			z->size = 0;
-		}
-		return;
-	}else if( nx == 1 ){
-		DaoxBigInt_UMulDigitX( z, y, dx[0] );
+	if( ny == 0 ){
+		z->size = 0;
 		return;
 	}else if( ny == 1 ){
-		DaoxBigInt_UMulDigitX( z, x, dy[0] );
+		DaoxBigInt_UMulDigitX( z, x, y->data[0] );
 		return;
-	}else if( nx <= 4 ){
-		DaoxBigInt_UMulSimple( z, x, y, buffer );
-		return;
-	}else if( ny <= 4 ){
-		DaoxBigInt_UMulSimple( z, y, x, buffer );
-		return;
-	}else if( nx < 16 && ny < 16 ){
-		DaoxBigInt_UMulSimple( z, x, y, buffer );
-		return;
-#if 0
-	}else if( nx < 64 && nx < 64 ){
-		return;
-#endif
 	}
-#if 0
-	DaoxBigInt_UMulK( z, x, y, NULL, 0 );
-#else
-	DaoxBigInt_UMulFFT( z, x, y, buffer );
-#endif
+	if( ny < BIGINT_NTT_THRESHOLD ) size = DaoxLimbs_MulSize( nx, ny );
+	work = DaoxBigIntBuffer_NewLimbs( buffer, size + (alias ? nx + ny : 0) );
+	if( alias ){ /* Multiply into the buffer, z is one of the operands: */
+		dz = (limb_t*) work->data.base + size;
+	}else{
+		DaoxBigInt_Reserve( z, nx + ny );
+		dz = z->data;
+	}
+	if( ny < BIGINT_NTT_THRESHOLD ){
+		DaoxLimbs_Mul( dz, x->data, nx, y->data, ny, (limb_t*) work->data.base );
+	}else{
+		DaoxLimbs_MulNTT( dz, x->data, nx, y->data, ny, buffer );
+	}
+	if( alias ){
+		DaoxBigInt_Reserve( z, nx + ny );
+		memcpy( z->data, dz, (nx + ny) * sizeof(limb_t) );
+	}
+	z->size = nx + ny;
+	DaoxBigInt_Normalize2( z );
+	DaoxBigIntBuffer_FreeLimbs( buffer, work );
 }
 void DaoxBigInt_Mul( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
 {
 	DaoxBigIntBuffer *inbuf = buffer;
+	int sign = x->sign * y->sign;
 	if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
 	DaoxBigInt_UMul( z, x, y, buffer );
 	DaoxBigInt_Normalize2( z );
-	/* DaoxBigInt_UMulK( z, x, y, NULL, 0 ); */
-	z->sign = x->sign * y->sign;
+	z->sign = sign;
 	if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
 }
 daoint DaoxBigInt_NormCount( DaoxBigInt *self )
 {
-	int i, d;
 	while( self->size && self->data[ self->size-1 ] ==0 ) self->size --;
 	/* if( self->size * 2 < self->bufSize ) DaoxBigInt_Resize( self->size ); */
 	if( self->size ==0 ) return 0;
-	d = self->data[ self->size-1 ];
-	for(i=1; d && (i<LONG_BITS); i++) d >>= 1;
-	return self->size * LONG_BITS + i - LONG_BITS;
+	return self->size * LONG_BITS - DaoxLimb_LeadingZeros( self->data[ self->size-1 ] );
 }
-void DaoxBigInt_UMulDigitX( DaoxBigInt *z, DaoxBigInt *x, uchar_t digit )
+void DaoxBigInt_UMulDigitX( DaoxBigInt *z, DaoxBigInt *x, limb_t digit )
 {
-	uchar_t *dz, *dx = x->data;
-	daoint i, nx = x->size;
-	uint_t carray = 0;
+	daoint nx = x->size;
+	limb_t carry;
 	if( digit == 0 ){
+		DaoxBigInt_Detach( z );
 		z->size = 0;
 		return;
 	}else if( digit == 1 ){
@@ -758,111 +1277,76 @@ void DaoxBigInt_UMulDigitX( DaoxBigInt *z, DaoxBigInt *x, uchar_t digit )
 	}
 	DaoxBigInt_Detach( z );
 	while(nx >0 && x->data[nx-1] ==0 ) nx--;
-	if( z->bufSize < nx ) DaoxBigInt_Reserve( z, nx );
-	dz = z->data;
-	z->size = nx;
-	for(i=0; i<nx; i++){
-		carray += digit * dx[i];
-		dz[i] = carray & LONG_MASK;
-		carray = carray >> LONG_BITS;
-	}
-	if( carray ) DaoxBigInt_Append( z, carray );
-	DaoxBigInt_Normalize2( z );
+	DaoxBigInt_Reserve( z, nx + 1 );
+	carry = DaoxLimbs_Mul1( z->data, x->data, nx, digit );
+	z->data[nx] = carry;
+	z->size = nx + (carry != 0);
 }
-uchar_t DaoxBigInt_UDivDigit( DaoxBigInt *z, uchar_t digit )
+limb_t DaoxBigInt_UDivDigit( DaoxBigInt *z, limb_t digit )
 {
-	daoint i, nz = z->size;
-	uint_t carray = 0;
+	daoint nz = z->size;
+	limb_t rem;
 	DaoxBigInt_Detach( z );
 	while(nz >0 && z->data[nz-1] ==0 ) nz--;
-	for(i=nz; i>0; i--){
-		carray = (carray<<LONG_BITS) | z->data[i-1];
-		z->data[i-1] = carray / digit;
-		carray = carray % digit;
-	}
+	rem = DaoxLimbs_Div1( z->data, z->data, nz, digit );
 	while(nz >0 && z->data[nz-1] ==0 ) nz--;
 	z->size = nz;
-	return carray;
+	return rem;
 }
-/* z = x * y + r; z, x: input, y, r: output */
+/*
+// z = x * y + r; z, x: input, y, r: output;
+// The quotient is rounded towards negative infinity,
+// so the remainder has the same sign as the divisor.
+*/
 void DaoxBigInt_Div( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigInt *r )
 {
-	DaoxBigInt *mul;
-	DaoxBigInt *r2;
-	uchar_t *pbase;
+	limb_t *work, *q, *rem;
 	daoint nx = x->size;
 	daoint nz = z->size;
-	daoint nr;
-	daoint hr;
-	int cmp, hx;
-	uchar_t d;
+	daoint nq, nr;
+	int sign = z->sign * x->sign;
+	int rsign = x->sign;
+	int base = z->base;
 
 	while(nx >0 && x->data[nx-1] ==0 ) nx--;
 	while(nz >0 && z->data[nz-1] ==0 ) nz--;
-	DaoxBigInt_Detach( y );
-	DaoxBigInt_Copy( r, z );
-	y->sign = z->sign * x->sign;
-	if( nz < nx ) return;
 	if( nx ==0 ){
 		/* XXX error */
-		y->size = 0;
+		DaoxBigInt_Copy( r, z );
+		DaoxBigInt_Resize( y, 0 );
 		return;
+	}
+	nq = nz >= nx ? nz - nx + 1 : 0;
+	nr = nz >= nx ? nx : nz;
+	work = (limb_t*) dao_malloc( (nq + 1 + nx + (nq ? nz + nx + 1 : 0)) * sizeof(limb_t) );
+	q = work;
+	rem = q + nq + 1;
+	q[nq] = 0;
+	if( nq == 0 ){
+		if( nz ) memcpy( rem, z->data, nz * sizeof(limb_t) );
 	}else if( nx == 1 ){
-		DaoxBigInt_Move( y, z );
-		r->size = 1;
-		r->data[0] = DaoxBigInt_UDivDigit( y, x->data[0] );
-		return;
+		rem[0] = DaoxLimbs_Div1( q, z->data, nz, x->data[0] );
+	}else{
+		DaoxLimbs_DivRem( q, rem, z->data, nz, x->data, nx, rem + nx );
 	}
-	y->size = 0; /* z might be y */
-	mul = DaoxBigInt_New();
-	r2 = DaoxBigInt_New();
-	pbase = r->data;
-	r->data = r->data + (r->size - nx);
-	r->size = nx;
-	hx = (x->data[nx-1] << LONG_BITS) | x->data[nx-2];
-	/* sliding x over r (originall equal to z) */
-	while( r->data >= pbase ){
-		if( r->size < nx || (r->size == nx && r->data[nx-1] < x->data[nx-1]) ){
-			DaoxBigInt_PushFront( y, 0 );
-			r->data --;
-			r->size ++;
-			continue;
-		}
-		assert( (r->size-1) <= nx );
-		nr = r->size;
-		hr = (r->data[nx-1] << LONG_BITS) | r->data[nx-2];
-		if( nr > nx ) hr |= ((daoint)r->data[nx]) << (LONG_BITS<<1);
-		/* using the first two digits of the divisor to guess the quotient */
-		d = hr / hx;
-		DaoxBigInt_UMulDigitX( mul, x, d );
-		cmp = DaoxBigInt_UCompare( mul, r );
-		if( cmp ==0 ){
-			r->size = 0;
-			r->data --;
-			DaoxBigInt_PushFront( y, d );
-			continue;
-		}else if( cmp >0 ){
-			d --;
-			DaoxBigInt_UMulDigitX( mul, x, d );
-		}
-		if( y->sign <0 && r->data == pbase ){
-			d ++;
-			DaoxBigInt_UMulDigitX( mul, x, d );
-			LongSub3( r2, mul, r );
-		}else{
-			LongSub3( r2, r, mul );
-		}
-		DaoxBigInt_PushFront( y, d );
-		memmove( r->data, r2->data, r2->size *sizeof(uchar_t) );
-		r->size = r2->size + 1;
-		r->data --;
-	}
-	r->size --;
-	r->data = pbase;
-	DaoxBigInt_Delete( mul );
-	DaoxBigInt_Delete( r2 );
-	DaoxBigInt_Normalize2( y );
-	DaoxBigInt_Normalize2( r );
+	while( nr && rem[nr-1] ==0 ) nr--;
+	if( sign < 0 && nr ){
+		DaoxLimbs_Add1( q, nq + 1, 1 );
+		DaoxLimbs_Sub( rem, x->data, nx, rem, nr );
+		nq += 1;
+		nr = nx;
+		while( nr && rem[nr-1] ==0 ) nr--;
+	}
+	while( nq && q[nq-1] ==0 ) nq--;
+
+	DaoxBigInt_Resize( y, nq );
+	memcpy( y->data, q, nq * sizeof(limb_t) );
+	y->sign = sign;
+	DaoxBigInt_Resize( r, nr );
+	memcpy( r->data, rem, nr * sizeof(limb_t) );
+	r->sign = rsign;
+	r->base = base;
+	dao_free( work );
 }
 void DaoxBigInt_Pow( DaoxBigInt *z, DaoxBigInt *x, daoint n, DaoxBigIntBuffer *buffer )
 {
@@ -891,72 +1375,346 @@ void DaoxBigInt_Pow( DaoxBigInt *z, DaoxBigInt *x, daoint n, DaoxBigIntBuffer *b
 	}
 	if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
 	DaoxBigInt_Copy( z, x );
-	while( 2*m <= n ){
+	/* Left to right binary exponentiation: */
+	while( 2*m <= n ) m *= 2;
+	for(m/=2; m>0; m/=2){
 		DaoxBigInt_Mul( z, z, z, buffer );
-		m *= 2;
-	}
-	if( m < n ){
-		DaoxBigInt *tmp = DaoxBigInt_New();
-		DaoxBigInt_Pow( tmp, x, n-m, buffer );
-		DaoxBigInt_Mul( z, z, tmp, buffer );
-		DaoxBigInt_Delete( tmp );
+		if( n & m ) DaoxBigInt_Mul( z, z, x, buffer );
 	}
 	if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
 }
-void DaoxBigInt_AddInt( DaoxBigInt *z, DaoxBigInt *x, daoint y, DaoxBigInt *buf )
+/*
+// Modular multiplication for the modular exponentiation: Montgomery reduction
+// (with R = 2^(LONG_BITS*size)) for an odd modulus, and Knuth's division for
+// an even modulus. All the scratch space is set up once by the caller.
+*/
+typedef struct DaoxModular DaoxModular;
+struct DaoxModular
+{
+	const limb_t  *mod;
+	daoint         size;
+	limb_t         minv;  /* -1/mod[0] mod 2^LONG_BITS for an odd modulus, otherwise zero; */
+	limb_t        *prod;  /* 2*size+1 limbs; */
+	limb_t        *quot;  /* size+1 limbs; */
+	limb_t        *work;  /* DaoxModular_WorkSize(size) limbs; */
+};
+static daoint DaoxModular_WorkSize( daoint n )
+{
+	daoint size = DaoxLimbs_MulSize( n, n );
+	return size > 3*n + 1 ? size : 3*n + 1;
+}
+static void DaoxModular_Init( DaoxModular *self, const limb_t *mod, daoint n, limb_t *space )
 {
+	limb_t inv = 1;
+	int i;
+	self->mod = mod;
+	self->size = n;
+	self->minv = 0;
+	self->prod = space;
+	self->quot = self->prod + 2*n + 1;
+	self->work = self->quot + n + 1;
+	if( (mod[0] & 1) == 0 ) return;
+	/* Newton iteration for 1/mod[0], each step doubles the correct bits: */
+	for(i=0; i<6; ++i) inv *= 2 - mod[0] * inv;
+	self->minv = - inv;
+}
+/* z[0,n) = x[0,n) * y[0,n) / R mod m (or x * y mod m); z may overlap x and y: */
+static void DaoxModular_Mul( DaoxModular *self, limb_t *z, const limb_t *x, const limb_t *y )
+{
+	const limb_t *m = self->mod;
+	limb_t *t = self->prod;
+	daoint i, n = self->size;
+
+	DaoxLimbs_Mul( t, x, n, y, n, self->work );
+	t[2*n] = 0;
+	if( self->minv == 0 ){
+		if( n == 1 ){
+			z[0] = DaoxLimbs_Div1( self->quot, t, 2, m[0] );
+		}else{
+			DaoxLimbs_DivRem( self->quot, z, t, 2*n, m, n, self->work );
+		}
+		return;
+	}
+	for(i=0; i<n; ++i){
+		limb_t carry = DaoxLimbs_MulAdd1( t + i, m, n, t[i] * self->minv );
+		DaoxLimbs_Add1( t + i + n, n + 1 - i, carry );
+	}
+	if( t[2*n] || DaoxLimbs_Compare( t + n, n, m, n ) >= 0 ){
+		DaoxLimbs_Sub( z, t + n, n, m, n );
+	}else{
+		memcpy( z, t + n, n * sizeof(limb_t) );
+	}
 }
-void DaoxBigInt_MulAdd( DaoxBigInt *Z, DaoxBigInt *X, uchar_t Y, short M )
+#define DaoxLimbs_Bit( x, i )  (((x)[(i)/LONG_BITS] >> ((i)%LONG_BITS)) & 1)
+
+/*
+// z = x^e mod m for m > 0 and e >= 0, by sliding window exponentiation
+// over the odd powers of x; the result is in [0,m).
+*/
+void DaoxBigInt_PowMod( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *e, DaoxBigInt *m, DaoxBigIntBuffer *buffer )
 {
-	daoint i, NZ, NX = X->size, NXM = NX + M;
-	uchar_t *DZ, *DX = X->data;
-	uint_t carray = 0;
+	DaoxBigIntBuffer *inbuf = buffer;
+	DaoxBigInt *base, *quot;
+	DaoxModular modular;
+	DArray *space;
+	limb_t *table, *sqr, *res;
+	daoint i, j, k, n, ebits, entries;
+	int w = 1;
 
-	DaoxBigInt_Detach( Z );
-	if( Z->bufSize < NX + M ) DaoxBigInt_Reserve( Z, NX + M );
-	DZ = Z->data;
-	for(i=Z->size; i<NXM; i++) DZ[i] = 0;
-	if( Z->size < NXM ) Z->size = NXM;
-	NZ = Z->size;
-	for(i=0; i<NX; i++){
-		carray += DX[i] * Y + DZ[i+M];
-		DZ[i+M] = carray & LONG_MASK;
-		carray = carray >> LONG_BITS;
+	ebits = DaoxBigInt_NormCount( e );
+	DaoxBigInt_NormCount( m );
+	n = m->size;
+	if( n == 1 && m->data[0] == 1 ){
+		DaoxBigInt_Resize( z, 0 );
+		z->sign = 1;
+		return;
+	}else if( ebits == 0 ){
+		DaoxBigInt_FromInteger( z, 1 );
+		return;
 	}
-	for(i=NX+M; i<NZ; i++){
-		carray += DZ[i];
-		DZ[i] = carray & LONG_MASK;
-		carray = carray >> LONG_BITS;
+	if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
+
+	if( ebits > 671 ){
+		w = 6;
+	}else if( ebits > 239 ){
+		w = 5;
+	}else if( ebits > 79 ){
+		w = 4;
+	}else if( ebits > 23 ){
+		w = 3;
+	}
+	entries = 1 << (w - 1);
+	space = DaoxBigIntBuffer_NewLimbs( buffer, (entries + 2)*n + 3*n + 2 + DaoxModular_WorkSize( n ) );
+	table = (limb_t*) space->data.base;
+	sqr = table + entries * n;
+	res = sqr + n;
+	DaoxModular_Init( & modular, m->data, n, res + n );
+
+	/* The base in [0,m), and in the Montgomery form x*R mod m for odd m: */
+	base = DaoxBigIntBuffer_NewBigInt( buffer );
+	quot = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt_Div( x, m, quot, base );
+	if( modular.minv ){
+		DaoxBigInt_ShiftLeft( base, n * LONG_BITS );
+		DaoxBigInt_Div( base, m, quot, base );
+	}
+	DaoxBigInt_NormCount( base );
+	memset( table, 0, n * sizeof(limb_t) );
+	memcpy( table, base->data, base->size * sizeof(limb_t) );
+	DaoxBigIntBuffer_FreeBigInt( buffer, base );
+	DaoxBigIntBuffer_FreeBigInt( buffer, quot );
+
+	/* table[k] = x^(2k+1): */
+	if( entries > 1 ) DaoxModular_Mul( & modular, sqr, table, table );
+	for(k=1; k<entries; ++k) DaoxModular_Mul( & modular, table + k*n, table + (k-1)*n, sqr );
+
+	/* The most significant bit of e is set, so the first window starts it: */
+	for(i=ebits-1; i>=0; ){
+		limb_t value = 0;
+		if( DaoxLimbs_Bit( e->data, i ) == 0 ){
+			DaoxModular_Mul( & modular, res, res, res );
+			i -= 1;
+			continue;
+		}
+		j = i - w + 1 > 0 ? i - w + 1 : 0;
+		while( DaoxLimbs_Bit( e->data, j ) == 0 ) j += 1;
+		for(k=i; k>=j; --k) value = (value << 1) | DaoxLimbs_Bit( e->data, k );
+		if( i == ebits-1 ){
+			memcpy( res, table + (value >> 1) * n, n * sizeof(limb_t) );
+		}else{
+			for(k=i; k>=j; --k) DaoxModular_Mul( & modular, res, res, res );
+			DaoxModular_Mul( & modular, res, res, table + (value >> 1) * n );
+		}
+		i = j - 1;
 	}
-	while( carray ){
-		DaoxBigInt_Append( Z, carray & LONG_MASK );
-		carray = carray >> LONG_BITS;
+	if( modular.minv ){ /* Out of the Montgomery form: */
+		memset( sqr, 0, n * sizeof(limb_t) );
+		sqr[0] = 1;
+		DaoxModular_Mul( & modular, res, res, sqr );
 	}
+	DaoxBigInt_Resize( z, n );
+	memcpy( z->data, res, n * sizeof(limb_t) );
+	z->sign = 1;
+	DaoxBigInt_Normalize2( z );
+	DaoxBigIntBuffer_FreeLimbs( buffer, space );
+	if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
+}
+/*
+// q = |x| / |y| and r = |x| % |y| for y != 0, with the work space from the buffer;
+// q and r must be distinct from x and y.
+*/
+static void DaoxBigInt_UDivRem( DaoxBigInt *q, DaoxBigInt *r, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
+{
+	daoint nx = x->size, ny = y->size;
+	while( nx > 0 && x->data[nx-1] == 0 ) nx --;
+	while( ny > 0 && y->data[ny-1] == 0 ) ny --;
+	q->sign = r->sign = 1;
+	if( nx < ny ){
+		DaoxBigInt_Resize( q, 0 );
+		DaoxBigInt_Resize( r, nx );
+		memcpy( r->data, x->data, nx * sizeof(limb_t) );
+		return;
+	}
+	DaoxBigInt_Resize( q, nx - ny + 1 );
+	if( ny == 1 ){
+		DaoxBigInt_Resize( r, 1 );
+		r->data[0] = DaoxLimbs_Div1( q->data, x->data, nx, y->data[0] );
+	}else{
+		DArray *work = DaoxBigIntBuffer_NewLimbs( buffer, nx + ny + 1 );
+		DaoxBigInt_Resize( r, ny );
+		DaoxLimbs_DivRem( q->data, r->data, x->data, nx, y->data, ny, (limb_t*) work->data.base );
+		DaoxBigIntBuffer_FreeLimbs( buffer, work );
+	}
+	DaoxBigInt_Normalize2( q );
+	DaoxBigInt_Normalize2( r );
+}
+/* z = gcd(x,y) >= 0, by the Euclidean algorithm: */
+void DaoxBigInt_GCD( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigIntBuffer *inbuf = buffer;
+	DaoxBigInt *a, *b, *q, *r, *t;
+
+	if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
+	a = DaoxBigIntBuffer_NewBigInt( buffer );
+	b = DaoxBigIntBuffer_NewBigInt( buffer );
+	q = DaoxBigIntBuffer_NewBigInt( buffer );
+	r = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt_Move( a, x );
+	DaoxBigInt_Move( b, y );
+	DaoxBigInt_NormCount( b );
+	while( b->size ){
+		DaoxBigInt_UDivRem( q, r, a, b, buffer );
+		t = a;  a = b;  b = r;  r = t;
+	}
+	DaoxBigInt_Move( z, a );
+	z->sign = 1;
+	DaoxBigIntBuffer_FreeBigInt( buffer, a );
+	DaoxBigIntBuffer_FreeBigInt( buffer, b );
+	DaoxBigIntBuffer_FreeBigInt( buffer, q );
+	DaoxBigIntBuffer_FreeBigInt( buffer, r );
+	if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
+}
+/*
+// Extended Euclidean algorithm: g = gcd(x,y) >= 0 and the coefficients with
+// x*s + y*t = g; "t" may be NULL.
+*/
+void DaoxBigInt_ExtGCD( DaoxBigInt *g, DaoxBigInt *s, DaoxBigInt *t, DaoxBigInt *x, DaoxBigInt *y, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigIntBuffer *inbuf = buffer;
+	DaoxBigInt *r0, *r1, *s0, *s1, *q, *p, *u, *tmp;
+	int xsign = x->sign, ysign = y->sign;
+
+	if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
+	r0 = DaoxBigIntBuffer_NewBigInt( buffer );
+	r1 = DaoxBigIntBuffer_NewBigInt( buffer );
+	s0 = DaoxBigIntBuffer_NewBigInt( buffer );
+	s1 = DaoxBigIntBuffer_NewBigInt( buffer );
+	q = DaoxBigIntBuffer_NewBigInt( buffer );
+	p = DaoxBigIntBuffer_NewBigInt( buffer );
+	u = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt_Move( r0, x );
+	DaoxBigInt_Move( r1, y );
+	r0->sign = r1->sign = 1;
+	DaoxBigInt_FromInteger( s0, 1 );
+	DaoxBigInt_NormCount( r1 );
+	/* Invariant: |x|*s0 = r0 and |x|*s1 = r1 modulo |y|: */
+	while( r1->size ){
+		DaoxBigInt_UDivRem( q, p, r0, r1, buffer );
+		tmp = r0;  r0 = r1;  r1 = p;  p = tmp;
+		DaoxBigInt_Mul( p, q, s1, buffer );
+		DaoxBigInt_Sub( u, s0, p );
+		tmp = s0;  s0 = s1;  s1 = u;  u = tmp;
+	}
+	if( t ){ /* t = (g - |x|*s0) / |y|, exactly: */
+		DaoxBigInt_NormCount( y );
+		if( y->size ){
+			DaoxBigInt_Move( q, x );
+			q->sign = 1;
+			DaoxBigInt_Mul( p, q, s0, buffer );
+			DaoxBigInt_Sub( u, r0, p );
+			DaoxBigInt_Move( q, y );
+			q->sign = 1;
+			DaoxBigInt_Div( u, q, t, s1 );
+			t->sign *= ysign;
+		}else{
+			DaoxBigInt_Resize( t, 0 );
+			t->sign = 1;
+		}
+		DaoxBigInt_Normalize2( t );
+	}
+	DaoxBigInt_Move( g, r0 );
+	DaoxBigInt_Move( s, s0 );
+	s->sign *= xsign;
+	DaoxBigInt_Normalize2( s );
+	DaoxBigIntBuffer_FreeBigInt( buffer, r0 );
+	DaoxBigIntBuffer_FreeBigInt( buffer, r1 );
+	DaoxBigIntBuffer_FreeBigInt( buffer, s0 );
+	DaoxBigIntBuffer_FreeBigInt( buffer, s1 );
+	DaoxBigIntBuffer_FreeBigInt( buffer, q );
+	DaoxBigIntBuffer_FreeBigInt( buffer, p );
+	DaoxBigIntBuffer_FreeBigInt( buffer, u );
+	if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
+}
+/* z = 1/x mod m in [0,m) for m > 0; return zero if x is not invertible modulo m: */
+int DaoxBigInt_ModInverse( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *m, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigIntBuffer *inbuf = buffer;
+	DaoxBigInt *a, *g, *q;
+	int ok;
+
+	if( buffer == NULL ) buffer = DaoxBigIntBuffer_New();
+	a = DaoxBigIntBuffer_NewBigInt( buffer );
+	g = DaoxBigIntBuffer_NewBigInt( buffer );
+	q = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt_Div( x, m, q, a );
+	DaoxBigInt_ExtGCD( g, a, NULL, a, m, buffer );
+	DaoxBigInt_NormCount( g );
+	ok = g->size == 1 && g->data[0] == 1;
+	if( ok ) DaoxBigInt_Div( a, m, q, z );
+	DaoxBigIntBuffer_FreeBigInt( buffer, a );
+	DaoxBigIntBuffer_FreeBigInt( buffer, g );
+	DaoxBigIntBuffer_FreeBigInt( buffer, q );
+	if( buffer != inbuf ) DaoxBigIntBuffer_Delete( buffer );
+	return ok;
+}
+void DaoxBigInt_AddInt( DaoxBigInt *z, DaoxBigInt *x, daoint y, DaoxBigInt *buf )
+{
+}
+static void DaoxBigInt_MulAdd( DaoxBigInt *z, DaoxBigInt *x, limb_t y, daoint m )
+{
+	daoint i, nx = x->size;
+	limb_t carry;
+
+	DaoxBigInt_Detach( z );
+	DaoxBigInt_Reserve( z, nx + m + 1 );
+	for(i=z->size; i<nx+m; i++) z->data[i] = 0;
+	if( z->size < nx + m ) z->size = nx + m;
+	carry = DaoxLimbs_MulAdd1( z->data + m, x->data, nx, y );
+	carry = DaoxLimbs_Add1( z->data + nx + m, z->size - nx - m, carry );
+	if( carry ) DaoxBigInt_Append( z, carry );
 }
 void DaoxBigInt_MulInt( DaoxBigInt *z, DaoxBigInt *x, daoint y )
 {
-	int m = 0, sign = 1;
+	size_t u = y < 0 ? - (size_t) y : (size_t) y;
+	int m = 0;
 	if( y ==0 ){
+		DaoxBigInt_Detach( z );
 		z->size = 0;
 		return;
-	}else if( y < 0 ){
-		sign = -1;
-		y = - y;
 	}
 	DaoxBigInt_Detach( z );
-	z->sign = x->sign * sign;
+	z->sign = x->sign * (y < 0 ? -1 : 1);
 	if( z->bufSize < x->size ) DaoxBigInt_Resize( z, x->size );
 	z->size = x->size;
-	memset( z->data, 0, z->size * sizeof(uchar_t) );
-	while( y ){
-		DaoxBigInt_MulAdd( z, x, y & LONG_MASK, m++ );
-		y = y >> LONG_BITS;
+	memset( z->data, 0, z->size * sizeof(limb_t) );
+	for(; u; u = (sizeof(size_t) > sizeof(limb_t)) ? (u >> (LONG_BITS/2)) >> (LONG_BITS/2) : 0){
+		DaoxBigInt_MulAdd( z, x, (limb_t) u, m++ );
 	}
 }
 void DaoxBigInt_BitAND( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 {
 	daoint i, min = x->size < y->size ? x->size : y->size;
-	uchar_t *dx, *dy, *dz;
+	limb_t *dx, *dy, *dz;
 	DaoxBigInt_Resize( z, min );
 	dx = x->data; dy = y->data; dz = z->data;
 	for(i=0; i<min; i++) dz[i] = dx[i] & dy[i];
@@ -964,7 +1722,7 @@ void DaoxBigInt_BitAND( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 void DaoxBigInt_BitOR( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 {
 	daoint i, max = x->size > y->size ? x->size : y->size;
-	uchar_t *dx, *dy, *dz;
+	limb_t *dx, *dy, *dz;
 	DaoxBigInt_Resize( z, max );
 	dx = x->data; dy = y->data; dz = z->data;
 	if( max == x->size ){
@@ -978,7 +1736,7 @@ void DaoxBigInt_BitOR( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 void DaoxBigInt_BitXOR( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 {
 	daoint i, max = x->size > y->size ? x->size : y->size;
-	uchar_t *dx, *dy, *dz;
+	limb_t *dx, *dy, *dz;
 	DaoxBigInt_Resize( z, max );
 	dx = x->data; dy = y->data; dz = z->data;
 	if( max == x->size ){
@@ -991,115 +1749,372 @@ void DaoxBigInt_BitXOR( DaoxBigInt *z, DaoxBigInt *x, DaoxBigInt *y )
 }
 void DaoxBigInt_ShiftLeft( DaoxBigInt *z, int bits )
 {
-	uchar_t *dz;
-	daoint i, k, nz = z->size;
+	daoint k, nz = z->size;
+	limb_t out;
+	if( nz == 0 || bits <= 0 ) return;
 	k = bits / LONG_BITS;
 	DaoxBigInt_Detach( z );
-	dz = z->data;
 	if( k && z->offset >= k ){
 		z->offset -= k;
 		z->data -= k;
 		z->size += k;
-		memset( z->data, 0, k * sizeof(uchar_t) );
+		memset( z->data, 0, k * sizeof(limb_t) );
 	}else if( k ){
 		DaoxBigInt_Resize( z, nz + k + 1 );
-		memmove( z->data + k, z->data, nz * sizeof(uchar_t) );
-		memset( z->data, 0, k * sizeof(uchar_t) );
+		memmove( z->data + k, z->data, nz * sizeof(limb_t) );
+		memset( z->data, 0, k * sizeof(limb_t) );
 		z->size --;
-		dz = z->data;
-		nz = z->size;
 	}
+	nz = z->size;
 	k = bits % LONG_BITS;
 	if( k == 0 ) return;
-	i = dz[nz-1] >> (LONG_BITS-k);
-	if( i ) DaoxBigInt_Append( z, i );
-	dz = z->data;
-	for(i=nz-1; i>0; i--) dz[i] = ((dz[i]<<k) | dz[i-1]>>(LONG_BITS-k)) & LONG_MASK;
-	dz[0] = (dz[0] << k) & LONG_MASK;
+	out = DaoxLimbs_ShiftLeft( z->data, z->data, nz, k );
+	if( out ) DaoxBigInt_Append( z, out );
 }
 void DaoxBigInt_ShiftRight( DaoxBigInt *z, int bits )
 {
-	uchar_t *dz;
-	daoint i, k, nz = z->size;
+	daoint k, nz = z->size;
+	if( bits <= 0 ) return;
 	if( bits >= nz * LONG_BITS ){
 		DaoxBigInt_Clear( z );
 		return;
 	}
 	DaoxBigInt_Detach( z );
-	dz = z->data;
 	k = bits / LONG_BITS;
-	if( k && (k + z->offset) < z->size/10 ){
+	if( k && (k + z->offset) < z->size/10 && (k + z->offset) < 0xffff ){
 		z->offset += k;
 		z->data += k;
+		z->size -= k;
 	}else if( k ){
-		memmove( z->data, z->data + k, (nz-k) * sizeof(uchar_t) );
+		memmove( z->data, z->data + k, (nz-k) * sizeof(limb_t) );
 		DaoxBigInt_Resize( z, nz-k );
-		dz = z->data;
-		nz = z->size;
 	}
+	nz = z->size;
 	k = bits % LONG_BITS;
 	if( k == 0 ) return;
-	nz --;
-	for(i=0; i<nz; i++) dz[i] = (( (dz[i+1]<<LONG_BITS) |dz[i] )>>k) & LONG_MASK;
-	dz[nz] = dz[nz] >> k;
-	if( dz[nz] ==0 ) z->size --;
+	DaoxLimbs_ShiftRight( z->data, z->data, nz, k );
+	if( z->data[nz-1] ==0 ) z->size --;
 }
 void DaoxBigInt_Flip( DaoxBigInt *self )
 {
 	daoint i;
 	DaoxBigInt_Detach( self );
-	for(i=0; i<self->size; i++) self->data[i] = (LONG_BASE-1) ^ self->data[i];
+	for(i=0; i<self->size; i++) self->data[i] = ~ self->data[i];
+}
+
+const int base_bits[] = {0,0,1,0,2,0,0,0,3,0,0,0,0,0,0,0,4};
+const int base_masks[] = {0,0,1,0,3,0,0,0,7,0,0,0,0,0,0,0,15};
+
+/* The "w" (at most 4) bits starting from the bit "pos": */
+static int DaoxBigInt_GetBits( DaoxBigInt *self, daoint pos, int w )
+{
+	daoint m = pos / LONG_BITS;
+	int shift = pos % LONG_BITS;
+	limb_t bits = self->data[m] >> shift;
+	if( shift + w > LONG_BITS && m + 1 < self->size ) bits |= self->data[m+1] << (LONG_BITS - shift);
+	return bits & ((1<<w) - 1);
+}
+static void DaoxBigInt_SetBits( DaoxBigInt *self, daoint pos, int w, limb_t bits )
+{
+	daoint m = pos / LONG_BITS;
+	int shift = pos % LONG_BITS;
+	limb_t mask = ((limb_t)1 << w) - 1;
+	self->data[m] = (self->data[m] & ~(mask << shift)) | (bits << shift);
+	if( shift + w > LONG_BITS && m + 1 < self->size ){
+		shift = LONG_BITS - shift;
+		self->data[m+1] = (self->data[m+1] & ~(mask >> shift)) | (bits >> shift);
+	}
+}
+/* The largest power of "base" in a limb, and its exponent: */
+static limb_t DaoxBigInt_PowerBase( int base, int *powers )
+{
+	limb_t power = base;
+	*powers = 1;
+	while( power <= LONG_MASK / base ){
+		power *= base;
+		*powers += 1;
+	}
+	return power;
+}
+static void DaoxBigInt_UAddDigit( DaoxBigInt *z, limb_t digit )
+{
+	DaoxBigInt_Detach( z );
+	if( DaoxLimbs_Add1( z->data, z->size, digit ) ) DaoxBigInt_Append( z, 1 );
 }
-void DaoxBigInt_Convert( DaoxBigInt *self, int base, DaoxBigInt *result, int tobase )
+/* z -= digit, z must not be less than the digit: */
+static void DaoxBigInt_USubDigit( DaoxBigInt *z, limb_t digit )
 {
-	double baselog = log(tobase)/log(2);
-	daoint ispower2 = baselog == (daoint) baselog;
-	daoint i, j, powers = 1, powerbase = tobase;
-	daoint intbits = CHAR_BIT * sizeof(daoint);
-	daoint n = 1 + self->size * (log(base) / log(tobase) + 1);
-	DaoxBigInt *source;
+	DaoxBigInt_Detach( z );
+	DaoxLimbs_Sub( z->data, z->data, z->size, & digit, 1 );
+	DaoxBigInt_Normalize2( z );
+}
+/*
+// z = floor(2^(2*s)/x), where x has s bits; by Newton iteration from
+// the reciprocal of the leading half of x for large x.
+*/
+static void DaoxBigInt_Reciprocal( DaoxBigInt *z, DaoxBigInt *x, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigInt *p = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt *e = DaoxBigIntBuffer_NewBigInt( buffer );
+	daoint h, s = DaoxBigInt_NormCount( x );
 
-	if( base == tobase && tobase == 256 ){
-		DaoxBigInt_Copy( result, self );
+	DaoxBigInt_FromInteger( p, 1 );
+	DaoxBigInt_ShiftLeft( p, 2*s );
+	if( x->size <= BIGINT_CONVERT_THRESHOLD ){
+		DaoxBigInt_Div( p, x, z, e );
+		DaoxBigIntBuffer_FreeBigInt( buffer, p );
+		DaoxBigIntBuffer_FreeBigInt( buffer, e );
 		return;
 	}
-	DaoxBigInt_Reserve( result, n );
-	if( ispower2 && tobase < 256 ){
-		daoint tobits = (daoint) baselog;
-		daoint tomask = ((uchar_t)(0xff << (8-tobits))) >> (8-tobits);
-		daoint chunks = 8 / tobits;
-		for(i=0; i<self->size; ++i){
-			for(j=0; j<chunks; ++j){
-				result->data[result->size++] = (self->data[i] >> (j*tobits)) & tomask;
-			}
+	/* y = floor(2^(2*h)/t) for the leading h bits t of x: */
+	h = s/2 + LONG_BITS;
+	DaoxBigInt_Copy( e, x );
+	DaoxBigInt_ShiftRight( e, s - h );
+	DaoxBigInt_Reciprocal( z, e, buffer );
+
+	/* Newton step from X = y*2^(s-h): X + X*(2^(2*s) - x*X)/2^(2*s): */
+	DaoxBigInt_Mul( e, x, z, buffer );
+	DaoxBigInt_ShiftLeft( e, s - h );
+	DaoxBigInt_Sub( e, p, e );
+	DaoxBigInt_Mul( e, e, z, buffer );
+	DaoxBigInt_ShiftRight( e, s + h );
+	DaoxBigInt_ShiftLeft( z, s - h );
+	DaoxBigInt_Add( z, z, e );
+
+	/* The error is a few units at most: */
+	DaoxBigInt_Mul( e, z, x, buffer );
+	DaoxBigInt_Sub( e, p, e );
+	while( DaoxBigInt_CompareToZero( e ) < 0 ){
+		DaoxBigInt_Add( e, e, x );
+		DaoxBigInt_USubDigit( z, 1 );
+	}
+	while( DaoxBigInt_UCompare( e, x ) >= 0 ){
+		DaoxBigInt_Sub( e, e, x );
+		DaoxBigInt_UAddDigit( z, 1 );
+	}
+	DaoxBigIntBuffer_FreeBigInt( buffer, p );
+	DaoxBigIntBuffer_FreeBigInt( buffer, e );
+}
+/* The cached power base^(d*2^k) (see DaoxBigIntBuffer): */
+static DaoxBigInt* DaoxBigIntBuffer_GetPower( DaoxBigIntBuffer *self, int base, int k )
+{
+	if( self->powerBase != base ){
+		DaoxBigIntBuffer_ClearPowers( self );
+		self->powerBase = base;
+	}
+	while( self->powers->size <= k ){
+		DaoxBigInt *power = DaoxBigInt_New();
+		if( self->powers->size == 0 ){
+			int powers;
+			DaoxBigInt_Resize( power, 1 );
+			power->data[0] = DaoxBigInt_PowerBase( base, & powers );
+		}else{
+			DaoxBigInt *last = (DaoxBigInt*) DList_Back( self->powers );
+			DaoxBigInt_Mul( power, last, last, self );
 		}
-		return;
+		DList_Append( self->powers, power );
+		DList_Append( self->recips, NULL );
 	}
+	return (DaoxBigInt*) self->powers->items.pVoid[k];
+}
+/*
+// q = x / P, r = x % P for P = base^(d*2^k) and x < P*P, by Barrett division
+// with the cached reciprocal of P:
+*/
+static void DaoxBigInt_DivPower( DaoxBigInt *q, DaoxBigInt *r, DaoxBigInt *x, int k, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigInt *power = (DaoxBigInt*) buffer->powers->items.pVoid[k];
+	DaoxBigInt *recip = (DaoxBigInt*) buffer->recips->items.pVoid[k];
+	DaoxBigInt *t = DaoxBigIntBuffer_NewBigInt( buffer );
+	daoint s = DaoxBigInt_NormCount( power );
 
-	source = DaoxBigInt_New();
-	DaoxBigInt_Copy( source, self );
-	while( ((powerbase * tobase) >> (intbits - LONG_BITS)) == 0 ){
-		powerbase *= tobase;
-		powers += 1;
-	}
-	DaoxBigInt_Reserve( result, n + powers );
-	result->size = 0;
-	while( source->size ){
-		daoint remainder = 0;
-		for(i=source->size-1; i>=0; --i){
-			daoint div, num = source->data[i] + (remainder * base);
-			source->data[i] = div = num / powerbase;
-			remainder = num - div * powerbase;
+	if( recip == NULL ){
+		recip = DaoxBigInt_New();
+		DaoxBigInt_Reciprocal( recip, power, buffer );
+		buffer->recips->items.pVoid[k] = recip;
+	}
+	DaoxBigInt_Copy( t, x );
+	DaoxBigInt_ShiftRight( t, s - 1 );
+	DaoxBigInt_Mul( q, t, recip, buffer );
+	DaoxBigInt_ShiftRight( q, s + 1 );
+	DaoxBigInt_Mul( t, q, power, buffer );
+	DaoxBigInt_Sub( r, x, t );
+	/* The estimated quotient is short by at most two: */
+	while( DaoxBigInt_UCompare( r, power ) >= 0 ){
+		DaoxBigInt_Sub( r, r, power );
+		DaoxBigInt_UAddDigit( q, 1 );
+	}
+	DaoxBigIntBuffer_FreeBigInt( buffer, t );
+}
+/*
+// Append the digits of x[0,n) in a base that is not a power of 2 to "s",
+// with leading zeros up to "pad" digits; by repeated division by the largest
+// power of the base in a limb.
+*/
+static void DaoxLimbs_PrintDigits( const limb_t *x, daoint n, int base, daoint pad, DString *s )
+{
+	const char *digits = "0123456789abcdef";
+	daoint i, count = 0, start = s->size;
+	int j, powers;
+	limb_t power = DaoxBigInt_PowerBase( base, & powers );
+	limb_t *source = (limb_t*) dao_malloc( (n + 1) * sizeof(limb_t) );
+	char *buf = (char*) dao_malloc( (n * LONG_BITS / (LONG_BITS - 4) + 1) * powers );
+	char *chars;
+
+	if( n ) memcpy( source, x, n * sizeof(limb_t) );
+	while( n && source[n-1] ==0 ) n --;
+	while( n ){
+		limb_t rem = DaoxLimbs_Div1( source, source, n, power );
+		while( n && source[n-1] ==0 ) n --;
+		for(j=0; j<powers; ++j){
+			buf[count++] = digits[ rem % base ];
+			rem = rem / base;
 		}
-		while( source->size && source->data[ source->size - 1 ] == 0 ) source->size -= 1;
-		j = powers;
-		while( j-- ){
-			result->data[result->size++] = remainder % tobase;
-			remainder = remainder / tobase;
+	}
+	while( count > (pad == 0) && buf[count-1] == '0' ) count -= 1;
+	if( count == 0 && pad == 0 ) buf[count++] = '0';
+	if( pad < count ) pad = count;
+	DString_Resize( s, start + pad );
+	chars = s->chars + start;
+	for(i=count; i<pad; ++i) *(chars++) = '0';
+	for(i=0; i<count; ++i) chars[i] = buf[count-1-i];
+	dao_free( source );
+	dao_free( buf );
+}
+/*
+// Divide-and-conquer printing of x < P*P for P = base^(d*2^k):
+// the digits of x / P followed by the d*2^k digits of x % P.
+*/
+static void DaoxBigInt_PrintPowers( DaoxBigInt *x, int base, int k, daoint pad, DString *s, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigInt *q, *r;
+	daoint digits;
+	int powers;
+
+	if( x->size < BIGINT_CONVERT_THRESHOLD ){
+		DaoxLimbs_PrintDigits( x->data, x->size, base, pad, s );
+		return;
+	}
+	DaoxBigInt_PowerBase( base, & powers );
+	digits = (daoint) powers << k;
+	q = DaoxBigIntBuffer_NewBigInt( buffer );
+	r = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt_DivPower( q, r, x, k, buffer );
+	if( pad == 0 && q->size == 0 ){ /* No leading zeros: */
+		DaoxBigInt_PrintPowers( r, base, k-1, 0, s, buffer );
+	}else{
+		DaoxBigInt_PrintPowers( q, base, k-1, pad ? pad - digits : 0, s, buffer );
+		DaoxBigInt_PrintPowers( r, base, k-1, digits, s, buffer );
+	}
+	DaoxBigIntBuffer_FreeBigInt( buffer, q );
+	DaoxBigIntBuffer_FreeBigInt( buffer, r );
+}
+/* Append the digits of the magnitude in "base" to "s": */
+static void DaoxBigInt_PrintDigits( DaoxBigInt *self, int base, DString *s )
+{
+	const char *digits = "0123456789abcdef";
+	daoint i, count, start = s->size;
+	daoint n = self->size;
+	int w = base <= 16 ? base_bits[base] : 0;
+	char *chars;
+
+	while( n && self->data[n-1] ==0 ) n --;
+	if( n == 0 ){
+		DString_AppendChar( s, '0' );
+		return;
+	}
+	if( w ){
+		count = (n * LONG_BITS - DaoxLimb_LeadingZeros( self->data[n-1] ) + w - 1) / w;
+		DString_Resize( s, start + count );
+		chars = s->chars + start + count - 1;
+		for(i=0; i<count; ++i) chars[-i] = digits[ DaoxBigInt_GetBits( self, i*w, w ) ];
+	}else if( n < BIGINT_CONVERT_THRESHOLD ){
+		DaoxLimbs_PrintDigits( self->data, n, base, 0, s );
+	}else{
+		DaoxBigIntBuffer *buffer = DaoxBigIntBuffer_New();
+		DaoxBigInt *x = DaoxBigIntBuffer_NewBigInt( buffer );
+		int k = 0;
+
+		DaoxBigInt_Move( x, self );
+		DaoxBigInt_Normalize2( x );
+		x->sign = 1;
+		/* Find the smallest k with x < P*P = base^(d*2^(k+1)): */
+		while( DaoxBigInt_UCompare( DaoxBigIntBuffer_GetPower( buffer, base, k+1 ), x ) <= 0 ) k += 1;
+		DaoxBigInt_PrintPowers( x, base, k, 0, s, buffer );
+		DaoxBigIntBuffer_FreeBigInt( buffer, x );
+		DaoxBigIntBuffer_Delete( buffer );
+	}
+}
+/* Convert the digit values (most significant first) by limb sized chunks: */
+static void DaoxBigInt_ParseChunks( DaoxBigInt *self, const uchar_t *digits, daoint n, int base )
+{
+	int powers;
+	daoint i = 0, j, size = 0;
+
+	DaoxBigInt_PowerBase( base, & powers );
+	DaoxBigInt_Resize( self, n / powers + 1 );
+	while( i < n ){
+		daoint chunk = i == 0 && (n % powers) ? n % powers : powers;
+		limb_t value = 0, carry, mult = 1;
+		for(j=0; j<chunk; ++j, ++i){
+			value = value * base + digits[i];
+			mult *= base;
 		}
+		carry = DaoxLimbs_Mul1( self->data, self->data, size, mult );
+		if( carry ) self->data[size++] = carry;
+		carry = DaoxLimbs_Add1( self->data, size, value );
+		if( carry ) self->data[size++] = carry;
 	}
-	while( result->size && result->data[result->size-1] == 0 ) result->size -= 1;
-	DaoxBigInt_Delete( source );
+	self->size = size;
+	self->sign = 1;
+	DaoxBigInt_Normalize2( self );
+}
+/*
+// Divide-and-conquer parsing: the leading digits times P = base^(d*2^k)
+// plus the d*2^k trailing digits, for the largest k with d*2^k < n.
+*/
+static void DaoxBigInt_ParsePowers( DaoxBigInt *self, const uchar_t *digits, daoint n, int base, DaoxBigIntBuffer *buffer )
+{
+	DaoxBigInt *high;
+	daoint m;
+	int k = 0, powers;
+
+	DaoxBigInt_PowerBase( base, & powers );
+	if( n < BIGINT_CONVERT_THRESHOLD * powers ){
+		DaoxBigInt_ParseChunks( self, digits, n, base );
+		return;
+	}
+	while( ((daoint) powers << (k+1)) < n ) k += 1;
+	m = (daoint) powers << k;
+	high = DaoxBigIntBuffer_NewBigInt( buffer );
+	DaoxBigInt_ParsePowers( high, digits, n - m, base, buffer );
+	DaoxBigInt_ParsePowers( self, digits + n - m, m, base, buffer );
+	DaoxBigInt_Mul( high, high, DaoxBigIntBuffer_GetPower( buffer, base, k ), buffer );
+	DaoxBigInt_UAdd( self, self, high );
+	DaoxBigIntBuffer_FreeBigInt( buffer, high );
+}
+/* Convert the digit values (most significant first) in "base" to the magnitude: */
+static void DaoxBigInt_ParseDigits( DaoxBigInt *self, const uchar_t *digits, daoint n, int base )
+{
+	daoint i;
+	int sign = self->sign;
+	int w = base <= 16 ? base_bits[base] : 0;
+	int powers;
+
+	DaoxBigInt_PowerBase( base, & powers );
+	if( w ){
+		DaoxBigInt_Resize( self, n * w / LONG_BITS + 1 );
+		memset( self->data, 0, self->size * sizeof(limb_t) );
+		for(i=0; i<n; ++i) DaoxBigInt_SetBits( self, i*w, w, digits[n-1-i] );
+	}else if( n < BIGINT_CONVERT_THRESHOLD * powers ){
+		DaoxBigInt_ParseChunks( self, digits, n, base );
+	}else{
+		DaoxBigIntBuffer *buffer = DaoxBigIntBuffer_New();
+		DaoxBigInt_ParsePowers( self, digits, n, base, buffer );
+		DaoxBigIntBuffer_Delete( buffer );
+	}
+	self->sign = sign;
+	DaoxBigInt_Normalize2( self );
 }
 static void DaoxBigInt_PrintBits( DaoxBigInt *self, DString *s )
 {
@@ -1108,14 +2123,16 @@ static void DaoxBigInt_PrintBits( DaoxBigInt *self, DString *s )
 	int j;
 	if( s == NULL ) s = DString_New();
 	DString_SetChars( s, "0" );
+	while( i && self->data[i-1] ==0 ) i --;
 	if( i ==0 ) goto Finish;
 	DString_Clear( s );
 
-	for(i=self->size; i>0; i--){
-		int digit = self->data[i-1];
-		for(j=LONG_BITS-1; j>=0; j--){
-			DString_AppendChar( s, '0' + ((digit & (1<<j))>>j) );
-		}
+	/* Leading zeros up to the byte boundary are printed: */
+	j = LONG_BITS - 1 - DaoxLimb_LeadingZeros( self->data[i-1] );
+	j = 8 * (j / 8) + 7;
+	for(; i>0; i--, j=LONG_BITS-1){
+		limb_t digit = self->data[i-1];
+		for(; j>=0; j--) DString_AppendChar( s, '0' + ((digit >> j) & 1) );
 	}
 Finish:
 	DString_AppendChars( s, "L2" );
@@ -1126,8 +2143,6 @@ Finish:
 }
 void DaoxBigInt_Print( DaoxBigInt *self, DString *s )
 {
-	const char *digits = "0123456789abcdef";
-	DaoxBigInt *based;
 	DString *s2 = s;
 	daoint i = self->size;
 	if( self->base == 2 ){
@@ -1140,14 +2155,8 @@ void DaoxBigInt_Print( DaoxBigInt *self, DString *s )
 	if( i ==0 ) goto Finish;
 	DString_Clear( s );
 	if( self->sign <0 ) DString_AppendChar( s, '-' );
-
-	based = DaoxBigInt_New();
-	DaoxBigInt_Convert( self, LONG_BASE, based, self->base );
-	i = based->size;
-	while(i >0 && based->data[i-1] ==0 ) i--;
-	for(; i>=1; i--) DString_AppendChar( s, digits[based->data[i-1]] );
+	DaoxBigInt_PrintDigits( self, self->base, s );
 	DString_AppendChar( s, 'L' );
-	DaoxBigInt_Delete( based );
 Finish:
 	if( self->base != 10 ){
 		char buf[20];
@@ -1161,51 +2170,32 @@ Finish:
 }
 daoint DaoxBigInt_ToInteger( DaoxBigInt *self )
 {
-	daoint i, k=1, n = (sizeof(daoint)*8) / LONG_BITS;
-	daoint res = 0;
-	switch( self->size ){
-	case 0 : break;
-	case 1 : res = self->data[0]; break;
-	case 2 : res = self->data[0] + LONG_BASE * self->data[1]; break;
-	default :
-			 if( self->size < n ) n = self->size;
-			 for(i=0; i<n; i++, k*=LONG_BASE) res += k * self->data[i];
-			 break;
+	daoint i, n = (sizeof(daoint)*8 + LONG_BITS - 1) / LONG_BITS;
+	size_t res = 0;
+	if( self->size < n ) n = self->size;
+	for(i=n-1; i>=0; i--){
+		res = sizeof(size_t) > sizeof(limb_t) ? (res << (LONG_BITS/2)) << (LONG_BITS/2) : 0;
+		res |= self->data[i];
 	}
-	return res * self->sign;
+	return (daoint) res * self->sign;
 }
 double DaoxBigInt_ToDouble( DaoxBigInt *self )
 {
-	daoint i, n;
-	double res = 0.0, k = 1.0;
-	switch( self->size ){
-	case 0 : break;
-	case 1 : res = self->data[0]; break;
-	case 2 : res = self->data[0] + LONG_BASE * self->data[1]; break;
-	default :
-		for( n = 0; n < self->size && self->data[n] == 0; n++ );
-		if( n == self->size )
-			return res;
-		for( i = n; i < self->size; i++, k *= LONG_BASE )
-			res += k * self->data[i];
-		if( n != 0 )
-			res = ldexp( res, n * LONG_BITS - 1 );
-		break;
-	}
+	daoint i, n = self->size;
+	double res = 0.0;
+	while( n && self->data[n-1] == 0 ) n -= 1;
+	/* The three leading limbs are more than the precision of double: */
+	for(i=n-1; i>=0 && i>=n-3; i--) res = ldexp( res, LONG_BITS ) + self->data[i];
+	if( i >= 0 ) res = ldexp( res, (i+1) * LONG_BITS );
 	return res * self->sign;
 }
 void DaoxBigInt_FromInteger( DaoxBigInt *self, daoint x )
 {
-	size_t y;
-	if( x < 0 ){
-		x = -x;
-		self->sign = -1;
-	}
+	size_t y = x < 0 ? - (size_t) x : (size_t) x;
 	DaoxBigInt_Clear( self );
-	y = x;
-	while( y ){
-		DaoxBigInt_Append( self, y & LONG_MASK );
-		y = y >> LONG_BITS;
+	self->sign = x < 0 ? -1 : 1;
+	for(; y; y = (sizeof(size_t) > sizeof(limb_t)) ? (y >> (LONG_BITS/2)) >> (LONG_BITS/2) : 0){
+		DaoxBigInt_Append( self, (limb_t) y );
 	}
 }
 void DaoxBigInt_FromFloat( DaoxBigInt *self, double value )
@@ -1221,22 +2211,23 @@ void DaoxBigInt_FromFloat( DaoxBigInt *self, double value )
 	if( expon <=0 ) return;
 
 	DaoxBigInt_Resize( self, expon / LONG_BITS + 1 );
+	memset( self->data, 0, self->size * sizeof(limb_t) );
 	/* convert bit by bit */
 	while( frac > 0 && expon ){
 		expon -= 1;
 		prod = frac * 2;
 		bit = (int) prod;
 		frac = prod - bit;
-		self->data[ expon/LONG_BITS ] |= (bit<<(expon%LONG_BITS));
+		self->data[ expon/LONG_BITS ] |= ((limb_t)bit << (expon%LONG_BITS));
 	}
 	DaoxBigInt_Normalize( self );
 }
 char DaoxBigInt_FromString( DaoxBigInt *self, DString *s )
 {
-	DaoxBigInt *tmp;
+	uchar_t *digits;
 	char table[256];
 	char *mbs;
-	daoint i, j, n, pl;
+	daoint i, n, pl;
 	int base = 10;
 
 	DaoxBigInt_Clear( self );
@@ -1268,21 +2259,17 @@ char DaoxBigInt_FromString( DaoxBigInt *self, DString *s )
 		mbs += 2;
 		n -= 2;
 	}
-	DaoxBigInt_Resize( self, n );
-	for(i=n, j=0; i>0; i--, j++){
-		uchar_t digit = table[ (uchar_t)mbs[i-1] ];
-		if( digit ==0 ) return mbs[i-1];
-		self->data[j] = digit - 1;
-		if( self->data[j] >= base ){
-			self->data[j] = 0;
-			self->size = j;
-			return mbs[i-1];
+	digits = (uchar_t*) dao_malloc( n + 1 );
+	for(i=0; i<n; i++){
+		uchar_t digit = table[ (uchar_t)mbs[i] ];
+		if( digit ==0 || digit > base ){
+			dao_free( digits );
+			return mbs[i];
 		}
+		digits[i] = digit - 1;
 	}
-	tmp = DaoxBigInt_New();
-	DaoxBigInt_Copy( tmp, self );
-	DaoxBigInt_Convert( tmp, base, self, LONG_BASE );
-	DaoxBigInt_Delete( tmp );
+	DaoxBigInt_ParseDigits( self, digits, n, base );
+	dao_free( digits );
 	return 0;
 }
 void DaoxBigInt_FromValue( DaoxBigInt *self, DaoValue *value )
@@ -1300,8 +2287,6 @@ void DaoxBigInt_FromValue( DaoxBigInt *self, DaoValue *value )
 	}
 }
 
-const int base_bits[] = {0,0,1,0,2,0,0,0,3,0,0,0,0,0,0,0,4};
-const int base_masks[] = {0,0,1,0,3,0,0,0,7,0,0,0,0,0,0,0,15};
 static void DaoxBigInt_GetItem1( DaoValue *self0, DaoProcess *proc, DaoValue *pid )
 {
 	DaoxBigInt *self = (DaoxBigInt*) DaoValue_CastCstruct( self0, daox_type_bigint );
@@ -1317,19 +2302,11 @@ static void DaoxBigInt_GetItem1( DaoValue *self0, DaoProcess *proc, DaoValue *pi
 		DaoProcess_RaiseError( proc, "Index", "out of range" );
 		return;
 	}
-	if( self->base == 2 ){
-		digit = (self->data[id/LONG_BITS] & (1<<(id%LONG_BITS)))>>(id%LONG_BITS);
-	}else{
-		int m = id*w / LONG_BITS;
-		if( ((id+1)*w <= (m+1)*LONG_BITS) || m+1 >= n ){
-			int digit2 = self->data[m] >> (id*w - m*LONG_BITS);
-			digit = digit2 & base_masks[self->base];
-			if( m+1 >= n && digit2 ==0 )
-				DaoProcess_RaiseError( proc, "Index", "out of range" );
-		}else{
-			int d = (self->data[m+1]<<LONG_BITS) | self->data[m];
-			digit = (d>>(id*w - m*LONG_BITS)) & base_masks[self->base];
-		}
+	digit = DaoxBigInt_GetBits( self, id*w, w );
+	if( self->base != 2 ){
+		daoint m = id*w / LONG_BITS;
+		if( m+1 >= n && (self->data[m] >> (id*w - m*LONG_BITS)) ==0 )
+			DaoProcess_RaiseError( proc, "Index", "out of range" );
 	}
 	DaoProcess_PutInteger( proc, digit );
 }
@@ -1353,33 +2330,13 @@ static void DaoxBigInt_SetItem1( DaoValue *self0, DaoProcess *proc, DaoValue *pi
 		return;
 	}
 	if( pid->type == 0 ){
-		uchar_t bits = digit;
-		if( self->base == 2 ) bits = digit ? LONG_BASE-1 : 0;
-		for(i=0; i<self->size; i++) self->data[i] = bits;
+		for(i=0; (i+1)*w<=n*LONG_BITS; i++) DaoxBigInt_SetBits( self, i*w, w, digit );
 	}else{
-		if( self->base == 2 ){
-			if( digit ){
-				self->data[id/LONG_BITS] |= (1<<(id%LONG_BITS));
-			}else{
-				self->data[id/LONG_BITS] &= ~(1<<(id%LONG_BITS));
-			}
-		}else{
-			int m = id*w / LONG_BITS;
-			int shift = id*w - m*LONG_BITS;
-			if( ((id+1)*w <= (m+1)*LONG_BITS) || m+1 >= n ){
-				int digit2 = self->data[m] >> shift;
-				self->data[m] &= ~(base_masks[self->base]<<shift);
-				self->data[m] |= digit<<shift;
-				if( m+1 >= n && digit2 ==0 )
-					DaoProcess_RaiseError( proc, "Index", "out of range" );
-			}else{
-				int d = (self->data[m+1]<<LONG_BITS) | self->data[m];
-				d &= ~(base_masks[self->base]<<shift);
-				d |= digit<<shift;
-				self->data[m] = d & LONG_MASK;
-				self->data[m+1] = d >> LONG_BITS;
-			}
-		}
+		daoint m = id*w / LONG_BITS;
+		limb_t digit2 = self->data[m] >> (id*w - m*LONG_BITS);
+		DaoxBigInt_SetBits( self, id*w, w, digit );
+		if( self->base != 2 && m+1 >= n && digit2 ==0 )
+			DaoProcess_RaiseError( proc, "Index", "out of range" );
 	}
 }
 static void DaoxBigInt_GetItem( DaoValue *self, DaoProcess *proc, DaoValue *ids[], int N )
@@ -1920,7 +2877,7 @@ static void BIGINT_CastToInt( DaoProcess *proc, DaoValue *p[], int n )
 	DaoxBigInt *self = (DaoxBigInt*) p[0];
 	dao_integer *res = DaoProcess_PutInteger( proc, 0 );
 	if( p[2]->xBoolean.value ){
-		*res = Dao_Hash( self->data, self->size, 0 );
+		*res = Dao_Hash( self->data, self->size * sizeof(limb_t), 0 );
 	}else{
 		*res = DaoxBigInt_ToInteger( self );
 	}
@@ -1931,6 +2888,81 @@ static void BIGINT_CastToString( DaoProcess *proc, DaoValue *p[], int n )
 	DString *res = DaoProcess_PutChars( proc, "" );
 	DaoxBigInt_Print( self, res );
 }
+static int DaoProcess_CheckModulus( DaoProcess *proc, DaoxBigInt *mod )
+{
+	int cmp = DaoxBigInt_CompareToZero( mod );
+	if( cmp == 0 ){
+		DaoProcess_RaiseError( proc, "Float::DivByZero", "" );
+	}else if( cmp < 0 ){
+		DaoProcess_RaiseError( proc, "Value", "modulus must be positive" );
+	}
+	return cmp > 0;
+}
+static void BIGINT_PowMod( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxBigInt *self = (DaoxBigInt*) p[0];
+	DaoxBigInt *mod = (DaoxBigInt*) p[2];
+	DaoxBigInt *exp = DaoxBigInt_New();
+	DaoxBigInt *res;
+
+	DaoxBigInt_FromValue( exp, p[1] );
+	if( DaoProcess_CheckModulus( proc, mod ) ){
+		DaoxBigIntBuffer *buffer = DaoxBigIntBuffer_New();
+		DaoxBigInt *base = self;
+		if( DaoxBigInt_CompareToZero( exp ) < 0 ){
+			base = DaoxBigIntBuffer_NewBigInt( buffer );
+			if( DaoxBigInt_ModInverse( base, self, mod, buffer ) == 0 ){
+				DaoProcess_RaiseError( proc, "Value", "base is not invertible for the modulus" );
+				DaoxBigIntBuffer_Delete( buffer );
+				DaoxBigInt_Delete( exp );
+				return;
+			}
+			exp->sign = 1;
+		}
+		res = (DaoxBigInt*) DaoProcess_PutCstruct( proc, daox_type_bigint );
+		DaoxBigInt_PowMod( res, base, exp, mod, buffer );
+		res->base = self->base;
+		if( base != self ) DaoxBigIntBuffer_FreeBigInt( buffer, base );
+		DaoxBigIntBuffer_Delete( buffer );
+	}
+	DaoxBigInt_Delete( exp );
+}
+static void BIGINT_ModInverse( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxBigInt *self = (DaoxBigInt*) p[0];
+	DaoxBigInt *mod = (DaoxBigInt*) p[1];
+	DaoxBigInt *res;
+
+	if( DaoProcess_CheckModulus( proc, mod ) == 0 ) return;
+	res = (DaoxBigInt*) DaoProcess_PutCstruct( proc, daox_type_bigint );
+	res->base = self->base;
+	if( DaoxBigInt_ModInverse( res, self, mod, NULL ) == 0 ){
+		DaoProcess_RaiseError( proc, "Value", "not invertible for the modulus" );
+	}
+}
+static void BIGINT_GCD( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxBigInt *self = (DaoxBigInt*) p[0];
+	DaoxBigInt *res = (DaoxBigInt*) DaoProcess_PutCstruct( proc, daox_type_bigint );
+	DaoxBigInt_GCD( res, self, (DaoxBigInt*) p[1], NULL );
+	res->base = self->base;
+}
+static void BIGINT_ExtGCD( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxBigInt *self = (DaoxBigInt*) p[0];
+	DaoxBigInt *items[3];
+	DaoTuple *res = DaoProcess_PutTuple( proc, 3 );
+	int i;
+
+	for(i=0; i<3; ++i){
+		if( res->values[i] == NULL ){
+			DaoTuple_SetItem( res, (DaoValue*) DaoxBigInt_New(), i );
+		}
+		items[i] = (DaoxBigInt*) res->values[i];
+		items[i]->base = self->base;
+	}
+	DaoxBigInt_ExtGCD( items[0], items[1], items[2], self, (DaoxBigInt*) p[1], NULL );
+}
 static DaoFunctionEntry daoBigIntMeths[]=
 {
 	{ BIGINT_New1, "BigInt( value: int, base = 10 ) => BigInt" },
@@ -2023,6 +3055,12 @@ static DaoFunctionEntry daoBigIntMeths[]=
 
 	{ BIGINT_Comparison,  "<=>( self: BigInt, B: BigInt ) => int" },
 
+	{ BIGINT_PowMod,      "powmod( self: BigInt, exponent: int, modulus: BigInt ) => BigInt" },
+	{ BIGINT_PowMod,      "powmod( self: BigInt, exponent: BigInt, modulus: BigInt ) => BigInt" },
+	{ BIGINT_ModInverse,  "modInverse( self: BigInt, modulus: BigInt ) => BigInt" },
+	{ BIGINT_GCD,         "gcd( self: BigInt, other: BigInt ) => BigInt" },
+	{ BIGINT_ExtGCD,      "egcd( self: BigInt, other: BigInt ) => tuple<gcd: BigInt, x: BigInt, y: BigInt>" },
+
 	{ BIGINT_CastToInt,     "(int)( self: BigInt, hashing = false )" },
 	{ BIGINT_CastToString,  "(string)( self: BigInt )" },
 
@@ -2048,7 +3086,7 @@ int DaoxBigInt_CoreCompare( DaoValue *self, DaoValue *other, DMap *cycmap )
 size_t DaoxBigInt_Hash( DaoValue *self )
 {
 	DaoxBigInt *pod = (DaoxBigInt*) self;
-	return Dao_Hash( pod->data, pod->size, 0 );
+	return Dao_Hash( pod->data, pod->size * sizeof(limb_t), 0 );
 }
 
 DaoValue* DaoxBigInt_Create( DaoType *self )
@@ -0,0 +1,588 @@
+/*
+// Built-in implementation of the core CBLAS routines, used in place of the
+// system CBLAS library when it is not available:
+//   cblas_dgemm, cblas_sgemm, cblas_dgemv, cblas_dsyrk, cblas_dtrsm;
+//   cblas_ddot, cblas_sdot, cblas_daxpy, cblas_saxpy (for dao_blas.c).
+//
+// Matrix multiplication is cache blocked with packed panels and a register
+// blocked micro kernel (see cblas_gemm.h), which the compiler vectorizes;
+// the other routines are built on it. Work is split over row blocks among
+// threads when the problem is large enough.
+//
+// All routines convert column major problems to the equivalent row major ones.
+*/
+
+#include<stdlib.h>
+#include<string.h>
+#include"dao.h"
+#include"daoThread.h"
+#include"cblas.h"
+
+#ifdef UNIX
+#include<unistd.h>
+#endif
+
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define DAO_CBLAS_KERNEL static __attribute__((target_clones("arch=x86-64-v3","default")))
+#else
+#define DAO_CBLAS_KERNEL static
+#endif
+
+#define DAO_CBLAS_MAX_THREADS  16
+#define DAO_CBLAS_MIN_WORK     (1<<21)   /* floating point operations per thread; */
+#define DAO_CBLAS_BLOCK        64        /* block size for syrk and trsm; */
+
+#if defined(__GNUC__)
+typedef double DaoCblas_Double4 __attribute__((vector_size(32)));
+typedef float  DaoCblas_Float8  __attribute__((vector_size(32)));
+#endif
+
+#define DAO_GEMM_MC  128
+#define DAO_GEMM_KC  256
+#define DAO_GEMM_NC  1024
+
+
+typedef void (*DaoCblasTask)( void *context, int index, int count );
+
+typedef struct DaoCblasThread  DaoCblasThread;
+
+struct DaoCblasThread
+{
+	DaoCblasTask   task;
+	void          *context;
+	int            index;
+	int            count;
+};
+
+static void DaoCblasThread_Run( void *p )
+{
+	DaoCblasThread *self = (DaoCblasThread*) p;
+	self->task( self->context, self->index, self->count );
+}
+
+static int DaoCblas_GetTaskCount( double work )
+{
+	int tasks = 1;
+#if defined(DAO_WITH_THREAD) && defined(UNIX)
+	tasks = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	if( tasks > DAO_CBLAS_MAX_THREADS ) tasks = DAO_CBLAS_MAX_THREADS;
+	if( work / DAO_CBLAS_MIN_WORK < tasks ) tasks = work / DAO_CBLAS_MIN_WORK;
+	return tasks < 1 ? 1 : tasks;
+}
+
+/* Run task(context,i,count) for i in [0,count), in parallel when possible: */
+static void DaoCblas_Parallel( DaoCblasTask task, void *context, int count )
+{
+	DaoCblasThread tasks[DAO_CBLAS_MAX_THREADS];
+#ifdef DAO_WITH_THREAD
+	DThread threads[DAO_CBLAS_MAX_THREADS];
+#endif
+	int i;
+
+	if( count > DAO_CBLAS_MAX_THREADS ) count = DAO_CBLAS_MAX_THREADS;
+	for(i=0; i<count; ++i){
+		tasks[i].task = task;
+		tasks[i].context = context;
+		tasks[i].index = i;
+		tasks[i].count = count;
+	}
+#ifdef DAO_WITH_THREAD
+	for(i=0; i<count-1; ++i){
+		DThread_Init( & threads[i] );
+		DThread_Start( & threads[i], DaoCblasThread_Run, & tasks[i] );
+	}
+	DaoCblasThread_Run( & tasks[count-1] );
+	for(i=0; i<count-1; ++i){
+		DThread_Join( & threads[i] );
+		DThread_Destroy( & threads[i] );
+	}
+#else
+	for(i=0; i<count; ++i) DaoCblasThread_Run( & tasks[i] );
+#endif
+}
+
+/* Split [0,size) evenly into "count" ranges, and get the range "index": */
+static void DaoCblas_GetRange( int size, int index, int count, int *first, int *end )
+{
+	*first = (int)(((double) size * index) / count);
+	*end = (int)(((double) size * (index + 1)) / count);
+}
+
+
+
+#define DAO_GEMM_REAL  double
+#define DAO_GEMM_MR    4
+#define DAO_GEMM_NR    8
+#define DAO_GEMM( name )  DaoCblas_D##name
+#if defined(__GNUC__)
+#define DAO_GEMM_VECTOR  DaoCblas_Double4
+#endif
+#include"cblas_gemm.h"
+#undef DAO_GEMM_REAL
+#undef DAO_GEMM_MR
+#undef DAO_GEMM_NR
+#undef DAO_GEMM
+#undef DAO_GEMM_VECTOR
+
+#define DAO_GEMM_REAL  float
+#define DAO_GEMM_MR    4
+#define DAO_GEMM_NR    16
+#define DAO_GEMM( name )  DaoCblas_S##name
+#if defined(__GNUC__)
+#define DAO_GEMM_VECTOR  DaoCblas_Float8
+#endif
+#include"cblas_gemm.h"
+#undef DAO_GEMM_REAL
+#undef DAO_GEMM_MR
+#undef DAO_GEMM_NR
+#undef DAO_GEMM
+#undef DAO_GEMM_VECTOR
+
+
+void cblas_dgemm( const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA,
+		const enum CBLAS_TRANSPOSE TransB, const blasint M, const blasint N, const blasint K,
+		const double alpha, const double *A, const blasint lda, const double *B, const blasint ldb,
+		const double beta, double *C, const blasint ldc )
+{
+	int transA = TransA == CblasTrans || TransA == CblasConjTrans;
+	int transB = TransB == CblasTrans || TransB == CblasConjTrans;
+	if( Order == CblasColMajor ){
+		/* C' = op(B)' * op(A)' in row major order: */
+		DaoCblas_DMultiply( transB, transA, N, M, K, alpha, B, ldb, A, lda, beta, C, ldc );
+	}else{
+		DaoCblas_DMultiply( transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
+	}
+}
+
+void cblas_sgemm( const enum CBLAS_ORDER Order, const enum CBLAS_TRANSPOSE TransA,
+		const enum CBLAS_TRANSPOSE TransB, const blasint M, const blasint N, const blasint K,
+		const float alpha, const float *A, const blasint lda, const float *B, const blasint ldb,
+		const float beta, float *C, const blasint ldc )
+{
+	int transA = TransA == CblasTrans || TransA == CblasConjTrans;
+	int transB = TransB == CblasTrans || TransB == CblasConjTrans;
+	if( Order == CblasColMajor ){
+		DaoCblas_SMultiply( transB, transA, N, M, K, alpha, B, ldb, A, lda, beta, C, ldc );
+	}else{
+		DaoCblas_SMultiply( transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
+	}
+}
+
+
+
+/* Copy a strided vector into a contiguous one, or back (if "back" is true): */
+static void DaoCblas_Gather( int n, double *x, int incx, double *buffer, int back )
+{
+	int i;
+	if( incx < 0 ) x += (n - 1) * (daoint)(- incx);
+	for(i=0; i<n; ++i, x+=incx){
+		if( back ){
+			*x = buffer[i];
+		}else{
+			buffer[i] = *x;
+		}
+	}
+}
+
+typedef struct DaoCblasGemv  DaoCblasGemv;
+
+struct DaoCblasGemv
+{
+	int            trans;
+	int            rows, cols;
+	double         alpha, beta;
+	const double  *A;
+	int            lda;
+	const double  *x;
+	double        *y;
+};
+
+DAO_CBLAS_KERNEL double DaoCblas_Dot( int n, const double *x, const double *y )
+{
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+	int i;
+	for(i=0; i+4<=n; i+=4){
+		s0 += x[i] * y[i];
+		s1 += x[i+1] * y[i+1];
+		s2 += x[i+2] * y[i+2];
+		s3 += x[i+3] * y[i+3];
+	}
+	for(; i<n; ++i) s0 += x[i] * y[i];
+	return (s0 + s1) + (s2 + s3);
+}
+
+DAO_CBLAS_KERNEL void DaoCblas_Axpy( int n, double alpha, const double *x, double *y )
+{
+	int i;
+	for(i=0; i<n; ++i) y[i] += alpha * x[i];
+}
+
+/*
+// Without transposition, each task computes a range of "y" as dot products of
+// the rows of "A" with "x"; with transposition, each task accumulates a range
+// of columns of "A" (weighted by "x") into the same range of "y":
+*/
+static void DaoCblasGemv_Task( void *context, int index, int count )
+{
+	DaoCblasGemv *self = (DaoCblasGemv*) context;
+	int i, first, end;
+
+	if( self->trans == 0 ){
+		DaoCblas_GetRange( self->rows, index, count, & first, & end );
+		for(i=first; i<end; ++i){
+			double dot = DaoCblas_Dot( self->cols, self->A + i*(daoint)self->lda, self->x );
+			self->y[i] = self->alpha * dot + (self->beta == 0.0 ? 0.0 : self->beta * self->y[i]);
+		}
+	}else{
+		DaoCblas_GetRange( self->cols, index, count, & first, & end );
+		for(i=first; i<end; ++i) self->y[i] = self->beta == 0.0 ? 0.0 : self->beta * self->y[i];
+		for(i=0; i<self->rows; ++i){
+			double a = self->alpha * self->x[i];
+			if( a != 0.0 ) DaoCblas_Axpy( end - first, a, self->A + i*(daoint)self->lda + first, self->y + first );
+		}
+	}
+}
+
+void cblas_dgemv( const enum CBLAS_ORDER order, const enum CBLAS_TRANSPOSE trans,
+		const blasint m, const blasint n, const double alpha, const double *a, const blasint lda,
+		const double *x, const blasint incx, const double beta, double *y, const blasint incy )
+{
+	DaoCblasGemv gemv;
+	double *xs = NULL, *ys = NULL;
+	int xlen, ylen, ntask;
+
+	gemv.trans = trans == CblasTrans || trans == CblasConjTrans;
+	gemv.rows = m;
+	gemv.cols = n;
+	if( order == CblasColMajor ){
+		gemv.trans = ! gemv.trans;
+		gemv.rows = n;
+		gemv.cols = m;
+	}
+	if( gemv.rows <= 0 || gemv.cols <= 0 ) return;
+
+	xlen = gemv.trans ? gemv.rows : gemv.cols;
+	ylen = gemv.trans ? gemv.cols : gemv.rows;
+	gemv.alpha = alpha;
+	gemv.beta = beta;
+	gemv.A = a;
+	gemv.lda = lda;
+	gemv.x = x;
+	gemv.y = y;
+	if( incx != 1 ){
+		gemv.x = xs = (double*) dao_malloc( xlen * sizeof(double) );
+		DaoCblas_Gather( xlen, (double*) x, incx, xs, 0 );
+	}
+	if( incy != 1 ){
+		gemv.y = ys = (double*) dao_malloc( ylen * sizeof(double) );
+		DaoCblas_Gather( ylen, y, incy, ys, 0 );
+	}
+
+	ntask = DaoCblas_GetTaskCount( 2.0 * m * n );
+	if( ntask > ylen ) ntask = ylen;
+	DaoCblas_Parallel( DaoCblasGemv_Task, & gemv, ntask );
+
+	if( ys ){
+		DaoCblas_Gather( ylen, y, incy, ys, 1 );
+		dao_free( ys );
+	}
+	if( xs ) dao_free( xs );
+}
+
+double cblas_ddot( const blasint n, const double *x, const blasint incx, const double *y, const blasint incy )
+{
+	double dot = 0.0;
+	int i;
+	if( n <= 0 ) return 0.0;
+	if( incx == 1 && incy == 1 ) return DaoCblas_Dot( n, x, y );
+	if( incx < 0 ) x += (n - 1) * (daoint)(- incx);
+	if( incy < 0 ) y += (n - 1) * (daoint)(- incy);
+	for(i=0; i<n; ++i, x+=incx, y+=incy) dot += *x * *y;
+	return dot;
+}
+
+void cblas_daxpy( const blasint n, const double alpha, const double *x, const blasint incx, double y[], const blasint incy )
+{
+	int i;
+	if( n <= 0 || alpha == 0.0 ) return;
+	if( incx == 1 && incy == 1 ){
+		DaoCblas_Axpy( n, alpha, x, y );
+		return;
+	}
+	if( incx < 0 ) x += (n - 1) * (daoint)(- incx);
+	if( incy < 0 ) y += (n - 1) * (daoint)(- incy);
+	for(i=0; i<n; ++i, x+=incx, y+=incy) *y += alpha * *x;
+}
+
+float cblas_sdot( const blasint n, const float *x, const blasint incx, const float *y, const blasint incy )
+{
+	float dot = 0.0f;
+	int i;
+	if( n <= 0 ) return 0.0f;
+	if( incx < 0 ) x += (n - 1) * (daoint)(- incx);
+	if( incy < 0 ) y += (n - 1) * (daoint)(- incy);
+	for(i=0; i<n; ++i, x+=incx, y+=incy) dot += *x * *y;
+	return dot;
+}
+
+void cblas_saxpy( const blasint n, const float alpha, const float *x, const blasint incx, float y[], const blasint incy )
+{
+	int i;
+	if( n <= 0 || alpha == 0.0f ) return;
+	if( incx < 0 ) x += (n - 1) * (daoint)(- incx);
+	if( incy < 0 ) y += (n - 1) * (daoint)(- incy);
+	for(i=0; i<n; ++i, x+=incx, y+=incy) *y += alpha * *x;
+}
+
+
+
+typedef struct DaoCblasSyrk  DaoCblasSyrk;
+
+struct DaoCblasSyrk
+{
+	int            upper;
+	int            trans;
+	int            N, K;
+	double         alpha, beta;
+	const double  *A;
+	int            lda;
+	double        *C;
+	int            ldc;
+};
+
+/*
+// Compute the rows [i0,i1) of C = alpha * op(A) * op(A)' + beta * C within the
+// triangle: the off diagonal part is computed into C directly, and the
+// diagonal block is computed into a buffer and then merged into the triangle.
+*/
+static void DaoCblasSyrk_Strip( DaoCblasSyrk *self, int i0, int i1, double *buffer )
+{
+	DaoCblas_DContext gemm;
+	int i, j, nb = i1 - i0;
+	int j0 = self->upper ? i1 : 0;
+	int j1 = self->upper ? self->N : i0;
+
+	/* op(A) is N x K, and op(A)' is K x N: */
+	gemm.transA = self->trans;
+	gemm.transB = ! self->trans;
+	gemm.K = self->K;
+	gemm.alpha = self->alpha;
+	gemm.lda = gemm.ldb = self->lda;
+	gemm.A = self->trans ? self->A + i0 : self->A + i0*(daoint)self->lda;
+
+	if( j1 > j0 ){
+		gemm.M = nb;
+		gemm.N = j1 - j0;
+		gemm.beta = self->beta;
+		gemm.B = self->trans ? self->A + j0 : self->A + j0*(daoint)self->lda;
+		gemm.C = self->C + i0*(daoint)self->ldc + j0;
+		gemm.ldc = self->ldc;
+		DaoCblas_DRun( & gemm, 0, nb );
+	}
+
+	gemm.M = gemm.N = nb;
+	gemm.beta = 0.0;
+	gemm.B = self->trans ? self->A + i0 : self->A + i0*(daoint)self->lda;
+	gemm.C = buffer;
+	gemm.ldc = nb;
+	DaoCblas_DRun( & gemm, 0, nb );
+	for(i=0; i<nb; ++i){
+		double *c = self->C + (i0 + i)*(daoint)self->ldc + i0;
+		int first = self->upper ? i : 0;
+		int end = self->upper ? nb : i + 1;
+		for(j=first; j<end; ++j){
+			c[j] = buffer[i*nb+j] + (self->beta == 0.0 ? 0.0 : self->beta * c[j]);
+		}
+	}
+}
+
+/* Strips are assigned cyclically, since their costs grow or shrink linearly: */
+static void DaoCblasSyrk_Task( void *context, int index, int count )
+{
+	DaoCblasSyrk *self = (DaoCblasSyrk*) context;
+	double *buffer = (double*) dao_malloc( DAO_CBLAS_BLOCK * DAO_CBLAS_BLOCK * sizeof(double) );
+	int i;
+	for(i=index*DAO_CBLAS_BLOCK; i<self->N; i+=count*DAO_CBLAS_BLOCK){
+		int end = i + DAO_CBLAS_BLOCK < self->N ? i + DAO_CBLAS_BLOCK : self->N;
+		DaoCblasSyrk_Strip( self, i, end, buffer );
+	}
+	dao_free( buffer );
+}
+
+void cblas_dsyrk( const enum CBLAS_ORDER Order, const enum CBLAS_UPLO Uplo,
+		const enum CBLAS_TRANSPOSE Trans, const blasint N, const blasint K,
+		const double alpha, const double *A, const blasint lda,
+		const double beta, double *C, const blasint ldc )
+{
+	DaoCblasSyrk syrk;
+	int ntask;
+
+	syrk.upper = Uplo == CblasUpper;
+	syrk.trans = Trans == CblasTrans || Trans == CblasConjTrans;
+	if( Order == CblasColMajor ){
+		/* The same as the transposed problem in row major order: */
+		syrk.upper = ! syrk.upper;
+		syrk.trans = ! syrk.trans;
+	}
+	if( N <= 0 ) return;
+
+	syrk.N = N;
+	syrk.K = K;
+	syrk.alpha = alpha;
+	syrk.beta = beta;
+	syrk.A = A;
+	syrk.lda = lda;
+	syrk.C = C;
+	syrk.ldc = ldc;
+	ntask = DaoCblas_GetTaskCount( (double) N * N * K );
+	if( ntask > (N + DAO_CBLAS_BLOCK - 1) / DAO_CBLAS_BLOCK ) ntask = (N + DAO_CBLAS_BLOCK - 1) / DAO_CBLAS_BLOCK;
+	DaoCblas_Parallel( DaoCblasSyrk_Task, & syrk, ntask );
+}
+
+
+
+typedef struct DaoCblasTrsm  DaoCblasTrsm;
+
+struct DaoCblasTrsm
+{
+	int            upper;
+	int            unit;
+	int            first, end;   /* rows of the diagonal block; */
+	int            cols;
+	const double  *A;
+	int            lda;
+	double        *B;
+	int            ldb;
+};
+
+/* Substitution with the diagonal block, each task handles a range of columns: */
+static void DaoCblasTrsm_Task( void *context, int index, int count )
+{
+	DaoCblasTrsm *self = (DaoCblasTrsm*) context;
+	int i, p, j0, j1;
+
+	DaoCblas_GetRange( self->cols, index, count, & j0, & j1 );
+	for(i=0; i<self->end-self->first; ++i){
+		int row = self->upper ? self->end - 1 - i : self->first + i;
+		int start = self->upper ? row + 1 : self->first;
+		int stop = self->upper ? self->end : row;
+		const double *a = self->A + row*(daoint)self->lda;
+		double *b = self->B + row*(daoint)self->ldb;
+		for(p=start; p<stop; ++p){
+			if( a[p] != 0.0 ) DaoCblas_Axpy( j1 - j0, - a[p], self->B + p*(daoint)self->ldb + j0, b + j0 );
+		}
+		if( self->unit == 0 ){
+			double d = a[row];
+			for(p=j0; p<j1; ++p) b[p] /= d;
+		}
+	}
+}
+
+/* Solve A * X = B for a k x k triangular A and a k x n B in row major order: */
+static void DaoCblas_SolveLeft( int upper, int unit, int k, int n, const double *A, int lda, double *B, int ldb )
+{
+	DaoCblasTrsm trsm;
+	int i0, i1, nb, ntask;
+
+	trsm.upper = upper;
+	trsm.unit = unit;
+	trsm.cols = n;
+	trsm.A = A;
+	trsm.lda = lda;
+	trsm.B = B;
+	trsm.ldb = ldb;
+	for(nb=0; nb<k; nb+=DAO_CBLAS_BLOCK){
+		if( upper ){
+			i1 = k - nb;
+			i0 = i1 > DAO_CBLAS_BLOCK ? i1 - DAO_CBLAS_BLOCK : 0;
+		}else{
+			i0 = nb;
+			i1 = i0 + DAO_CBLAS_BLOCK < k ? i0 + DAO_CBLAS_BLOCK : k;
+		}
+		trsm.first = i0;
+		trsm.end = i1;
+		ntask = DaoCblas_GetTaskCount( (double)(i1 - i0) * (i1 - i0) * n );
+		if( ntask > n ) ntask = n;
+		DaoCblas_Parallel( DaoCblasTrsm_Task, & trsm, ntask );
+
+		/* Eliminate the solved block from the remaining rows: */
+		if( upper && i0 > 0 ){
+			DaoCblas_DMultiply( 0, 0, i0, n, i1 - i0, -1.0, A + i0, lda,
+					B + i0*(daoint)ldb, ldb, 1.0, B, ldb );
+		}else if( ! upper && i1 < k ){
+			DaoCblas_DMultiply( 0, 0, k - i1, n, i1 - i0, -1.0, A + i1*(daoint)lda + i0, lda,
+					B + i0*(daoint)ldb, ldb, 1.0, B + i1*(daoint)ldb, ldb );
+		}
+	}
+}
+
+/* Transpose the rows x cols matrix A into B: */
+static void DaoCblas_Transpose( int rows, int cols, const double *A, int lda, double *B, int ldb )
+{
+	int i, j, i0, j0;
+	for(i0=0; i0<rows; i0+=32){
+		int i1 = i0 + 32 < rows ? i0 + 32 : rows;
+		for(j0=0; j0<cols; j0+=32){
+			int j1 = j0 + 32 < cols ? j0 + 32 : cols;
+			for(i=i0; i<i1; ++i){
+				for(j=j0; j<j1; ++j) B[j*(daoint)ldb+i] = A[i*(daoint)lda+j];
+			}
+		}
+	}
+}
+
+void cblas_dtrsm( const enum CBLAS_ORDER Order, const enum CBLAS_SIDE Side,
+		const enum CBLAS_UPLO Uplo, const enum CBLAS_TRANSPOSE TransA,
+		const enum CBLAS_DIAG Diag, const blasint M, const blasint N,
+		const double alpha, const double *A, const blasint lda, double *B, const blasint ldb )
+{
+	int left = Side == CblasLeft;
+	int upper = Uplo == CblasUpper;
+	int trans = TransA == CblasTrans || TransA == CblasConjTrans;
+	int unit = Diag == CblasUnit;
+	int rows = M, cols = N, k, i, j;
+	double *At = NULL, *Bt = NULL;
+
+	if( Order == CblasColMajor ){
+		/* B' is N x M in row major order, and A' is the transposed triangle: */
+		left = ! left;
+		upper = ! upper;
+		rows = N;
+		cols = M;
+	}
+	if( rows <= 0 || cols <= 0 ) return;
+
+	for(i=0; i<rows; ++i){
+		double *b = B + i*(daoint)ldb;
+		if( alpha == 0.0 ){
+			for(j=0; j<cols; ++j) b[j] = 0.0;
+		}else if( alpha != 1.0 ){
+			for(j=0; j<cols; ++j) b[j] *= alpha;
+		}
+	}
+	if( alpha == 0.0 ) return;
+
+	/*
+	// X * op(A) = B is solved as op(A)' * X' = B'; and op(A) or op(A)' is made
+	// explicit by transposing A when it is the transpose of A:
+	*/
+	k = left ? rows : cols;
+	if( trans != ! left ){
+		At = (double*) dao_malloc( (daoint) k * k * sizeof(double) );
+		DaoCblas_Transpose( k, k, A, lda, At, k );
+		A = At;
+		upper = ! upper;
+	}
+	if( left ){
+		DaoCblas_SolveLeft( upper, unit, k, cols, A, At ? k : lda, B, ldb );
+	}else{
+		Bt = (double*) dao_malloc( (daoint) rows * cols * sizeof(double) );
+		DaoCblas_Transpose( rows, cols, B, ldb, Bt, rows );
+		DaoCblas_SolveLeft( upper, unit, k, rows, A, At ? k : lda, Bt, rows );
+		DaoCblas_Transpose( cols, rows, Bt, rows, B, ldb );
+		dao_free( Bt );
+	}
+	if( At ) dao_free( At );
+}
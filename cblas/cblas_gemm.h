@@ -0,0 +1,215 @@
+/*
+// Blocked matrix multiplication for the built-in CBLAS fallback.
+//
+// This file is a template included by cblas_fallback.c once for each real type,
+// with the following macros defined:
+//   DAO_GEMM_REAL: the real type;
+//   DAO_GEMM_MR, DAO_GEMM_NR: the size of the register block (micro tile);
+//   DAO_GEMM( name ): the name of a function for the real type;
+//   DAO_GEMM_VECTOR: optional, a GCC vector type of DAO_GEMM_NR/2 reals;
+//
+// Matrices are in row major order. The operands are packed into panels so that
+// the micro kernel reads them contiguously: the kc x nc panel of op(B) is stored
+// as slivers of DAO_GEMM_NR columns and should stay in the L2/L3 cache; the
+// mc x kc block of op(A) is stored as slivers of DAO_GEMM_MR rows and should
+// stay in the L1/L2 cache. Partial slivers are padded with zeros.
+*/
+
+typedef struct DAO_GEMM( Context )  DAO_GEMM( Context );
+
+struct DAO_GEMM( Context )
+{
+	int  transA, transB;
+	int  M, N, K;
+	int  lda, ldb, ldc;
+
+	DAO_GEMM_REAL  alpha, beta;
+
+	const DAO_GEMM_REAL  *A;
+	const DAO_GEMM_REAL  *B;
+	DAO_GEMM_REAL        *C;
+};
+
+
+static void DAO_GEMM( PackA )( int trans, const DAO_GEMM_REAL *A, int lda, int mc, int kc, DAO_GEMM_REAL *Ap )
+{
+	int i, ir, p;
+	for(ir=0; ir<mc; ir+=DAO_GEMM_MR){
+		int mr = mc - ir < DAO_GEMM_MR ? mc - ir : DAO_GEMM_MR;
+		for(p=0; p<kc; ++p, Ap+=DAO_GEMM_MR){
+			if( trans ){
+				const DAO_GEMM_REAL *a = A + p*lda + ir;
+				for(i=0; i<mr; ++i) Ap[i] = a[i];
+			}else{
+				const DAO_GEMM_REAL *a = A + ir*lda + p;
+				for(i=0; i<mr; ++i) Ap[i] = a[i*lda];
+			}
+			for(; i<DAO_GEMM_MR; ++i) Ap[i] = 0;
+		}
+	}
+}
+
+static void DAO_GEMM( PackB )( int trans, const DAO_GEMM_REAL *B, int ldb, int kc, int nc, DAO_GEMM_REAL *Bp )
+{
+	int j, jr, p;
+	for(jr=0; jr<nc; jr+=DAO_GEMM_NR){
+		int nr = nc - jr < DAO_GEMM_NR ? nc - jr : DAO_GEMM_NR;
+		for(p=0; p<kc; ++p, Bp+=DAO_GEMM_NR){
+			if( trans ){
+				const DAO_GEMM_REAL *b = B + jr*ldb + p;
+				for(j=0; j<nr; ++j) Bp[j] = b[j*ldb];
+			}else{
+				const DAO_GEMM_REAL *b = B + p*ldb + jr;
+				for(j=0; j<nr; ++j) Bp[j] = b[j];
+			}
+			for(; j<DAO_GEMM_NR; ++j) Bp[j] = 0;
+		}
+	}
+}
+
+/* C[mr x nr] += alpha * Ap[mr x kc] * Bp[kc x nr]: */
+#ifdef DAO_GEMM_VECTOR
+
+/*
+// With GCC vector extensions: the tile is held in 4 x 2 vector registers,
+// namely DAO_GEMM_MR must be 4 and DAO_GEMM_NR must be two vectors.
+*/
+DAO_CBLAS_KERNEL void DAO_GEMM( Kernel )( int kc, const DAO_GEMM_REAL *Ap, const DAO_GEMM_REAL *Bp,
+		DAO_GEMM_REAL *C, int ldc, DAO_GEMM_REAL alpha, int mr, int nr )
+{
+	const int V = DAO_GEMM_NR / 2;
+	DAO_GEMM_VECTOR c00 = {0}, c01 = {0}, c10 = {0}, c11 = {0};
+	DAO_GEMM_VECTOR c20 = {0}, c21 = {0}, c30 = {0}, c31 = {0};
+	DAO_GEMM_VECTOR b0, b1;
+	DAO_GEMM_REAL ab[DAO_GEMM_MR][DAO_GEMM_NR];
+	int i, j, p;
+
+	for(p=0; p<kc; ++p, Ap+=DAO_GEMM_MR, Bp+=DAO_GEMM_NR){
+		memcpy( & b0, Bp, sizeof(DAO_GEMM_VECTOR) );
+		memcpy( & b1, Bp + V, sizeof(DAO_GEMM_VECTOR) );
+		c00 += Ap[0] * b0;  c01 += Ap[0] * b1;
+		c10 += Ap[1] * b0;  c11 += Ap[1] * b1;
+		c20 += Ap[2] * b0;  c21 += Ap[2] * b1;
+		c30 += Ap[3] * b0;  c31 += Ap[3] * b1;
+	}
+	memcpy( ab[0], & c00, sizeof(DAO_GEMM_VECTOR) );  memcpy( ab[0] + V, & c01, sizeof(DAO_GEMM_VECTOR) );
+	memcpy( ab[1], & c10, sizeof(DAO_GEMM_VECTOR) );  memcpy( ab[1] + V, & c11, sizeof(DAO_GEMM_VECTOR) );
+	memcpy( ab[2], & c20, sizeof(DAO_GEMM_VECTOR) );  memcpy( ab[2] + V, & c21, sizeof(DAO_GEMM_VECTOR) );
+	memcpy( ab[3], & c30, sizeof(DAO_GEMM_VECTOR) );  memcpy( ab[3] + V, & c31, sizeof(DAO_GEMM_VECTOR) );
+	for(i=0; i<mr; ++i, C+=ldc){
+		for(j=0; j<nr; ++j) C[j] += alpha * ab[i][j];
+	}
+}
+
+#else
+
+DAO_CBLAS_KERNEL void DAO_GEMM( Kernel )( int kc, const DAO_GEMM_REAL *Ap, const DAO_GEMM_REAL *Bp,
+		DAO_GEMM_REAL *C, int ldc, DAO_GEMM_REAL alpha, int mr, int nr )
+{
+	DAO_GEMM_REAL ab[DAO_GEMM_MR][DAO_GEMM_NR];
+	int i, j, p;
+
+	for(i=0; i<DAO_GEMM_MR; ++i){
+		for(j=0; j<DAO_GEMM_NR; ++j) ab[i][j] = 0;
+	}
+	for(p=0; p<kc; ++p, Ap+=DAO_GEMM_MR, Bp+=DAO_GEMM_NR){
+		for(i=0; i<DAO_GEMM_MR; ++i){
+			DAO_GEMM_REAL a = Ap[i];
+			for(j=0; j<DAO_GEMM_NR; ++j) ab[i][j] += a * Bp[j];
+		}
+	}
+	for(i=0; i<mr; ++i, C+=ldc){
+		for(j=0; j<nr; ++j) C[j] += alpha * ab[i][j];
+	}
+}
+
+#endif
+
+/* C = beta * C for the rows [first,end): */
+static void DAO_GEMM( Scale )( DAO_GEMM( Context ) *self, int first, int end )
+{
+	int i, j;
+	if( self->beta == 1 ) return;
+	for(i=first; i<end; ++i){
+		DAO_GEMM_REAL *c = self->C + i*self->ldc;
+		if( self->beta == 0 ){
+			for(j=0; j<self->N; ++j) c[j] = 0;
+		}else{
+			for(j=0; j<self->N; ++j) c[j] *= self->beta;
+		}
+	}
+}
+
+/* Compute the rows [first,end) of C: */
+static void DAO_GEMM( Run )( DAO_GEMM( Context ) *self, int first, int end )
+{
+	DAO_GEMM_REAL *Ap, *Bp;
+	int ic, jc, pc, ir, jr;
+
+	DAO_GEMM( Scale )( self, first, end );
+	if( first >= end || self->K == 0 || self->alpha == 0 ) return;
+
+	Ap = (DAO_GEMM_REAL*) dao_malloc( DAO_GEMM_MC * DAO_GEMM_KC * sizeof(DAO_GEMM_REAL) );
+	Bp = (DAO_GEMM_REAL*) dao_malloc( DAO_GEMM_KC * DAO_GEMM_NC * sizeof(DAO_GEMM_REAL) );
+	for(jc=0; jc<self->N; jc+=DAO_GEMM_NC){
+		int nc = self->N - jc < DAO_GEMM_NC ? self->N - jc : DAO_GEMM_NC;
+		for(pc=0; pc<self->K; pc+=DAO_GEMM_KC){
+			int kc = self->K - pc < DAO_GEMM_KC ? self->K - pc : DAO_GEMM_KC;
+			const DAO_GEMM_REAL *B = self->transB ? self->B + jc*self->ldb + pc : self->B + pc*self->ldb + jc;
+			DAO_GEMM( PackB )( self->transB, B, self->ldb, kc, nc, Bp );
+			for(ic=first; ic<end; ic+=DAO_GEMM_MC){
+				int mc = end - ic < DAO_GEMM_MC ? end - ic : DAO_GEMM_MC;
+				const DAO_GEMM_REAL *A = self->transA ? self->A + pc*self->lda + ic : self->A + ic*self->lda + pc;
+				DAO_GEMM( PackA )( self->transA, A, self->lda, mc, kc, Ap );
+				for(jr=0; jr<nc; jr+=DAO_GEMM_NR){
+					int nr = nc - jr < DAO_GEMM_NR ? nc - jr : DAO_GEMM_NR;
+					for(ir=0; ir<mc; ir+=DAO_GEMM_MR){
+						int mr = mc - ir < DAO_GEMM_MR ? mc - ir : DAO_GEMM_MR;
+						DAO_GEMM_REAL *C = self->C + (ic + ir)*self->ldc + jc + jr;
+						DAO_GEMM( Kernel )( kc, Ap + ir*kc, Bp + jr*kc, C, self->ldc, self->alpha, mr, nr );
+					}
+				}
+			}
+		}
+	}
+	dao_free( Ap );
+	dao_free( Bp );
+}
+
+/* Each task computes a range of rows of C (aligned to the register block): */
+static void DAO_GEMM( Task )( void *context, int index, int count )
+{
+	DAO_GEMM( Context ) *self = (DAO_GEMM( Context )*) context;
+	int blocks = (self->M + DAO_GEMM_MR - 1) / DAO_GEMM_MR;
+	int first = (int)(((double) blocks * index) / count) * DAO_GEMM_MR;
+	int end = (int)(((double) blocks * (index + 1)) / count) * DAO_GEMM_MR;
+	if( end > self->M ) end = self->M;
+	DAO_GEMM( Run )( self, first, end );
+}
+
+/* C = alpha * op(A) * op(B) + beta * C, in row major order: */
+static void DAO_GEMM( Multiply )( int transA, int transB, int M, int N, int K,
+		DAO_GEMM_REAL alpha, const DAO_GEMM_REAL *A, int lda, const DAO_GEMM_REAL *B, int ldb,
+		DAO_GEMM_REAL beta, DAO_GEMM_REAL *C, int ldc )
+{
+	DAO_GEMM( Context ) context;
+	int ntask = DaoCblas_GetTaskCount( 2.0 * M * N * K );
+
+	if( M <= 0 || N <= 0 ) return;
+	if( ntask > (M + DAO_GEMM_MR - 1) / DAO_GEMM_MR ) ntask = (M + DAO_GEMM_MR - 1) / DAO_GEMM_MR;
+
+	context.transA = transA;
+	context.transB = transB;
+	context.M = M;
+	context.N = N;
+	context.K = K;
+	context.alpha = alpha;
+	context.beta = beta;
+	context.A = A;
+	context.B = B;
+	context.C = C;
+	context.lda = lda;
+	context.ldb = ldb;
+	context.ldc = ldc;
+	DaoCblas_Parallel( DAO_GEMM( Task ), & context, ntask );
+}
@@ -0,0 +1,362 @@
+/*
+// High level matrix operations over CBLAS.
+//
+// Matrices and vectors are passed to CBLAS as views of the array storage,
+// with the dimensions and the leading dimensions derived from the arrays.
+// Array slices are supported without copying when they can be described
+// by a leading dimension (for matrices) or an increment (for vectors):
+// the elements of a slice are laid out as equally spaced intervals of
+// DaoArray_GetWorkIntervalSize() elements, which are the matrix rows.
+//
+// The double precision routines are used for array<float>, or the single
+// precision ones if dao_float is float, so the storage is never converted.
+*/
+
+#include<string.h>
+#include"dao_cblas.h"
+#include"daoValue.h"
+#include"daoNumtype.h"
+
+
+typedef struct DaoBlasMatrix  DaoBlasMatrix;
+
+struct DaoBlasMatrix
+{
+	dao_float *data;
+	daoint     rows;
+	daoint     cols;
+	daoint     ld;      /* leading dimension; */
+	DaoArray  *work;    /* the array that owns the storage; */
+};
+
+
+/* Get the view of an array or an array slice as a row major matrix: */
+static int DaoBlas_GetMatrix( DaoArray *array, DaoBlasMatrix *matrix )
+{
+	DaoArray *work = DaoArray_GetWorkArray( array );
+	daoint size = DaoArray_GetWorkSize( array );
+	daoint start = DaoArray_GetWorkStart( array );
+	daoint len = DaoArray_GetWorkIntervalSize( array );
+	daoint step = DaoArray_GetWorkStep( array );
+
+	if( work->ndim != 2 && (work != array || work->ndim != 1) ) return 0;
+	matrix->work = work;
+	matrix->data = work->data.f + start;
+	if( work == array ){
+		matrix->rows = array->ndim == 2 ? array->dims[0] : 1;
+		matrix->cols = array->ndim == 2 ? array->dims[1] : array->dims[0];
+		matrix->ld = matrix->cols ? matrix->cols : 1;
+	}else if( len < size ){
+		/* Intervals are rows: */
+		matrix->rows = size / len;
+		matrix->cols = len;
+		matrix->ld = step;
+	}else if( size > work->dims[1] ){
+		/* A range of complete rows: */
+		matrix->cols = work->dims[1];
+		matrix->rows = size / matrix->cols;
+		matrix->ld = matrix->cols;
+	}else{
+		/* A part of one row: */
+		matrix->rows = size ? 1 : 0;
+		matrix->cols = size;
+		matrix->ld = work->dims[1];
+	}
+	return 1;
+}
+
+/* Get the view of an array or an array slice as a vector with an increment: */
+static dao_float* DaoBlas_GetVector( DaoArray *array, daoint *size, daoint *inc )
+{
+	DaoArray *work = DaoArray_GetWorkArray( array );
+	daoint start = DaoArray_GetWorkStart( array );
+	daoint len = DaoArray_GetWorkIntervalSize( array );
+
+	*size = DaoArray_GetWorkSize( array );
+	*inc = 1;
+	if( len < *size ){
+		if( len != 1 ) return NULL;
+		*inc = DaoArray_GetWorkStep( array );
+	}
+	return work->data.f + start;
+}
+
+/* Input vectors that cannot be viewed are copied: */
+static dao_float* DaoBlas_GetInputVector( DaoArray *array, daoint *size, daoint *inc )
+{
+	dao_float *data = DaoBlas_GetVector( array, size, inc );
+	if( data ) return data;
+	DaoArray_Sliced( array );
+	return DaoBlas_GetVector( array, size, inc );
+}
+
+static void DaoBlas_Transpose( DaoBlasMatrix *self, int trans )
+{
+	daoint rows = self->rows;
+	if( trans == 0 ) return;
+	self->rows = self->cols;
+	self->cols = rows;
+}
+
+
+/* C = op(A) * op(B), where the sizes of A and C are after the transposition: */
+static void DaoBlas_Gemm( DaoBlasMatrix *A, int transA, DaoBlasMatrix *B, int transB, DaoBlasMatrix *C )
+{
+	daoint K = A->cols;
+	if( C->rows == 0 || C->cols == 0 ) return;
+	if( K == 0 ){
+		daoint i;
+		for(i=0; i<C->rows; ++i) memset( C->data + i*C->ld, 0, C->cols*sizeof(dao_float) );
+		return;
+	}
+	if( sizeof(dao_float) == sizeof(float) ){
+		/* Also for vectors, since the built-in fallback has no cblas_sgemv(): */
+		cblas_sgemm( CblasRowMajor, transA ? CblasTrans : CblasNoTrans, transB ? CblasTrans : CblasNoTrans,
+				C->rows, C->cols, K, 1.0, (float*) A->data, A->ld, (float*) B->data, B->ld, 0.0,
+				(float*) C->data, C->ld );
+	}else if( C->rows == 1 ){
+		/* Row vector (with increment A->ld if transposed) times matrix: */
+		cblas_dgemv( CblasRowMajor, transB ? CblasNoTrans : CblasTrans, transB ? B->cols : B->rows,
+				transB ? B->rows : B->cols, 1.0, (double*) B->data, B->ld, (double*) A->data,
+				transA ? A->ld : 1, 0.0, (double*) C->data, 1 );
+	}else if( C->cols == 1 && ! transB ){
+		/* Matrix times column vector: */
+		cblas_dgemv( CblasRowMajor, transA ? CblasTrans : CblasNoTrans, transA ? A->cols : A->rows,
+				transA ? A->rows : A->cols, 1.0, (double*) A->data, A->ld, (double*) B->data, B->ld, 0.0,
+				(double*) C->data, C->ld );
+	}else{
+		cblas_dgemm( CblasRowMajor, transA ? CblasTrans : CblasNoTrans, transB ? CblasTrans : CblasNoTrans,
+				C->rows, C->cols, K, 1.0, (double*) A->data, A->ld, (double*) B->data, B->ld, 0.0,
+				(double*) C->data, C->ld );
+	}
+}
+
+/*
+// Get the output array for a result of the given shape: the "out" parameter
+// if it is an array of the same size, or a new array. The output may be a
+// slice only for a matrix result ("view" is true), otherwise it must be
+// contiguous and the result is stored in row major order.
+*/
+static DaoArray* DaoBlas_GetOutput( DaoProcess *proc, DaoValue *out, daoint *dims, int ndim, int view, DaoBlasMatrix *C )
+{
+	DaoArray *res;
+	daoint i, size = 1;
+	for(i=0; i<ndim; ++i) size *= dims[i];
+
+	if( out->type == DAO_ARRAY ){
+		res = (DaoArray*) out;
+		if( view && DaoBlas_GetMatrix( res, C ) ){
+			if( C->rows != dims[0] || C->cols != dims[1] ){
+				DaoProcess_RaiseError( proc, "Param", "output array shape not matching" );
+				return NULL;
+			}
+			DaoProcess_PutValue( proc, (DaoValue*) res );
+			return res;
+		}
+		if( DaoArray_GetWorkArray( res ) != res || res->size != size ){
+			DaoProcess_RaiseError( proc, "Param", "output array must be a contiguous array of the result size" );
+			return NULL;
+		}
+		DaoProcess_PutValue( proc, (DaoValue*) res );
+	}else{
+		res = DaoProcess_PutArray( proc );
+		DaoArray_SetNumType( res, DAO_FLOAT );
+		DaoArray_ResizeArray( res, dims, ndim );
+	}
+	C->work = res;
+	C->data = res->data.f;
+	C->ld = 0;
+	return res;
+}
+
+/*
+// Get the number of dimensions of an operand: a slice of one row or one column
+// of a matrix is a vector; slices of 3-D arrays are copied:
+*/
+static int DaoBlas_GetDimCount( DaoArray *array )
+{
+	DaoArray *work = DaoArray_GetWorkArray( array );
+	DaoBlasMatrix matrix;
+	if( work == array ) return array->ndim;
+	if( work->ndim == 2 ){
+		DaoBlas_GetMatrix( array, & matrix );
+		if( matrix.rows == 1 && work->dims[0] > 1 ) return 1;
+		if( matrix.cols == 1 && work->dims[1] > 1 ) return 1;
+		return 2;
+	}
+	DaoArray_Sliced( array );
+	return array->ndim;
+}
+/*
+// Get a vector operand as a column of one matrix column, with the increment
+// of the vector as the leading dimension:
+*/
+static void DaoBlas_GetColumn( DaoArray *array, DaoBlasMatrix *matrix )
+{
+	daoint size, inc;
+	matrix->data = DaoBlas_GetInputVector( array, & size, & inc );
+	matrix->work = DaoArray_GetWorkArray( array );
+	matrix->rows = size;
+	matrix->cols = 1;
+	matrix->ld = inc;
+}
+
+/*
+// Matrix multiplication of two dimensional arrays (or slices), with support
+// for vectors (one dimensional arrays) and batches (three dimensional arrays):
+//   [M,K] x [K,N] => [M,N];
+//   [M,K] x [K] => [M];  [K] x [K,N] => [N];
+//   [B,M,K] x [B,K,N] => [B,M,N];  [B,M,K] x [K,N] => [B,M,N];  [M,K] x [B,K,N] => [B,M,N];
+// Slices of two dimensional arrays are used in place with the leading dimension
+// of the original array; a slice of one row or column is used as a vector.
+*/
+static void BLAS_MatMul( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *a = (DaoArray*) p[0];
+	DaoArray *b = (DaoArray*) p[1];
+	int transA = p[3]->xBoolean.value;
+	int transB = p[4]->xBoolean.value;
+	int ndimA = DaoBlas_GetDimCount( a );
+	int ndimB = DaoBlas_GetDimCount( b );
+	int ndim = 0;
+	DaoBlasMatrix A, B, C;
+	daoint i, dims[3], batch = 1, strideA = 0, strideB = 0, strideC = 0;
+
+	if( ndimA > 3 || ndimB > 3 || (ndimA == 1 && ndimB == 1) ){
+		DaoProcess_RaiseError( proc, "Param", "invalid array dimensions for matrix multiplication" );
+		return;
+	}
+	if( ndimA == 3 ){
+		batch = a->dims[0];
+		A.data = a->data.f;
+		A.rows = a->dims[1];
+		A.cols = A.ld = a->dims[2];
+		strideA = A.rows * A.cols;
+	}else if( ndimA == 1 ){
+		/* A vector on the left is a row vector, the transpose of a column: */
+		DaoBlas_GetColumn( a, & A );
+		transA = 1;
+	}else{
+		DaoBlas_GetMatrix( a, & A );
+	}
+	if( ndimB == 3 ){
+		if( ndimA == 3 && b->dims[0] != batch ){
+			DaoProcess_RaiseError( proc, "Param", "batch sizes not matching" );
+			return;
+		}
+		batch = b->dims[0];
+		B.data = b->data.f;
+		B.rows = b->dims[1];
+		B.cols = B.ld = b->dims[2];
+		strideB = B.rows * B.cols;
+	}else if( ndimB == 1 ){
+		/* A vector on the right is a column vector: */
+		DaoBlas_GetColumn( b, & B );
+		transB = 0;
+	}else{
+		DaoBlas_GetMatrix( b, & B );
+	}
+	if( A.ld == 0 ) A.ld = 1;
+	if( B.ld == 0 ) B.ld = 1;
+
+	DaoBlas_Transpose( & A, transA );
+	DaoBlas_Transpose( & B, transB );
+	if( A.cols != B.rows ){
+		DaoProcess_RaiseError( proc, "Param", "matrix dimensions not matching" );
+		return;
+	}
+
+	if( ndimA == 3 || ndimB == 3 ) dims[ndim++] = batch;
+	if( ndimA != 1 ) dims[ndim++] = A.rows;
+	if( ndimB != 1 ) dims[ndim++] = B.cols;
+	if( DaoBlas_GetOutput( proc, p[2], dims, ndim, ndimA == 2 && ndimB == 2, & C ) == NULL ) return;
+	if( C.work == DaoArray_GetWorkArray( a ) || C.work == DaoArray_GetWorkArray( b ) ){
+		DaoProcess_RaiseError( proc, "Param", "output array overlapping with input" );
+		return;
+	}
+	C.rows = A.rows;
+	C.cols = B.cols;
+	if( C.ld == 0 ) C.ld = C.cols ? C.cols : 1;
+	strideC = C.rows * C.cols;
+
+	if( ndimA == 3 && ndimB != 3 && transA == 0 ){
+		/* The batch of A can be multiplied as one matrix: */
+		A.rows *= batch;
+		C.rows *= batch;
+		batch = 1;
+	}
+	for(i=0; i<batch; ++i){
+		DaoBlasMatrix A2 = A, B2 = B, C2 = C;
+		A2.data += i * strideA;
+		B2.data += i * strideB;
+		C2.data += i * strideC;
+		DaoBlas_Gemm( & A2, transA, & B2, transB, & C2 );
+	}
+}
+
+static void BLAS_Dot( DaoProcess *proc, DaoValue *p[], int N )
+{
+	daoint nx, ny, incx, incy;
+	dao_float *x = DaoBlas_GetInputVector( (DaoArray*) p[0], & nx, & incx );
+	dao_float *y = DaoBlas_GetInputVector( (DaoArray*) p[1], & ny, & incy );
+	if( nx != ny ){
+		DaoProcess_RaiseError( proc, "Param", "vector sizes not matching" );
+		return;
+	}
+	if( sizeof(dao_float) == sizeof(float) ){
+		DaoProcess_PutFloat( proc, cblas_sdot( nx, (float*) x, incx, (float*) y, incy ) );
+	}else{
+		DaoProcess_PutFloat( proc, cblas_ddot( nx, (double*) x, incx, (double*) y, incy ) );
+	}
+}
+
+static void BLAS_Axpy( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *array = (DaoArray*) p[2];
+	daoint nx, ny, incx, incy;
+	dao_float *x = DaoBlas_GetInputVector( (DaoArray*) p[1], & nx, & incx );
+	dao_float *y = DaoBlas_GetVector( array, & ny, & incy );
+
+	DaoProcess_PutValue( proc, (DaoValue*) array );
+	if( y == NULL ){
+		DaoProcess_RaiseError( proc, "Param", "output vector must have equally spaced elements" );
+		return;
+	}else if( nx != ny ){
+		DaoProcess_RaiseError( proc, "Param", "vector sizes not matching" );
+		return;
+	}
+	if( sizeof(dao_float) == sizeof(float) ){
+		cblas_saxpy( nx, p[0]->xFloat.value, (float*) x, incx, (float*) y, incy );
+	}else{
+		cblas_daxpy( nx, p[0]->xFloat.value, (double*) x, incx, (double*) y, incy );
+	}
+}
+
+static DaoFunctionEntry blasMeths[] =
+{
+	/*
+	// Matrix product of "a" and "b" (optionally transposed), stored in "out"
+	// if it is an array; vectors and batches of matrices are supported:
+	//   [M,K] x [K,N] => [M,N];  [M,K] x [K] => [M];  [K] x [K,N] => [N];
+	//   [B,M,K] x [B,K,N] => [B,M,N];  [B,M,K] x [K,N] => [B,M,N];
+	*/
+	{ BLAS_MatMul,
+		"matmul( a: array<float>, b: array<float>, out: array<float>|none = none, "
+			"transA: bool = false, transB: bool = false ) => array<float>"
+	},
+
+	/* Dot product of two vectors: */
+	{ BLAS_Dot,   "dot( x: array<float>, y: array<float> ) => float" },
+
+	/* y = alpha * x + y, and return y: */
+	{ BLAS_Axpy,  "axpy( alpha: float, x: array<float>, y: array<float> ) => array<float>" },
+	{ NULL, NULL }
+};
+
+int DaoBLAS_Load( DaoVmSpace *vms, DaoNamespace *ns )
+{
+	DaoNamespace *blasns = DaoVmSpace_GetNamespace( vms, "blas" );
+	DaoNamespace_AddConstValue( ns, "blas", (DaoValue*) blasns );
+	DaoNamespace_WrapFunctions( blasns, blasMeths );
+	return 0;
+}
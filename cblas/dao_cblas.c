@@ -4,10 +4,42 @@
 extern "C"{
 #endif
 
+/*
+// Single precision (and single precision complex) routines use the storage of
+// array<float> directly when dao_float is float. Otherwise they work on float
+// copies, which are converted back only for the arrays they modify ("output").
+*/
+static float* DaoCBLAS_GetFloat32( DaoArray *array )
+{
+	float *data;
+	daoint i;
+
+	DaoArray_Sliced( array );
+	if( sizeof(dao_float) == sizeof(float) ) return (float*) array->data.f;
+
+	data = (float*) dao_malloc( (array->size + 1) * sizeof(float) );
+	for(i=0; i<array->size; ++i) data[i] = array->data.f[i];
+	return data;
+}
+
+static void DaoCBLAS_PutFloat32( DaoArray *array, const float *data, int output )
+{
+	daoint i;
+
+	if( (void*) data == (void*) array->data.f ) return;
+	if( output ){
+		for(i=0; i<array->size; ++i) array->data.f[i] = data[i];
+	}
+	dao_free( (void*) data );
+}
+
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_sdsdot( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_dsdot( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static void dao__cblas_sdot( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ddot( DaoProcess *_proc, DaoValue *_p[], int _n );
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_sasum( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_dasum( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_scasum( DaoProcess *_proc, DaoValue *_p[], int _n );
@@ -20,8 +52,10 @@ static void dao__cblas_isamax( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_idamax( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_icamax( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_izamax( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static void dao__cblas_saxpy( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_daxpy( DaoProcess *_proc, DaoValue *_p[], int _n );
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_caxpy( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zaxpy( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_scopy( DaoProcess *_proc, DaoValue *_p[], int _n );
@@ -47,7 +81,9 @@ static void dao__cblas_zscal( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_csscal( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zdscal( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_sgemv( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static void dao__cblas_dgemv( DaoProcess *_proc, DaoValue *_p[], int _n );
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_cgemv( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zgemv( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_sger( DaoProcess *_proc, DaoValue *_p[], int _n );
@@ -112,8 +148,10 @@ static void dao__cblas_chbmv( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zhbmv( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_chpmv( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zhpmv( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static void dao__cblas_sgemm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_dgemm( DaoProcess *_proc, DaoValue *_p[], int _n );
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_cgemm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zgemm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ssymm( DaoProcess *_proc, DaoValue *_p[], int _n );
@@ -121,7 +159,9 @@ static void dao__cblas_dsymm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_csymm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zsymm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ssyrk( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static void dao__cblas_dsyrk( DaoProcess *_proc, DaoValue *_p[], int _n );
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_csyrk( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zsyrk( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ssyr2k( DaoProcess *_proc, DaoValue *_p[], int _n );
@@ -133,7 +173,9 @@ static void dao__cblas_dtrmm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ctrmm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ztrmm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_strsm( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static void dao__cblas_dtrsm( DaoProcess *_proc, DaoValue *_p[], int _n );
+#ifndef DAO_CBLAS_FALLBACK
 static void dao__cblas_ctrsm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_ztrsm( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_chemm( DaoProcess *_proc, DaoValue *_p[], int _n );
@@ -142,12 +184,16 @@ static void dao__cblas_cherk( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zherk( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_cher2k( DaoProcess *_proc, DaoValue *_p[], int _n );
 static void dao__cblas_zher2k( DaoProcess *_proc, DaoValue *_p[], int _n );
+#endif
 static DaoFunctionEntry dao__Funcs[] = 
 {
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_sdsdot, "cblas_sdsdot( n: int, alpha: float, x: array<float>, incx: int, y: array<float>, incy: int )=>float" },
   { dao__cblas_dsdot, "cblas_dsdot( n: int, x: array<float>, incx: int, y: array<float>, incy: int )=>float" },
+#endif
   { dao__cblas_sdot, "cblas_sdot( n: int, x: array<float>, incx: int, y: array<float>, incy: int )=>float" },
   { dao__cblas_ddot, "cblas_ddot( n: int, x: array<float>, incx: int, y: array<float>, incy: int )=>float" },
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_sasum, "cblas_sasum( n: int, x: array<float>, incx: int )=>float" },
   { dao__cblas_dasum, "cblas_dasum( n: int, x: array<float>, incx: int )=>float" },
   { dao__cblas_scasum, "cblas_scasum( n: int, x: array<float>, incx: int )=>float" },
@@ -160,8 +206,10 @@ static DaoFunctionEntry dao__Funcs[] =
   { dao__cblas_idamax, "cblas_idamax( n: int, x: array<float>, incx: int )=>int" },
   { dao__cblas_icamax, "cblas_icamax( n: int, x: array<float>, incx: int )=>int" },
   { dao__cblas_izamax, "cblas_izamax( n: int, x: array<float>, incx: int )=>int" },
+#endif
   { dao__cblas_saxpy, "cblas_saxpy( n: int, alpha: float, x: array<float>, incx: int, y: array<float>, incy: int )" },
   { dao__cblas_daxpy, "cblas_daxpy( n: int, alpha: float, x: array<float>, incx: int, y: array<float>, incy: int )" },
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_caxpy, "cblas_caxpy( n: int, alpha: array<float>, x: array<float>, incx: int, y: array<float>, incy: int )" },
   { dao__cblas_zaxpy, "cblas_zaxpy( n: int, alpha: array<float>, x: array<float>, incx: int, y: array<float>, incy: int )" },
   { dao__cblas_scopy, "cblas_scopy( n: int, x: array<float>, incx: int, y: array<float>, incy: int )" },
@@ -187,7 +235,9 @@ static DaoFunctionEntry dao__Funcs[] =
   { dao__cblas_csscal, "cblas_csscal( N: int, alpha: float, X: array<float>, incX: int )" },
   { dao__cblas_zdscal, "cblas_zdscal( N: int, alpha: float, X: array<float>, incX: int )" },
   { dao__cblas_sgemv, "cblas_sgemv( order: int, trans: int, m: int, n: int, alpha: float, a: array<float>, lda: int, x: array<float>, incx: int, beta: float, y: array<float>, incy: int )" },
+#endif
   { dao__cblas_dgemv, "cblas_dgemv( order: int, trans: int, m: int, n: int, alpha: float, a: array<float>, lda: int, x: array<float>, incx: int, beta: float, y: array<float>, incy: int )" },
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_cgemv, "cblas_cgemv( order: int, trans: int, m: int, n: int, alpha: array<float>, a: array<float>, lda: int, x: array<float>, incx: int, beta: array<float>, y: array<float>, incy: int )" },
   { dao__cblas_zgemv, "cblas_zgemv( order: int, trans: int, m: int, n: int, alpha: array<float>, a: array<float>, lda: int, x: array<float>, incx: int, beta: array<float>, y: array<float>, incy: int )" },
   { dao__cblas_sger, "cblas_sger( order: int, M: int, N: int, alpha: float, X: array<float>, incX: int, Y: array<float>, incY: int, A: array<float>, lda: int )" },
@@ -252,8 +302,10 @@ static DaoFunctionEntry dao__Funcs[] =
   { dao__cblas_zhbmv, "cblas_zhbmv( order: int, Uplo: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, X: array<float>, incX: int, beta: array<float>, Y: array<float>, incY: int )" },
   { dao__cblas_chpmv, "cblas_chpmv( order: int, Uplo: int, N: int, alpha: array<float>, Ap: array<float>, X: array<float>, incX: int, beta: array<float>, Y: array<float>, incY: int )" },
   { dao__cblas_zhpmv, "cblas_zhpmv( order: int, Uplo: int, N: int, alpha: array<float>, Ap: array<float>, X: array<float>, incX: int, beta: array<float>, Y: array<float>, incY: int )" },
+#endif
   { dao__cblas_sgemm, "cblas_sgemm( Order: int, TransA: int, TransB: int, M: int, N: int, K: int, alpha: float, A: array<float>, lda: int, B: array<float>, ldb: int, beta: float, C: array<float>, ldc: int )" },
   { dao__cblas_dgemm, "cblas_dgemm( Order: int, TransA: int, TransB: int, M: int, N: int, K: int, alpha: float, A: array<float>, lda: int, B: array<float>, ldb: int, beta: float, C: array<float>, ldc: int )" },
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_cgemm, "cblas_cgemm( Order: int, TransA: int, TransB: int, M: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: array<float>, C: array<float>, ldc: int )" },
   { dao__cblas_zgemm, "cblas_zgemm( Order: int, TransA: int, TransB: int, M: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: array<float>, C: array<float>, ldc: int )" },
   { dao__cblas_ssymm, "cblas_ssymm( Order: int, Side: int, Uplo: int, M: int, N: int, alpha: float, A: array<float>, lda: int, B: array<float>, ldb: int, beta: float, C: array<float>, ldc: int )" },
@@ -261,7 +313,9 @@ static DaoFunctionEntry dao__Funcs[] =
   { dao__cblas_csymm, "cblas_csymm( Order: int, Side: int, Uplo: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: array<float>, C: array<float>, ldc: int )" },
   { dao__cblas_zsymm, "cblas_zsymm( Order: int, Side: int, Uplo: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: array<float>, C: array<float>, ldc: int )" },
   { dao__cblas_ssyrk, "cblas_ssyrk( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: float, A: array<float>, lda: int, beta: float, C: array<float>, ldc: int )" },
+#endif
   { dao__cblas_dsyrk, "cblas_dsyrk( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: float, A: array<float>, lda: int, beta: float, C: array<float>, ldc: int )" },
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_csyrk, "cblas_csyrk( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, beta: array<float>, C: array<float>, ldc: int )" },
   { dao__cblas_zsyrk, "cblas_zsyrk( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, beta: array<float>, C: array<float>, ldc: int )" },
   { dao__cblas_ssyr2k, "cblas_ssyr2k( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: float, A: array<float>, lda: int, B: array<float>, ldb: int, beta: float, C: array<float>, ldc: int )" },
@@ -273,7 +327,9 @@ static DaoFunctionEntry dao__Funcs[] =
   { dao__cblas_ctrmm, "cblas_ctrmm( Order: int, Side: int, Uplo: int, TransA: int, Diag: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int )" },
   { dao__cblas_ztrmm, "cblas_ztrmm( Order: int, Side: int, Uplo: int, TransA: int, Diag: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int )" },
   { dao__cblas_strsm, "cblas_strsm( Order: int, Side: int, Uplo: int, TransA: int, Diag: int, M: int, N: int, alpha: float, A: array<float>, lda: int, B: array<float>, ldb: int )" },
+#endif
   { dao__cblas_dtrsm, "cblas_dtrsm( Order: int, Side: int, Uplo: int, TransA: int, Diag: int, M: int, N: int, alpha: float, A: array<float>, lda: int, B: array<float>, ldb: int )" },
+#ifndef DAO_CBLAS_FALLBACK
   { dao__cblas_ctrsm, "cblas_ctrsm( Order: int, Side: int, Uplo: int, TransA: int, Diag: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int )" },
   { dao__cblas_ztrsm, "cblas_ztrsm( Order: int, Side: int, Uplo: int, TransA: int, Diag: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int )" },
   { dao__cblas_chemm, "cblas_chemm( Order: int, Side: int, Uplo: int, M: int, N: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: array<float>, C: array<float>, ldc: int )" },
@@ -282,9 +338,11 @@ static DaoFunctionEntry dao__Funcs[] =
   { dao__cblas_zherk, "cblas_zherk( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: float, A: array<float>, lda: int, beta: float, C: array<float>, ldc: int )" },
   { dao__cblas_cher2k, "cblas_cher2k( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: float, C: array<float>, ldc: int )" },
   { dao__cblas_zher2k, "cblas_zher2k( Order: int, Uplo: int, Trans: int, N: int, K: int, alpha: array<float>, A: array<float>, lda: int, B: array<float>, ldb: int, beta: float, C: array<float>, ldc: int )" },
+#endif
   { NULL, NULL }
 };
 
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_sdsdot( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -292,12 +350,12 @@ static void dao__cblas_sdsdot( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[1] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[3] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[5] );
-  const float* y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
+  const float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
 
   float _cblas_sdsdot = cblas_sdsdot( n, alpha, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], y, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_sdsdot );
 }
 /* cblas.h */
@@ -306,26 +364,27 @@ static void dao__cblas_dsdot( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[4] );
-  const float* y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   double _cblas_dsdot = cblas_dsdot( n, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], y, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_dsdot );
 }
+#endif
 /* cblas.h */
 static void dao__cblas_sdot( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[4] );
-  const float* y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   float _cblas_sdot = cblas_sdot( n, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], y, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_sdot );
 }
 /* cblas.h */
@@ -342,15 +401,16 @@ static void dao__cblas_ddot( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[3] );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_ddot );
 }
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_sasum( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   float _cblas_sasum = cblas_sasum( n, x, incx );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_sasum );
 }
 /* cblas.h */
@@ -369,10 +429,10 @@ static void dao__cblas_scasum( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   float _cblas_scasum = cblas_scasum( n, x, incx );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_scasum );
 }
 /* cblas.h */
@@ -391,10 +451,10 @@ static void dao__cblas_snrm2( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[2] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   float _cblas_snrm2 = cblas_snrm2( N, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], X, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_snrm2 );
 }
 /* cblas.h */
@@ -413,10 +473,10 @@ static void dao__cblas_scnrm2( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[2] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   float _cblas_scnrm2 = cblas_scnrm2( N, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], X, 0 );
   DaoProcess_PutFloat( _proc, (dao_float) _cblas_scnrm2 );
 }
 /* cblas.h */
@@ -435,10 +495,10 @@ static void dao__cblas_isamax( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   size_t _cblas_isamax = cblas_isamax( n, x, incx );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
   DaoProcess_PutInteger( _proc, (dao_integer) _cblas_isamax );
 }
 /* cblas.h */
@@ -457,10 +517,10 @@ static void dao__cblas_icamax( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   size_t _cblas_icamax = cblas_icamax( n, x, incx );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
   DaoProcess_PutInteger( _proc, (dao_integer) _cblas_icamax );
 }
 /* cblas.h */
@@ -474,19 +534,20 @@ static void dao__cblas_izamax( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[1] );
   DaoProcess_PutInteger( _proc, (dao_integer) _cblas_izamax );
 }
+#endif
 /* cblas.h */
 static void dao__cblas_saxpy( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[1] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[3] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[5] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
 
   cblas_saxpy( n, alpha, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_daxpy( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -502,20 +563,21 @@ static void dao__cblas_daxpy( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[2] );
   DaoArray_FromFloat64( (DaoArray*)_p[4] );
 }
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_caxpy( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[3] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[5] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   cblas_caxpy( n, alpha, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zaxpy( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -537,13 +599,13 @@ static void dao__cblas_scopy( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[4] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   cblas_scopy( n, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dcopy( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -563,13 +625,13 @@ static void dao__cblas_ccopy( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[4] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   cblas_ccopy( n, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zcopy( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -588,14 +650,14 @@ static void dao__cblas_zcopy( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_sswap( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
-  float* x = (float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[4] );
 
   cblas_sswap( n, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dswap( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -614,14 +676,14 @@ static void dao__cblas_dswap( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_cswap( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int n = (const int) DaoValue_TryGetInteger( _p[0] );
-  float* x = (float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[2] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[4] );
 
   cblas_cswap( n, x, incx, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], x, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zswap( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -640,16 +702,16 @@ static void dao__cblas_zswap( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_srot( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[2] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[4] );
   const float c = (const float) DaoValue_TryGetFloat( _p[5] );
   const float s = (const float) DaoValue_TryGetFloat( _p[6] );
 
   cblas_srot( N, X, incX, Y, incY, c, s );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], X, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_drot( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -670,14 +732,14 @@ static void dao__cblas_drot( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_srotg( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   float a = (float) DaoValue_TryGetFloat( _p[0] );
-  float* b = (float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
-  float* c = (float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
-  float* s = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* b = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
+  float* c = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
+  float* s = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_srotg( &a, b, c, s );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], b, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], c, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], s, 1 );
   DaoProcess_PutFloat( _proc, (dao_float) a );
 }
 /* cblas.h */
@@ -698,16 +760,16 @@ static void dao__cblas_drotg( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_srotm( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[2] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[4] );
-  const float* P = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* P = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_srotm( N, X, incX, Y, incY, P );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], X, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], Y, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], P, 0 );
 }
 /* cblas.h */
 static void dao__cblas_drotm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -728,15 +790,15 @@ static void dao__cblas_drotm( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_srotmg( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   float d1 = (float) DaoValue_TryGetFloat( _p[0] );
-  float* d2 = (float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
-  float* b1 = (float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
+  float* d2 = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
+  float* b1 = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
   const float b2 = (const float) DaoValue_TryGetFloat( _p[3] );
-  float* P = (float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  float* P = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_srotmg( &d1, d2, b1, b2, P );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], d2, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], b1, 1 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], P, 1 );
   DaoProcess_PutFloat( _proc, (dao_float) d1 );
 }
 /* cblas.h */
@@ -759,11 +821,11 @@ static void dao__cblas_sscal( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[1] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[3] );
 
   cblas_sscal( N, alpha, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dscal( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -780,13 +842,13 @@ static void dao__cblas_dscal( DaoProcess *_proc, DaoValue *_p[], int _n )
 static void dao__cblas_cscal( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[3] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[1] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[1] );
 
   cblas_cscal( N, alpha, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[1] );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[1], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zscal( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -805,11 +867,11 @@ static void dao__cblas_csscal( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
   const int N = (const int) DaoValue_TryGetInteger( _p[0] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[1] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[2] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[3] );
 
   cblas_csscal( N, alpha, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[2] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[2], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zdscal( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -833,16 +895,17 @@ static void dao__cblas_sgemv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[8] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[9] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* a = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* a = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_sgemv( order, trans, m, n, alpha, a, lda, x, incx, beta, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], a, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], y, 1 );
 }
+#endif
 /* cblas.h */
 static void dao__cblas_dgemv( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -864,6 +927,7 @@ static void dao__cblas_dgemv( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[7] );
   DaoArray_FromFloat64( (DaoArray*)_p[10] );
 }
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_cgemv( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -873,19 +937,19 @@ static void dao__cblas_cgemv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int n = (const int) DaoValue_TryGetInteger( _p[3] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
   const int incx = (const int) DaoValue_TryGetInteger( _p[8] );
-  float* y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* y = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int incy = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
-  const float* x = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* a = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
+  const float* x = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* a = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_cgemv( order, trans, m, n, alpha, a, lda, x, incx, beta, y, incy );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], a, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], x, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zgemv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -919,15 +983,15 @@ static void dao__cblas_sger( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_sger( order, M, N, alpha, X, incX, Y, incY, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dger( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -956,17 +1020,17 @@ static void dao__cblas_cgeru( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_cgeru( order, M, N, alpha, X, incX, Y, incY, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_cgerc( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -976,17 +1040,17 @@ static void dao__cblas_cgerc( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_cgerc( order, M, N, alpha, X, incX, Y, incY, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zgeru( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1037,13 +1101,13 @@ static void dao__cblas_strsv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_strsv( order, Uplo, TransA, Diag, N, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtrsv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1071,13 +1135,13 @@ static void dao__cblas_ctrsv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_ctrsv( order, Uplo, TransA, Diag, N, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztrsv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1105,13 +1169,13 @@ static void dao__cblas_strmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_strmv( order, Uplo, TransA, Diag, N, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtrmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1139,13 +1203,13 @@ static void dao__cblas_ctrmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_ctrmv( order, Uplo, TransA, Diag, N, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztrmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1172,13 +1236,13 @@ static void dao__cblas_ssyr( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_ssyr( order, Uplo, N, alpha, X, incX, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dsyr( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1204,13 +1268,13 @@ static void dao__cblas_cher( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_cher( order, Uplo, N, alpha, X, incX, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zher( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1237,15 +1301,15 @@ static void dao__cblas_ssyr2( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_ssyr2( order, Uplo, N, alpha, X, incX, Y, incY, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dsyr2( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1274,17 +1338,17 @@ static void dao__cblas_cher2( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_cher2( order, Uplo, N, alpha, X, incX, Y, incY, A, lda );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zher2( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1319,15 +1383,15 @@ static void dao__cblas_sgbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[8] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[10] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[11] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[12] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[12] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[13] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
 
   cblas_sgbmv( order, TransA, M, N, KL, KU, alpha, A, lda, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
-  DaoArray_FromFloat32( (DaoArray*)_p[12] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[12], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dgbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1363,19 +1427,19 @@ static void dao__cblas_cgbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int KU = (const int) DaoValue_TryGetInteger( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[8] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[10] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[12] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[12] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[13] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_cgbmv( order, TransA, M, N, KL, KU, alpha, A, lda, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
-  DaoArray_FromFloat32( (DaoArray*)_p[12] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[12], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zgbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1413,15 +1477,15 @@ static void dao__cblas_ssbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[8] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[9] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_ssbmv( order, Uplo, N, K, alpha, A, lda, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dsbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1454,13 +1518,13 @@ static void dao__cblas_stbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int K = (const int) DaoValue_TryGetInteger( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_stbmv( order, Uplo, TransA, Diag, N, K, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1490,13 +1554,13 @@ static void dao__cblas_ctbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int K = (const int) DaoValue_TryGetInteger( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_ctbmv( order, Uplo, TransA, Diag, N, K, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1526,13 +1590,13 @@ static void dao__cblas_stbsv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int K = (const int) DaoValue_TryGetInteger( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_stbsv( order, Uplo, TransA, Diag, N, K, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtbsv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1562,13 +1626,13 @@ static void dao__cblas_ctbsv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int K = (const int) DaoValue_TryGetInteger( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_ctbsv( order, Uplo, TransA, Diag, N, K, A, lda, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztbsv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1596,13 +1660,13 @@ static void dao__cblas_stpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_TRANSPOSE TransA = (const CBLAS_TRANSPOSE) DaoValue_TryGetInteger( _p[2] );
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[7] );
-  const float* Ap = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_stpmv( order, Uplo, TransA, Diag, N, Ap, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], Ap, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1628,13 +1692,13 @@ static void dao__cblas_ctpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_TRANSPOSE TransA = (const CBLAS_TRANSPOSE) DaoValue_TryGetInteger( _p[2] );
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[7] );
-  const float* Ap = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_ctpmv( order, Uplo, TransA, Diag, N, Ap, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], Ap, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1660,13 +1724,13 @@ static void dao__cblas_stpsv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_TRANSPOSE TransA = (const CBLAS_TRANSPOSE) DaoValue_TryGetInteger( _p[2] );
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[7] );
-  const float* Ap = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_stpsv( order, Uplo, TransA, Diag, N, Ap, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], Ap, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtpsv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1692,13 +1756,13 @@ static void dao__cblas_ctpsv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_TRANSPOSE TransA = (const CBLAS_TRANSPOSE) DaoValue_TryGetInteger( _p[2] );
   const CBLAS_DIAG Diag = (const CBLAS_DIAG) DaoValue_TryGetInteger( _p[3] );
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
-  float* X = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[7] );
-  const float* Ap = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_ctpsv( order, Uplo, TransA, Diag, N, Ap, X, incX );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], Ap, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], X, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztpsv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1726,15 +1790,15 @@ static void dao__cblas_ssymv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[7] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[8] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[10] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_ssymv( order, Uplo, N, alpha, A, lda, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dsymv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1764,19 +1828,19 @@ static void dao__cblas_chemv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[10] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_chemv( order, Uplo, N, alpha, A, lda, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zhemv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1809,15 +1873,15 @@ static void dao__cblas_sspmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[6] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[7] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
-  const float* Ap = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
+  const float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_sspmv( order, Uplo, N, alpha, Ap, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], Ap, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dspmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1846,12 +1910,12 @@ static void dao__cblas_sspr( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
-  float* Ap = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_sspr( order, Uplo, N, alpha, X, incX, Ap );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Ap, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dspr( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1876,12 +1940,12 @@ static void dao__cblas_chpr( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_chpr( order, Uplo, N, alpha, X, incX, A );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zhpr( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1907,14 +1971,14 @@ static void dao__cblas_sspr2( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[3] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* A = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_sspr2( order, Uplo, N, alpha, X, incX, Y, incY, A );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dspr2( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1942,16 +2006,16 @@ static void dao__cblas_chpr2( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[5] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* Ap = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* Y = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_chpr2( order, Uplo, N, alpha, X, incX, Y, incY, Ap );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], Y, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], Ap, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zhpr2( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -1981,19 +2045,19 @@ static void dao__cblas_chbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int K = (const int) DaoValue_TryGetInteger( _p[3] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[6] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[8] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
 
   cblas_chbmv( order, Uplo, N, K, alpha, A, lda, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zhbmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2025,19 +2089,19 @@ static void dao__cblas_chpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   const CBLAS_UPLO Uplo = (const CBLAS_UPLO) DaoValue_TryGetInteger( _p[1] );
   const int N = (const int) DaoValue_TryGetInteger( _p[2] );
   const int incX = (const int) DaoValue_TryGetInteger( _p[6] );
-  float* Y = (float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  float* Y = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
   const int incY = (const int) DaoValue_TryGetInteger( _p[9] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* X = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
-  const float* Ap = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[4] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[3] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* X = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
+  const float* Ap = DaoCBLAS_GetFloat32( (DaoArray*)_p[4] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[3] );
 
   cblas_chpmv( order, Uplo, N, alpha, Ap, X, incX, beta, Y, incY );
-  DaoArray_FromFloat32( (DaoArray*)_p[3] );
-  DaoArray_FromFloat32( (DaoArray*)_p[4] );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[3], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[4], Ap, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], X, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], Y, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zhpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2060,6 +2124,7 @@ static void dao__cblas_zhpmv( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[7] );
   DaoArray_FromFloat64( (DaoArray*)_p[8] );
 }
+#endif
 /* cblas.h */
 static void dao__cblas_sgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -2073,15 +2138,15 @@ static void dao__cblas_sgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[8] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[10] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[11] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[12] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[12] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[13] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
 
   cblas_sgemm( Order, TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
-  DaoArray_FromFloat32( (DaoArray*)_p[12] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[12], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2106,6 +2171,7 @@ static void dao__cblas_dgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[9] );
   DaoArray_FromFloat64( (DaoArray*)_p[12] );
 }
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_cgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -2117,19 +2183,19 @@ static void dao__cblas_cgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int K = (const int) DaoValue_TryGetInteger( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[8] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[10] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[12] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[12] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[13] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_cgemm( Order, TransA, TransB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
-  DaoArray_FromFloat32( (DaoArray*)_p[12] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[12], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zgemm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2168,15 +2234,15 @@ static void dao__cblas_ssymm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[9] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[10] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[12] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_ssymm( Order, Side, Uplo, M, N, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dsymm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2210,19 +2276,19 @@ static void dao__cblas_csymm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[12] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_csymm( Order, Side, Uplo, M, N, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zsymm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2259,14 +2325,15 @@ static void dao__cblas_ssyrk( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[8] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[10] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_ssyrk( Order, Uplo, Trans, N, K, alpha, A, lda, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], C, 1 );
 }
+#endif
 /* cblas.h */
 static void dao__cblas_dsyrk( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -2286,6 +2353,7 @@ static void dao__cblas_dsyrk( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[6] );
   DaoArray_FromFloat64( (DaoArray*)_p[9] );
 }
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_csyrk( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -2295,17 +2363,17 @@ static void dao__cblas_csyrk( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[3] );
   const int K = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[10] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_csyrk( Order, Uplo, Trans, N, K, alpha, A, lda, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zsyrk( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2340,15 +2408,15 @@ static void dao__cblas_ssyr2k( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[9] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[10] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[12] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_ssyr2k( Order, Uplo, Trans, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dsyr2k( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2382,19 +2450,19 @@ static void dao__cblas_csyr2k( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int K = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[12] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_csyr2k( Order, Uplo, Trans, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zsyr2k( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2432,13 +2500,13 @@ static void dao__cblas_strmm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[6] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[7] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* B = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
 
   cblas_strmm( Order, Side, Uplo, TransA, Diag, M, N, alpha, A, lda, B, ldb );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], B, 1 );
 }
 /* cblas.h */
 static void dao__cblas_dtrmm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2471,15 +2539,15 @@ static void dao__cblas_ctrmm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int M = (const int) DaoValue_TryGetInteger( _p[5] );
   const int N = (const int) DaoValue_TryGetInteger( _p[6] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* B = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
 
   cblas_ctrmm( Order, Side, Uplo, TransA, Diag, M, N, alpha, A, lda, B, ldb );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], B, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztrmm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2514,14 +2582,15 @@ static void dao__cblas_strsm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[6] );
   const float alpha = (const float) DaoValue_TryGetFloat( _p[7] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* B = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
 
   cblas_strsm( Order, Side, Uplo, TransA, Diag, M, N, alpha, A, lda, B, ldb );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], B, 1 );
 }
+#endif
 /* cblas.h */
 static void dao__cblas_dtrsm( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -2542,6 +2611,7 @@ static void dao__cblas_dtrsm( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[8] );
   DaoArray_FromFloat64( (DaoArray*)_p[10] );
 }
+#ifndef DAO_CBLAS_FALLBACK
 /* cblas.h */
 static void dao__cblas_ctrsm( DaoProcess *_proc, DaoValue *_p[], int _n )
 {
@@ -2553,15 +2623,15 @@ static void dao__cblas_ctrsm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int M = (const int) DaoValue_TryGetInteger( _p[5] );
   const int N = (const int) DaoValue_TryGetInteger( _p[6] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* B = (float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
+  float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[11] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[7] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[7] );
 
   cblas_ctrsm( Order, Side, Uplo, TransA, Diag, M, N, alpha, A, lda, B, ldb );
-  DaoArray_FromFloat32( (DaoArray*)_p[7] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[7], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], B, 1 );
 }
 /* cblas.h */
 static void dao__cblas_ztrsm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2594,19 +2664,19 @@ static void dao__cblas_chemm( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int N = (const int) DaoValue_TryGetInteger( _p[4] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[9] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[12] );
-  const float* beta = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[10] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* beta = DaoCBLAS_GetFloat32( (DaoArray*)_p[10] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_chemm( Order, Side, Uplo, M, N, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[10] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[10], beta, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zhemm( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2643,13 +2713,13 @@ static void dao__cblas_cherk( DaoProcess *_proc, DaoValue *_p[], int _n )
   const float alpha = (const float) DaoValue_TryGetFloat( _p[5] );
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[8] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[9] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[9] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[10] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
 
   cblas_cherk( Order, Uplo, Trans, N, K, alpha, A, lda, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[9] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[9], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zherk( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2681,17 +2751,17 @@ static void dao__cblas_cher2k( DaoProcess *_proc, DaoValue *_p[], int _n )
   const int lda = (const int) DaoValue_TryGetInteger( _p[7] );
   const int ldb = (const int) DaoValue_TryGetInteger( _p[9] );
   const float beta = (const float) DaoValue_TryGetFloat( _p[10] );
-  float* C = (float*) DaoArray_ToFloat32( (DaoArray*)_p[11] );
+  float* C = DaoCBLAS_GetFloat32( (DaoArray*)_p[11] );
   const int ldc = (const int) DaoValue_TryGetInteger( _p[12] );
-  const float* B = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[8] );
-  const float* A = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[6] );
-  const float* alpha = (const float*) DaoArray_ToFloat32( (DaoArray*)_p[5] );
+  const float* B = DaoCBLAS_GetFloat32( (DaoArray*)_p[8] );
+  const float* A = DaoCBLAS_GetFloat32( (DaoArray*)_p[6] );
+  const float* alpha = DaoCBLAS_GetFloat32( (DaoArray*)_p[5] );
 
   cblas_cher2k( Order, Uplo, Trans, N, K, alpha, A, lda, B, ldb, beta, C, ldc );
-  DaoArray_FromFloat32( (DaoArray*)_p[5] );
-  DaoArray_FromFloat32( (DaoArray*)_p[6] );
-  DaoArray_FromFloat32( (DaoArray*)_p[8] );
-  DaoArray_FromFloat32( (DaoArray*)_p[11] );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[5], alpha, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[6], A, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[8], B, 0 );
+  DaoCBLAS_PutFloat32( (DaoArray*)_p[11], C, 1 );
 }
 /* cblas.h */
 static void dao__cblas_zher2k( DaoProcess *_proc, DaoValue *_p[], int _n )
@@ -2716,6 +2786,7 @@ static void dao__cblas_zher2k( DaoProcess *_proc, DaoValue *_p[], int _n )
   DaoArray_FromFloat64( (DaoArray*)_p[8] );
   DaoArray_FromFloat64( (DaoArray*)_p[11] );
 }
+#endif
 
 #ifdef __cplusplus
 }
@@ -2752,6 +2823,8 @@ static const char *dao__Aliases[] =
 extern "C"{
 #endif
 
+int DaoBLAS_Load( DaoVmSpace *vms, DaoNamespace *ns );
+
 int DaoCBLAS_OnLoad( DaoVmSpace *vms, DaoNamespace *ns )
 {
 	DaoNamespace *aux = DaoVmSpace_LinkModule( vms, ns, "aux" );
@@ -2759,7 +2832,7 @@ int DaoCBLAS_OnLoad( DaoVmSpace *vms, DaoNamespace *ns )
 	DaoNamespace_AddConstNumbers( ns, dao__Nums );
 	DaoNamespace_AliasTypes( ns, dao__Aliases );
 	DaoNamespace_WrapFunctions( ns, dao__Funcs );
-	return 0;
+	return DaoBLAS_Load( vms, ns );
 }
 
 #ifdef __cplusplus
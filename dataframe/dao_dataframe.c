@@ -28,6 +28,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <assert.h>
 #include "dao_dataframe.h"
 #include "daoVmspace.h"
@@ -35,14 +36,23 @@
 #include "daoNumtype.h"
 #include "daoValue.h"
 #include "daoType.h"
+#include "daoThread.h"
 #include "daoGC.h"
 
+#ifdef UNIX
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
 
 #ifdef DAO_WITH_NUMARRAY
 
 
 extern DaoTypeCore daoDataColumnCore;
 extern DaoTypeCore daoDataFrameCore;
+extern DaoTypeCore daoDataQueryCore;
 
 
 static int DaoType_GetDataSize( DaoType *self )
@@ -71,6 +81,315 @@ static int DaoType_GetDataType( DaoType *self )
 
 
 
+/*
+// Memory mapped storage shared by the numeric columns decoded in place
+// from a binary dataframe file. The mapping is private (copy-on-write),
+// so cells can be updated in place; a column only needs to be detached
+// from the mapping when it is resized or freed.
+*/
+struct DaoxDataMapping
+{
+	int     refCount;
+	void   *data;
+	size_t  size;
+};
+
+#ifdef DAO_WITH_THREAD
+static DMutex mutex_mapping;
+#endif
+
+static DaoxDataMapping* DaoxDataMapping_New( void *data, size_t size )
+{
+	DaoxDataMapping *self = (DaoxDataMapping*) dao_calloc( 1, sizeof(DaoxDataMapping) );
+	self->refCount = 1;
+	self->data = data;
+	self->size = size;
+	return self;
+}
+static void DaoxDataMapping_Acquire( DaoxDataMapping *self )
+{
+#ifdef DAO_WITH_THREAD
+	DMutex_Lock( & mutex_mapping );
+#endif
+	self->refCount += 1;
+#ifdef DAO_WITH_THREAD
+	DMutex_Unlock( & mutex_mapping );
+#endif
+}
+static void DaoxDataMapping_Release( DaoxDataMapping *self )
+{
+	int refCount;
+#ifdef DAO_WITH_THREAD
+	DMutex_Lock( & mutex_mapping );
+#endif
+	refCount = -- self->refCount;
+#ifdef DAO_WITH_THREAD
+	DMutex_Unlock( & mutex_mapping );
+#endif
+	if( refCount > 0 ) return;
+#ifdef UNIX
+	munmap( self->data, self->size );
+#endif
+	dao_free( self );
+}
+
+/*
+// Detach the column from the mapped file, and keep the first "keep" cells
+// by copying them into memory owned by the cell array.
+*/
+static void DaoxDataColumn_Unmap( DaoxDataColumn *self, daoint keep )
+{
+	DaoxDataMapping *mapping = self->mapping;
+	void *data = self->cells->data.base;
+
+	if( mapping == NULL ) return;
+	if( keep > self->cells->size ) keep = self->cells->size;
+
+	self->mapping = NULL;
+	self->cells->data.base = NULL;
+	self->cells->size = self->cells->capacity = 0;
+	if( keep > 0 ){
+		DArray_Resize( self->cells, keep );
+		memcpy( self->cells->data.base, data, keep * self->cells->stride );
+	}
+	DaoxDataMapping_Release( mapping );
+}
+
+
+/*
+// Dictionary encoding of string columns:
+//
+// An encoded string column stores the codes (int) of its cells, which index
+// the distinct strings in a dictionary. The dictionary is append-only, so it
+// can be shared by the columns derived from the same column (by slicing,
+// grouping or joining), and cells with equal codes in such columns are equal.
+// Code zero is reserved for the empty string.
+*/
+#define DAOX_DF_DICT_RATIO  4  /* minimum ratio of cells to distinct strings to encode on loading; */
+
+struct DaoxDataDictionary
+{
+	int      refCount;
+	DList   *strings;  /* DList<DString*>: distinct strings indexed by codes; */
+	DArray  *hashes;   /* DArray<uint64_t>: hashes of the strings; */
+	DMap    *codes;    /* DMap<DString*,int>: codes of the strings; */
+};
+
+#ifdef DAO_WITH_THREAD
+static DMutex mutex_dictionary;
+#endif
+
+static uint64_t DaoxDF_HashString( DString *string )
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	daoint i;
+	for(i=0; i<string->size; ++i){
+		hash ^= (uchar_t) string->chars[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+/*
+// Return the code of the string, adding it to the dictionary if necessary.
+// The dictionary is not synchronized internally: adding may reallocate the
+// list of strings and rehash the code map, so the callers that may add to a
+// dictionary shared by other threads must hold a lock around the addition
+// and around the reads of the strings by code (see DaoxSectionScan_GetCell()).
+// The added strings themselves are never moved or freed before the dictionary.
+*/
+static int DaoxDataDictionary_Add( DaoxDataDictionary *self, DString *string )
+{
+	DNode *it = DMap_Find( self->codes, string );
+	int code = self->strings->size;
+	if( it != NULL ) return it->value.pInt;
+	DList_Append( self->strings, string );
+	* (uint64_t*) DArray_Push( self->hashes ) = DaoxDF_HashString( string );
+	DMap_Insert( self->codes, string, (void*)(size_t) code );
+	return code;
+}
+static DaoxDataDictionary* DaoxDataDictionary_New()
+{
+	DaoxDataDictionary *self = (DaoxDataDictionary*) dao_calloc( 1, sizeof(DaoxDataDictionary) );
+	DString empty = DString_WrapChars( "" );
+	self->refCount = 1;
+	self->strings = DList_New( DAO_DATA_STRING );
+	self->hashes = DArray_New( sizeof(uint64_t) );
+	self->codes = DHash_New( DAO_DATA_STRING, 0 );
+	DaoxDataDictionary_Add( self, & empty );
+	return self;
+}
+static void DaoxDataDictionary_Acquire( DaoxDataDictionary *self )
+{
+#ifdef DAO_WITH_THREAD
+	DMutex_Lock( & mutex_dictionary );
+#endif
+	self->refCount += 1;
+#ifdef DAO_WITH_THREAD
+	DMutex_Unlock( & mutex_dictionary );
+#endif
+}
+static void DaoxDataDictionary_Release( DaoxDataDictionary *self )
+{
+	int refCount;
+#ifdef DAO_WITH_THREAD
+	DMutex_Lock( & mutex_dictionary );
+#endif
+	refCount = -- self->refCount;
+#ifdef DAO_WITH_THREAD
+	DMutex_Unlock( & mutex_dictionary );
+#endif
+	if( refCount > 0 ) return;
+	DList_Delete( self->strings );
+	DArray_Delete( self->hashes );
+	DMap_Delete( self->codes );
+	dao_free( self );
+}
+
+/* Turn an empty string column into an encoded column using the dictionary: */
+static void DaoxDataColumn_UseDictionary( DaoxDataColumn *self, DaoxDataDictionary *dictionary )
+{
+	DArray *cells = self->cells;
+
+	DaoxDataColumn_Reset( self, 0 );
+	if( self->dictionary == dictionary ) return;
+	if( self->dictionary ){
+		DaoxDataDictionary_Release( self->dictionary );
+	}else{
+		cells->capacity = (cells->capacity * cells->stride) / sizeof(int);
+		cells->stride = sizeof(int);
+		cells->type = DAO_INTEGER;
+	}
+	DaoxDataDictionary_Acquire( dictionary );
+	self->dictionary = dictionary;
+}
+static DString* DaoxDataColumn_GetString( DaoxDataColumn *self, daoint i )
+{
+	if( self->dictionary ){
+		return self->dictionary->strings->items.pString[ self->cells->data.ints[i] ];
+	}
+	return self->cells->data.strings + i;
+}
+
+/*
+// Encode a plain string column with a dictionary, if it has no more than
+// "maxcodes" distinct strings. Return one if the column is encoded.
+*/
+int DaoxDataColumn_EncodeStrings( DaoxDataColumn *self, daoint maxcodes )
+{
+	DaoxDataDictionary *dictionary;
+	DArray *codes;
+	daoint i;
+
+	if( self->dictionary != NULL ) return 1;
+	if( self->vatype == NULL || self->vatype->tid != DAO_STRING || self->mapping ) return 0;
+	if( maxcodes <= 0 ) return 0;
+
+	dictionary = DaoxDataDictionary_New();
+	codes = DArray_New( sizeof(int) );
+	DArray_Resize( codes, self->cells->size );
+	for(i=0; i<self->cells->size; ++i){
+		codes->data.ints[i] = DaoxDataDictionary_Add( dictionary, self->cells->data.strings + i );
+		if( dictionary->strings->size > maxcodes + 1 ) break;  /* Plus the empty string; */
+	}
+	if( i < self->cells->size ){
+		DaoxDataDictionary_Release( dictionary );
+		DArray_Delete( codes );
+		return 0;
+	}
+	DaoxDataColumn_Reset( self, 0 );
+	DArray_Delete( self->cells );
+	codes->type = DAO_INTEGER;
+	self->cells = codes;
+	self->dictionary = dictionary;
+	return 1;
+}
+
+
+
+
+/*
+// Data parallel execution of a task over a range of items (rows or cells).
+// The range is partitioned into contiguous blocks, one per worker thread;
+// the last block is processed by the calling thread.
+*/
+#define DAOX_DF_MAX_THREADS  32
+#define DAOX_DF_MIN_BLOCK    (1<<15)
+
+typedef struct DaoxDataTask  DaoxDataTask;
+
+typedef void (*DaoxDataTaskFunction)( DaoxDataTask *task );
+
+struct DaoxDataTask
+{
+	DaoxDataTaskFunction  function;
+
+	void    *context;
+	daoint   first;   /* first item of the block; */
+	daoint   end;     /* one past the last item of the block; */
+	int      index;   /* block index; */
+};
+
+static int DaoxDF_GetCpuCount()
+{
+	int count = 1;
+#ifdef UNIX
+	count = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	if( count < 1 ) count = 1;
+	if( count > DAOX_DF_MAX_THREADS ) count = DAOX_DF_MAX_THREADS;
+	return count;
+}
+/* Number of blocks to partition "count" items into, with at least "minblock" items per block: */
+static int DaoxDF_GetTaskCount( daoint count, daoint minblock )
+{
+	daoint tasks = DaoxDF_GetCpuCount();
+#ifndef DAO_WITH_THREAD
+	tasks = 1;
+#endif
+	if( minblock < 1 ) minblock = 1;
+	if( count / minblock < tasks ) tasks = count / minblock;
+	if( tasks < 1 ) tasks = 1;
+	return tasks;
+}
+static void DaoxDF_RunTask( void *p )
+{
+	DaoxDataTask *task = (DaoxDataTask*) p;
+	task->function( task );
+}
+static void DaoxDF_RunTasks( DaoxDataTaskFunction function, void *context, daoint count, int ntask )
+{
+	DaoxDataTask tasks[DAOX_DF_MAX_THREADS];
+#ifdef DAO_WITH_THREAD
+	DThread threads[DAOX_DF_MAX_THREADS];
+#endif
+	daoint i;
+
+	if( ntask < 1 ) ntask = 1;
+	if( ntask > DAOX_DF_MAX_THREADS ) ntask = DAOX_DF_MAX_THREADS;
+	for(i=0; i<ntask; ++i){
+		tasks[i].function = function;
+		tasks[i].context = context;
+		tasks[i].first = (count * i) / ntask;
+		tasks[i].end = (count * (i + 1)) / ntask;
+		tasks[i].index = i;
+	}
+#ifdef DAO_WITH_THREAD
+	for(i=0; i<ntask-1; ++i){
+		DThread_Init( & threads[i] );
+		DThread_Start( & threads[i], DaoxDF_RunTask, & tasks[i] );
+	}
+	DaoxDF_RunTask( & tasks[ntask-1] );
+	for(i=0; i<ntask-1; ++i){
+		DThread_Join( & threads[i] );
+		DThread_Destroy( & threads[i] );
+	}
+#else
+	for(i=0; i<ntask; ++i) DaoxDF_RunTask( & tasks[i] );
+#endif
+}
+
+
+
 DaoxDataColumn* DaoxDataColumn_New( DaoVmSpace *vmspace, DaoType *type )
 {
 	DaoxDataColumn *self = (DaoxDataColumn*) dao_calloc( 1, sizeof(DaoxDataColumn) );
@@ -87,6 +406,7 @@ DaoxDataColumn* DaoxDataColumn_New( DaoVmSpace *vmspace, DaoType *type )
 void DaoxDataColumn_Delete( DaoxDataColumn *self )
 {
 	DaoxDataColumn_Reset( self, 0 );
+	if( self->dictionary ) DaoxDataDictionary_Release( self->dictionary );
 	DArray_Delete( self->cells );
 	GC_DecRC( self->vatype );
 	DaoCstruct_Free( (DaoCstruct*) self );
@@ -95,8 +415,15 @@ void DaoxDataColumn_Delete( DaoxDataColumn *self )
 void DaoxDataColumn_Reset( DaoxDataColumn *self, daoint size )
 {
 	daoint i, datatype;
+	if( self->mapping ) DaoxDataColumn_Unmap( self, size );
 	if( self->vatype == NULL && self->cells->size == 0 && size == 0 ) return;
 	assert( self->vatype != NULL );
+	if( self->dictionary ){
+		daoint old = self->cells->size;
+		DArray_Resize( self->cells, size );
+		if( size > old ) memset( self->cells->data.ints + old, 0, (size - old) * sizeof(int) );
+		return;
+	}
 	datatype = DaoType_GetDataType( self->vatype );
 	if( size < self->cells->size ){
 		for(i=size; i<self->cells->size; ++i){
@@ -124,6 +451,10 @@ void DaoxDataColumn_SetType( DaoxDataColumn *self, DaoType *type )
 	int datatype, datasize;
 
 	DaoxDataColumn_Reset( self, 0 );
+	if( self->dictionary ){
+		DaoxDataDictionary_Release( self->dictionary );
+		self->dictionary = NULL;
+	}
 	//if( type == NULL ) type = DaoVmSpace_GetCommonType( DAO_ANY, 0 );
 	datatype = DaoType_GetDataType( type );
 	datasize = DaoType_GetDataSize( type );
@@ -145,10 +476,26 @@ void DaoxDataColumn_SetCell( DaoxDataColumn *self, daoint i, DaoValue *value )
 		case DAO_INTEGER : self->cells->data.daoints[i]   = 0; break;
 		case DAO_FLOAT   : self->cells->data.doubles[i]   = 0.0; break;
 		case DAO_COMPLEX : self->cells->data.complexes[i] = zero; break;
-		case DAO_STRING  : DString_Reset( & self->cells->data.strings[i], 0 ); break;
+		case DAO_STRING  :
+			if( self->dictionary ){
+				self->cells->data.ints[i] = 0;
+			}else{
+				DString_Reset( & self->cells->data.strings[i], 0 );
+			}
+			break;
 		}
 		return;
 	}
+	if( self->dictionary ){
+		DString *string = value->type == DAO_STRING ? value->xString.value : NULL;
+		if( string == NULL ){
+			string = DString_New();
+			DaoValue_GetString( value, string );
+		}
+		self->cells->data.ints[i] = DaoxDataDictionary_Add( self->dictionary, string );
+		if( value->type != DAO_STRING ) DString_Delete( string );
+		return;
+	}
 	switch( self->vatype->tid ){
 	default :
 		GC_Assign( & self->cells->data.values[i], value );
@@ -166,11 +513,204 @@ DaoValue* DaoxDataColumn_GetCell( DaoxDataColumn *self, daoint i, DaoValue *valu
 	case DAO_INTEGER : value->xInteger.value = self->cells->data.daoints[i]; break;
 	case DAO_FLOAT   : value->xFloat.value   = self->cells->data.doubles[i]; break;
 	case DAO_COMPLEX : value->xComplex.value = self->cells->data.complexes[i]; break;
-	case DAO_STRING  : value->xString.value  = & self->cells->data.strings[i]; break;
+	case DAO_STRING  : value->xString.value  = DaoxDataColumn_GetString( self, i ); break;
 	default : value = self->cells->data.values[i]; break;
 	}
 	return value;
 }
+/*
+// Typed cell operations without boxing the cells:
+*/
+static uint64_t DaoxDF_HashBits( uint64_t x )
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+}
+static uint64_t DaoxDF_HashFloat( double value )
+{
+	uint64_t bits;
+	if( value == 0.0 ) value = 0.0;      /* Same hash for -0.0 and 0.0; */
+	if( value != value ) value = NAN;    /* Same hash for all NaNs; */
+	memcpy( & bits, & value, sizeof(double) );
+	return DaoxDF_HashBits( bits );
+}
+static uint64_t DaoxDataColumn_HashCell( DaoxDataColumn *self, daoint i )
+{
+	uint64_t hash;
+	switch( self->vatype->tid ){
+	case DAO_INTEGER : return DaoxDF_HashBits( (uint64_t) self->cells->data.daoints[i] );
+	case DAO_FLOAT   : return DaoxDF_HashFloat( self->cells->data.doubles[i] );
+	case DAO_COMPLEX :
+		hash = DaoxDF_HashFloat( self->cells->data.complexes[i].real );
+		return hash ^ (DaoxDF_HashFloat( self->cells->data.complexes[i].imag ) >> 1);
+	case DAO_STRING  :
+		if( self->dictionary ){
+			uint64_t *hashes = (uint64_t*) self->dictionary->hashes->data.base;
+			return hashes[ self->cells->data.ints[i] ];
+		}
+		return DaoxDF_HashString( self->cells->data.strings + i );
+	}
+	return DaoxDF_HashBits( (uint64_t)(size_t) self->cells->data.values[i] );
+}
+static int DaoxDF_CompareFloats( double a, double b )
+{
+	if( a == b ) return 0;
+	if( a != a ) return b != b ? 0 : 1;  /* NaN are ordered last; */
+	if( b != b ) return -1;
+	return a < b ? -1 : 1;
+}
+/* Compare the i-th cell of "self" with the j-th cell of "other" of the same type: */
+static int DaoxDataColumn_CompareCells( DaoxDataColumn *self, daoint i, DaoxDataColumn *other, daoint j )
+{
+	DArray *A = self->cells, *B = other->cells;
+	int cmp;
+	switch( self->vatype->tid ){
+	case DAO_INTEGER :
+		if( A->data.daoints[i] == B->data.daoints[j] ) return 0;
+		return A->data.daoints[i] < B->data.daoints[j] ? -1 : 1;
+	case DAO_FLOAT :
+		return DaoxDF_CompareFloats( A->data.doubles[i], B->data.doubles[j] );
+	case DAO_COMPLEX :
+		cmp = DaoxDF_CompareFloats( A->data.complexes[i].real, B->data.complexes[j].real );
+		if( cmp ) return cmp;
+		return DaoxDF_CompareFloats( A->data.complexes[i].imag, B->data.complexes[j].imag );
+	case DAO_STRING :
+		if( self->dictionary && self->dictionary == other->dictionary ){
+			if( A->data.ints[i] == B->data.ints[j] ) return 0;
+		}
+		return DString_Compare( DaoxDataColumn_GetString( self, i ), DaoxDataColumn_GetString( other, j ) );
+	}
+	if( A->data.values[i] == B->data.values[j] ) return 0;
+	return A->data.values[i] < B->data.values[j] ? -1 : 1;
+}
+/* Copy the j-th cell of "other" to the i-th cell of "self" of the same type: */
+static void DaoxDataColumn_CopyCell( DaoxDataColumn *self, daoint i, DaoxDataColumn *other, daoint j )
+{
+	DArray *A = self->cells, *B = other->cells;
+	switch( DaoType_GetDataType( self->vatype ) ){
+	case 0 : GC_Assign( A->data.values + i, B->data.values[j] ); break;
+	case DAO_STRING :
+		if( self->dictionary && self->dictionary == other->dictionary ){
+			A->data.ints[i] = B->data.ints[j];
+		}else if( self->dictionary ){
+			A->data.ints[i] = DaoxDataDictionary_Add( self->dictionary, DaoxDataColumn_GetString( other, j ) );
+		}else{
+			DString_Assign( A->data.strings + i, DaoxDataColumn_GetString( other, j ) );
+		}
+		break;
+	default : memcpy( DArray_Get( A, i ), DArray_Get( B, j ), A->stride ); break;
+	}
+}
+/* Format a float with the fewest digits (up to 17) that read back to the same value: */
+static void DaoxDF_FormatFloat( char *buffer, double value )
+{
+	int digits;
+	for(digits=15; digits<17; ++digits){
+		sprintf( buffer, "%.*g", digits, value );
+		if( strtod( buffer, NULL ) == value ) return;
+	}
+	sprintf( buffer, "%.17g", value );
+}
+static void DaoxDataColumn_AppendCellString( DaoxDataColumn *self, daoint i, DString *output )
+{
+	char real[32], imag[32];
+	char buffer[100];
+	buffer[0] = '\0';
+	switch( self->vatype->tid ){
+	case DAO_INTEGER :
+		sprintf( buffer, "%" DAO_INT, self->cells->data.daoints[i] );
+		break;
+	case DAO_FLOAT :
+		DaoxDF_FormatFloat( buffer, self->cells->data.doubles[i] );
+		break;
+	case DAO_COMPLEX :
+		DaoxDF_FormatFloat( real, self->cells->data.complexes[i].real );
+		DaoxDF_FormatFloat( imag, self->cells->data.complexes[i].imag );
+		sprintf( buffer, "(%s,%s)", real, imag );
+		break;
+	case DAO_STRING :
+		DString_Append( output, DaoxDataColumn_GetString( self, i ) );
+		break;
+	default :
+		sprintf( buffer, "%p", self->cells->data.values[i] );
+		break;
+	}
+	DString_AppendChars( output, buffer );
+}
+/* Hash the cells of the key columns at a row: */
+static uint64_t DaoxDF_HashRow( DaoxDataColumn **keys, int nkey, daoint row )
+{
+	uint64_t hash = 0;
+	int i;
+	for(i=0; i<nkey; ++i) hash = DaoxDF_HashBits( hash + DaoxDataColumn_HashCell( keys[i], row ) );
+	return hash;
+}
+/* Compare lexicographically the cells of two lists of key columns of the same types: */
+static int DaoxDF_CompareRows( DaoxDataColumn **keys1, daoint row1, DaoxDataColumn **keys2, daoint row2, int nkey )
+{
+	int i, cmp;
+	for(i=0; i<nkey; ++i){
+		cmp = DaoxDataColumn_CompareCells( keys1[i], row1, keys2[i], row2 );
+		if( cmp ) return cmp;
+	}
+	return 0;
+}
+/*
+// Resize "self" to "count" cells, and gather the cells of "source" at "rows";
+// negative rows produce missing cells (NaN for float, otherwise zero or empty):
+*/
+static void DaoxDataColumn_Gather( DaoxDataColumn *self, DaoxDataColumn *source, daoint *rows, daoint count )
+{
+	DArray *A, *B = source->cells;
+	dao_complex zero = {0.0,0.0};
+	daoint i;
+
+	if( source->dictionary && self->cells->size == 0 && self->vatype->tid == DAO_STRING ){
+		DaoxDataColumn_UseDictionary( self, source->dictionary );
+	}
+	DaoxDataColumn_Reset( self, count );
+	A = self->cells;
+	if( self->dictionary ){
+		if( self->dictionary == source->dictionary ){
+			for(i=0; i<count; ++i) A->data.ints[i] = rows[i] >= 0 ? B->data.ints[rows[i]] : 0;
+		}else{
+			for(i=0; i<count; ++i){
+				A->data.ints[i] = 0;
+				if( rows[i] >= 0 ) DaoxDataColumn_CopyCell( self, i, source, rows[i] );
+			}
+		}
+		return;
+	}
+	switch( DaoType_GetDataType( self->vatype ) ){
+	case DAO_INTEGER :
+		for(i=0; i<count; ++i) A->data.daoints[i] = rows[i] >= 0 ? B->data.daoints[rows[i]] : 0;
+		break;
+	case DAO_FLOAT :
+		for(i=0; i<count; ++i) A->data.doubles[i] = rows[i] >= 0 ? B->data.doubles[rows[i]] : NAN;
+		break;
+	case DAO_COMPLEX :
+		for(i=0; i<count; ++i) A->data.complexes[i] = rows[i] >= 0 ? B->data.complexes[rows[i]] : zero;
+		break;
+	case DAO_STRING :
+		for(i=0; i<count; ++i){
+			if( rows[i] >= 0 ){
+				DString_Assign( A->data.strings + i, DaoxDataColumn_GetString( source, rows[i] ) );
+			}else{
+				DString_Reset( A->data.strings + i, 0 );
+			}
+		}
+		break;
+	default :
+		for(i=0; i<count; ++i){
+			GC_Assign( A->data.values + i, rows[i] >= 0 ? B->data.values[rows[i]] : NULL );
+		}
+		break;
+	}
+}
 static int DaoxDataColumn_GetPrintWidth( DaoxDataColumn *self, int max )
 {
 	daoint i, width = 0;
@@ -182,7 +722,7 @@ static int DaoxDataColumn_GetPrintWidth( DaoxDataColumn *self, int max )
 		int w = 0;
 		switch( self->vatype->tid ){
 		case DAO_INTEGER : w = 1 + log10( 1 + abs( self->cells->data.daoints[i] ) ); break;
-		case DAO_STRING  : w = self->cells->data.strings[i].size; break;
+		case DAO_STRING  : w = DaoxDataColumn_GetString( self, i )->size; break;
 		default : w = max; break;
 		}
 		if( w > width ) width = w;
@@ -277,7 +817,9 @@ void DaoxDataFrame_Reset( DaoxDataFrame *self )
 {
 	daoint i;
 	for(i=0; i<self->columns->size; ++i){
-		DList_Append( self->caches, self->columns->items.pVoid[i] );
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[i];
+		DaoxDataColumn_Unmap( column, 0 );
+		DList_Append( self->caches, column );
 	}
 	for(i=0; i<3; ++i){
 		self->dims[i] = 0;
@@ -465,6 +1007,7 @@ static void DaoxDataFrame_SliceFrom( DaoxDataFrame *self, DaoxDataFrame *orig, D
 
 		cols->data.daoints[jj] = j;
 		DList_Append( self->columns, target );
+		if( source->dictionary ) DaoxDataColumn_UseDictionary( target, source->dictionary );
 		DaoxDataColumn_Reset( target, N*K );
 		for(i=0; i<N; ++i){
 			daoint ii = DaoSlice_GetIndex( slices, 0, i );
@@ -479,7 +1022,7 @@ static void DaoxDataFrame_SliceFrom( DaoxDataFrame *self, DaoxDataFrame *orig, D
 				if( datatype == 0 ){ /* DaoValue */
 					DaoValue *value = source->cells->data.values[id2];
 					GC_Assign( target->cells->data.values + id3, value );
-				}else if( datatype == DAO_STRING ){
+				}else if( datatype == DAO_STRING && target->dictionary == NULL ){
 					DString *value = & source->cells->data.strings[id2];
 					DString_Assign( target->cells->data.strings + id3, value );
 				}else{
@@ -524,236 +1067,1196 @@ daoint DaoxDataFrame_SliceSize( DaoxDataFrame *self, DaoxDataFrame *original )
 	return self->slices->data.daoints[6] * self->slices->data.daoints[9];
 }
 
-void DaoxDataFrame_Encode( DaoxDataFrame *self, DString *output )
-{
-}
-void DaoxDataFrame_Decode( DaoxDataFrame *self, DString *input )
-{
-}
+/*
+// Binary columnar format (native byte order):
+//
+// Header:
+//   magic[8], version:u32, byte order tag:u32, dims:i64[3],
+//   column count:u32, reserved:u32;
+// Labels, for each dimension:
+//   group count:u32; for each group:
+//     label count:u32; for each label: index:i64, size:u32, bytes;
+// Column descriptors:
+//   type id:u32, codec:u32, cell size:u32, reserved:u32,
+//   cell count:i64, payload offset:i64, payload size:i64;
+// Payloads:
+//   each aligned to DAOX_DF_ALIGN bytes from the start of the encoding;
+//   raw cells for numeric columns (DAOX_DF_RAW), so that they can be used
+//   in place from a memory mapped file;
+//   zigzag delta varints for compressed integer columns (DAOX_DF_DELTA);
+//   offsets:i64[count+1] followed by the bytes for string columns;
+//   for dictionary encoded string columns (DAOX_DF_DICTIONARY), the string
+//   count:i64 and the strings (as above) of the dictionary, followed by the
+//   codes:i32[count] aligned to 8 bytes, which can also be used in place.
+*/
+#define DAOX_DF_MAGIC    "\x89" "DAODF\r\n"
+#define DAOX_DF_VERSION  1
+#define DAOX_DF_BYTEORD  0x01020304
+#define DAOX_DF_ALIGN    16
 
+enum DaoxDataCodecs
+{
+	DAOX_DF_RAW ,
+	DAOX_DF_DELTA ,
+	DAOX_DF_STRINGS ,
+	DAOX_DF_DICTIONARY
+};
 
+typedef struct DaoxDataReader DaoxDataReader;
 
+struct DaoxDataReader
+{
+	const uchar_t  *data;
+	daoint          size;
+	daoint          offset;
+	int             error;
+};
 
-static int SliceRange( DArray *slices, daoint N, daoint first, daoint end )
+static void DaoxDF_WriteUInt32( DString *output, uint32_t value )
 {
-	daoint *start = DArray_PushDaoInt( slices, 0 );
-	daoint *count = DArray_PushDaoInt( slices, 0 );
-	if( first < 0 ) first += N;
-	if( end < 0 ) end += N;
-	if( first < 0 || first >= N || end < 0 || end > N ) return 0;
-	*start = first;
-	if( first < end ) *count = end - first;
-	return 1;
+	DString_AppendBytes( output, (char*) & value, sizeof(uint32_t) );
 }
-static int SliceRange2( DArray *slices, daoint N, daoint first, daoint count )
+static void DaoxDF_WriteInt64( DString *output, int64_t value )
 {
-	daoint *start = DArray_PushDaoInt( slices, 0 );
-	daoint *count2 = DArray_PushDaoInt( slices, 0 );
-	if( first < 0 ) first += N;
-	if( first < 0 || first >= N ) return 0;
-	*start = first;
-	if( first + count > N ) return 0;
-	*count2 = count;
-	return 1;
+	DString_AppendBytes( output, (char*) & value, sizeof(int64_t) );
 }
-static void MakeSlice( DaoProcess *proc, DaoValue *pid, daoint N, DArray *slice )
+static void DaoxDF_PatchInt64( DString *output, daoint offset, int64_t value )
 {
-	daoint j, id, from, to, rc = 0;
-	if( pid == NULL || pid->type == 0 ){
-		SliceRange2( slice, N, 0, N );
-		return;
+	memcpy( output->chars + offset, & value, sizeof(int64_t) );
+}
+static void DaoxDF_WritePadding( DString *output, daoint size )
+{
+	while( size % DAOX_DF_ALIGN ){
+		DString_AppendChar( output, 0 );
+		size += 1;
 	}
-	switch( pid->xBase.subtype ){
-	case DAO_INTEGER :
-	case DAO_FLOAT :
-		{
-			id = DaoValue_GetInteger( pid );
-			rc = SliceRange2( slice, N, id, 1 );
-			break;
-		}
-	case DAO_STRING :
-		{
-			break;
-		}
-	case DAO_RANGE :
-		{
-			DaoValue **data = pid->xTuple.values;
-			if( data[0]->type == DAO_INTEGER && data[1]->type == DAO_INTEGER ){
-				from = data[0]->xInteger.value;
-				to   = data[1]->xInteger.value;
-				rc = SliceRange( slice, N, from, to );
-			}else if( data[0]->type == DAO_NONE && data[1]->type == DAO_NONE ){
-				rc = SliceRange2( slice, N, 0, N );
-			}else if( data[0]->type <= DAO_FLOAT && data[1]->type == DAO_NONE ){
-				from = DaoValue_GetInteger( data[0] );
-				rc = SliceRange( slice, N, from, N );
-			}else if( data[0]->type == DAO_NONE && data[1]->type <= DAO_FLOAT ){
-				to = DaoValue_GetInteger( data[1] );
-				rc = SliceRange( slice, N, 0, to );
-			}else if( data[0]->type == DAO_STRING && data[1]->type == DAO_STRING ){
-			}else if( data[0]->type == DAO_STRING && data[1]->type == DAO_NONE ){
-			}else if( data[0]->type == DAO_NONE && data[1]->type == DAO_STRING ){
-			}else{
-				DaoProcess_RaiseError( proc, "Index", "need number" );
-			}
-			break;
-		}
-	default: break;
-	}
-	if( slice->size < 2 ) SliceRange2( slice, N, 0, N );
-	if( rc == 0 ) DaoProcess_RaiseError( proc, "Index::Range", "" );
 }
-static void DaoxDataFrame_MakeFullSlice( DaoxDataFrame *self, DArray *slices )
+static const uchar_t* DaoxDataReader_Read( DaoxDataReader *self, daoint size )
 {
-	daoint i, D = 3;
-
-	DArray_Reserve( slices, 10 );
-	DArray_Reset( slices, 0 );
-	for(i=0; i<D; ++i){
-		DArray_PushDaoInt( slices, 0 );
-		DArray_PushDaoInt( slices, self->dims[i] );
+	const uchar_t *data = self->data + self->offset;
+	if( self->error || size < 0 || self->offset + size > self->size ){
+		self->error = 1;
+		return NULL;
 	}
+	self->offset += size;
+	return data;
 }
-static void DaoArray_MakeFullSlice( DaoArray *self, DArray *slices )
+static uint32_t DaoxDataReader_ReadUInt32( DaoxDataReader *self )
 {
-	daoint i, D = self->ndim;
+	uint32_t value = 0;
+	const uchar_t *data = DaoxDataReader_Read( self, sizeof(uint32_t) );
+	if( data ) memcpy( & value, data, sizeof(uint32_t) );
+	return value;
+}
+static int64_t DaoxDataReader_ReadInt64( DaoxDataReader *self )
+{
+	int64_t value = 0;
+	const uchar_t *data = DaoxDataReader_Read( self, sizeof(int64_t) );
+	if( data ) memcpy( & value, data, sizeof(int64_t) );
+	return value;
+}
 
-	DArray_Reserve( slices, 2*self->ndim + 4 );
-	DArray_Reset( slices, 0 );
-	for(i=0; i<D; ++i){
-		DArray_PushDaoInt( slices, 0 );
-		DArray_PushDaoInt( slices, self->dims[i] );
+/*
+// Encode integers as zigzag varints of the differences between adjacent cells.
+// With output == NULL, only the size of the encoding is computed.
+*/
+static daoint DaoxDF_EncodeDeltas( daoint *cells, daoint count, DString *output )
+{
+	uchar_t bytes[16];
+	uint64_t previous = 0;
+	daoint i, size = 0;
+	for(i=0; i<count; ++i){
+		int64_t delta = (int64_t)((uint64_t) cells[i] - previous);
+		uint64_t zigzag = ((uint64_t) delta << 1) ^ (uint64_t)(delta >> 63);
+		int n = 0;
+		previous = (uint64_t) cells[i];
+		while( zigzag >= 0x80 ){
+			bytes[n++] = (uchar_t)(zigzag | 0x80);
+			zigzag >>= 7;
+		}
+		bytes[n++] = (uchar_t) zigzag;
+		if( output ) DString_AppendBytes( output, (char*) bytes, n );
+		size += n;
 	}
-	if( D == 2 ){
-		DArray_PushDaoInt( slices, 0 );
-		DArray_PushDaoInt( slices, 1 );
+	return size;
+}
+static int DaoxDF_DecodeDeltas( daoint *cells, daoint count, const uchar_t *data, daoint size )
+{
+	const uchar_t *end = data + size;
+	uint64_t previous = 0;
+	daoint i;
+	for(i=0; i<count; ++i){
+		uint64_t zigzag = 0;
+		int shift = 0;
+		while( data < end && (*data & 0x80) && shift < 63 ){
+			zigzag |= (uint64_t)(*data & 0x7f) << shift;
+			shift += 7;
+			data += 1;
+		}
+		if( data >= end ) return 0;
+		zigzag |= (uint64_t)(*data++) << shift;
+		previous += (uint64_t)((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+		cells[i] = (daoint) previous;
 	}
+	return data == end;
 }
-static int DaoxDataFrame_MakeSlice( DaoxDataFrame *self, DaoProcess *proc, DaoValue *idx[], int N, DArray *slices )
+
+static int DaoxDataColumn_GetCodec( DaoxDataColumn *self, int compress, daoint *size )
 {
-	daoint *dims = self->dims;
-	daoint i, D = 3, S = 1;
+	DArray *cells = self->cells;
+	daoint i;
 
-	DaoxDataFrame_MakeFullSlice( self, slices );
-	if( N > D ){
-		DaoProcess_RaiseWarning( proc, NULL, "too many indices" );
-		N = D;
-	}
-	DArray_Reset( slices, 0 );
-	for(i=0; i<N; ++i) MakeSlice( proc, idx[i], dims[i], slices );
-	for(i=N; i<D; ++i){
-		DArray_PushDaoInt( slices, 0 );
-		DArray_PushDaoInt( slices, self->dims[i] );
+	*size = cells->size * cells->stride;
+	switch( DaoType_GetDataType( self->vatype ) ){
+	case DAO_INTEGER :
+		if( compress ){
+			daoint size2 = DaoxDF_EncodeDeltas( cells->data.daoints, cells->size, NULL );
+			if( size2 < *size ){
+				*size = size2;
+				return DAOX_DF_DELTA;
+			}
+		}
+		return DAOX_DF_RAW;
+	case DAO_FLOAT :
+	case DAO_COMPLEX :
+		return DAOX_DF_RAW;
+	case DAO_STRING :
+		if( self->dictionary ){
+			DList *strings = self->dictionary->strings;
+			*size = (strings->size + 2) * sizeof(int64_t);
+			for(i=0; i<strings->size; ++i) *size += strings->items.pString[i]->size;
+			*size += (8 - *size % 8) % 8;
+			*size += cells->size * sizeof(int);
+			return DAOX_DF_DICTIONARY;
+		}
+		*size = (cells->size + 1) * sizeof(int64_t);
+		for(i=0; i<cells->size; ++i) *size += cells->data.strings[i].size;
+		return DAOX_DF_STRINGS;
 	}
-	for(i=0; i<D; ++i) S *= DaoSlice_GetSize( slices, i );
-	return S;
+	return -1;
 }
 
-static int DaoxDF_AlignShape1( daoint dims1[], daoint ndim1, daoint dims2[], daoint ndim2 )
+/*
+// Append raw cells to "output", or write them directly to "fout" (after
+// flushing "output" from "start") if it is not NULL:
+*/
+static int DaoxDF_WriteCells( DString *output, daoint start, FILE *fout, daoint *written, void *cells, daoint size )
 {
-	daoint i;
-	if( ndim1 != ndim2 ) return 0;
-	for(i=0; i<ndim1; ++i) if( dims1[i] != dims2[i] ) return 0;
+	if( fout == NULL ){
+		DString_AppendBytes( output, (char*) cells, size );
+		return 1;
+	}
+	DaoFile_WriteString( fout, output );
+	*written += output->size - start;
+	DString_Reset( output, start );
+	if( fwrite( cells, 1, size, fout ) != (size_t) size ) return 0;
+	*written += size;
 	return 1;
 }
-static int DaoxDF_AlignShape2( DArray *slices, daoint dims[], daoint ndim )
+
+/*
+// Encode the dataframe into "output", or write it to "fout" if it is not NULL.
+// When writing to a file, the raw cells are written without copying them.
+*/
+static int DaoxDataFrame_EncodeTo( DaoxDataFrame *self, DString *output, FILE *fout, int compress )
 {
-	daoint i, j;
-	if( slices->size < 2*ndim ) return 0;
-	for(i=0; i<ndim; ++i){
-		if( dims[i] != DaoSlice_GetSize( slices, i ) ) return 0;
+	DArray *offsets = DArray_New( sizeof(daoint) );
+	DArray *sizes = DArray_New( sizeof(daoint) );
+	DArray *codecs = DArray_New( sizeof(int) );
+	daoint d, g, i, j, start = output->size;
+	daoint offset, written;
+
+	DaoxDataFrame_Sliced( self );
+	for(j=0; j<self->columns->size; ++j){
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[j];
+		daoint size = 0;
+		int codec = DaoxDataColumn_GetCodec( column, compress, & size );
+		if( codec < 0 ) goto Failed;  /* Columns of arbitrary values are not supported; */
+		DArray_PushInt( codecs, codec );
+		DArray_PushDaoInt( sizes, size );
+	}
+
+	DString_AppendBytes( output, DAOX_DF_MAGIC, 8 );
+	DaoxDF_WriteUInt32( output, DAOX_DF_VERSION );
+	DaoxDF_WriteUInt32( output, DAOX_DF_BYTEORD );
+	for(d=0; d<3; ++d) DaoxDF_WriteInt64( output, self->dims[d] );
+	DaoxDF_WriteUInt32( output, self->columns->size );
+	DaoxDF_WriteUInt32( output, 0 );
+
+	for(d=0; d<3; ++d){
+		DList *labels = self->labels[d];
+		DaoxDF_WriteUInt32( output, labels->size );
+		for(g=0; g<labels->size; ++g){
+			DMap *labmap = labels->items.pMap[g];
+			DNode *it;
+			DaoxDF_WriteUInt32( output, labmap->size );
+			for(it=DMap_First(labmap); it; it=DMap_Next(labmap,it)){
+				DaoxDF_WriteInt64( output, it->value.pInt );
+				DaoxDF_WriteUInt32( output, it->key.pString->size );
+				DString_AppendBytes( output, it->key.pString->chars, it->key.pString->size );
+			}
+		}
+	}
+
+	for(j=0; j<self->columns->size; ++j){
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[j];
+		DaoxDF_WriteUInt32( output, column->vatype->tid );
+		DaoxDF_WriteUInt32( output, codecs->data.ints[j] );
+		DaoxDF_WriteUInt32( output, column->cells->stride );
+		DaoxDF_WriteUInt32( output, 0 );
+		DaoxDF_WriteInt64( output, column->cells->size );
+		DArray_PushDaoInt( offsets, output->size );
+		DaoxDF_WriteInt64( output, 0 );
+		DaoxDF_WriteInt64( output, sizes->data.daoints[j] );
+	}
+
+	offset = output->size - start;
+	for(j=0; j<self->columns->size; ++j){
+		offset += (DAOX_DF_ALIGN - offset % DAOX_DF_ALIGN) % DAOX_DF_ALIGN;
+		DaoxDF_PatchInt64( output, offsets->data.daoints[j], offset );
+		offset += sizes->data.daoints[j];
 	}
+
+	written = 0;
+	for(j=0; j<self->columns->size; ++j){
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[j];
+		DArray *cells = column->cells;
+		DList *strings;
+		daoint size = sizes->data.daoints[j];
+
+		DaoxDF_WritePadding( output, written + output->size - start );
+		switch( codecs->data.ints[j] ){
+		case DAOX_DF_RAW :
+			if( DaoxDF_WriteCells( output, start, fout, & written, cells->data.base, size ) == 0 ) goto Failed;
+			break;
+		case DAOX_DF_DELTA :
+			DaoxDF_EncodeDeltas( cells->data.daoints, cells->size, output );
+			break;
+		case DAOX_DF_STRINGS :
+			offset = 0;
+			for(i=0; i<cells->size; ++i){
+				DaoxDF_WriteInt64( output, offset );
+				offset += cells->data.strings[i].size;
+			}
+			DaoxDF_WriteInt64( output, offset );
+			for(i=0; i<cells->size; ++i){
+				DString *cell = cells->data.strings + i;
+				DString_AppendBytes( output, cell->chars, cell->size );
+			}
+			break;
+		case DAOX_DF_DICTIONARY :
+			strings = column->dictionary->strings;
+			DaoxDF_WriteInt64( output, strings->size );
+			offset = 0;
+			for(i=0; i<strings->size; ++i){
+				DaoxDF_WriteInt64( output, offset );
+				offset += strings->items.pString[i]->size;
+			}
+			DaoxDF_WriteInt64( output, offset );
+			for(i=0; i<strings->size; ++i){
+				DString *string = strings->items.pString[i];
+				DString_AppendBytes( output, string->chars, string->size );
+			}
+			while( (written + output->size - start) % 8 ) DString_AppendChar( output, '\0' );
+			size = cells->size * sizeof(int);
+			if( DaoxDF_WriteCells( output, start, fout, & written, cells->data.base, size ) == 0 ) goto Failed;
+			break;
+		}
+		if( fout != NULL ){
+			DaoFile_WriteString( fout, output );
+			written += output->size - start;
+			DString_Reset( output, start );
+		}
+	}
+	DArray_Delete( offsets );
+	DArray_Delete( sizes );
+	DArray_Delete( codecs );
 	return 1;
+Failed:
+	DString_Reset( output, start );
+	DArray_Delete( offsets );
+	DArray_Delete( sizes );
+	DArray_Delete( codecs );
+	return 0;
 }
-static int DaoxDF_AlignShape3( DArray *slices1, DArray *slices2, int ndim )
+
+/* Decode the dictionary and the codes of a dictionary encoded string column: */
+static int DaoxDataColumn_DecodeDictionary( DaoxDataColumn *self, const uchar_t *payload, daoint bytes, daoint count, DaoxDataMapping *mapping )
 {
-	daoint i, j;
-	if( slices1->size < 2*ndim ) return 0;
-	if( slices2->size < 2*ndim ) return 0;
-	for(i=0; i<ndim; ++i){
-		if( DaoSlice_GetSize( slices1, i ) != DaoSlice_GetSize( slices2, i ) ) return 0;
+	DaoxDataDictionary *dictionary;
+	const uchar_t *chars;
+	const int *codes;
+	int64_t n, head, offsets[2];
+	DString string;
+	daoint i;
+	int valid;
+
+	if( bytes < sizeof(int64_t) ) return 0;
+	memcpy( & n, payload, sizeof(int64_t) );
+	if( n < 1 || n > bytes / (daoint) sizeof(int64_t) ) return 0;
+	head = (n + 2) * sizeof(int64_t);
+	if( head > bytes ) return 0;
+	memcpy( offsets, payload + (n + 1) * sizeof(int64_t), sizeof(int64_t) );
+	head += offsets[0];
+	head += (8 - head % 8) % 8;
+	if( offsets[0] < 0 || head + count * (daoint) sizeof(int) != bytes ) return 0;
+
+	dictionary = DaoxDataDictionary_New();
+	chars = payload + (n + 2) * sizeof(int64_t);
+	for(i=0; i<n; ++i){
+		memcpy( offsets, payload + (i + 1) * sizeof(int64_t), 2*sizeof(int64_t) );
+		if( offsets[0] < 0 || offsets[1] < offsets[0] ) break;
+		if( (chars - payload) + offsets[1] > bytes ) break;
+		string = DString_WrapBytes( (char*) chars + offsets[0], offsets[1] - offsets[0] );
+		/* The codes are valid only for a dictionary of distinct strings: */
+		if( DaoxDataDictionary_Add( dictionary, & string ) != i ) break;
+	}
+	codes = (const int*)(payload + head);
+	valid = i == n;
+	for(i=0; i<count && valid; ++i) valid = codes[i] >= 0 && codes[i] < n;
+	if( ! valid ){
+		DaoxDataDictionary_Release( dictionary );
+		return 0;
+	}
+	DaoxDataColumn_UseDictionary( self, dictionary );
+	DaoxDataDictionary_Release( dictionary );
+	if( mapping != NULL ){
+		DArray_Clear( self->cells );
+		DaoxDataMapping_Acquire( mapping );
+		self->mapping = mapping;
+		self->cells->data.base = (void*) codes;
+		self->cells->size = self->cells->capacity = count;
+	}else{
+		DaoxDataColumn_Reset( self, count );
+		memcpy( self->cells->data.ints, codes, count * sizeof(int) );
 	}
 	return 1;
 }
-static int DaoxDataFrame_AlignArray( DaoxDataFrame *self, DaoArray *array )
+
+/*
+// Decode the dataframe from "data". If "mapping" is not NULL, "data" is
+// the memory mapped file, and the uncompressed numeric columns will use
+// the mapped cells in place.
+*/
+static int DaoxDataFrame_DecodeFrom( DaoxDataFrame *self, const uchar_t *data, daoint size, DaoxDataMapping *mapping )
 {
-	daoint dims1[4] = {0,0,1,0};
-	daoint dims2[4] = {0,0,1,0};
-	daoint ndim2 = 3;
-	if( self->original && self->slices ){
-		dims1[0] = DaoSlice_GetSize( self->slices, 0 );
-		dims1[1] = DaoSlice_GetSize( self->slices, 1 );
-		dims1[2] = DaoSlice_GetSize( self->slices, 2 );
-	}else{
-		dims1[0] = self->dims[0];
-		dims1[1] = self->dims[1];
-		dims1[2] = self->dims[2];
+	DaoVmSpace *vmspace = DaoType_GetVmSpace( self->ctype );
+	DaoxDataReader reader = { NULL, 0, 0, 0 };
+	DString *label = DString_New();
+	daoint d, g, i, j, k, M;
+
+	reader.data = data;
+	reader.size = size;
+	DaoxDataFrame_Reset( self );
+
+	if( size < 8 || memcmp( data, DAOX_DF_MAGIC, 8 ) != 0 ) goto Failed;
+	DaoxDataReader_Read( & reader, 8 );
+	if( DaoxDataReader_ReadUInt32( & reader ) != DAOX_DF_VERSION ) goto Failed;
+	if( DaoxDataReader_ReadUInt32( & reader ) != DAOX_DF_BYTEORD ) goto Failed;
+	for(d=0; d<3; ++d) self->dims[d] = DaoxDataReader_ReadInt64( & reader );
+	M = DaoxDataReader_ReadUInt32( & reader );
+	DaoxDataReader_ReadUInt32( & reader );
+	if( reader.error || M != self->dims[1] ) goto Failed;
+	if( self->dims[0] < 0 || self->dims[2] < 0 ) goto Failed;
+
+	for(d=0; d<3; ++d){
+		daoint groups = DaoxDataReader_ReadUInt32( & reader );
+		for(g=0; g<groups && reader.error == 0; ++g){
+			daoint count = DaoxDataReader_ReadUInt32( & reader );
+			DaoxDataFrame_AddLabelGroup( self, d );
+			for(k=0; k<count && reader.error == 0; ++k){
+				daoint index = DaoxDataReader_ReadInt64( & reader );
+				daoint length = DaoxDataReader_ReadUInt32( & reader );
+				const uchar_t *chars = DaoxDataReader_Read( & reader, length );
+				if( chars == NULL ) break;
+				DString_Reset( label, 0 );
+				DString_AppendBytes( label, (char*) chars, length );
+				DaoxDataFrame_AddLabel( self, d, label->chars, index );
+			}
+		}
 	}
-	if( array->original && array->slices ){
-		dims2[0] = DaoSlice_GetSize( array->slices, 0 );
-		dims2[1] = DaoSlice_GetSize( array->slices, 1 );
-		if( array->original->ndim == 3 ){
-			dims2[2] = DaoSlice_GetSize( array->slices, 2 );
-		}else if( array->original->ndim != 2 ){
-			ndim2 = array->original->ndim;
+	if( reader.error ) goto Failed;
+
+	for(j=0; j<M; ++j){
+		DaoxDataColumn *column;
+		DaoType *type;
+		const uchar_t *payload;
+		int tid = DaoxDataReader_ReadUInt32( & reader );
+		int codec = DaoxDataReader_ReadUInt32( & reader );
+		int stride = DaoxDataReader_ReadUInt32( & reader );
+		daoint count, offset, bytes;
+
+		DaoxDataReader_ReadUInt32( & reader );
+		count = DaoxDataReader_ReadInt64( & reader );
+		offset = DaoxDataReader_ReadInt64( & reader );
+		bytes = DaoxDataReader_ReadInt64( & reader );
+		if( reader.error ) goto Failed;
+		if( tid < DAO_INTEGER || tid > DAO_STRING ) goto Failed;
+		if( count != self->dims[0] * self->dims[2] ) goto Failed;
+		if( offset < 0 || bytes < 0 || offset + bytes > size ) goto Failed;
+
+		type = DaoVmSpace_GetCommonType( vmspace, tid, 0 );
+		if( codec == DAOX_DF_DICTIONARY ){
+			if( stride != sizeof(int) ) goto Failed;
+		}else if( stride != DaoType_GetDataSize( type ) ){
+			goto Failed;
 		}
-	}else{
-		dims2[0] = array->dims[0];
-		dims2[1] = array->dims[1];
-		if( array->ndim == 3 ){
-			dims2[2] = array->dims[2];
-		}else if( array->ndim != 2 ){
-			ndim2 = array->ndim;
+
+		payload = data + offset;
+		column = DaoxDataFrame_MakeColumn( self, type );
+		DList_Append( self->columns, column );
+
+		switch( codec ){
+		case DAOX_DF_RAW :
+			if( tid == DAO_STRING || bytes != count * stride ) goto Failed;
+			if( mapping != NULL ){
+				DaoxDataColumn_Reset( column, 0 );
+				DArray_Clear( column->cells );
+				DaoxDataMapping_Acquire( mapping );
+				column->mapping = mapping;
+				column->cells->data.base = (void*) payload;
+				column->cells->size = column->cells->capacity = count;
+			}else{
+				DaoxDataColumn_Reset( column, count );
+				memcpy( column->cells->data.base, payload, bytes );
+			}
+			break;
+		case DAOX_DF_DELTA :
+			if( tid != DAO_INTEGER ) goto Failed;
+			DaoxDataColumn_Reset( column, count );
+			if( DaoxDF_DecodeDeltas( column->cells->data.daoints, count, payload, bytes ) == 0 ) goto Failed;
+			break;
+		case DAOX_DF_STRINGS :
+			if( tid != DAO_STRING || bytes < (count + 1) * sizeof(int64_t) ) goto Failed;
+			DaoxDataColumn_Reset( column, count );
+			for(i=0; i<count; ++i){
+				int64_t offsets[2];
+				const uchar_t *chars = payload + (count + 1) * sizeof(int64_t);
+				memcpy( offsets, payload + i * sizeof(int64_t), 2*sizeof(int64_t) );
+				if( offsets[0] < 0 || offsets[1] < offsets[0] ) goto Failed;
+				if( (chars - payload) + offsets[1] > bytes ) goto Failed;
+				DString_Reset( column->cells->data.strings + i, 0 );
+				DString_AppendBytes( column->cells->data.strings + i, (char*) chars + offsets[0], offsets[1] - offsets[0] );
+			}
+			DaoxDataColumn_EncodeStrings( column, count / DAOX_DF_DICT_RATIO );
+			break;
+		case DAOX_DF_DICTIONARY :
+			if( tid != DAO_STRING ) goto Failed;
+			if( DaoxDataColumn_DecodeDictionary( column, payload, bytes, count, mapping ) == 0 ) goto Failed;
+			break;
+		default :
+			goto Failed;
 		}
 	}
-	return DaoxDF_AlignShape1( dims1, 3, dims2, ndim2 );
+	DString_Delete( label );
+	return 1;
+Failed:
+	DaoxDataFrame_Reset( self );
+	DString_Delete( label );
+	return 0;
 }
-static int DaoxDataFrame_AlignFrame( DaoxDataFrame *self, DaoxDataFrame *df )
+
+int DaoxDataFrame_Encode( DaoxDataFrame *self, DString *output, int compress )
 {
-	if( self->original && self->slices && df->original && df->slices ){
-		return DaoxDF_AlignShape3( self->slices, df->slices, 3 );
-	}else if( self->original && self->slices ){
-		return DaoxDF_AlignShape2( self->slices, df->dims, 3 );
-	}else if( df->original && df->slices ){
-		return DaoxDF_AlignShape2( df->slices, self->dims, 3 );
-	}else{
-		return DaoxDF_AlignShape1( self->dims, 3, df->dims, 3 );
+	return DaoxDataFrame_EncodeTo( self, output, NULL, compress );
+}
+int DaoxDataFrame_Decode( DaoxDataFrame *self, DString *input )
+{
+	return DaoxDataFrame_DecodeFrom( self, (uchar_t*) input->chars, input->size, NULL );
+}
+int DaoxDataFrame_Save( DaoxDataFrame *self, const char *file, int compress )
+{
+	DString *buffer = DString_New();
+	FILE *fout = fopen( file, "wb" );
+	int ret = 0;
+	if( fout != NULL ){
+		ret = DaoxDataFrame_EncodeTo( self, buffer, fout, compress );
+		fclose( fout );
 	}
-	return 0;
+	DString_Delete( buffer );
+	return ret;
 }
+/*
+// With "mapping" set, the file is memory mapped (on Unix systems), and
+// numeric columns saved without compression are used without copying.
+*/
+int DaoxDataFrame_Load( DaoxDataFrame *self, const char *file, int mapping )
+{
+	DString *buffer;
+	FILE *fin;
+	int ret = 0;
+
+#ifdef UNIX
+	if( mapping ){
+		DaoxDataMapping *mapped;
+		struct stat info;
+		void *data;
+		int fd = open( file, O_RDONLY );
+		if( fd < 0 ) return 0;
+		if( fstat( fd, & info ) != 0 || info.st_size == 0 ){
+			close( fd );
+			return 0;
+		}
+		data = mmap( NULL, info.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0 );
+		close( fd );
+		if( data == MAP_FAILED ) return 0;
+		mapped = DaoxDataMapping_New( data, info.st_size );
+		ret = DaoxDataFrame_DecodeFrom( self, (uchar_t*) data, info.st_size, mapped );
+		DaoxDataMapping_Release( mapped );
+		return ret;
+	}
+#endif
 
-enum
+	fin = fopen( file, "rb" );
+	if( fin == NULL ) return 0;
+	buffer = DString_New();
+	DaoFile_ReadAll( fin, buffer, 1 );
+	ret = DaoxDataFrame_Decode( self, buffer );
+	DString_Delete( buffer );
+	return ret;
+}
+
+
+
+/*
+// CSV/TSV loading:
+//
+// The file is read in chunks of bounded size. Each chunk is scanned once
+// to locate the record boundaries (newlines outside of quoted fields),
+// then the records are partitioned into blocks that are parsed in parallel
+// directly into the typed cell arrays of the columns.
+//
+// Column types are inferred from the first records, unless they are given.
+// If a later record does not fit the inferred type of a column, the column
+// is promoted (int to float, int or float to string) and the chunk is
+// parsed again. The numbers of the earlier chunks cannot be turned back into
+// their source text, so a promotion to string after the first chunk reads the
+// file again from the start (at most once for each column).
+*/
+#define DAOX_CSV_CHUNK   (1<<24)
+#define DAOX_CSV_SAMPLE  100
+
+typedef struct DaoxCsvField   DaoxCsvField;
+typedef struct DaoxCsvParser  DaoxCsvParser;
+
+struct DaoxCsvField
 {
-	DAOX_DF_WRONG_SHAP = 1 ,
-	DAOX_DF_WRONG_VALUE
+	const char  *chars;
+	daoint       size;
+	int          quoted;
 };
 
-static int DaoValue_Update( DaoValue *self, DaoValue *other, int opcode )
+struct DaoxCsvParser
 {
-	double D1, D2;
-	dao_complex C1, C2;
+	DaoxDataFrame  *frame;
+
+	const char  *data;     /* chunk data; */
+	DArray      *records;  /* DArray<daoint>: start and end offsets of the records; */
+	daoint       skip;     /* number of records to skip (the header); */
+	daoint       offset;   /* row index of the first parsed record in the chunk; */
+	char         sep;
+	int         *types;    /* column types: DAO_INTEGER, DAO_FLOAT or DAO_STRING; */
+	int         *fixed;    /* types given by the user, not to be promoted; */
+	int         *promote;  /* DaoxDataTask.index * columns + column: required type; */
+};
 
-	switch( (self->type<<8)|other->type ){
-	case (DAO_INTEGER<<8)|DAO_INTEGER :
-		switch( opcode ){
-		case DVM_MOVE   : self->xInteger.value  = other->xInteger.value; break;
-		case DVM_ADD    : self->xInteger.value += other->xInteger.value; break;
-		case DVM_SUB    : self->xInteger.value -= other->xInteger.value; break;
-		case DVM_MUL    : self->xInteger.value *= other->xInteger.value; break;
-		case DVM_DIV    : self->xInteger.value /= other->xInteger.value; break;
-		case DVM_MOD    : self->xInteger.value %= other->xInteger.value; break;
-		case DVM_BITAND : self->xInteger.value &= other->xInteger.value; break;
-		case DVM_BITOR  : self->xInteger.value |= other->xInteger.value; break;
-		case DVM_BITXOR : self->xInteger.value ^= other->xInteger.value; break;
-		default : return 1;
+static const char* DaoxCsv_ParseField( const char *p, const char *end, char sep, DaoxCsvField *field )
+{
+	field->quoted = 0;
+	if( p < end && *p == '"' ){
+		field->chars = ++p;
+		field->quoted = 1;
+		while( p < end ){
+			if( *p == '"' ){
+				if( p + 1 < end && p[1] == '"' ){
+					p += 2;
+					continue;
+				}
+				break;
+			}
+			p += 1;
 		}
-		break;
-	case (DAO_FLOAT<<8)|DAO_FLOAT :
-		D1 = self->xFloat.value;
-		D2 = other->xFloat.value;
-		switch( opcode ){
-		case DVM_MOVE : self->xFloat.value  = other->xFloat.value; break;
-		case DVM_ADD  : self->xFloat.value += other->xFloat.value; break;
+		field->size = p - field->chars;
+		while( p < end && *p != sep ) p += 1;
+		return p;
+	}
+	field->chars = p;
+	while( p < end && *p != sep ) p += 1;
+	field->size = p - field->chars;
+	return p;
+}
+static void DaoxCsv_GetString( DaoxCsvField *field, DString *string )
+{
+	daoint i;
+	DString_Reset( string, 0 );
+	if( field->quoted == 0 ){
+		DString_AppendBytes( string, field->chars, field->size );
+		return;
+	}
+	for(i=0; i<field->size; ++i){
+		DString_AppendChar( string, field->chars[i] );
+		if( field->chars[i] == '"' ) i += 1; /* Escaped quote; */
+	}
+}
+static void DaoxCsv_Trim( DaoxCsvField *field )
+{
+	while( field->size && (*field->chars == ' ' || *field->chars == '\t') ){
+		field->chars += 1;
+		field->size -= 1;
+	}
+	while( field->size && (field->chars[field->size-1] == ' ' || field->chars[field->size-1] == '\t') ){
+		field->size -= 1;
+	}
+}
+static int DaoxCsv_ParseInteger( DaoxCsvField *field, daoint *value )
+{
+	const char *p = field->chars, *end = p + field->size;
+	uint64_t integer = 0;
+	int negative = 0;
+
+	if( p < end && (*p == '-' || *p == '+') ) negative = *p++ == '-';
+	if( p == end || end - p > 18 ) return 0;
+	for(; p<end; ++p){
+		if( *p < '0' || *p > '9' ) return 0;
+		integer = 10*integer + (*p - '0');
+	}
+	*value = negative ? - (daoint) integer : (daoint) integer;
+	return 1;
+}
+static int DaoxCsv_ParseFloat( DaoxCsvField *field, double *value )
+{
+	char buffer[64], *end = NULL;
+	if( field->size == 0 || field->size >= sizeof(buffer) ) return 0;
+	memcpy( buffer, field->chars, field->size );
+	buffer[field->size] = '\0';
+	*value = strtod( buffer, & end );
+	return end == buffer + field->size;
+}
+/* Return the type required to hold the field, or zero for empty field: */
+static int DaoxCsv_Classify( DaoxCsvField *field )
+{
+	DaoxCsvField field2 = *field;
+	daoint integer;
+	double number;
+
+	DaoxCsv_Trim( & field2 );
+	if( field2.size == 0 ) return 0;
+	if( DaoxCsv_ParseInteger( & field2, & integer ) ) return DAO_INTEGER;
+	if( DaoxCsv_ParseFloat( & field2, & number ) ) return DAO_FLOAT;
+	return DAO_STRING;
+}
+
+static void DaoxCsvParser_ParseRecords( DaoxDataTask *task )
+{
+	DaoxCsvParser *self = (DaoxCsvParser*) task->context;
+	DaoxDataFrame *frame = self->frame;
+	DaoxCsvField field;
+	daoint i, j, M = frame->dims[1];
+	int *promote = self->promote + task->index * M;
+	char sep = self->sep;
+
+	for(i=task->first; i<task->end; ++i){
+		daoint *record = self->records->data.daoints + 2*(self->skip + i);
+		const char *p = self->data + record[0];
+		const char *end = self->data + record[1];
+		daoint row = self->offset + i;
+		for(j=0; j<M; ++j){
+			DaoxDataColumn *column = (DaoxDataColumn*) frame->columns->items.pVoid[j];
+			DArray *cells = column->cells;
+			int type = self->types[j];
+
+			field.chars = end;
+			field.size = 0;
+			field.quoted = 0;
+			if( p <= end ){
+				p = DaoxCsv_ParseField( p, end, sep, & field );
+				p += 1; /* Skip the separator; */
+			}
+			if( type == DAO_STRING ){
+				DaoxCsv_GetString( & field, cells->data.strings + row );
+				continue;
+			}
+			DaoxCsv_Trim( & field );
+			if( type == DAO_INTEGER ){
+				cells->data.daoints[row] = 0;
+				if( field.size && DaoxCsv_ParseInteger( & field, cells->data.daoints + row ) ) continue;
+			}else{
+				cells->data.doubles[row] = NAN;
+				if( field.size == 0 || DaoxCsv_ParseFloat( & field, cells->data.doubles + row ) ) continue;
+			}
+			if( self->fixed[j] ) continue;
+			/*
+			// An empty cell in an inferred integer column promotes it to float,
+			// so that the missing value is read as NaN instead of zero;
+			// integer columns have no empty cells to lose in promotion.
+			*/
+			type = field.size ? DaoxCsv_Classify( & field ) : DAO_FLOAT;
+			if( type > promote[j] ) promote[j] = type;
+		}
+	}
+}
+
+/*
+// Change the type of the column while keeping the first "count" cells.
+// Only integer cells promoted to float are kept; string cells must be
+// parsed again from the source text.
+*/
+static void DaoxDataColumn_Promote( DaoxDataColumn *self, DaoType *type, daoint count )
+{
+	DArray *cells = DArray_New( self->cells->stride );
+	daoint i;
+
+	if( type->tid != DAO_FLOAT ) count = 0;
+	DArray_Resize( cells, count );
+	memcpy( cells->data.base, self->cells->data.base, count * cells->stride );
+	DaoxDataColumn_SetType( self, type );
+	DaoxDataColumn_Reset( self, count );
+	for(i=0; i<count; ++i) self->cells->data.doubles[i] = cells->data.daoints[i];
+	DArray_Delete( cells );
+}
+
+/*
+// Find the records in the chunk, and return the number of bytes consumed.
+// At the end of the file, the last record may not be terminated by a newline.
+// A quote opens a quoted field only at the start of the field, and a doubled
+// quote inside a quoted field is an escaped quote.
+*/
+static daoint DaoxCsv_FindRecords( const char *data, daoint size, DArray *records, char sep, int eof )
+{
+	daoint i, start = 0;
+	int quoted = 0;
+
+	DArray_Reset( records, 0 );
+	for(i=0; i<size; ++i){
+		daoint end = i;
+		if( quoted ){
+			if( data[i] != '"' ) continue;
+			if( i + 1 < size && data[i+1] == '"' ){
+				i += 1;
+			}else{
+				quoted = 0;
+			}
+			continue;
+		}
+		if( data[i] == '"' && (i == start || data[i-1] == sep) ){
+			quoted = 1;
+			continue;
+		}
+		if( data[i] != '\n' ) continue;
+		if( end > start && data[end-1] == '\r' ) end -= 1;
+		if( end > start ){
+			DArray_PushDaoInt( records, start );
+			DArray_PushDaoInt( records, end );
+		}
+		start = i + 1;
+	}
+	if( eof && start < size ){
+		daoint end = size;
+		if( data[end-1] == '\r' ) end -= 1;
+		if( end > start ){
+			DArray_PushDaoInt( records, start );
+			DArray_PushDaoInt( records, end );
+		}
+		start = size;
+	}
+	return start;
+}
+
+/*
+// "types": DAO_INTEGER, DAO_FLOAT, DAO_STRING or zero (to be inferred) for each column;
+// columns beyond "ntype" are inferred.
+*/
+int DaoxDataFrame_ReadCsv( DaoxDataFrame *self, const char *file, char sep, int header, int types[], int ntype )
+{
+	DaoVmSpace *vmspace = DaoType_GetVmSpace( self->ctype );
+	DaoxCsvParser parser;
+	DaoxCsvField field;
+	DArray *records = DArray_New( sizeof(daoint) );
+	DArray *promotes = DArray_New( sizeof(int) );
+	DArray *coltypes = DArray_New( sizeof(int) );
+	DArray *fixed = DArray_New( sizeof(int) );
+	DString *buffer = DString_New();
+	DString *label = DString_New();
+	DList *labels = DList_New( DAO_DATA_STRING );
+	daoint i, j, M = -1, rows = 0;
+	FILE *fin = fopen( file, "rb" );
+	int eof = 0, skip = header, restart = 0;
+
+	if( fin == NULL ) goto Failed;
+
+	DaoxDataFrame_Reset( self );
+	memset( & parser, 0, sizeof(DaoxCsvParser) );
+	parser.frame = self;
+	parser.records = records;
+	parser.sep = sep;
+
+	while( eof == 0 ){
+		daoint old = buffer->size, count, consumed, nrecord, first = 0;
+		int ntask, retry;
+
+		DString_Reset( buffer, old + DAOX_CSV_CHUNK );
+		count = fread( buffer->chars + old, 1, DAOX_CSV_CHUNK, fin );
+		DString_Reset( buffer, old + count );
+		eof = count < DAOX_CSV_CHUNK;
+
+		consumed = DaoxCsv_FindRecords( buffer->chars, buffer->size, records, sep, eof );
+		nrecord = records->size / 2;
+		if( skip && nrecord > 0 ){
+			first = 1;
+			skip = 0;
+		}
+
+		if( M < 0 && nrecord > 0 ){
+			const char *p = buffer->chars + records->data.daoints[0];
+			const char *end = buffer->chars + records->data.daoints[1];
+			M = 0;
+			while( p <= end ){
+				p = DaoxCsv_ParseField( p, end, sep, & field ) + 1;
+				if( header ){
+					DaoxCsv_GetString( & field, label );
+					DList_Append( labels, label );
+				}
+				M += 1;
+			}
+
+			DArray_Resize( coltypes, M );
+			DArray_Resize( fixed, M );
+			for(j=0; j<M; ++j){
+				int type = j < ntype ? types[j] : 0;
+				fixed->data.ints[j] = type != 0;
+				coltypes->data.ints[j] = type;
+			}
+			/* Infer the column types from the first records: */
+			for(i=first; i<nrecord && i<first+DAOX_CSV_SAMPLE; ++i){
+				const char *p = buffer->chars + records->data.daoints[2*i];
+				const char *end = buffer->chars + records->data.daoints[2*i+1];
+				for(j=0; j<M && p<=end; ++j){
+					int type;
+					p = DaoxCsv_ParseField( p, end, sep, & field ) + 1;
+					if( fixed->data.ints[j] ) continue;
+					type = DaoxCsv_Classify( & field );
+					if( type > coltypes->data.ints[j] ) coltypes->data.ints[j] = type;
+				}
+			}
+			for(j=0; j<M; ++j){
+				int type = coltypes->data.ints[j];
+				DaoxDataColumn *column;
+				if( type == 0 ) type = DAO_STRING;
+				coltypes->data.ints[j] = type;
+				column = DaoxDataFrame_MakeColumn( self, DaoVmSpace_GetCommonType( vmspace, type, 0 ) );
+				DList_Append( self->columns, column );
+			}
+			self->dims[1] = M;
+			self->dims[2] = 1;
+			if( header ){
+				DaoxDataFrame_AddLabelGroup( self, DAOX_DF_COL );
+				for(j=0; j<M; ++j){
+					DaoxDataFrame_AddLabel( self, DAOX_DF_COL, labels->items.pString[j]->chars, j );
+				}
+			}
+		}
+		if( M < 0 ) goto NextChunk;
+
+		parser.data = buffer->chars;
+		parser.offset = rows;
+		parser.skip = first;
+		parser.types = coltypes->data.ints;
+		parser.fixed = fixed->data.ints;
+		ntask = DaoxDF_GetTaskCount( nrecord - first, 1024 );
+		DArray_Resize( promotes, ntask * M );
+		do {
+			retry = 0;
+			for(j=0; j<M; ++j){
+				DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[j];
+				DaoxDataColumn_Reset( column, rows + nrecord - first );
+			}
+			memset( promotes->data.ints, 0, ntask * M * sizeof(int) );
+			parser.promote = promotes->data.ints;
+			DaoxDF_RunTasks( DaoxCsvParser_ParseRecords, & parser, nrecord - first, ntask );
+			for(j=0; j<M; ++j){
+				DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[j];
+				int type = coltypes->data.ints[j];
+				for(i=0; i<ntask; ++i){
+					int type2 = promotes->data.ints[i*M + j];
+					if( type2 > type ) type = type2;
+				}
+				if( type == coltypes->data.ints[j] ) continue;
+				if( type == DAO_STRING && rows ) restart = 1;
+				DaoxDataColumn_Promote( column, DaoVmSpace_GetCommonType( vmspace, type, 0 ), rows );
+				coltypes->data.ints[j] = type;
+				retry = 1;
+			}
+		} while( retry && ! restart );
+		if( restart ){
+			/* Parse the file again with the promoted column types: */
+			if( fseek( fin, 0, SEEK_SET ) != 0 ){
+				fclose( fin );
+				goto Failed;
+			}
+			DString_Reset( buffer, 0 );
+			rows = 0;
+			skip = header;
+			restart = 0;
+			eof = 0;
+			continue;
+		}
+		rows += nrecord - first;
+		self->dims[0] = rows;
+
+NextChunk:
+		memmove( buffer->chars, buffer->chars + consumed, buffer->size - consumed );
+		DString_Reset( buffer, buffer->size - consumed );
+	}
+	fclose( fin );
+
+	/* Encode the low cardinality string columns with dictionaries: */
+	for(j=0; j<self->columns->size; ++j){
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[j];
+		DaoxDataColumn_EncodeStrings( column, rows / DAOX_DF_DICT_RATIO );
+	}
+
+	DArray_Delete( records );
+	DArray_Delete( promotes );
+	DArray_Delete( coltypes );
+	DArray_Delete( fixed );
+	DString_Delete( buffer );
+	DString_Delete( label );
+	DList_Delete( labels );
+	return 1;
+Failed:
+	DArray_Delete( records );
+	DArray_Delete( promotes );
+	DArray_Delete( coltypes );
+	DArray_Delete( fixed );
+	DString_Delete( buffer );
+	DString_Delete( label );
+	DList_Delete( labels );
+	return 0;
+}
+
+
+
+
+static int SliceRange( DArray *slices, daoint N, daoint first, daoint end )
+{
+	daoint *start = DArray_PushDaoInt( slices, 0 );
+	daoint *count = DArray_PushDaoInt( slices, 0 );
+	if( first < 0 ) first += N;
+	if( end < 0 ) end += N;
+	if( first < 0 || first >= N || end < 0 || end > N ) return 0;
+	*start = first;
+	if( first < end ) *count = end - first;
+	return 1;
+}
+static int SliceRange2( DArray *slices, daoint N, daoint first, daoint count )
+{
+	daoint *start = DArray_PushDaoInt( slices, 0 );
+	daoint *count2 = DArray_PushDaoInt( slices, 0 );
+	if( first < 0 ) first += N;
+	if( first < 0 || first >= N ) return 0;
+	*start = first;
+	if( first + count > N ) return 0;
+	*count2 = count;
+	return 1;
+}
+static void MakeSlice( DaoProcess *proc, DaoValue *pid, daoint N, DArray *slice )
+{
+	daoint j, id, from, to, rc = 0;
+	if( pid == NULL || pid->type == 0 ){
+		SliceRange2( slice, N, 0, N );
+		return;
+	}
+	switch( pid->xBase.subtype ){
+	case DAO_INTEGER :
+	case DAO_FLOAT :
+		{
+			id = DaoValue_GetInteger( pid );
+			rc = SliceRange2( slice, N, id, 1 );
+			break;
+		}
+	case DAO_STRING :
+		{
+			break;
+		}
+	case DAO_RANGE :
+		{
+			DaoValue **data = pid->xTuple.values;
+			if( data[0]->type == DAO_INTEGER && data[1]->type == DAO_INTEGER ){
+				from = data[0]->xInteger.value;
+				to   = data[1]->xInteger.value;
+				rc = SliceRange( slice, N, from, to );
+			}else if( data[0]->type == DAO_NONE && data[1]->type == DAO_NONE ){
+				rc = SliceRange2( slice, N, 0, N );
+			}else if( data[0]->type <= DAO_FLOAT && data[1]->type == DAO_NONE ){
+				from = DaoValue_GetInteger( data[0] );
+				rc = SliceRange( slice, N, from, N );
+			}else if( data[0]->type == DAO_NONE && data[1]->type <= DAO_FLOAT ){
+				to = DaoValue_GetInteger( data[1] );
+				rc = SliceRange( slice, N, 0, to );
+			}else if( data[0]->type == DAO_STRING && data[1]->type == DAO_STRING ){
+			}else if( data[0]->type == DAO_STRING && data[1]->type == DAO_NONE ){
+			}else if( data[0]->type == DAO_NONE && data[1]->type == DAO_STRING ){
+			}else{
+				DaoProcess_RaiseError( proc, "Index", "need number" );
+			}
+			break;
+		}
+	default: break;
+	}
+	if( slice->size < 2 ) SliceRange2( slice, N, 0, N );
+	if( rc == 0 ) DaoProcess_RaiseError( proc, "Index::Range", "" );
+}
+static void DaoxDataFrame_MakeFullSlice( DaoxDataFrame *self, DArray *slices )
+{
+	daoint i, D = 3;
+
+	DArray_Reserve( slices, 10 );
+	DArray_Reset( slices, 0 );
+	for(i=0; i<D; ++i){
+		DArray_PushDaoInt( slices, 0 );
+		DArray_PushDaoInt( slices, self->dims[i] );
+	}
+}
+static void DaoArray_MakeFullSlice( DaoArray *self, DArray *slices )
+{
+	daoint i, D = self->ndim;
+
+	DArray_Reserve( slices, 2*self->ndim + 4 );
+	DArray_Reset( slices, 0 );
+	for(i=0; i<D; ++i){
+		DArray_PushDaoInt( slices, 0 );
+		DArray_PushDaoInt( slices, self->dims[i] );
+	}
+	if( D == 2 ){
+		DArray_PushDaoInt( slices, 0 );
+		DArray_PushDaoInt( slices, 1 );
+	}
+}
+static int DaoxDataFrame_MakeSlice( DaoxDataFrame *self, DaoProcess *proc, DaoValue *idx[], int N, DArray *slices )
+{
+	daoint *dims = self->dims;
+	daoint i, D = 3, S = 1;
+
+	DaoxDataFrame_MakeFullSlice( self, slices );
+	if( N > D ){
+		DaoProcess_RaiseWarning( proc, NULL, "too many indices" );
+		N = D;
+	}
+	DArray_Reset( slices, 0 );
+	for(i=0; i<N; ++i) MakeSlice( proc, idx[i], dims[i], slices );
+	for(i=N; i<D; ++i){
+		DArray_PushDaoInt( slices, 0 );
+		DArray_PushDaoInt( slices, self->dims[i] );
+	}
+	for(i=0; i<D; ++i) S *= DaoSlice_GetSize( slices, i );
+	return S;
+}
+
+static int DaoxDF_AlignShape1( daoint dims1[], daoint ndim1, daoint dims2[], daoint ndim2 )
+{
+	daoint i;
+	if( ndim1 != ndim2 ) return 0;
+	for(i=0; i<ndim1; ++i) if( dims1[i] != dims2[i] ) return 0;
+	return 1;
+}
+static int DaoxDF_AlignShape2( DArray *slices, daoint dims[], daoint ndim )
+{
+	daoint i, j;
+	if( slices->size < 2*ndim ) return 0;
+	for(i=0; i<ndim; ++i){
+		if( dims[i] != DaoSlice_GetSize( slices, i ) ) return 0;
+	}
+	return 1;
+}
+static int DaoxDF_AlignShape3( DArray *slices1, DArray *slices2, int ndim )
+{
+	daoint i, j;
+	if( slices1->size < 2*ndim ) return 0;
+	if( slices2->size < 2*ndim ) return 0;
+	for(i=0; i<ndim; ++i){
+		if( DaoSlice_GetSize( slices1, i ) != DaoSlice_GetSize( slices2, i ) ) return 0;
+	}
+	return 1;
+}
+static int DaoxDataFrame_AlignArray( DaoxDataFrame *self, DaoArray *array )
+{
+	daoint dims1[4] = {0,0,1,0};
+	daoint dims2[4] = {0,0,1,0};
+	daoint ndim2 = 3;
+	if( self->original && self->slices ){
+		dims1[0] = DaoSlice_GetSize( self->slices, 0 );
+		dims1[1] = DaoSlice_GetSize( self->slices, 1 );
+		dims1[2] = DaoSlice_GetSize( self->slices, 2 );
+	}else{
+		dims1[0] = self->dims[0];
+		dims1[1] = self->dims[1];
+		dims1[2] = self->dims[2];
+	}
+	if( array->original && array->slices ){
+		dims2[0] = DaoSlice_GetSize( array->slices, 0 );
+		dims2[1] = DaoSlice_GetSize( array->slices, 1 );
+		if( array->original->ndim == 3 ){
+			dims2[2] = DaoSlice_GetSize( array->slices, 2 );
+		}else if( array->original->ndim != 2 ){
+			ndim2 = array->original->ndim;
+		}
+	}else{
+		dims2[0] = array->dims[0];
+		dims2[1] = array->dims[1];
+		if( array->ndim == 3 ){
+			dims2[2] = array->dims[2];
+		}else if( array->ndim != 2 ){
+			ndim2 = array->ndim;
+		}
+	}
+	return DaoxDF_AlignShape1( dims1, 3, dims2, ndim2 );
+}
+static int DaoxDataFrame_AlignFrame( DaoxDataFrame *self, DaoxDataFrame *df )
+{
+	if( self->original && self->slices && df->original && df->slices ){
+		return DaoxDF_AlignShape3( self->slices, df->slices, 3 );
+	}else if( self->original && self->slices ){
+		return DaoxDF_AlignShape2( self->slices, df->dims, 3 );
+	}else if( df->original && df->slices ){
+		return DaoxDF_AlignShape2( df->slices, self->dims, 3 );
+	}else{
+		return DaoxDF_AlignShape1( self->dims, 3, df->dims, 3 );
+	}
+	return 0;
+}
+
+enum
+{
+	DAOX_DF_WRONG_SHAP = 1 ,
+	DAOX_DF_WRONG_VALUE
+};
+
+static int DaoValue_Update( DaoValue *self, DaoValue *other, int opcode )
+{
+	double D1, D2;
+	dao_complex C1, C2;
+
+	switch( (self->type<<8)|other->type ){
+	case (DAO_INTEGER<<8)|DAO_INTEGER :
+		switch( opcode ){
+		case DVM_MOVE   : self->xInteger.value  = other->xInteger.value; break;
+		case DVM_ADD    : self->xInteger.value += other->xInteger.value; break;
+		case DVM_SUB    : self->xInteger.value -= other->xInteger.value; break;
+		case DVM_MUL    : self->xInteger.value *= other->xInteger.value; break;
+		case DVM_DIV    : self->xInteger.value /= other->xInteger.value; break;
+		case DVM_MOD    : self->xInteger.value %= other->xInteger.value; break;
+		case DVM_BITAND : self->xInteger.value &= other->xInteger.value; break;
+		case DVM_BITOR  : self->xInteger.value |= other->xInteger.value; break;
+		case DVM_BITXOR : self->xInteger.value ^= other->xInteger.value; break;
+		default : return 1;
+		}
+		break;
+	case (DAO_FLOAT<<8)|DAO_FLOAT :
+		D1 = self->xFloat.value;
+		D2 = other->xFloat.value;
+		switch( opcode ){
+		case DVM_MOVE : self->xFloat.value  = other->xFloat.value; break;
+		case DVM_ADD  : self->xFloat.value += other->xFloat.value; break;
 		case DVM_SUB  : self->xFloat.value -= other->xFloat.value; break;
 		case DVM_MUL  : self->xFloat.value *= other->xFloat.value; break;
 		case DVM_DIV  : self->xFloat.value /= other->xFloat.value; break;
@@ -761,177 +2264,1652 @@ static int DaoValue_Update( DaoValue *self, DaoValue *other, int opcode )
 		default : return 1;
 		}
 		break;
-	case (DAO_INTEGER<<8)|DAO_FLOAT :
-		D1 = self->xInteger.value;
-		D2 = DaoValue_GetFloat( other );
-		switch( opcode ){
-		case DVM_MOVE : self->xInteger.value = (daoint) D2; break;
-		case DVM_ADD  : self->xInteger.value = (daoint)(D1 + D2); break;
-		case DVM_SUB  : self->xInteger.value = (daoint)(D1 - D2); break;
-		case DVM_MUL  : self->xInteger.value = (daoint)(D1 * D2); break;
-		case DVM_DIV  : self->xInteger.value = (daoint)(D1 / D2); break;
-		case DVM_MOD  : self->xInteger.value = (daoint)(D1-D2*(daoint)(D1/D2)); break;
-		default : return 1;
+	case (DAO_INTEGER<<8)|DAO_FLOAT :
+		D1 = self->xInteger.value;
+		D2 = DaoValue_GetFloat( other );
+		switch( opcode ){
+		case DVM_MOVE : self->xInteger.value = (daoint) D2; break;
+		case DVM_ADD  : self->xInteger.value = (daoint)(D1 + D2); break;
+		case DVM_SUB  : self->xInteger.value = (daoint)(D1 - D2); break;
+		case DVM_MUL  : self->xInteger.value = (daoint)(D1 * D2); break;
+		case DVM_DIV  : self->xInteger.value = (daoint)(D1 / D2); break;
+		case DVM_MOD  : self->xInteger.value = (daoint)(D1-D2*(daoint)(D1/D2)); break;
+		default : return 1;
+		}
+		break;
+	case (DAO_FLOAT<<8)|DAO_INTEGER :
+		D1 = self->xFloat.value;
+		D2 = DaoValue_GetFloat( other );
+		switch( opcode ){
+		case DVM_MOVE : self->xFloat.value =  D2; break;
+		case DVM_ADD  : self->xFloat.value = (D1 + D2); break;
+		case DVM_SUB  : self->xFloat.value = (D1 - D2); break;
+		case DVM_MUL  : self->xFloat.value = (D1 * D2); break;
+		case DVM_DIV  : self->xFloat.value = (D1 / D2); break;
+		case DVM_MOD  : self->xFloat.value = (D1-D2*(daoint)(D1/D2)); break;
+		default : return 1;
+		}
+		break;
+	case (DAO_COMPLEX<<8)|DAO_INTEGER :
+	case (DAO_COMPLEX<<8)|DAO_FLOAT :
+		C1 = self->xComplex.value;
+		D2 = DaoValue_GetFloat( other );
+		switch( opcode ){
+		case DVM_MOVE : C1.real = D2;  C1.imag = 0.0; self->xComplex.value = C1; break;
+		case DVM_MUL  : C1.real *= D2; C1.imag *= D2; self->xComplex.value = C1; break;
+		case DVM_DIV  : C1.real /= D2; C1.imag /= D2; self->xComplex.value = C1; break;
+		case DVM_ADD  : self->xComplex.value.real += D2; break;
+		case DVM_SUB  : self->xComplex.value.real -= D2; break;
+		default : return 1;
+		}
+		break;
+	case (DAO_COMPLEX<<8)|DAO_COMPLEX :
+		C1 = self->xComplex.value;
+		C2 = other->xComplex.value;
+		switch( opcode ){
+		case DVM_MOVE : self->xComplex.value = C2; break;
+		case DVM_ADD  : COM_IP_ADD( C1, C2 ); self->xComplex.value = C1; break;
+		case DVM_SUB  : COM_IP_SUB( C1, C2 ); self->xComplex.value = C1; break;
+		case DVM_MUL  : COM_IP_MUL( C1, C2 ); self->xComplex.value = C1; break;
+		case DVM_DIV  : COM_IP_DIV( C1, C2 ); self->xComplex.value = C1; break;
+		default : return 1;
+		}
+		break;
+	}
+	return 0;
+}
+
+static int DaoxDataFrame_UpdateByArray( DaoxDataFrame *self, DaoArray *array, int opcode )
+{
+	DaoValue value = {0};
+	DaoValue value2 = {0};
+	DArray *destSlices = self->slices;
+	DArray *fromSlices = array->slices;
+	DArray *fromSlices2 = array->slices;
+	daoint i, j, k, N, M, K;
+
+	if( DaoxDataFrame_AlignArray( self, array ) == 0 ) return DAOX_DF_WRONG_SHAP;
+
+	if( self->original == NULL ){
+		DaoxDataFrame_PrepareSlices( self );
+		DaoxDataFrame_MakeFullSlice( self, self->slices );
+		destSlices = self->slices;
+	}else{
+		self = self->original;
+	}
+	if( array->original == NULL ){
+		fromSlices = DArray_New( sizeof(daoint) );
+		DaoArray_MakeFullSlice( array, fromSlices );
+	}else{
+		array = array->original;
+	}
+
+	N = DaoSlice_GetSize( destSlices, 0 );
+	M = DaoSlice_GetSize( destSlices, 1 );
+	K = DaoSlice_GetSize( destSlices, 2 );
+
+	for(j=0; j<M; ++j){
+		daoint jjdes = DaoSlice_GetIndex( destSlices, 1, j );
+		daoint jjsrc = DaoSlice_GetIndex( fromSlices, 1, j );
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[jjdes];
+		for(i=0; i<N; ++i){
+			daoint iides = DaoSlice_GetIndex( destSlices, 0, i );
+			daoint iisrc = DaoSlice_GetIndex( fromSlices, 0, i );
+			for(k=0; k<K; ++k){
+				daoint kkdes = DaoSlice_GetIndex( destSlices, 2, k );
+				daoint kksrc = DaoSlice_GetIndex( fromSlices, 2, k );
+				daoint idsrc = iisrc * M * K + jjsrc * K + kksrc;
+				daoint iddes = kkdes * N + iides;
+				DaoValue *dest = DaoxDataColumn_GetCell( column, iddes, & value2 );
+				DaoArray_GetValue( array, idsrc, & value );
+				if( DaoValue_Update( dest, & value, opcode ) ) return DAOX_DF_WRONG_VALUE;
+				DaoxDataColumn_SetCell( column, iddes, dest );
+			}
+		}
+	}
+
+	if( fromSlices != fromSlices2 ) DArray_Delete( fromSlices );
+	return 0;
+}
+/*
+// Typed kernels for updating a contiguous block of numeric cells by another.
+// The loops are kept simple so that they can be vectorized by the compiler;
+// they return zero for operations that are not supported by the cell type.
+*/
+static int DaoxDF_UpdateIntegers( daoint *A, daoint *B, daoint n, int opcode )
+{
+	daoint i;
+	switch( opcode ){
+	case DVM_MOVE   : for(i=0; i<n; ++i) A[i]  = B[i]; break;
+	case DVM_ADD    : for(i=0; i<n; ++i) A[i] += B[i]; break;
+	case DVM_SUB    : for(i=0; i<n; ++i) A[i] -= B[i]; break;
+	case DVM_MUL    : for(i=0; i<n; ++i) A[i] *= B[i]; break;
+	case DVM_DIV    : for(i=0; i<n; ++i) A[i] /= B[i]; break;
+	case DVM_MOD    : for(i=0; i<n; ++i) A[i] %= B[i]; break;
+	case DVM_BITAND : for(i=0; i<n; ++i) A[i] &= B[i]; break;
+	case DVM_BITOR  : for(i=0; i<n; ++i) A[i] |= B[i]; break;
+	case DVM_BITXOR : for(i=0; i<n; ++i) A[i] ^= B[i]; break;
+	default : return 0;
+	}
+	return 1;
+}
+static int DaoxDF_UpdateFloats( double *A, double *B, daoint n, int opcode )
+{
+	daoint i;
+	switch( opcode ){
+	case DVM_MOVE : for(i=0; i<n; ++i) A[i]  = B[i]; break;
+	case DVM_ADD  : for(i=0; i<n; ++i) A[i] += B[i]; break;
+	case DVM_SUB  : for(i=0; i<n; ++i) A[i] -= B[i]; break;
+	case DVM_MUL  : for(i=0; i<n; ++i) A[i] *= B[i]; break;
+	case DVM_DIV  : for(i=0; i<n; ++i) A[i] /= B[i]; break;
+	case DVM_MOD  : for(i=0; i<n; ++i) A[i] = A[i] - B[i]*(daoint)(A[i]/B[i]); break;
+	default : return 0;
+	}
+	return 1;
+}
+static int DaoxDF_UpdateComplexes( dao_complex *A, dao_complex *B, daoint n, int opcode )
+{
+	daoint i;
+	switch( opcode ){
+	case DVM_MOVE : for(i=0; i<n; ++i) A[i] = B[i]; break;
+	case DVM_ADD  :
+		for(i=0; i<n; ++i){
+			A[i].real += B[i].real;
+			A[i].imag += B[i].imag;
+		}
+		break;
+	case DVM_SUB  :
+		for(i=0; i<n; ++i){
+			A[i].real -= B[i].real;
+			A[i].imag -= B[i].imag;
+		}
+		break;
+	default : return 0;
+	}
+	return 1;
+}
+/*
+// Update the cells of "coldes" by "colsrc" with the typed kernels, block by block
+// for each depth. Return zero if the generic path should be used instead.
+// The rows of a slice are always contiguous, so each block is contiguous;
+// partially overlapping blocks of the same column are left to the generic
+// path to keep its element by element semantics.
+*/
+static int DaoxDataColumn_UpdateTyped( DaoxDataColumn *coldes, DaoxDataColumn *colsrc, int opcode,
+		DArray *destSlices, DArray *fromSlices, daoint destRows, daoint fromRows )
+{
+	daoint k, N = DaoSlice_GetSize( destSlices, 0 );
+	daoint K = DaoSlice_GetSize( destSlices, 2 );
+	int tid = coldes->vatype->tid;
+
+	if( colsrc->vatype->tid != tid ) return 0;
+	if( tid != DAO_INTEGER && tid != DAO_FLOAT && tid != DAO_COMPLEX ) return 0;
+	if( tid == DAO_COMPLEX && opcode != DVM_MOVE && opcode != DVM_ADD && opcode != DVM_SUB ) return 0;
+	if( tid == DAO_FLOAT && opcode >= DVM_BITAND && opcode <= DVM_BITXOR ) return 0;
+
+	if( coldes == colsrc ){
+		for(k=0; k<K; ++k){
+			daoint kkdes = DaoSlice_GetIndex( destSlices, 2, k );
+			daoint iddes = kkdes * destRows + DaoSlice_GetIndex( destSlices, 0, 0 );
+			daoint k2;
+			for(k2=0; k2<K; ++k2){
+				daoint kksrc2 = DaoSlice_GetIndex( fromSlices, 2, k2 );
+				daoint idsrc2 = kksrc2 * fromRows + DaoSlice_GetIndex( fromSlices, 0, 0 );
+				if( k2 == k && idsrc2 == iddes ) continue;
+				if( idsrc2 < iddes + N && iddes < idsrc2 + N ) return 0;
+			}
+		}
+	}
+
+	for(k=0; k<K; ++k){
+		daoint kkdes = DaoSlice_GetIndex( destSlices, 2, k );
+		daoint kksrc = DaoSlice_GetIndex( fromSlices, 2, k );
+		daoint iddes = kkdes * destRows + DaoSlice_GetIndex( destSlices, 0, 0 );
+		daoint idsrc = kksrc * fromRows + DaoSlice_GetIndex( fromSlices, 0, 0 );
+		DArray *A = coldes->cells;
+		DArray *B = colsrc->cells;
+		switch( tid ){
+		case DAO_INTEGER :
+			DaoxDF_UpdateIntegers( A->data.daoints + iddes, B->data.daoints + idsrc, N, opcode );
+			break;
+		case DAO_FLOAT :
+			DaoxDF_UpdateFloats( A->data.doubles + iddes, B->data.doubles + idsrc, N, opcode );
+			break;
+		case DAO_COMPLEX :
+			DaoxDF_UpdateComplexes( A->data.complexes + iddes, B->data.complexes + idsrc, N, opcode );
+			break;
+		}
+	}
+	return 1;
+}
+static int DaoxDataFrame_UpdateByFrame( DaoxDataFrame *self, DaoxDataFrame *df, int opcode )
+{
+	DaoValue value = {0};
+	DaoValue value2 = {0};
+	DArray *destSlices = self->slices;
+	DArray *fromSlices = df->slices;
+	DArray *fromSlices2 = df->slices;
+	daoint i, j, k, N, M, K;
+
+	if( DaoxDataFrame_AlignFrame( self, df ) == 0 ) return DAOX_DF_WRONG_SHAP;
+
+	if( self->original == NULL ){
+		DaoxDataFrame_PrepareSlices( self );
+		DaoxDataFrame_MakeFullSlice( self, self->slices );
+		destSlices = self->slices;
+	}else{
+		self = self->original;
+	}
+	if( df->original == NULL ){
+		fromSlices = DArray_New( sizeof(daoint) );
+		DaoxDataFrame_MakeFullSlice( df, fromSlices );
+	}else{
+		df = df->original;
+	}
+
+	N = DaoSlice_GetSize( destSlices, 0 );
+	M = DaoSlice_GetSize( destSlices, 1 );
+	K = DaoSlice_GetSize( destSlices, 2 );
+
+	for(j=0; j<M; ++j){
+		daoint jjdes = DaoSlice_GetIndex( destSlices, 1, j );
+		daoint jjsrc = DaoSlice_GetIndex( fromSlices, 1, j );
+		DaoxDataColumn *coldes = (DaoxDataColumn*) self->columns->items.pVoid[jjdes];
+		DaoxDataColumn *colsrc = (DaoxDataColumn*) df->columns->items.pVoid[jjsrc];
+		if( DaoType_MatchTo( colsrc->vatype, coldes->vatype, NULL ) < DAO_MT_SUB )
+			return DAOX_DF_WRONG_VALUE;
+		if( DaoxDataColumn_UpdateTyped( coldes, colsrc, opcode, destSlices, fromSlices, self->dims[0], df->dims[0] ) ){
+			continue;
+		}
+		for(i=0; i<N; ++i){
+			daoint iides = DaoSlice_GetIndex( destSlices, 0, i );
+			daoint iisrc = DaoSlice_GetIndex( fromSlices, 0, i );
+			for(k=0; k<K; ++k){
+				daoint kkdes = DaoSlice_GetIndex( destSlices, 2, k );
+				daoint kksrc = DaoSlice_GetIndex( fromSlices, 2, k );
+				daoint idsrc = kksrc * df->dims[0] + iisrc;
+				daoint iddes = kkdes * self->dims[0] + iides;
+				DaoValue *dest = DaoxDataColumn_GetCell( coldes, iddes, & value2 );
+				DaoValue *val = DaoxDataColumn_GetCell( colsrc, idsrc, & value );
+				if( val->type == dest->type && val->type == DAO_STRING ){
+					DaoxDataColumn_SetCell( coldes, iddes, val );
+					continue;
+				}else if( DaoValue_Update( dest, val, opcode ) ){
+					return DAOX_DF_WRONG_VALUE;
+				}
+				DaoxDataColumn_SetCell( coldes, iddes, dest );
+			}
+		}
+	}
+
+	if( fromSlices != fromSlices2 ) DArray_Delete( fromSlices );
+	return 0;
+}
+
+
+
+/*
+// Group-by aggregation:
+//
+// Rows are grouped by hashing the raw cells of the key columns into an
+// open addressing table, whose groups are identified by their first rows.
+// For large frames, the rows are partitioned into blocks that are grouped
+// and aggregated in parallel into partial tables; the partial tables are
+// then merged in block order, so that the groups are ordered by their
+// first appearances, as in the sequential case.
+*/
+typedef struct DaoxAggregate   DaoxAggregate;
+typedef struct DaoxGroupTable  DaoxGroupTable;
+typedef struct DaoxGroupBy     DaoxGroupBy;
+
+struct DaoxAggregate
+{
+	daoint  count;    /* number of aggregated (non-NaN) cells; */
+	daoint  row;      /* first row, or the row of the extreme string; */
+	daoint  integer;  /* sum or extreme of integers; */
+	double  number;   /* sum or extreme of floats, or sum of integers for mean; */
+};
+
+struct DaoxGroupTable
+{
+	DArray  *slots;    /* DArray<daoint>: group index plus one, or zero for empty slot; */
+	DArray  *rows;     /* DArray<daoint>: first row of each group; */
+	DArray  *hashes;   /* DArray<uint64_t>: hash of each group; */
+	DArray  *values;   /* DArray<DaoxAggregate>: aggregates of each group; */
+};
+
+struct DaoxGroupBy
+{
+	DaoxDataColumn  **keys;
+	DaoxDataColumn  **columns;
+	int              *methods;
+	int               nkey;
+	int               nagg;
+	daoint           *rows;     /* selected rows (cell indices), or NULL for all rows; */
+	DaoxGroupTable   *tables;
+};
+
+static void DaoxGroupTable_Init( DaoxGroupTable *self )
+{
+	self->slots = DArray_New( sizeof(daoint) );
+	self->rows = DArray_New( sizeof(daoint) );
+	self->hashes = DArray_New( sizeof(uint64_t) );
+	self->values = DArray_New( sizeof(DaoxAggregate) );
+	DArray_Resize( self->slots, 64 );
+	memset( self->slots->data.base, 0, 64 * sizeof(daoint) );
+}
+static void DaoxGroupTable_Clear( DaoxGroupTable *self )
+{
+	DArray_Delete( self->slots );
+	DArray_Delete( self->rows );
+	DArray_Delete( self->hashes );
+	DArray_Delete( self->values );
+}
+static void DaoxGroupTable_Rehash( DaoxGroupTable *self )
+{
+	uint64_t *hashes = (uint64_t*) self->hashes->data.base;
+	daoint i, size = 2 * self->slots->size, mask = size - 1;
+
+	DArray_Resize( self->slots, size );
+	memset( self->slots->data.base, 0, size * sizeof(daoint) );
+	for(i=0; i<self->rows->size; ++i){
+		daoint pos = hashes[i] & mask;
+		while( self->slots->data.daoints[pos] ) pos = (pos + 1) & mask;
+		self->slots->data.daoints[pos] = i + 1;
+	}
+}
+/* Find or add the group of the row, and return the group index: */
+static daoint DaoxGroupTable_Find( DaoxGroupTable *self, DaoxGroupBy *groupby, uint64_t hash, daoint row )
+{
+	uint64_t *hashes = (uint64_t*) self->hashes->data.base;
+	daoint mask = self->slots->size - 1;
+	daoint i, group, pos = hash & mask;
+
+	while( (group = self->slots->data.daoints[pos]) != 0 ){
+		group -= 1;
+		if( hashes[group] == hash && DaoxDF_CompareRows( groupby->keys, self->rows->data.daoints[group], groupby->keys, row, groupby->nkey ) == 0 ){
+			return group;
+		}
+		pos = (pos + 1) & mask;
+	}
+	group = self->rows->size;
+	self->slots->data.daoints[pos] = group + 1;
+	DArray_PushDaoInt( self->rows, row );
+	* (uint64_t*) DArray_Push( self->hashes ) = hash;
+	for(i=0; i<groupby->nagg; ++i){
+		DaoxAggregate *aggregate = (DaoxAggregate*) DArray_Push( self->values );
+		aggregate->count = 0;
+		aggregate->row = -1;
+		aggregate->integer = 0;
+		aggregate->number = 0.0;
+	}
+	if( 2*self->rows->size > self->slots->size ) DaoxGroupTable_Rehash( self );
+	return group;
+}
+static DaoxAggregate* DaoxGroupTable_GetAggregates( DaoxGroupTable *self, DaoxGroupBy *groupby, daoint group )
+{
+	return ((DaoxAggregate*) self->values->data.base) + group * groupby->nagg;
+}
+static void DaoxGroupBy_Aggregate( DaoxGroupBy *self, DaoxAggregate *aggregates, daoint row )
+{
+	int i;
+	for(i=0; i<self->nagg; ++i){
+		DaoxDataColumn *column = self->columns[i];
+		DaoxAggregate *aggregate = aggregates + i;
+		int method = self->methods[i];
+		daoint integer;
+		double number;
+
+		if( method == DAOX_DF_FIRST ){
+			if( aggregate->row < 0 ) aggregate->row = row;
+			aggregate->count += 1;
+			continue;
+		}
+		switch( column->vatype->tid ){
+		case DAO_INTEGER :
+			integer = column->cells->data.daoints[row];
+			switch( method ){
+			case DAOX_DF_SUM :
+			case DAOX_DF_MEAN :
+				aggregate->integer += integer;
+				aggregate->number += integer;
+				break;
+			case DAOX_DF_MIN :
+				if( aggregate->count == 0 || integer < aggregate->integer ) aggregate->integer = integer;
+				break;
+			case DAOX_DF_MAX :
+				if( aggregate->count == 0 || integer > aggregate->integer ) aggregate->integer = integer;
+				break;
+			}
+			break;
+		case DAO_FLOAT :
+			number = column->cells->data.doubles[row];
+			if( number != number ) continue;  /* NaN for missing values; */
+			switch( method ){
+			case DAOX_DF_SUM :
+			case DAOX_DF_MEAN :
+				aggregate->number += number;
+				break;
+			case DAOX_DF_MIN :
+				if( aggregate->count == 0 || number < aggregate->number ) aggregate->number = number;
+				break;
+			case DAOX_DF_MAX :
+				if( aggregate->count == 0 || number > aggregate->number ) aggregate->number = number;
+				break;
+			}
+			break;
+		case DAO_STRING :
+			if( method == DAOX_DF_MIN || method == DAOX_DF_MAX ){
+				int cmp = aggregate->count == 0 ? 0 : DaoxDataColumn_CompareCells( column, row, column, aggregate->row );
+				if( aggregate->count == 0 || (method == DAOX_DF_MIN ? cmp < 0 : cmp > 0) ){
+					aggregate->row = row;
+				}
+			}
+			break;
+		}
+		aggregate->count += 1;
+	}
+}
+/* Merge the aggregates from a later block into the aggregates of an earlier block: */
+static void DaoxGroupBy_Merge( DaoxGroupBy *self, DaoxAggregate *aggregates, DaoxAggregate *others )
+{
+	int i;
+	for(i=0; i<self->nagg; ++i){
+		DaoxDataColumn *column = self->columns[i];
+		DaoxAggregate *aggregate = aggregates + i;
+		DaoxAggregate *other = others + i;
+		int method = self->methods[i];
+		int tid = column->vatype->tid;
+		int take = 0;
+
+		if( other->count == 0 ) continue;
+		switch( method ){
+		case DAOX_DF_SUM :
+		case DAOX_DF_MEAN :
+			aggregate->integer += other->integer;
+			aggregate->number += other->number;
+			break;
+		case DAOX_DF_MIN :
+		case DAOX_DF_MAX :
+			take = aggregate->count == 0;
+			if( take ) break;
+			if( tid == DAO_INTEGER ){
+				take = method == DAOX_DF_MIN ? other->integer < aggregate->integer : other->integer > aggregate->integer;
+			}else if( tid == DAO_FLOAT ){
+				take = method == DAOX_DF_MIN ? other->number < aggregate->number : other->number > aggregate->number;
+			}else{
+				int cmp = DaoxDataColumn_CompareCells( column, other->row, column, aggregate->row );
+				take = method == DAOX_DF_MIN ? cmp < 0 : cmp > 0;
+			}
+			break;
+		case DAOX_DF_FIRST :
+			take = aggregate->row < 0;
+			break;
+		}
+		if( take ){
+			aggregate->row = other->row;
+			aggregate->integer = other->integer;
+			aggregate->number = other->number;
+		}
+		aggregate->count += other->count;
+	}
+}
+static void DaoxGroupBy_Partial( DaoxDataTask *task )
+{
+	DaoxGroupBy *self = (DaoxGroupBy*) task->context;
+	DaoxGroupTable *table = self->tables + task->index;
+	daoint i;
+
+	for(i=task->first; i<task->end; ++i){
+		daoint row = self->rows ? self->rows[i] : i;
+		uint64_t hash = DaoxDF_HashRow( self->keys, self->nkey, row );
+		daoint group = DaoxGroupTable_Find( table, self, hash, row );
+		DaoxGroupBy_Aggregate( self, DaoxGroupTable_GetAggregates( table, self, group ), row );
+	}
+}
+static DaoType* DaoxGroupBy_GetResultType( DaoxDataColumn *column, int method, DaoVmSpace *vmspace )
+{
+	int tid = column->vatype->tid;
+	switch( method ){
+	case DAOX_DF_SUM :
+		if( tid == DAO_INTEGER || tid == DAO_FLOAT ) return column->vatype;
+		break;
+	case DAOX_DF_MEAN :
+		if( tid == DAO_INTEGER || tid == DAO_FLOAT ) return DaoVmSpace_GetCommonType( vmspace, DAO_FLOAT, 0 );
+		break;
+	case DAOX_DF_COUNT :
+		return DaoVmSpace_GetCommonType( vmspace, DAO_INTEGER, 0 );
+	case DAOX_DF_MIN :
+	case DAOX_DF_MAX :
+		if( tid == DAO_INTEGER || tid == DAO_FLOAT || tid == DAO_STRING ) return column->vatype;
+		break;
+	case DAOX_DF_FIRST :
+		return column->vatype;
+	}
+	return NULL;
+}
+static void DaoxDataFrame_GetColumnName( DaoxDataFrame *self, daoint column, DString *name )
+{
+	char buffer[32];
+	DString_Reset( name, 0 );
+	if( self->labels[DAOX_DF_COL]->size ){
+		DaoxDataFrame_GetLabel( self, DAOX_DF_COL, self->groups[DAOX_DF_COL], column, name );
+	}
+	if( name->size ) return;
+	sprintf( buffer, "%" DAO_INT, column );
+	DString_SetChars( name, buffer );
+}
+
+static const char* const daox_aggregate_names[] =
+{
+	"sum", "mean", "count", "min", "max", "first"
+};
+
+/*
+// Group the selected "rows" (cell indices, or all rows if NULL) of "self",
+// and aggregate them into "result" (see DaoxDataFrame_GroupBy()):
+*/
+static int DaoxDataFrame_GroupRows( DaoxDataFrame *self, DaoxDataFrame *result, daoint *rows, daoint count,
+		daoint keys[], int nkey, daoint columns[], int methods[], int nagg )
+{
+	DaoVmSpace *vmspace = DaoType_GetVmSpace( self->ctype );
+	DaoxGroupBy groupby;
+	DaoxGroupTable table;
+	DaoxDataColumn *column;
+	DString *label, *name;
+	daoint i, j, t, G, N;
+	int ntask;
+
+	if( nkey < 0 || nagg < 0 ) return 0;
+	for(i=0; i<nkey; ++i){
+		if( keys[i] < 0 || keys[i] >= self->dims[1] ) return 0;
+		column = (DaoxDataColumn*) self->columns->items.pVoid[keys[i]];
+		if( DaoType_GetDataType( column->vatype ) == 0 ) return 0;
+	}
+	for(i=0; i<nagg; ++i){
+		if( columns[i] < 0 || columns[i] >= self->dims[1] ) return 0;
+		column = (DaoxDataColumn*) self->columns->items.pVoid[columns[i]];
+		if( DaoxGroupBy_GetResultType( column, methods[i], vmspace ) == NULL ) return 0;
+	}
+
+	N = count;
+	groupby.nkey = nkey;
+	groupby.nagg = nagg;
+	groupby.rows = rows;
+	groupby.methods = methods;
+	groupby.keys = (DaoxDataColumn**) dao_malloc( (nkey + nagg + 1) * sizeof(DaoxDataColumn*) );
+	groupby.columns = groupby.keys + nkey;
+	for(i=0; i<nkey; ++i) groupby.keys[i] = (DaoxDataColumn*) self->columns->items.pVoid[keys[i]];
+	for(i=0; i<nagg; ++i) groupby.columns[i] = (DaoxDataColumn*) self->columns->items.pVoid[columns[i]];
+
+	ntask = DaoxDF_GetTaskCount( N, DAOX_DF_MIN_BLOCK );
+	groupby.tables = (DaoxGroupTable*) dao_malloc( ntask * sizeof(DaoxGroupTable) );
+	for(t=0; t<ntask; ++t) DaoxGroupTable_Init( groupby.tables + t );
+	DaoxDF_RunTasks( DaoxGroupBy_Partial, & groupby, N, ntask );
+
+	if( ntask == 1 ){
+		table = groupby.tables[0];
+	}else{
+		DaoxGroupTable_Init( & table );
+		for(t=0; t<ntask; ++t){
+			DaoxGroupTable *partial = groupby.tables + t;
+			uint64_t *hashes = (uint64_t*) partial->hashes->data.base;
+			for(i=0; i<partial->rows->size; ++i){
+				daoint row = partial->rows->data.daoints[i];
+				daoint group = DaoxGroupTable_Find( & table, & groupby, hashes[i], row );
+				DaoxAggregate *aggregates = DaoxGroupTable_GetAggregates( & table, & groupby, group );
+				DaoxAggregate *others = DaoxGroupTable_GetAggregates( partial, & groupby, i );
+				DaoxGroupBy_Merge( & groupby, aggregates, others );
+			}
+			DaoxGroupTable_Clear( partial );
+		}
+	}
+
+	G = table.rows->size;
+	DaoxDataFrame_Reset( result );
+	result->dims[0] = G;
+	result->dims[1] = nkey + nagg;
+	result->dims[2] = 1;
+	for(j=0; j<nkey; ++j){
+		DaoxDataColumn *key = groupby.keys[j];
+		column = DaoxDataFrame_MakeColumn( result, key->vatype );
+		DList_Append( result->columns, column );
+		if( key->dictionary ) DaoxDataColumn_UseDictionary( column, key->dictionary );
+		DaoxDataColumn_Reset( column, G );
+		for(i=0; i<G; ++i) DaoxDataColumn_CopyCell( column, i, key, table.rows->data.daoints[i] );
+	}
+	for(j=0; j<nagg; ++j){
+		DaoxDataColumn *source = groupby.columns[j];
+		DaoType *type = DaoxGroupBy_GetResultType( source, methods[j], vmspace );
+		int tid = source->vatype->tid;
+
+		column = DaoxDataFrame_MakeColumn( result, type );
+		DList_Append( result->columns, column );
+		if( source->dictionary && type == source->vatype ) DaoxDataColumn_UseDictionary( column, source->dictionary );
+		DaoxDataColumn_Reset( column, G );
+		for(i=0; i<G; ++i){
+			DaoxAggregate *aggregate = DaoxGroupTable_GetAggregates( & table, & groupby, i ) + j;
+			switch( methods[j] ){
+			case DAOX_DF_COUNT :
+				column->cells->data.daoints[i] = aggregate->count;
+				break;
+			case DAOX_DF_MEAN :
+				column->cells->data.doubles[i] = aggregate->count ? aggregate->number / aggregate->count : NAN;
+				break;
+			case DAOX_DF_FIRST :
+				DaoxDataColumn_CopyCell( column, i, source, aggregate->row );
+				break;
+			default :
+				if( tid == DAO_INTEGER ){
+					column->cells->data.daoints[i] = aggregate->integer;
+				}else if( tid == DAO_FLOAT ){
+					double value = aggregate->number;
+					if( aggregate->count == 0 && methods[j] != DAOX_DF_SUM ) value = NAN;
+					column->cells->data.doubles[i] = value;
+				}else if( aggregate->count ){
+					DaoxDataColumn_CopyCell( column, i, source, aggregate->row );
+				}
+				break;
+			}
+		}
+	}
+
+	label = DString_New();
+	name = DString_New();
+	DaoxDataFrame_AddLabelGroup( result, DAOX_DF_ROW );
+	for(i=0; i<G; ++i){
+		DString_Reset( label, 0 );
+		if( nkey == 1 ){
+			DaoxDataColumn_AppendCellString( groupby.keys[0], table.rows->data.daoints[i], label );
+			DaoxDataFrame_AddLabel( result, DAOX_DF_ROW, label->chars, i );
+			continue;
+		}
+		/* Join the keys with commas, escaping commas and backslashes in the keys: */
+		for(j=0; j<nkey; ++j){
+			daoint k;
+			if( j ) DString_AppendChar( label, ',' );
+			DString_Reset( name, 0 );
+			DaoxDataColumn_AppendCellString( groupby.keys[j], table.rows->data.daoints[i], name );
+			for(k=0; k<name->size; ++k){
+				if( name->chars[k] == ',' || name->chars[k] == '\\' ) DString_AppendChar( label, '\\' );
+				DString_AppendChar( label, name->chars[k] );
+			}
+		}
+		DaoxDataFrame_AddLabel( result, DAOX_DF_ROW, label->chars, i );
+	}
+	DaoxDataFrame_AddLabelGroup( result, DAOX_DF_COL );
+	for(j=0; j<nkey; ++j){
+		DaoxDataFrame_GetColumnName( self, keys[j], name );
+		DaoxDataFrame_AddLabel( result, DAOX_DF_COL, name->chars, j );
+	}
+	for(j=0; j<nagg; ++j){
+		DaoxDataFrame_GetColumnName( self, columns[j], name );
+		DString_SetChars( label, daox_aggregate_names[ methods[j] ] );
+		DString_AppendChar( label, '(' );
+		DString_Append( label, name );
+		DString_AppendChar( label, ')' );
+		DaoxDataFrame_AddLabel( result, DAOX_DF_COL, label->chars, nkey + j );
+	}
+	DString_Delete( label );
+	DString_Delete( name );
+
+	DaoxGroupTable_Clear( & table );
+	dao_free( groupby.tables );
+	dao_free( groupby.keys );
+	return 1;
+}
+
+/*
+// Group the rows of "self" by the "keys" columns, and aggregate the "columns"
+// with the "methods" (DaoxDataAggregates) into "result". The result has the
+// key columns followed by the aggregated columns, and one row per group;
+// without keys, all the rows are aggregated into a single group.
+// The row labels join the keys of the groups with commas, where commas and
+// backslashes in the keys are escaped by backslashes; float keys are written
+// with enough digits to read back exactly.
+// Return zero for invalid columns or unsupported aggregations.
+*/
+int DaoxDataFrame_GroupBy( DaoxDataFrame *self, DaoxDataFrame *result, daoint keys[], int nkey, daoint columns[], int methods[], int nagg )
+{
+	DaoxDataFrame_Sliced( self );
+	if( self->dims[2] != 1 ) return 0;
+	return DaoxDataFrame_GroupRows( self, result, NULL, self->dims[0], keys, nkey, columns, methods, nagg );
+}
+
+
+
+/*
+// Joining:
+//
+// The join produces a list of row pairs from the two frames; a negative row
+// in a pair stands for the missing side of an unmatched row. The rows are
+// ordered by the rows of the left frame, with the matched rows of the right
+// frame in their original order; for outer join, the unmatched rows of the
+// right frame are appended at the end. The output columns are then filled
+// by gathering the paired rows, with one allocation per column.
+//
+// Frames that are already sorted on the keys are joined by merging, others
+// by hashing with a table built on the smaller frame.
+*/
+typedef struct DaoxJoin  DaoxJoin;
+
+struct DaoxJoin
+{
+	DaoxDataColumn  **keys1;  /* key columns of the left frame; */
+	DaoxDataColumn  **keys2;  /* key columns of the right frame; */
+	int               nkey;
+	int               how;
+	daoint            count1;
+	daoint            count2;
+	DArray           *rows1;  /* DArray<daoint>: left rows of the row pairs; */
+	DArray           *rows2;  /* DArray<daoint>: right rows of the row pairs; */
+	DArray           *extra;  /* DArray<daoint>: unmatched right rows for outer join; */
+};
+
+static void DaoxJoin_Append( DaoxJoin *self, daoint row1, daoint row2 )
+{
+	DArray_PushDaoInt( self->rows1, row1 );
+	DArray_PushDaoInt( self->rows2, row2 );
+}
+static int DaoxJoin_IsSorted( DaoxDataColumn **keys, int nkey, daoint count )
+{
+	daoint i;
+	for(i=1; i<count; ++i){
+		if( DaoxDF_CompareRows( keys, i-1, keys, i, nkey ) > 0 ) return 0;
+	}
+	return 1;
+}
+static void DaoxJoin_Merge( DaoxJoin *self )
+{
+	daoint i = 0, j = 0, i2, j2, a, b;
+
+	while( i < self->count1 && j < self->count2 ){
+		int cmp = DaoxDF_CompareRows( self->keys1, i, self->keys2, j, self->nkey );
+		if( cmp < 0 ){
+			if( self->how != DAOX_DF_INNER ) DaoxJoin_Append( self, i, -1 );
+			i += 1;
+		}else if( cmp > 0 ){
+			if( self->how == DAOX_DF_OUTER ) DArray_PushDaoInt( self->extra, j );
+			j += 1;
+		}else{
+			i2 = i + 1;
+			j2 = j + 1;
+			while( i2 < self->count1 && DaoxDF_CompareRows( self->keys1, i, self->keys1, i2, self->nkey ) == 0 ) i2 += 1;
+			while( j2 < self->count2 && DaoxDF_CompareRows( self->keys2, j, self->keys2, j2, self->nkey ) == 0 ) j2 += 1;
+			for(a=i; a<i2; ++a){
+				for(b=j; b<j2; ++b) DaoxJoin_Append( self, a, b );
+			}
+			i = i2;
+			j = j2;
+		}
+	}
+	if( self->how != DAOX_DF_INNER ){
+		for(; i<self->count1; ++i) DaoxJoin_Append( self, i, -1 );
+	}
+	if( self->how == DAOX_DF_OUTER ){
+		for(; j<self->count2; ++j) DArray_PushDaoInt( self->extra, j );
+	}
+}
+/*
+// Build a hash table on the rows of the "keys" columns. Rows with the same
+// keys are chained in "next" in their original order, with the first rows
+// (plus one) stored in the slots of the returned table.
+*/
+static DArray* DaoxJoin_Build( DaoxDataColumn **keys, int nkey, daoint count, DArray *hashes, DArray *next )
+{
+	DArray *slots = DArray_New( sizeof(daoint) );
+	uint64_t *H;
+	daoint *N, *S;
+	daoint i, mask, size = 16;
+
+	while( size < 2*count ) size <<= 1;
+	mask = size - 1;
+	DArray_Resize( slots, size );
+	DArray_Resize( hashes, count );
+	DArray_Resize( next, count );
+	memset( slots->data.base, 0, size * sizeof(daoint) );
+	H = (uint64_t*) hashes->data.base;
+	N = next->data.daoints;
+	S = slots->data.daoints;
+
+	for(i=count-1; i>=0; --i){
+		daoint pos;
+		H[i] = DaoxDF_HashRow( keys, nkey, i );
+		pos = H[i] & mask;
+		N[i] = -1;
+		while( S[pos] ){
+			daoint row = S[pos] - 1;
+			if( H[row] == H[i] && DaoxDF_CompareRows( keys, row, keys, i, nkey ) == 0 ){
+				N[i] = row;
+				break;
+			}
+			pos = (pos + 1) & mask;
+		}
+		S[pos] = i + 1;
+	}
+	return slots;
+}
+/* Find the first row of the built table matching the probing row: */
+static daoint DaoxJoin_Probe( DaoxDataColumn **keys, DArray *slots, DArray *hashes, DaoxDataColumn **probe, daoint row, int nkey )
+{
+	uint64_t *H = (uint64_t*) hashes->data.base;
+	uint64_t hash = DaoxDF_HashRow( probe, nkey, row );
+	daoint mask = slots->size - 1;
+	daoint pos = hash & mask;
+
+	while( slots->data.daoints[pos] ){
+		daoint first = slots->data.daoints[pos] - 1;
+		if( H[first] == hash && DaoxDF_CompareRows( keys, first, probe, row, nkey ) == 0 ) return first;
+		pos = (pos + 1) & mask;
+	}
+	return -1;
+}
+static void DaoxJoin_Hash( DaoxJoin *self )
+{
+	DArray *hashes = DArray_New( sizeof(uint64_t) );
+	DArray *next = DArray_New( sizeof(daoint) );
+	DArray *slots, *rows, *offsets;
+	daoint i, j, count;
+
+	if( self->count2 <= self->count1 ){
+		/* Build on the right frame, and probe in the order of the left frame: */
+		DArray *matched = DArray_New( sizeof(uchar_t) );
+		DArray_Resize( matched, self->count2 );
+		memset( matched->data.base, 0, self->count2 );
+		slots = DaoxJoin_Build( self->keys2, self->nkey, self->count2, hashes, next );
+		for(i=0; i<self->count1; ++i){
+			j = DaoxJoin_Probe( self->keys2, slots, hashes, self->keys1, i, self->nkey );
+			if( j < 0 && self->how != DAOX_DF_INNER ) DaoxJoin_Append( self, i, -1 );
+			for(; j>=0; j=next->data.daoints[j]){
+				DaoxJoin_Append( self, i, j );
+				matched->data.uchars[j] = 1;
+			}
+		}
+		if( self->how == DAOX_DF_OUTER ){
+			for(j=0; j<self->count2; ++j){
+				if( matched->data.uchars[j] == 0 ) DArray_PushDaoInt( self->extra, j );
+			}
+		}
+		DArray_Delete( matched );
+		DArray_Delete( slots );
+		DArray_Delete( hashes );
+		DArray_Delete( next );
+		return;
+	}
+
+	/*
+	// Build on the left frame, and probe in the order of the right frame;
+	// the pairs are then placed in the order of the left frame by counting:
+	*/
+	rows = DArray_New( sizeof(daoint) );
+	offsets = DArray_New( sizeof(daoint) );
+	DArray_Resize( offsets, self->count1 + 1 );
+	memset( offsets->data.base, 0, (self->count1 + 1) * sizeof(daoint) );
+	slots = DaoxJoin_Build( self->keys1, self->nkey, self->count1, hashes, next );
+	for(j=0; j<self->count2; ++j){
+		i = DaoxJoin_Probe( self->keys1, slots, hashes, self->keys2, j, self->nkey );
+		if( i < 0 && self->how == DAOX_DF_OUTER ) DArray_PushDaoInt( self->extra, j );
+		for(; i>=0; i=next->data.daoints[i]){
+			DArray_PushDaoInt( rows, i );
+			DArray_PushDaoInt( rows, j );
+			offsets->data.daoints[i] += 1;
+		}
+	}
+	count = 0;
+	for(i=0; i<self->count1; ++i){
+		daoint matches = offsets->data.daoints[i];
+		offsets->data.daoints[i] = count;
+		count += matches ? matches : (self->how != DAOX_DF_INNER);
+	}
+	DArray_Resize( self->rows1, count );
+	DArray_Resize( self->rows2, count );
+	if( self->how != DAOX_DF_INNER ){
+		for(i=0; i<self->count1; ++i){
+			daoint offset = offsets->data.daoints[i];
+			self->rows1->data.daoints[offset] = i;
+			self->rows2->data.daoints[offset] = -1;
+		}
+	}
+	for(j=0; j<rows->size; j+=2){
+		daoint row1 = rows->data.daoints[j];
+		daoint offset = offsets->data.daoints[row1]++;
+		self->rows1->data.daoints[offset] = row1;
+		self->rows2->data.daoints[offset] = rows->data.daoints[j+1];
+	}
+	DArray_Delete( rows );
+	DArray_Delete( offsets );
+	DArray_Delete( slots );
+	DArray_Delete( hashes );
+	DArray_Delete( next );
+}
+
+/*
+// Join "self" with "other" on the key columns "keys1" of "self" and "keys2"
+// of "other", with the joining method "how" (DaoxDataJoins). The result has
+// the columns of "self", followed by the non-key columns of "other".
+// Return zero for invalid or mismatched key columns.
+*/
+int DaoxDataFrame_Join( DaoxDataFrame *self, DaoxDataFrame *other, DaoxDataFrame *result, daoint keys1[], daoint keys2[], int nkey, int how )
+{
+	DaoxJoin join;
+	DaoxDataColumn *column, *source;
+	DString *name;
+	daoint i, j, k, count, M1, M2;
+
+	DaoxDataFrame_Sliced( self );
+	DaoxDataFrame_Sliced( other );
+	if( self->dims[2] != 1 || other->dims[2] != 1 || nkey <= 0 ) return 0;
+	for(i=0; i<nkey; ++i){
+		DaoxDataColumn *key1, *key2;
+		if( keys1[i] < 0 || keys1[i] >= self->dims[1] ) return 0;
+		if( keys2[i] < 0 || keys2[i] >= other->dims[1] ) return 0;
+		key1 = (DaoxDataColumn*) self->columns->items.pVoid[keys1[i]];
+		key2 = (DaoxDataColumn*) other->columns->items.pVoid[keys2[i]];
+		if( DaoType_GetDataType( key1->vatype ) == 0 ) return 0;
+		if( key1->vatype->tid != key2->vatype->tid ) return 0;
+	}
+
+	join.nkey = nkey;
+	join.how = how;
+	join.count1 = self->dims[0];
+	join.count2 = other->dims[0];
+	join.keys1 = (DaoxDataColumn**) dao_malloc( 2 * nkey * sizeof(DaoxDataColumn*) );
+	join.keys2 = join.keys1 + nkey;
+	join.rows1 = DArray_New( sizeof(daoint) );
+	join.rows2 = DArray_New( sizeof(daoint) );
+	join.extra = DArray_New( sizeof(daoint) );
+	for(i=0; i<nkey; ++i){
+		join.keys1[i] = (DaoxDataColumn*) self->columns->items.pVoid[keys1[i]];
+		join.keys2[i] = (DaoxDataColumn*) other->columns->items.pVoid[keys2[i]];
+	}
+
+	if( DaoxJoin_IsSorted( join.keys1, nkey, join.count1 ) && DaoxJoin_IsSorted( join.keys2, nkey, join.count2 ) ){
+		DaoxJoin_Merge( & join );
+	}else{
+		DaoxJoin_Hash( & join );
+	}
+	for(i=0; i<join.extra->size; ++i) DaoxJoin_Append( & join, -1, join.extra->data.daoints[i] );
+
+	M1 = self->dims[1];
+	M2 = other->dims[1];
+	count = join.rows1->size;
+	DaoxDataFrame_Reset( result );
+	result->dims[0] = count;
+	result->dims[1] = M1 + M2 - nkey;
+	result->dims[2] = 1;
+	for(j=0; j<M1; ++j){
+		source = (DaoxDataColumn*) self->columns->items.pVoid[j];
+		column = DaoxDataFrame_MakeColumn( result, source->vatype );
+		DList_Append( result->columns, column );
+		DaoxDataColumn_Gather( column, source, join.rows1->data.daoints, count );
+		if( join.extra->size == 0 ) continue;
+		for(k=0; k<nkey; ++k){
+			if( keys1[k] != j ) continue;
+			/* The keys of the unmatched right rows are taken from the right frame: */
+			for(i=count-join.extra->size; i<count; ++i){
+				DaoxDataColumn_CopyCell( column, i, join.keys2[k], join.rows2->data.daoints[i] );
+			}
+			break;
+		}
+	}
+	for(j=0; j<M2; ++j){
+		for(k=0; k<nkey; ++k) if( keys2[k] == j ) break;
+		if( k < nkey ) continue;
+		source = (DaoxDataColumn*) other->columns->items.pVoid[j];
+		column = DaoxDataFrame_MakeColumn( result, source->vatype );
+		DList_Append( result->columns, column );
+		DaoxDataColumn_Gather( column, source, join.rows2->data.daoints, count );
+	}
+
+	name = DString_New();
+	DaoxDataFrame_AddLabelGroup( result, DAOX_DF_COL );
+	for(j=0; j<M1; ++j){
+		DaoxDataFrame_GetColumnName( self, j, name );
+		DaoxDataFrame_AddLabel( result, DAOX_DF_COL, name->chars, j );
+	}
+	for(j=0, i=M1; j<M2; ++j){
+		for(k=0; k<nkey; ++k) if( keys2[k] == j ) break;
+		if( k < nkey ) continue;
+		DaoxDataFrame_GetColumnName( other, j, name );
+		if( DaoxDataFrame_GetIndex( result, DAOX_DF_COL, name->chars ) >= 0 ){
+			DString_AppendChars( name, "_right" );
+		}
+		DaoxDataFrame_AddLabel( result, DAOX_DF_COL, name->chars, i++ );
+	}
+	DString_Delete( name );
+
+	DArray_Delete( join.rows1 );
+	DArray_Delete( join.rows2 );
+	DArray_Delete( join.extra );
+	dao_free( join.keys1 );
+	return 1;
+}
+
+
+
+/*
+// Lazy queries:
+//
+// A query records filtering, selection and aggregation steps on a dataframe
+// (or a slice of it) without executing them. When collected, the steps are
+// executed in stages separated by the aggregations. In each stage, adjacent
+// filters and selections are fused into one pass over a vector of selected
+// rows: the filters only touch the columns they test, the selections only
+// update the list of viewed columns, and no intermediate frame is created.
+// Only the columns in the final view (or those that are aggregated) are
+// gathered into the result. A query on a slice uses the slice as the initial
+// row selection and view, so the slice is never materialized.
+*/
+enum DaoxDataStepKind
+{
+	DAOX_DQ_FILTER ,
+	DAOX_DQ_SELECT ,
+	DAOX_DQ_AGGREGATE
+};
+
+typedef struct DaoxDataStep  DaoxDataStep;
+
+struct DaoxDataStep
+{
+	int      kind;
+	int      op;       /* comparison (DaoxDataComparisons) for filter; */
+	int      nkey;     /* number of key columns for aggregation; */
+	DList   *values;   /* DList<DaoValue*>: column references, and the compared value for filter; */
+	DArray  *methods;  /* DArray<int>: methods for aggregation; */
+};
+
+static DaoxDataStep* DaoxDataStep_New( int kind )
+{
+	DaoxDataStep *self = (DaoxDataStep*) dao_calloc( 1, sizeof(DaoxDataStep) );
+	self->kind = kind;
+	self->values = DList_New( DAO_DATA_VALUE );
+	self->methods = DArray_New( sizeof(int) );
+	return self;
+}
+static void DaoxDataStep_Delete( DaoxDataStep *self )
+{
+	DList_Delete( self->values );
+	DArray_Delete( self->methods );
+	dao_free( self );
+}
+
+DaoxDataQuery* DaoxDataQuery_New( DaoxDataFrame *frame )
+{
+	DaoxDataQuery *self = (DaoxDataQuery*) dao_calloc( 1, sizeof(DaoxDataQuery) );
+	DaoType *ctype = DaoVmSpace_GetType( DaoType_GetVmSpace( frame->ctype ), & daoDataQueryCore );
+	DaoCstruct_Init( (DaoCstruct*) self, ctype );
+	GC_IncRC( frame );
+	self->frame = frame;
+	self->steps = DList_New(0);
+	return self;
+}
+void DaoxDataQuery_Delete( DaoxDataQuery *self )
+{
+	daoint i;
+	for(i=0; i<self->steps->size; ++i) DaoxDataStep_Delete( (DaoxDataStep*) self->steps->items.pVoid[i] );
+	DList_Delete( self->steps );
+	GC_DecRC( self->frame );
+	DaoCstruct_Free( (DaoCstruct*) self );
+	dao_free( self );
+}
+void DaoxDataQuery_AddFilter( DaoxDataQuery *self, DaoValue *column, int op, DaoValue *value )
+{
+	DaoxDataStep *step = DaoxDataStep_New( DAOX_DQ_FILTER );
+	step->op = op;
+	DList_Append( step->values, column );
+	DList_Append( step->values, value );
+	DList_Append( self->steps, step );
+}
+void DaoxDataQuery_AddSelection( DaoxDataQuery *self, DList *columns )
+{
+	DaoxDataStep *step = DaoxDataStep_New( DAOX_DQ_SELECT );
+	daoint i;
+	for(i=0; i<columns->size; ++i) DList_Append( step->values, columns->items.pValue[i] );
+	DList_Append( self->steps, step );
+}
+/* The "columns" are aggregated by the "methods" (DaoxDataAggregates): */
+void DaoxDataQuery_AddAggregation( DaoxDataQuery *self, DList *keys, DList *columns, int methods[] )
+{
+	DaoxDataStep *step = DaoxDataStep_New( DAOX_DQ_AGGREGATE );
+	daoint i;
+	step->nkey = keys->size;
+	for(i=0; i<keys->size; ++i) DList_Append( step->values, keys->items.pValue[i] );
+	for(i=0; i<columns->size; ++i){
+		DList_Append( step->values, columns->items.pValue[i] );
+		DArray_PushInt( step->methods, methods[i] );
+	}
+	DList_Append( self->steps, step );
+}
+
+/* Resolve a column reference (index in the view, or label) to a column of the input: */
+static daoint DaoxDataQuery_Resolve( DaoxDataFrame *input, DArray *view, DaoValue *ref )
+{
+	daoint i, index = -1;
+	if( ref->type == DAO_INTEGER ){
+		index = ref->xInteger.value;
+		if( index < 0 || index >= view->size ) return -1;
+		return view->data.daoints[index];
+	}else if( ref->type == DAO_STRING ){
+		index = DaoxDataFrame_GetIndex( input, DAOX_DF_COL, ref->xString.value->chars );
+	}
+	for(i=0; i<view->size; ++i){
+		if( view->data.daoints[i] == index ) return index;
+	}
+	return -1;
+}
+static int DaoxDF_TestComparison( int cmp, int op )
+{
+	switch( op ){
+	case DAOX_DF_EQ : return cmp == 0;
+	case DAOX_DF_NE : return cmp != 0;
+	case DAOX_DF_LT : return cmp <  0;
+	case DAOX_DF_LE : return cmp <= 0;
+	case DAOX_DF_GT : return cmp >  0;
+	case DAOX_DF_GE : return cmp >= 0;
+	}
+	return 0;
+}
+
+/* Branch free compaction of the selected rows, with "row" as the current row: */
+#define DAOX_DF_FILTER( CELL, OP, VALUE ) \
+	for(i=0; i<count; ++i){ \
+		daoint row = rows[i]; \
+		rows[k] = row; \
+		k += CELL OP VALUE; \
+	}
+
+#define DAOX_DF_FILTER_BY( CELL, VALUE ) \
+	switch( op ){ \
+	case DAOX_DF_EQ : DAOX_DF_FILTER( CELL, ==, VALUE ); break; \
+	case DAOX_DF_NE : DAOX_DF_FILTER( CELL, !=, VALUE ); break; \
+	case DAOX_DF_LT : DAOX_DF_FILTER( CELL, <,  VALUE ); break; \
+	case DAOX_DF_LE : DAOX_DF_FILTER( CELL, <=, VALUE ); break; \
+	case DAOX_DF_GT : DAOX_DF_FILTER( CELL, >,  VALUE ); break; \
+	case DAOX_DF_GE : DAOX_DF_FILTER( CELL, >=, VALUE ); break; \
+	}
+
+/*
+// Keep the "rows" whose cells satisfy the comparison with "value", and return
+// the number of kept rows, or -1 if the value cannot be compared to the cells.
+// Dictionary encoded cells are tested by looking up the results for the codes.
+*/
+static daoint DaoxDataColumn_Filter( DaoxDataColumn *self, int op, DaoValue *value, daoint *rows, daoint count )
+{
+	DArray *cells = self->cells;
+	daoint i, k = 0;
+
+	switch( self->vatype->tid ){
+	case DAO_INTEGER :
+		if( value->type == DAO_INTEGER ){
+			daoint integer = value->xInteger.value;
+			DAOX_DF_FILTER_BY( cells->data.daoints[row], integer );
+		}else if( value->type == DAO_FLOAT ){
+			double number = value->xFloat.value;
+			DAOX_DF_FILTER_BY( (double) cells->data.daoints[row], number );
+		}else{
+			return -1;
+		}
+		break;
+	case DAO_FLOAT :
+		if( value->type == DAO_INTEGER || value->type == DAO_FLOAT ){
+			double number = DaoValue_GetFloat( value );
+			DAOX_DF_FILTER_BY( cells->data.doubles[row], number );
+		}else{
+			return -1;
 		}
 		break;
-	case (DAO_FLOAT<<8)|DAO_INTEGER :
-		D1 = self->xFloat.value;
-		D2 = DaoValue_GetFloat( other );
-		switch( opcode ){
-		case DVM_MOVE : self->xFloat.value =  D2; break;
-		case DVM_ADD  : self->xFloat.value = (D1 + D2); break;
-		case DVM_SUB  : self->xFloat.value = (D1 - D2); break;
-		case DVM_MUL  : self->xFloat.value = (D1 * D2); break;
-		case DVM_DIV  : self->xFloat.value = (D1 / D2); break;
-		case DVM_MOD  : self->xFloat.value = (D1-D2*(daoint)(D1/D2)); break;
-		default : return 1;
+	case DAO_STRING :
+		if( value->type != DAO_STRING ) return -1;
+		if( self->dictionary ){
+			DList *strings = self->dictionary->strings;
+			uchar_t *tests = (uchar_t*) dao_malloc( strings->size * sizeof(uchar_t) );
+			for(i=0; i<strings->size; ++i){
+				int cmp = DString_Compare( strings->items.pString[i], value->xString.value );
+				tests[i] = DaoxDF_TestComparison( cmp, op );
+			}
+			DAOX_DF_FILTER( tests[cells->data.ints[row]], !=, 0 );
+			dao_free( tests );
+		}else{
+			for(i=0; i<count; ++i){
+				daoint row = rows[i];
+				int cmp = DString_Compare( cells->data.strings + row, value->xString.value );
+				rows[k] = row;
+				k += DaoxDF_TestComparison( cmp, op );
+			}
 		}
 		break;
-	case (DAO_COMPLEX<<8)|DAO_INTEGER :
-	case (DAO_COMPLEX<<8)|DAO_FLOAT :
-		C1 = self->xComplex.value;
-		D2 = DaoValue_GetFloat( other );
-		switch( opcode ){
-		case DVM_MOVE : C1.real = D2;  C1.imag = 0.0; self->xComplex.value = C1; break;
-		case DVM_MUL  : C1.real *= D2; C1.imag *= D2; self->xComplex.value = C1; break;
-		case DVM_DIV  : C1.real /= D2; C1.imag /= D2; self->xComplex.value = C1; break;
-		case DVM_ADD  : self->xComplex.value.real += D2; break;
-		case DVM_SUB  : self->xComplex.value.real -= D2; break;
-		default : return 1;
+	default :
+		return -1;
+	}
+	return k;
+}
+
+/*
+// Gather the viewed columns of the selected rows of "input" into "result",
+// together with the column labels and the row labels of the active groups:
+*/
+static void DaoxDataFrame_Project( DaoxDataFrame *input, DaoxDataFrame *result, DArray *rows, DArray *view )
+{
+	DString *name = DString_New();
+	daoint i, j, N = input->dims[0];
+
+	DaoxDataFrame_Reset( result );
+	result->dims[0] = rows->size;
+	result->dims[1] = view->size;
+	result->dims[2] = 1;
+	for(j=0; j<view->size; ++j){
+		DaoxDataColumn *source = (DaoxDataColumn*) input->columns->items.pVoid[view->data.daoints[j]];
+		DaoxDataColumn *column = DaoxDataFrame_MakeColumn( result, source->vatype );
+		DList_Append( result->columns, column );
+		DaoxDataColumn_Gather( column, source, rows->data.daoints, rows->size );
+	}
+	if( input->labels[DAOX_DF_COL]->size ){
+		DaoxDataFrame_AddLabelGroup( result, DAOX_DF_COL );
+		for(j=0; j<view->size; ++j){
+			DaoxDataFrame_GetColumnName( input, view->data.daoints[j], name );
+			DaoxDataFrame_AddLabel( result, DAOX_DF_COL, name->chars, j );
 		}
-		break;
-	case (DAO_COMPLEX<<8)|DAO_COMPLEX :
-		C1 = self->xComplex.value;
-		C2 = other->xComplex.value;
-		switch( opcode ){
-		case DVM_MOVE : self->xComplex.value = C2; break;
-		case DVM_ADD  : COM_IP_ADD( C1, C2 ); self->xComplex.value = C1; break;
-		case DVM_SUB  : COM_IP_SUB( C1, C2 ); self->xComplex.value = C1; break;
-		case DVM_MUL  : COM_IP_MUL( C1, C2 ); self->xComplex.value = C1; break;
-		case DVM_DIV  : COM_IP_DIV( C1, C2 ); self->xComplex.value = C1; break;
-		default : return 1;
+	}
+	if( input->groups[DAOX_DF_ROW] < input->labels[DAOX_DF_ROW]->size ){
+		DMap *labmap = input->labels[DAOX_DF_ROW]->items.pMap[ input->groups[DAOX_DF_ROW] ];
+		DArray *positions = DArray_New( sizeof(daoint) );
+		DNode *it;
+		DArray_Resize( positions, N );
+		for(i=0; i<N; ++i) positions->data.daoints[i] = -1;
+		for(i=0; i<rows->size; ++i) positions->data.daoints[ rows->data.daoints[i] % N ] = i;
+		DaoxDataFrame_AddLabelGroup( result, DAOX_DF_ROW );
+		for(it=DMap_First(labmap); it; it=DMap_Next(labmap,it)){
+			daoint pos = it->value.pInt < N ? positions->data.daoints[it->value.pInt] : -1;
+			if( pos >= 0 ) DaoxDataFrame_AddLabel( result, DAOX_DF_ROW, it->key.pString->chars, pos );
 		}
-		break;
+		DArray_Delete( positions );
 	}
-	return 0;
+	DString_Delete( name );
 }
 
-static int DaoxDataFrame_UpdateByArray( DaoxDataFrame *self, DaoArray *array, int opcode )
+static void DaoxDF_MakeRange( DArray *indices, daoint count )
 {
-	DaoValue value = {0};
-	DaoValue value2 = {0};
-	DArray *destSlices = self->slices;
-	DArray *fromSlices = array->slices;
-	DArray *fromSlices2 = array->slices;
-	daoint i, j, k, N, M, K;
-
-	if( DaoxDataFrame_AlignArray( self, array ) == 0 ) return DAOX_DF_WRONG_SHAP;
+	daoint i;
+	DArray_Resize( indices, count );
+	for(i=0; i<count; ++i) indices->data.daoints[i] = i;
+}
 
-	if( self->original == NULL ){
-		DaoxDataFrame_PrepareSlices( self );
-		DaoxDataFrame_MakeFullSlice( self, self->slices );
-		destSlices = self->slices;
+/*
+// Execute the query and store the result in "result". Return zero for
+// invalid column references or comparisons, or unsupported aggregations.
+*/
+int DaoxDataQuery_Collect( DaoxDataQuery *self, DaoxDataFrame *result )
+{
+	DaoxDataFrame *frame = self->frame;
+	DaoxDataFrame *input = frame;
+	DaoxDataFrame *stage = NULL, *next;
+	DArray *rows = DArray_New( sizeof(daoint) );
+	DArray *view = DArray_New( sizeof(daoint) );
+	DArray *indices = DArray_New( sizeof(daoint) );
+	DArray *swap;
+	daoint i, j, s;
+	int ret = 0;
+
+	if( frame->original != NULL && frame->slices != NULL ){
+		daoint N = DaoSlice_GetSize( frame->slices, 0 );
+		daoint M = DaoSlice_GetSize( frame->slices, 1 );
+		daoint kk = DaoSlice_GetIndex( frame->slices, 2, 0 );
+		input = frame->original;
+		if( DaoSlice_GetSize( frame->slices, 2 ) != 1 ) goto Done;
+		DArray_Resize( rows, N );
+		DArray_Resize( view, M );
+		for(i=0; i<N; ++i) rows->data.daoints[i] = kk * input->dims[0] + DaoSlice_GetIndex( frame->slices, 0, i );
+		for(j=0; j<M; ++j) view->data.daoints[j] = DaoSlice_GetIndex( frame->slices, 1, j );
 	}else{
-		self = self->original;
+		if( frame->dims[2] != 1 ) goto Done;
+		DaoxDF_MakeRange( rows, frame->dims[0] );
+		DaoxDF_MakeRange( view, frame->dims[1] );
 	}
-	if( array->original == NULL ){
-		fromSlices = DArray_New( sizeof(daoint) );
-		DaoArray_MakeFullSlice( array, fromSlices );
-	}else{
-		array = array->original;
+
+	for(s=0; s<self->steps->size; ++s){
+		DaoxDataStep *step = (DaoxDataStep*) self->steps->items.pVoid[s];
+		DList *values = step->values;
+		daoint count, index;
+
+		switch( step->kind ){
+		case DAOX_DQ_FILTER :
+			index = DaoxDataQuery_Resolve( input, view, values->items.pValue[0] );
+			if( index < 0 ) goto Done;
+			count = DaoxDataColumn_Filter( (DaoxDataColumn*) input->columns->items.pVoid[index],
+					step->op, values->items.pValue[1], rows->data.daoints, rows->size );
+			if( count < 0 ) goto Done;
+			DArray_Reset( rows, count );
+			break;
+		case DAOX_DQ_SELECT :
+			DArray_Reset( indices, 0 );
+			for(j=0; j<values->size; ++j){
+				index = DaoxDataQuery_Resolve( input, view, values->items.pValue[j] );
+				if( index < 0 ) goto Done;
+				DArray_PushDaoInt( indices, index );
+			}
+			swap = view;
+			view = indices;
+			indices = swap;
+			break;
+		case DAOX_DQ_AGGREGATE :
+			DArray_Reset( indices, 0 );
+			for(j=0; j<values->size; ++j){
+				index = DaoxDataQuery_Resolve( input, view, values->items.pValue[j] );
+				if( index < 0 ) goto Done;
+				DArray_PushDaoInt( indices, index );
+			}
+			if( s + 1 == self->steps->size ){
+				/* The aggregation is the last step, and produces the result directly: */
+				ret = DaoxDataFrame_GroupRows( input, result, rows->data.daoints, rows->size, indices->data.daoints,
+						step->nkey, indices->data.daoints + step->nkey, step->methods->data.ints, step->methods->size );
+				goto Done;
+			}
+			next = DaoxDataFrame_New( DaoType_GetVmSpace( frame->ctype ) );
+			GC_IncRC( next );
+			ret = DaoxDataFrame_GroupRows( input, next, rows->data.daoints, rows->size, indices->data.daoints,
+					step->nkey, indices->data.daoints + step->nkey, step->methods->data.ints, step->methods->size );
+			if( stage ) GC_DecRC( stage );
+			stage = next;
+			if( ret == 0 ) goto Done;
+			ret = 0;
+			DaoxDF_MakeRange( rows, stage->dims[0] );
+			DaoxDF_MakeRange( view, stage->dims[1] );
+			input = stage;
+			break;
+		}
 	}
+	DaoxDataFrame_Project( input, result, rows, view );
+	ret = 1;
+Done:
+	if( stage ) GC_DecRC( stage );
+	DArray_Delete( rows );
+	DArray_Delete( view );
+	DArray_Delete( indices );
+	return ret;
+}
 
-	N = DaoSlice_GetSize( destSlices, 0 );
-	M = DaoSlice_GetSize( destSlices, 1 );
-	K = DaoSlice_GetSize( destSlices, 2 );
 
-	for(j=0; j<M; ++j){
-		daoint jjdes = DaoSlice_GetIndex( destSlices, 1, j );
-		daoint jjsrc = DaoSlice_GetIndex( fromSlices, 1, j );
-		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[jjdes];
-		for(i=0; i<N; ++i){
-			daoint iides = DaoSlice_GetIndex( destSlices, 0, i );
-			daoint iisrc = DaoSlice_GetIndex( fromSlices, 0, i );
-			for(k=0; k<K; ++k){
-				daoint kkdes = DaoSlice_GetIndex( destSlices, 2, k );
-				daoint kksrc = DaoSlice_GetIndex( fromSlices, 2, k );
-				daoint idsrc = iisrc * M * K + jjsrc * K + kksrc;
-				daoint iddes = kkdes * N + iides;
-				DaoValue *dest = DaoxDataColumn_GetCell( column, iddes, & value2 );
-				DaoArray_GetValue( array, idsrc, & value );
-				if( DaoValue_Update( dest, & value, opcode ) ) return DAOX_DF_WRONG_VALUE;
-				DaoxDataColumn_SetCell( column, iddes, dest );
+/*
+// Sorting:
+//
+// Sorting computes a permutation of the rows, and then gathers each column
+// with the permutation. Integer and float keys, and dictionary encoded string
+// keys (through the ranks of their codes), are mapped to unsigned integers
+// of the same order, and sorted by a stable LSD radix sort; other keys are
+// sorted by a stable merge sort. Multiple keys are sorted from the last key
+// to the first one, so that ties on a key keep the order of the next keys.
+// NaN are ordered last in both ascending and descending order.
+*/
+typedef struct DaoxSorter  DaoxSorter;
+
+struct DaoxSorter
+{
+	DaoxDataColumn  *column;      /* column of the cells to compare; */
+	DList           *strings;     /* or strings to compare; */
+	int              descending;
+};
+
+static int DaoxSorter_Compare( DaoxSorter *self, daoint a, daoint b )
+{
+	int cmp;
+	if( self->column ){
+		cmp = DaoxDataColumn_CompareCells( self->column, a, self->column, b );
+	}else{
+		cmp = DString_Compare( self->strings->items.pString[a], self->strings->items.pString[b] );
+	}
+	return self->descending ? -cmp : cmp;
+}
+/* Stable sort of "rows" by bottom-up merging; "buffer" has the same size: */
+static void DaoxSorter_MergeSort( DaoxSorter *self, daoint *rows, daoint *buffer, daoint count )
+{
+	daoint *source = rows, *target = buffer, *swap;
+	daoint width, i, j;
+
+	for(i=0; i<count; i+=16){ /* Insertion sort on short runs; */
+		daoint end = i + 16 < count ? i + 16 : count;
+		for(j=i+1; j<end; ++j){
+			daoint row = rows[j], k = j;
+			while( k > i && DaoxSorter_Compare( self, row, rows[k-1] ) < 0 ){
+				rows[k] = rows[k-1];
+				k -= 1;
+			}
+			rows[k] = row;
+		}
+	}
+	for(width=16; width<count; width*=2){
+		for(i=0; i<count; i+=2*width){
+			daoint mid = i + width < count ? i + width : count;
+			daoint end = i + 2*width < count ? i + 2*width : count;
+			daoint a = i, b = mid, k = i;
+			while( a < mid && b < end ){
+				if( DaoxSorter_Compare( self, source[b], source[a] ) < 0 ){
+					target[k++] = source[b++];
+				}else{
+					target[k++] = source[a++];
+				}
 			}
+			while( a < mid ) target[k++] = source[a++];
+			while( b < end ) target[k++] = source[b++];
+		}
+		swap = source;  source = target;  target = swap;
+	}
+	if( source != rows ) memcpy( rows, source, count*sizeof(daoint) );
+}
+/* Stable sort of "rows" by "keys" (aligned with "rows") with 8-bit digits: */
+static void DaoxDF_RadixSort( daoint *rows, uint64_t *keys, daoint *rows2, uint64_t *keys2, daoint count )
+{
+	daoint *counts = (daoint*) dao_calloc( 8*256, sizeof(daoint) );
+	daoint *source = rows, *target = rows2, *swap;
+	uint64_t *skeys = keys, *tkeys = keys2, *swap2;
+	daoint i, d, b, offset;
+
+	for(i=0; i<count; ++i){
+		uint64_t key = keys[i];
+		for(d=0; d<8; ++d) counts[d*256 + ((key >> (8*d)) & 0xff)] += 1;
+	}
+	for(d=0; d<8; ++d){
+		daoint *offsets = counts + d*256;
+		int shift = 8*d;
+		if( offsets[ (skeys[0] >> shift) & 0xff ] == count ) continue; /* Same digit; */
+		for(b=0, offset=0; b<256; ++b){
+			daoint n = offsets[b];
+			offsets[b] = offset;
+			offset += n;
 		}
+		for(i=0; i<count; ++i){
+			daoint pos = offsets[ (skeys[i] >> shift) & 0xff ]++;
+			target[pos] = source[i];
+			tkeys[pos] = skeys[i];
+		}
+		swap = source;  source = target;  target = swap;
+		swap2 = skeys;  skeys = tkeys;  tkeys = swap2;
 	}
+	if( source != rows ) memcpy( rows, source, count*sizeof(daoint) );
+	dao_free( counts );
+}
+/*
+// Map the key cells of the rows to unsigned integers of the same order;
+// return zero if the column type has no such mapping:
+*/
+static int DaoxDataColumn_MakeSortKeys( DaoxDataColumn *self, daoint *rows, uint64_t *keys, daoint count, int descending )
+{
+	uint64_t sign = (uint64_t)1 << 63;
+	daoint i;
 
-	if( fromSlices != fromSlices2 ) DArray_Delete( fromSlices );
+	switch( self->vatype->tid ){
+	case DAO_INTEGER :
+		for(i=0; i<count; ++i){
+			uint64_t key = ((uint64_t) self->cells->data.daoints[rows[i]]) ^ sign;
+			keys[i] = descending ? ~key : key;
+		}
+		return 1;
+	case DAO_FLOAT :
+		for(i=0; i<count; ++i){
+			double value = self->cells->data.doubles[rows[i]];
+			uint64_t key;
+			if( value != value ){
+				keys[i] = ~(uint64_t)0;
+				continue;
+			}
+			if( value == 0.0 ) value = 0.0; /* Negative zero; */
+			memcpy( & key, & value, sizeof(uint64_t) );
+			key = (key & sign) ? ~key : (key ^ sign);
+			if( descending ) key = ~key;
+			keys[i] = key;
+		}
+		return 1;
+	case DAO_STRING :
+		if( self->dictionary ){
+			DaoxDataDictionary *dict = self->dictionary;
+			daoint n = dict->strings->size;
+			daoint *codes = (daoint*) dao_malloc( 2 * n * sizeof(daoint) );
+			daoint *ranks = codes + n;
+			DaoxSorter sorter = { NULL, NULL, 0 };
+			sorter.strings = dict->strings;
+			for(i=0; i<n; ++i) codes[i] = i;
+			DaoxSorter_MergeSort( & sorter, codes, ranks, n );
+			for(i=0; i<n; ++i) ranks[codes[i]] = i;
+			for(i=0; i<count; ++i){
+				uint64_t key = ranks[ self->cells->data.ints[rows[i]] ];
+				keys[i] = descending ? ~key : key;
+			}
+			dao_free( codes );
+			return 1;
+		}
+		break;
+	}
 	return 0;
 }
-static int DaoxDataFrame_UpdateByFrame( DaoxDataFrame *self, DaoxDataFrame *df, int opcode )
+
+/*
+// Sort the rows of "self" by the "keys" columns into "result";
+// Return zero for invalid columns.
+*/
+int DaoxDataFrame_SortBy( DaoxDataFrame *self, DaoxDataFrame *result, daoint keys[], int nkey, int descending )
 {
-	DaoValue value = {0};
-	DaoValue value2 = {0};
-	DArray *destSlices = self->slices;
-	DArray *fromSlices = df->slices;
-	DArray *fromSlices2 = df->slices;
-	daoint i, j, k, N, M, K;
+	daoint N, k;
+	daoint *rows, *buffer;
+	uint64_t *skeys;
+	DArray *order, *view;
 
-	if( DaoxDataFrame_AlignFrame( self, df ) == 0 ) return DAOX_DF_WRONG_SHAP;
+	DaoxDataFrame_Sliced( self );
+	if( self->dims[2] != 1 ) return 0;
+	for(k=0; k<nkey; ++k){
+		if( keys[k] < 0 || keys[k] >= self->dims[1] ) return 0;
+	}
 
-	if( self->original == NULL ){
-		DaoxDataFrame_PrepareSlices( self );
-		DaoxDataFrame_MakeFullSlice( self, self->slices );
-		destSlices = self->slices;
-	}else{
-		self = self->original;
+	N = self->dims[0];
+	order = DArray_New( sizeof(daoint) );
+	view = DArray_New( sizeof(daoint) );
+	DaoxDF_MakeRange( order, N );
+	DaoxDF_MakeRange( view, self->dims[1] );
+	rows = order->data.daoints;
+	buffer = (daoint*) dao_malloc( (N + 1) * sizeof(daoint) );
+	skeys = (uint64_t*) dao_malloc( (2*N + 1) * sizeof(uint64_t) );
+	for(k=nkey-1; k>=0; --k){
+		DaoxDataColumn *column = (DaoxDataColumn*) self->columns->items.pVoid[keys[k]];
+		if( N < 2 ) break;
+		if( DaoxDataColumn_MakeSortKeys( column, rows, skeys, N, descending ) ){
+			DaoxDF_RadixSort( rows, skeys, buffer, skeys + N, N );
+		}else{
+			DaoxSorter sorter = { NULL, NULL, 0 };
+			sorter.column = column;
+			sorter.descending = descending;
+			DaoxSorter_MergeSort( & sorter, rows, buffer, N );
+		}
 	}
-	if( df->original == NULL ){
-		fromSlices = DArray_New( sizeof(daoint) );
-		DaoxDataFrame_MakeFullSlice( df, fromSlices );
-	}else{
-		df = df->original;
+	DaoxDataFrame_Project( self, result, order, view );
+	dao_free( buffer );
+	dao_free( skeys );
+	DArray_Delete( order );
+	DArray_Delete( view );
+	return 1;
+}
+
+/*
+// Heap based selection of the rows with the "k" largest cells in a column:
+// the heap keeps the current selection with its smallest cell at the root,
+// so each row is compared with the root, and only replaces it if larger.
+// Equal cells are ranked by their row order; NaN cells are skipped.
+*/
+static int DaoxSorter_Better( DaoxSorter *self, daoint a, daoint b )
+{
+	int cmp = DaoxSorter_Compare( self, a, b );
+	return cmp > 0 || (cmp == 0 && a < b);
+}
+static void DaoxSorter_SiftDown( DaoxSorter *self, daoint *heap, daoint count, daoint i )
+{
+	daoint row = heap[i];
+	while( 2*i + 1 < count ){
+		daoint child = 2*i + 1;
+		if( child + 1 < count && DaoxSorter_Better( self, heap[child], heap[child+1] ) ) child += 1;
+		if( ! DaoxSorter_Better( self, row, heap[child] ) ) break;
+		heap[i] = heap[child];
+		i = child;
 	}
+	heap[i] = row;
+}
 
-	N = DaoSlice_GetSize( destSlices, 0 );
-	M = DaoSlice_GetSize( destSlices, 1 );
-	K = DaoSlice_GetSize( destSlices, 2 );
+/*
+// Select the rows of "self" with the "k" largest cells in "column" into "result",
+// in descending order of the cells. Return zero for invalid column.
+*/
+int DaoxDataFrame_TopK( DaoxDataFrame *self, DaoxDataFrame *result, daoint column, daoint k )
+{
+	DaoxSorter sorter = { NULL, NULL, 0 };
+	DArray *heap, *view;
+	daoint *rows;
+	daoint N, i, n = 0;
 
-	for(j=0; j<M; ++j){
-		daoint jjdes = DaoSlice_GetIndex( destSlices, 1, j );
-		daoint jjsrc = DaoSlice_GetIndex( fromSlices, 1, j );
-		DaoxDataColumn *coldes = (DaoxDataColumn*) self->columns->items.pVoid[jjdes];
-		DaoxDataColumn *colsrc = (DaoxDataColumn*) df->columns->items.pVoid[jjsrc];
-		if( DaoType_MatchTo( colsrc->vatype, coldes->vatype, NULL ) < DAO_MT_SUB )
-			return DAOX_DF_WRONG_VALUE;
-		for(i=0; i<N; ++i){
-			daoint iides = DaoSlice_GetIndex( destSlices, 0, i );
-			daoint iisrc = DaoSlice_GetIndex( fromSlices, 0, i );
-			for(k=0; k<K; ++k){
-				daoint kkdes = DaoSlice_GetIndex( destSlices, 2, k );
-				daoint kksrc = DaoSlice_GetIndex( fromSlices, 2, k );
-				daoint idsrc = kksrc * N + iisrc;
-				daoint iddes = kkdes * N + iides;
-				DaoValue *dest = DaoxDataColumn_GetCell( coldes, iddes, & value2 );
-				DaoValue *val = DaoxDataColumn_GetCell( colsrc, idsrc, & value );
-				if( val->type == dest->type && val->type == DAO_STRING ){
-					DString_Assign( dest->xString.value, val->xString.value );
-					continue;
-				}else if( DaoValue_Update( dest, val, opcode ) ){
-					return DAOX_DF_WRONG_VALUE;
-				}
-				DaoxDataColumn_SetCell( coldes, iddes, dest );
+	DaoxDataFrame_Sliced( self );
+	if( self->dims[2] != 1 ) return 0;
+	if( column < 0 || column >= self->dims[1] ) return 0;
+
+	N = self->dims[0];
+	if( k < 0 ) k = 0;
+	if( k > N ) k = N;
+	sorter.column = (DaoxDataColumn*) self->columns->items.pVoid[column];
+	heap = DArray_New( sizeof(daoint) );
+	view = DArray_New( sizeof(daoint) );
+	DArray_Resize( heap, k );
+	DaoxDF_MakeRange( view, self->dims[1] );
+	rows = heap->data.daoints;
+	for(i=0; i<N && k; ++i){
+		if( sorter.column->vatype->tid == DAO_FLOAT ){
+			double value = sorter.column->cells->data.doubles[i];
+			if( value != value ) continue;
+		}
+		if( n < k ){
+			daoint j = n++;
+			rows[j] = i;
+			while( j > 0 && DaoxSorter_Better( & sorter, rows[(j-1)/2], rows[j] ) ){
+				daoint parent = (j-1)/2, row = rows[j];
+				rows[j] = rows[parent];
+				rows[parent] = row;
+				j = parent;
 			}
+		}else if( DaoxSorter_Better( & sorter, i, rows[0] ) ){
+			rows[0] = i;
+			DaoxSorter_SiftDown( & sorter, rows, n, 0 );
 		}
 	}
-
-	if( fromSlices != fromSlices2 ) DArray_Delete( fromSlices );
-	return 0;
+	DArray_Resize( heap, n );
+	for(i=n-1; i>0; --i){ /* Move the smallest to the end; */
+		daoint row = rows[0];
+		rows[0] = rows[i];
+		rows[i] = row;
+		DaoxSorter_SiftDown( & sorter, rows, i, 0 );
+	}
+	DaoxDataFrame_Project( self, result, heap, view );
+	DArray_Delete( heap );
+	DArray_Delete( view );
+	return 1;
 }
 
 
 
 
+
 DaoxDataFrame* DaoProcess_MakeReturnDataFrame( DaoProcess *self )
 {
 	DaoVmCode *vmc = self->activeCode;
@@ -1277,7 +4255,8 @@ static void FRAME_PRINT( DaoProcess *proc, DaoValue *p[], int n )
 				CheckPrintWidth( com.imag, & max, & min, & dec );
 				break;
 			case DAO_STRING :
-				if( cells->data.strings[ii].size > max ) max = cells->data.strings[ii].size;
+				w = DaoxDataColumn_GetString( col, ii )->size;
+				if( w > max ) max = w;
 				break;
 			default :
 				break;
@@ -1487,235 +4466,373 @@ static void FRAME_PRINT( DaoProcess *proc, DaoValue *p[], int n )
 			DaoStream_WriteChars( stream, "\n" );
 		}
 	}
-	if( casting ) DaoProcess_PutString( proc, sstream2->buffer );
-	DaoGC_TryDelete( (DaoValue*) sstream );
-	DaoGC_TryDelete( (DaoValue*) sstream2 );
-	DArray_Delete( aligns );
-	DArray_Delete( scifmts );
-	DArray_Delete( decimals );
-	DArray_Delete( rlabwidth );
-	DArray_Delete( clabwidth );
-	DString_Delete( label );
+	if( casting ) DaoProcess_PutString( proc, sstream2->buffer );
+	DaoGC_TryDelete( (DaoValue*) sstream );
+	DaoGC_TryDelete( (DaoValue*) sstream2 );
+	DArray_Delete( aligns );
+	DArray_Delete( scifmts );
+	DArray_Delete( decimals );
+	DArray_Delete( rlabwidth );
+	DArray_Delete( clabwidth );
+	DString_Delete( label );
+}
+
+/*
+// Code section execution over cells, rows or columns.
+// With the parallel option, the rows (or the columns for column sections)
+// are partitioned into contiguous blocks, and each block is scanned by
+// a worker process that shares the code section of the calling process,
+// and has its own reusable index values, tuple or list buffer.
+// Updates to different rows touch disjoint cells, except for dictionary
+// encoded columns whose shared dictionary is updated under a lock.
+*/
+#define DAOX_DF_MIN_SECTION_BLOCK  64
+
+enum DaoxSectionModes
+{
+	DAOX_DF_SCAN_CELLS ,
+	DAOX_DF_SCAN_ROWS  ,
+	DAOX_DF_SCAN_COLS
+};
+
+typedef struct DaoxSectionScan  DaoxSectionScan;
+
+struct DaoxSectionScan
+{
+	DaoProcess     *proc;      /* process invoking the code section; */
+	DaoVmCode      *sect;
+	DaoxDataFrame  *frame;     /* frame with the slices to scan; */
+	DaoxDataFrame  *original;  /* frame holding the columns; */
+	DaoType        *type;      /* row tuple type; */
+	DList          *types;     /* column list types; */
+	daoint          entry;
+	int             mode;
+	int             update;
+	int             parallel;
+	int             aborted;   /* set and read under the mutex in parallel scans; */
+#ifdef DAO_WITH_THREAD
+	DMutex          mutex;
+#endif
+};
+
+/*
+// The dictionary of an encoded string column may grow when a cell is set,
+// so in the parallel updating scans, the dictionary cells are read and set
+// under the mutex:
+*/
+static DaoValue* DaoxSectionScan_GetCell( DaoxSectionScan *self, DaoxDataColumn *column, daoint i, DaoValue *value )
+{
+#ifdef DAO_WITH_THREAD
+	if( self->parallel && self->update && column->dictionary != NULL ){
+		DMutex_Lock( & self->mutex );
+		value = DaoxDataColumn_GetCell( column, i, value );
+		DMutex_Unlock( & self->mutex );
+		return value;
+	}
+#endif
+	return DaoxDataColumn_GetCell( column, i, value );
+}
+static void DaoxSectionScan_SetCell( DaoxSectionScan *self, DaoxDataColumn *column, daoint i, DaoValue *value )
+{
+#ifdef DAO_WITH_THREAD
+	if( self->parallel && column->dictionary != NULL ){
+		DMutex_Lock( & self->mutex );
+		DaoxDataColumn_SetCell( column, i, value );
+		DMutex_Unlock( & self->mutex );
+		return;
+	}
+#endif
+	DaoxDataColumn_SetCell( column, i, value );
+}
+/* Check and propagate the abortion of the section execution in any block: */
+static int DaoxSectionScan_Aborted( DaoxSectionScan *self, DaoProcess *proc )
+{
+	int aborted;
+#ifdef DAO_WITH_THREAD
+	if( self->parallel ){
+		DMutex_Lock( & self->mutex );
+		if( proc->status == DAO_PROCESS_ABORTED ) self->aborted = 1;
+		aborted = self->aborted;
+		DMutex_Unlock( & self->mutex );
+		return aborted;
+	}
+#endif
+	if( proc->status == DAO_PROCESS_ABORTED ) self->aborted = 1;
+	return self->aborted;
 }
 
-static void FRAME_CellsCodeSection( DaoProcess *proc, DaoValue *p[], int npar, int func )
+static void DaoxSectionScan_ScanCells( DaoxSectionScan *self, DaoProcess *proc, daoint first, daoint end )
 {
-	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *frame = self->frame;
 	DaoxDataFrame *original = self->original;
-	DaoVmCode *sect = DaoProcess_InitCodeSection( proc, 4 );
+	DaoVmCode *sect = self->sect;
 	DaoInteger integer1 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger integer2 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger integer3 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger *rowidx = & integer1;
 	DaoInteger *colidx = & integer2;
 	DaoInteger *depidx = & integer3;
-	DaoValue *nulls[3] = {NULL,NULL,NULL};
 	DaoValue value;
-	daoint N, M, K;
-	daoint entry, i, j, k;
+	daoint N = original->dims[0];
+	daoint M = DaoSlice_GetSize( frame->slices, 1 );
+	daoint K = DaoSlice_GetSize( frame->slices, 2 );
+	daoint i, j, k;
 
 	value.xInteger = integer1;
-	if( sect == NULL ) return;
-
-	if( self->original == NULL ){
-		DaoxDataFrame_PrepareSlices( self );
-		DaoxDataFrame_MakeSlice( self, proc, nulls, 3, self->slices );
-		original = self;
-	}
-
-	N = DaoSlice_GetSize( self->slices, 0 );
-	M = DaoSlice_GetSize( self->slices, 1 );
-	K = DaoSlice_GetSize( self->slices, 2 );
-
-	entry = proc->topFrame->entry;
 	for(k=0; k<K; ++k){
-		daoint kk = DaoSlice_GetIndex( self->slices, 2, k );
+		daoint kk = DaoSlice_GetIndex( frame->slices, 2, k );
 		depidx->value = kk;
 		for(j=0; j<M; ++j){
-			daoint jj = DaoSlice_GetIndex( self->slices, 1, j );
+			daoint jj = DaoSlice_GetIndex( frame->slices, 1, j );
 			DaoxDataColumn *column = (DaoxDataColumn*) original->columns->items.pVoid[jj];
 			colidx->value = jj;
-			for(i=0; i<N; ++i){
-				daoint ii = DaoSlice_GetIndex( self->slices, 0, i );
+			for(i=first; i<end; ++i){
+				daoint ii = DaoSlice_GetIndex( frame->slices, 0, i );
 				rowidx->value = ii;
 				if( sect->b >0 ){
-					DaoValue *cell = DaoxDataColumn_GetCell( column, kk*N+ii, & value );
+					DaoValue *cell = DaoxSectionScan_GetCell( self, column, kk*N+ii, & value );
 					DaoProcess_SetValue( proc, sect->a, cell );
 				}
 				if( sect->b >1 ) DaoProcess_SetValue( proc, sect->a+1, (DaoValue*) rowidx );
 				if( sect->b >2 ) DaoProcess_SetValue( proc, sect->a+2, (DaoValue*) colidx );
 				if( sect->b >3 ) DaoProcess_SetValue( proc, sect->a+3, (DaoValue*) depidx );
-				proc->topFrame->entry = entry;
+				proc->topFrame->entry = self->entry;
 				DaoProcess_Execute( proc );
-				if( proc->status == DAO_PROCESS_ABORTED ) break;
-				if( func ){
-					DaoxDataColumn_SetCell( column, kk*N+ii, proc->stackValues[0] );
+				if( DaoxSectionScan_Aborted( self, proc ) ) return;
+				if( self->update ){
+					DaoxSectionScan_SetCell( self, column, kk*N+ii, proc->stackValues[0] );
 				}
 			}
 		}
 	}
-	DaoProcess_PopFrame( proc );
 }
-static void FRAME_RowsCodeSection( DaoProcess *proc, DaoValue *p[], int npar, int func )
+static void DaoxSectionScan_ScanRows( DaoxSectionScan *self, DaoProcess *proc, daoint first, daoint end )
 {
-	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *frame = self->frame;
 	DaoxDataFrame *original = self->original;
-	DaoNamespace *ns = proc->activeNamespace;
-	DaoVmCode *sect = DaoProcess_InitCodeSection( proc, 3 );
+	DaoVmCode *sect = self->sect;
 	DaoInteger integer1 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger integer3 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger *rowidx = & integer1;
 	DaoInteger *depidx = & integer3;
-	DaoValue *nulls[3] = {NULL,NULL,NULL};
+	DaoTuple *tuple = DaoTuple_Create( self->type, 0, 0 );
 	DaoValue value;
-	DaoTuple *tuple;
-	DaoType *type;
-	DList *ts;
-	daoint N, M, K;
-	daoint entry, i, j, k;
-
-	value.xInteger = integer1;
-	if( sect == NULL ) return;
-
-	if( self->original == NULL ){
-		DaoxDataFrame_PrepareSlices( self );
-		DaoxDataFrame_MakeSlice( self, proc, nulls, 3, self->slices );
-		original = self;
-	}
-
-	N = DaoSlice_GetSize( self->slices, 0 );
-	M = DaoSlice_GetSize( self->slices, 1 );
-	K = DaoSlice_GetSize( self->slices, 2 );
+	daoint N = original->dims[0];
+	daoint M = DaoSlice_GetSize( frame->slices, 1 );
+	daoint K = DaoSlice_GetSize( frame->slices, 2 );
+	daoint i, j, k;
 
-	ts = DList_New(0);
-	for(j=0; j<M; ++j){
-		daoint jj = DaoSlice_GetIndex( self->slices, 1, j );
-		DaoxDataColumn *column = (DaoxDataColumn*) original->columns->items.pVoid[jj];
-		DList_Append( ts, column->vatype );
-	}
-	type = DaoNamespace_MakeType( ns, "tuple", DAO_TUPLE, NULL, ts->items.pType, ts->size );
-	DList_Delete( ts );
-
-	tuple = DaoTuple_Create( type, 0, 0 );
 	GC_IncRC( tuple );
-
-	entry = proc->topFrame->entry;
+	value.xInteger = integer1;
 	for(k=0; k<K; ++k){
-		daoint kk = DaoSlice_GetIndex( self->slices, 2, k );
+		daoint kk = DaoSlice_GetIndex( frame->slices, 2, k );
 		depidx->value = kk;
-		for(i=0; i<N; ++i){
-			daoint ii = DaoSlice_GetIndex( self->slices, 0, i );
+		for(i=first; i<end; ++i){
+			daoint ii = DaoSlice_GetIndex( frame->slices, 0, i );
 			rowidx->value = ii;
 			for(j=0; j<M; ++j){
-				daoint jj = DaoSlice_GetIndex( self->slices, 1, j );
+				daoint jj = DaoSlice_GetIndex( frame->slices, 1, j );
 				DaoxDataColumn *column = (DaoxDataColumn*) original->columns->items.pVoid[jj];
-				DaoValue *cell = DaoxDataColumn_GetCell( column, kk*N+ii, & value );
+				DaoValue *cell = DaoxSectionScan_GetCell( self, column, kk*N+ii, & value );
 				DaoTuple_SetItem( tuple, cell, j );
 			}
 			if( sect->b >0 ) DaoProcess_SetValue( proc, sect->a, (DaoValue*) tuple );
 			if( sect->b >1 ) DaoProcess_SetValue( proc, sect->a+1, (DaoValue*) rowidx );
 			if( sect->b >2 ) DaoProcess_SetValue( proc, sect->a+2, (DaoValue*) depidx );
-			proc->topFrame->entry = entry;
+			proc->topFrame->entry = self->entry;
 			DaoProcess_Execute( proc );
-			if( proc->status == DAO_PROCESS_ABORTED ) break;
-			if( func == 0 ) continue;
+			if( DaoxSectionScan_Aborted( self, proc ) ){
+				GC_DecRC( tuple );
+				return;
+			}
+			if( self->update == 0 ) continue;
 			for(j=0; j<M; ++j){
-				daoint jj = DaoSlice_GetIndex( self->slices, 1, j );
+				daoint jj = DaoSlice_GetIndex( frame->slices, 1, j );
 				DaoxDataColumn *column = (DaoxDataColumn*) original->columns->items.pVoid[jj];
-				DaoxDataColumn_SetCell( column, kk*N+ii, tuple->values[j] );
+				DaoxSectionScan_SetCell( self, column, kk*N+ii, tuple->values[j] );
 			}
 		}
 	}
-	DaoProcess_PopFrame( proc );
 	GC_DecRC( tuple );
 }
-static void FRAME_ColsCodeSection( DaoProcess *proc, DaoValue *p[], int npar, int func )
+static void DaoxSectionScan_ScanCols( DaoxSectionScan *self, DaoProcess *proc, daoint first, daoint end )
 {
-	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *frame = self->frame;
 	DaoxDataFrame *original = self->original;
-	DaoNamespace *ns = proc->activeNamespace;
-	DaoVmCode *sect = DaoProcess_InitCodeSection( proc, 3 );
+	DaoVmCode *sect = self->sect;
 	DaoInteger integer2 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger integer3 = {DAO_INTEGER,0,0,0,0,0};
 	DaoInteger *colidx = & integer2;
 	DaoInteger *depidx = & integer3;
-	DaoValue *nulls[3] = {NULL,NULL,NULL};
+	DaoList *list = DaoList_New();
 	DaoValue value;
-	DaoList *list;
-	daoint N, M, K;
-	daoint entry, i, j, k;
-
-	value.xInteger = integer2;
-	if( sect == NULL ) return;
-
-	if( self->original == NULL ){
-		DaoxDataFrame_PrepareSlices( self );
-		DaoxDataFrame_MakeSlice( self, proc, nulls, 3, self->slices );
-		original = self;
-	}
+	daoint N = DaoSlice_GetSize( frame->slices, 0 );
+	daoint K = DaoSlice_GetSize( frame->slices, 2 );
+	daoint i, j, k;
 
-	N = DaoSlice_GetSize( self->slices, 0 );
-	M = DaoSlice_GetSize( self->slices, 1 );
-	K = DaoSlice_GetSize( self->slices, 2 );
-
-	list = DaoList_New();
 	GC_IncRC( list );
-
-	entry = proc->topFrame->entry;
+	value.xInteger = integer2;
 	for(k=0; k<K; ++k){
-		daoint kk = DaoSlice_GetIndex( self->slices, 2, k );
+		daoint kk = DaoSlice_GetIndex( frame->slices, 2, k );
 		depidx->value = kk;
-		for(j=0; j<M; ++j){
-			daoint jj = DaoSlice_GetIndex( self->slices, 1, j );
+		for(j=first; j<end; ++j){
+			daoint jj = DaoSlice_GetIndex( frame->slices, 1, j );
 			DaoxDataColumn *column = (DaoxDataColumn*) original->columns->items.pVoid[jj];
-			DaoType *type = DaoNamespace_MakeType( ns, "list", DAO_LIST, NULL, & column->vatype, 1 );
 			colidx->value = jj;
 			DaoList_Clear( list );
-			GC_Assign( & list->ctype, type );
+			GC_Assign( & list->ctype, self->types->items.pType[j] );
 			for(i=0; i<N; ++i){
-				daoint ii = DaoSlice_GetIndex( self->slices, 0, i );
-				DaoValue *cell = DaoxDataColumn_GetCell( column, kk*N+ii, & value );
+				daoint ii = DaoSlice_GetIndex( frame->slices, 0, i );
+				DaoValue *cell = DaoxSectionScan_GetCell( self, column, kk*original->dims[0]+ii, & value );
 				DaoList_Append( list, cell );
 			}
 			if( sect->b >0 ) DaoProcess_SetValue( proc, sect->a, (DaoValue*) list );
 			if( sect->b >1 ) DaoProcess_SetValue( proc, sect->a+1, (DaoValue*) colidx );
 			if( sect->b >2 ) DaoProcess_SetValue( proc, sect->a+2, (DaoValue*) depidx );
-			proc->topFrame->entry = entry;
+			proc->topFrame->entry = self->entry;
 			DaoProcess_Execute( proc );
-			if( proc->status == DAO_PROCESS_ABORTED ) break;
-			if( func == 0 ) continue;
+			if( DaoxSectionScan_Aborted( self, proc ) ){
+				GC_DecRC( list );
+				return;
+			}
+			if( self->update == 0 ) continue;
 			for(i=0; i<N; ++i){
-				daoint ii = DaoSlice_GetIndex( self->slices, 0, i );
-				DaoxDataColumn_SetCell( column, kk*N+ii, list->value->items.pValue[i] );
+				daoint ii = DaoSlice_GetIndex( frame->slices, 0, i );
+				DaoValue *cell = list->value->items.pValue[i];
+				DaoxSectionScan_SetCell( self, column, kk*original->dims[0]+ii, cell );
 			}
 		}
 	}
-	DaoProcess_PopFrame( proc );
 	GC_DecRC( list );
 }
+static void DaoxSectionScan_Scan( DaoxSectionScan *self, DaoProcess *proc, daoint first, daoint end )
+{
+	switch( self->mode ){
+	case DAOX_DF_SCAN_CELLS : DaoxSectionScan_ScanCells( self, proc, first, end ); break;
+	case DAOX_DF_SCAN_ROWS  : DaoxSectionScan_ScanRows( self, proc, first, end ); break;
+	case DAOX_DF_SCAN_COLS  : DaoxSectionScan_ScanCols( self, proc, first, end ); break;
+	}
+}
+/*
+// Prepare a worker process to run the code section of the calling process,
+// the outer variables of the section are accessed through the calling process:
+*/
+static DaoProcess* DaoxSectionScan_AcquireProcess( DaoxSectionScan *self )
+{
+	DaoProcess *proto = self->proc;
+	DaoProcess *clone = DaoVmSpace_AcquireProcess( proto->vmSpace );
+
+	DaoProcess_PushRoutine( clone, proto->activeRoutine, proto->activeObject );
+	clone->activeCode = proto->activeCode;
+	DaoProcess_PushFunction( clone, proto->topFrame->routine );
+	DaoProcess_SetActiveFrame( clone, clone->topFrame );
+	DaoProcess_PushSectionFrame( clone );
+	clone->topFrame->outer = proto;
+	clone->topFrame->returning = -1;
+	clone->stackTop = clone->topFrame->stackBase + self->sect->b;
+	clone->paramCount = self->sect->b;
+	return clone;
+}
+static void DaoxSectionScan_RunBlock( DaoxDataTask *task )
+{
+	DaoxSectionScan *self = (DaoxSectionScan*) task->context;
+	DaoProcess *clone = DaoxSectionScan_AcquireProcess( self );
+
+	DaoxSectionScan_Scan( self, clone, task->first, task->end );
+	DaoProcess_PopFrames( clone, clone->firstFrame );
+	DaoVmSpace_ReleaseProcess( self->proc->vmSpace, clone );
+}
+
+static void FRAME_RunCodeSection( DaoProcess *proc, DaoValue *p[], int npar, int mode, int update )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *original = self->original;
+	DaoNamespace *ns = proc->activeNamespace;
+	DaoVmCode *sect = DaoProcess_InitCodeSection( proc, mode == DAOX_DF_SCAN_CELLS ? 4 : 3 );
+	DaoValue *nulls[3] = {NULL,NULL,NULL};
+	DaoxSectionScan scan;
+	daoint N, M, j, count;
+	int ntask = 1;
+
+	if( sect == NULL ) return;
+
+	if( self->original == NULL ){
+		DaoxDataFrame_PrepareSlices( self );
+		DaoxDataFrame_MakeSlice( self, proc, nulls, 3, self->slices );
+		original = self;
+	}
+
+	N = DaoSlice_GetSize( self->slices, 0 );
+	M = DaoSlice_GetSize( self->slices, 1 );
+
+	memset( & scan, 0, sizeof(DaoxSectionScan) );
+	scan.proc = proc;
+	scan.sect = sect;
+	scan.frame = self;
+	scan.original = original;
+	scan.entry = proc->topFrame->entry;
+	scan.mode = mode;
+	scan.update = update;
+	scan.types = DList_New(0);
+	for(j=0; j<M; ++j){
+		daoint jj = DaoSlice_GetIndex( self->slices, 1, j );
+		DaoxDataColumn *column = (DaoxDataColumn*) original->columns->items.pVoid[jj];
+		DaoType *type = column->vatype;
+		if( mode == DAOX_DF_SCAN_COLS ){
+			type = DaoNamespace_MakeType( ns, "list", DAO_LIST, NULL, & column->vatype, 1 );
+		}
+		DList_Append( scan.types, type );
+	}
+	if( mode == DAOX_DF_SCAN_ROWS ){
+		DList *ts = scan.types;
+		scan.type = DaoNamespace_MakeType( ns, "tuple", DAO_TUPLE, NULL, ts->items.pType, ts->size );
+	}
+
+	count = mode == DAOX_DF_SCAN_COLS ? M : N;
+	if( npar > 1 && p[1]->xBoolean.value ){
+		ntask = DaoxDF_GetTaskCount( count, DAOX_DF_MIN_SECTION_BLOCK );
+	}
+	if( ntask > 1 ){
+		scan.parallel = 1;
+#ifdef DAO_WITH_THREAD
+		DMutex_Init( & scan.mutex );
+#endif
+		DaoxDF_RunTasks( DaoxSectionScan_RunBlock, & scan, count, ntask );
+#ifdef DAO_WITH_THREAD
+		DMutex_Destroy( & scan.mutex );
+#endif
+		if( scan.aborted && proc->status != DAO_PROCESS_ABORTED ){
+			DaoProcess_RaiseError( proc, NULL, "code section execution failed in a parallel block" );
+		}
+	}else{
+		DaoxSectionScan_Scan( & scan, proc, 0, count );
+	}
+	DaoProcess_PopFrame( proc );
+	DList_Delete( scan.types );
+}
 static void FRAME_ScanCells( DaoProcess *proc, DaoValue *p[], int npar )
 {
-	FRAME_CellsCodeSection( proc, p, npar, 0 );
+	FRAME_RunCodeSection( proc, p, npar, DAOX_DF_SCAN_CELLS, 0 );
 }
 static void FRAME_UpdateCells( DaoProcess *proc, DaoValue *p[], int npar )
 {
-	FRAME_CellsCodeSection( proc, p, npar, 1 );
+	FRAME_RunCodeSection( proc, p, npar, DAOX_DF_SCAN_CELLS, 1 );
 }
 static void FRAME_ScanRows( DaoProcess *proc, DaoValue *p[], int npar )
 {
-	FRAME_RowsCodeSection( proc, p, npar, 0 );
+	FRAME_RunCodeSection( proc, p, npar, DAOX_DF_SCAN_ROWS, 0 );
 }
 static void FRAME_UpdateRows( DaoProcess *proc, DaoValue *p[], int npar )
 {
-	FRAME_RowsCodeSection( proc, p, npar, 1 );
+	FRAME_RunCodeSection( proc, p, npar, DAOX_DF_SCAN_ROWS, 1 );
 }
 static void FRAME_ScanCols( DaoProcess *proc, DaoValue *p[], int npar )
 {
-	FRAME_ColsCodeSection( proc, p, npar, 0 );
+	FRAME_RunCodeSection( proc, p, npar, DAOX_DF_SCAN_COLS, 0 );
 }
 static void FRAME_UpdateCols( DaoProcess *proc, DaoValue *p[], int npar )
 {
-	FRAME_ColsCodeSection( proc, p, npar, 1 );
+	FRAME_RunCodeSection( proc, p, npar, DAOX_DF_SCAN_COLS, 1 );
 }
 
 static void FRAME_AddFrame( DaoProcess *proc, DaoValue *P[], int N )
@@ -1794,6 +4911,208 @@ static void FRAME_BitXorArray( DaoProcess *proc, DaoValue *P[], int N )
 }
 
 
+static void FRAME_Encode( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DString *res = DaoProcess_PutChars( proc, "" );
+	if( DaoxDataFrame_Encode( self, res, p[1]->xBoolean.value ) == 0 ){
+		DaoProcess_RaiseError( proc, "Value", "column type not supported for encoding" );
+	}
+}
+static void FRAME_Decode( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	int ret = DaoxDataFrame_Decode( self, p[1]->xString.value );
+	DaoProcess_PutBoolean( proc, ret );
+}
+static void FRAME_Save( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DString *codePath = proc->activeRoutine->nameSpace->path;
+	DString *file = DString_Copy( p[1]->xString.value );
+	DString_MakePath( codePath, file );
+	if( DaoxDataFrame_Save( self, file->chars, p[2]->xBoolean.value ) == 0 ){
+		DaoProcess_RaiseError( proc, NULL, "file saving failed" );
+	}
+	DString_Delete( file );
+}
+static void FRAME_Load( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DString *codePath = proc->activeRoutine->nameSpace->path;
+	DString *file = DString_Copy( p[1]->xString.value );
+	DString_MakePath( codePath, file );
+	if( DaoxDataFrame_Load( self, file->chars, p[2]->xEnum.value ) == 0 ){
+		DaoProcess_RaiseError( proc, NULL, "file loading failed" );
+	}
+	DString_Delete( file );
+}
+
+
+static void FRAME_ReadCsv( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DString *codePath = proc->activeRoutine->nameSpace->path;
+	DString *file = DString_Copy( p[1]->xString.value );
+	DString *sep = p[2]->xString.value;
+	DList *list = p[4]->xList.value;
+	DArray *types = DArray_New( sizeof(int) );
+	daoint i;
+
+	for(i=0; i<list->size; ++i){
+		int type = 0;
+		switch( list->items.pValue[i]->xEnum.value ){
+		case 1 : type = DAO_INTEGER; break;
+		case 2 : type = DAO_FLOAT; break;
+		case 3 : type = DAO_STRING; break;
+		}
+		DArray_PushInt( types, type );
+	}
+	DString_MakePath( codePath, file );
+	if( sep->size != 1 ){
+		DaoProcess_RaiseError( proc, "Param", "invalid separator" );
+	}else if( DaoxDataFrame_ReadCsv( self, file->chars, sep->chars[0], p[3]->xBoolean.value, types->data.ints, types->size ) == 0 ){
+		DaoProcess_RaiseError( proc, NULL, "file loading failed" );
+	}
+	DArray_Delete( types );
+	DString_Delete( file );
+}
+
+
+static daoint DaoxDataFrame_GetColumnIndex( DaoxDataFrame *self, DaoValue *value )
+{
+	daoint index = -1;
+	if( value->type == DAO_INTEGER ){
+		index = value->xInteger.value;
+	}else if( value->type == DAO_STRING ){
+		index = DaoxDataFrame_GetIndex( self, DAOX_DF_COL, value->xString.value->chars );
+	}
+	if( index < 0 || index >= self->dims[1] ) return -1;
+	return index;
+}
+static void FRAME_GroupBy( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *result = DaoProcess_MakeReturnDataFrame( proc );
+	DList *keys = p[1]->xList.value;
+	DList *aggregates = p[2]->xList.value;
+	DArray *indices = DArray_New( sizeof(daoint) );
+	DArray *methods = DArray_New( sizeof(int) );
+	daoint i;
+
+	DaoxDataFrame_Sliced( self );
+	for(i=0; i<keys->size; ++i){
+		daoint index = DaoxDataFrame_GetColumnIndex( self, keys->items.pValue[i] );
+		if( index < 0 ) goto InvalidColumn;
+		DArray_PushDaoInt( indices, index );
+	}
+	for(i=0; i<aggregates->size; ++i){
+		DaoTuple *tuple = (DaoTuple*) aggregates->items.pValue[i];
+		daoint index = DaoxDataFrame_GetColumnIndex( self, tuple->values[0] );
+		if( index < 0 ) goto InvalidColumn;
+		DArray_PushDaoInt( indices, index );
+		DArray_PushInt( methods, tuple->values[1]->xEnum.value );
+	}
+	if( self->dims[2] > 1 ){
+		DaoProcess_RaiseError( proc, "Param", "grouping is not supported for 3D dataframe" );
+	}else if( DaoxDataFrame_GroupBy( self, result, indices->data.daoints, keys->size,
+				indices->data.daoints + keys->size, methods->data.ints, methods->size ) == 0 ){
+		DaoProcess_RaiseError( proc, "Param", "invalid grouping keys or aggregations" );
+	}
+	DArray_Delete( indices );
+	DArray_Delete( methods );
+	return;
+InvalidColumn:
+	DaoProcess_RaiseError( proc, "Index", "invalid column" );
+	DArray_Delete( indices );
+	DArray_Delete( methods );
+}
+
+
+static void FRAME_Join( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *other = (DaoxDataFrame*) p[1];
+	DaoxDataFrame *result = DaoProcess_MakeReturnDataFrame( proc );
+	DList *keys = p[2]->xList.value;
+	DArray *indices = DArray_New( sizeof(daoint) );
+	daoint i;
+
+	DaoxDataFrame_Sliced( self );
+	DaoxDataFrame_Sliced( other );
+	DArray_Resize( indices, 2*keys->size );
+	for(i=0; i<keys->size; ++i){
+		daoint index1 = DaoxDataFrame_GetColumnIndex( self, keys->items.pValue[i] );
+		daoint index2 = DaoxDataFrame_GetColumnIndex( other, keys->items.pValue[i] );
+		if( index1 < 0 || index2 < 0 ){
+			DaoProcess_RaiseError( proc, "Index", "invalid column" );
+			DArray_Delete( indices );
+			return;
+		}
+		indices->data.daoints[i] = index1;
+		indices->data.daoints[i+keys->size] = index2;
+	}
+	if( self->dims[2] > 1 || other->dims[2] > 1 ){
+		DaoProcess_RaiseError( proc, "Param", "joining is not supported for 3D dataframe" );
+	}else if( DaoxDataFrame_Join( self, other, result, indices->data.daoints,
+				indices->data.daoints + keys->size, keys->size, p[3]->xEnum.value ) == 0 ){
+		DaoProcess_RaiseError( proc, "Param", "invalid or mismatched joining keys" );
+	}
+	DArray_Delete( indices );
+}
+
+
+static void FRAME_SortBy( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *result = DaoProcess_MakeReturnDataFrame( proc );
+	DList *keys = p[1]->xList.value;
+	DArray *indices = DArray_New( sizeof(daoint) );
+	daoint i;
+
+	DaoxDataFrame_Sliced( self );
+	for(i=0; i<keys->size; ++i){
+		daoint index = DaoxDataFrame_GetColumnIndex( self, keys->items.pValue[i] );
+		if( index < 0 ){
+			DaoProcess_RaiseError( proc, "Index", "invalid column" );
+			DArray_Delete( indices );
+			return;
+		}
+		DArray_PushDaoInt( indices, index );
+	}
+	if( self->dims[2] > 1 ){
+		DaoProcess_RaiseError( proc, "Param", "sorting is not supported for 3D dataframe" );
+	}else{
+		DaoxDataFrame_SortBy( self, result, indices->data.daoints, indices->size, p[2]->xBoolean.value );
+	}
+	DArray_Delete( indices );
+}
+static void FRAME_TopK( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataFrame *result = DaoProcess_MakeReturnDataFrame( proc );
+	daoint index;
+
+	DaoxDataFrame_Sliced( self );
+	index = DaoxDataFrame_GetColumnIndex( self, p[1] );
+	if( index < 0 ){
+		DaoProcess_RaiseError( proc, "Index", "invalid column" );
+	}else if( self->dims[2] > 1 ){
+		DaoProcess_RaiseError( proc, "Param", "sorting is not supported for 3D dataframe" );
+	}else{
+		DaoxDataFrame_TopK( self, result, index, p[2]->xInteger.value );
+	}
+}
+
+
+static void FRAME_Lazy( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataFrame *self = (DaoxDataFrame*) p[0];
+	DaoxDataQuery *query = DaoxDataQuery_New( self );
+	DaoProcess_PutValue( proc, (DaoValue*) query );
+}
+
+
 static void FRAME_SLICED( DaoProcess *proc, DaoValue *p[], int npar )
 {
 	DaoxDataFrame *self = (DaoxDataFrame*) proc;
@@ -1825,14 +5144,14 @@ static DaoFunctionEntry daoDataFrameMeths[]=
 	{ FRAME_PRINT,  "Print( self: DataFrame, stream: io::Stream = io::stdio )" },
 	{ FRAME_PRINT,  "(string)( self: DataFrame, stream: io::Stream|none = none )" },
 
-	{ FRAME_ScanCells,  "ScanCells( self: DataFrame )[cell:@T,row:int,column:int,depth:int]" },
-	{ FRAME_UpdateCells, "UpdateCells( self: DataFrame )[cell:@T,row:int,column:int,depth:int=>@T]" },
+	{ FRAME_ScanCells,  "ScanCells( self: DataFrame, parallel = false )[cell:@T,row:int,column:int,depth:int]" },
+	{ FRAME_UpdateCells, "UpdateCells( self: DataFrame, parallel = false )[cell:@T,row:int,column:int,depth:int=>@T]" },
 
-	{ FRAME_ScanRows,  "ScanRows( self: DataFrame )[value:tuple,row:int,depth:int]" },
-	{ FRAME_UpdateRows, "UpdateRows( self: DataFrame )[value:tuple,row:int,depth:int=>tuple]" },
+	{ FRAME_ScanRows,  "ScanRows( self: DataFrame, parallel = false )[value:tuple,row:int,depth:int]" },
+	{ FRAME_UpdateRows, "UpdateRows( self: DataFrame, parallel = false )[value:tuple,row:int,depth:int=>tuple]" },
 
-	{ FRAME_ScanCols,  "ScanColumns( self: DataFrame )[value:tuple,column:int,depth:int]" },
-	{ FRAME_UpdateCols, "UpdateColumns( self: DataFrame )[value:tuple,column:int,depth:int=>tuple]" },
+	{ FRAME_ScanCols,  "ScanColumns( self: DataFrame, parallel = false )[value:tuple,column:int,depth:int]" },
+	{ FRAME_UpdateCols, "UpdateColumns( self: DataFrame, parallel = false )[value:tuple,column:int,depth:int=>tuple]" },
 
 	{ FRAME_AddFrame,     "+=( self: DataFrame, other: DataFrame )" },
 	{ FRAME_SubFrame,     "-=( self: DataFrame, other: DataFrame )" },
@@ -1852,6 +5171,25 @@ static DaoFunctionEntry daoDataFrameMeths[]=
 	{ FRAME_BitOrArray,   "|=( self: DataFrame, other: array<@T> )" },
 	{ FRAME_BitXorArray,  "^=( self: DataFrame, other: array<@T> )" },
 
+	{ FRAME_Encode,  "Encode( self: DataFrame, compress = false ) => string" },
+	{ FRAME_Decode,  "Decode( self: DataFrame, data: string ) => bool" },
+	{ FRAME_Save,    "Save( self: DataFrame, file: string, compress = false )" },
+	{ FRAME_Load,    "Load( self: DataFrame, file: string, mode: enum<copy,mapping> = $mapping )" },
+
+	{ FRAME_ReadCsv,
+		"ReadCsv( self: DataFrame, file: string, separator = ',', header = true, types: list<enum<auto,int,float,string>> = {} )" },
+
+	{ FRAME_GroupBy,
+		"GroupBy( self: DataFrame, keys: list<int|string>, aggregates: list<tuple<column:int|string,method:enum<sum,mean,count,min,max,first>>> ) => DataFrame" },
+	{ FRAME_Join,
+		"Join( self: DataFrame, other: DataFrame, on: list<int|string>, how: enum<inner,left,outer> = $inner ) => DataFrame" },
+
+	{ FRAME_SortBy,
+		"SortBy( self: DataFrame, columns: list<int|string>, descending = false ) => DataFrame" },
+	{ FRAME_TopK,  "TopK( self: DataFrame, column: int|string, k: int ) => DataFrame" },
+
+	{ FRAME_Lazy,  "Lazy( self: DataFrame ) => DataQuery" },
+
 	{ NULL, NULL },
 };
 
@@ -1970,10 +5308,107 @@ DaoTypeCore daoDataFrameCore =
 
 
 
+static void QUERY_Filter( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataQuery *self = (DaoxDataQuery*) p[0];
+	DaoxDataQuery_AddFilter( self, p[1], p[2]->xEnum.value, p[3] );
+	DaoProcess_PutValue( proc, p[0] );
+}
+static void QUERY_Select( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataQuery *self = (DaoxDataQuery*) p[0];
+	DaoxDataQuery_AddSelection( self, p[1]->xList.value );
+	DaoProcess_PutValue( proc, p[0] );
+}
+static void QUERY_Aggregate( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataQuery *self = (DaoxDataQuery*) p[0];
+	DList *aggregates = p[2]->xList.value;
+	DList *columns = DList_New( DAO_DATA_VALUE );
+	DArray *methods = DArray_New( sizeof(int) );
+	daoint i;
+
+	for(i=0; i<aggregates->size; ++i){
+		DaoTuple *tuple = (DaoTuple*) aggregates->items.pValue[i];
+		DList_Append( columns, tuple->values[0] );
+		DArray_PushInt( methods, tuple->values[1]->xEnum.value );
+	}
+	DaoxDataQuery_AddAggregation( self, p[1]->xList.value, columns, methods->data.ints );
+	DaoProcess_PutValue( proc, p[0] );
+	DList_Delete( columns );
+	DArray_Delete( methods );
+}
+static void QUERY_Collect( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoxDataQuery *self = (DaoxDataQuery*) p[0];
+	DaoxDataFrame *result = DaoProcess_MakeReturnDataFrame( proc );
+	if( DaoxDataQuery_Collect( self, result ) == 0 ){
+		DaoProcess_RaiseError( proc, "Param", "invalid column, comparison or aggregation in query" );
+	}
+}
+
+static DaoFunctionEntry daoDataQueryMeths[]=
+{
+	{ QUERY_Filter,
+		"Filter( self: DataQuery, column: int|string, op: enum<eq,ne,lt,le,gt,ge>, value: int|float|string ) => DataQuery" },
+	{ QUERY_Select,
+		"Select( self: DataQuery, columns: list<int|string> ) => DataQuery" },
+	{ QUERY_Aggregate,
+		"Aggregate( self: DataQuery, keys: list<int|string>, aggregates: list<tuple<column:int|string,method:enum<sum,mean,count,min,max,first>>> ) => DataQuery" },
+	{ QUERY_Collect,
+		"Collect( self: DataQuery ) => DataFrame" },
+	{ NULL, NULL },
+};
+
+static void DaoxDataQuery_HandleGC( DaoValue *p, DList *values, DList *arrays, DList *m, int rm )
+{
+	DaoxDataQuery *self = (DaoxDataQuery*) p;
+	daoint i;
+	for(i=0; i<self->steps->size; ++i){
+		DaoxDataStep *step = (DaoxDataStep*) self->steps->items.pVoid[i];
+		DList_Append( arrays, step->values );
+	}
+	if( self->frame ) DList_Append( values, self->frame );
+	if( rm ) self->frame = NULL;
+}
+
+DaoTypeCore daoDataQueryCore =
+{
+	"DataQuery",                                           /* name */
+	sizeof(DaoxDataQuery),                                 /* size */
+	{ NULL },                                              /* bases */
+	{ NULL },                                              /* casts */
+	NULL,                                                  /* numbers */
+	daoDataQueryMeths,                                     /* methods */
+	DaoCstruct_CheckGetField,    DaoCstruct_DoGetField,    /* GetField */
+	DaoCstruct_CheckSetField,    DaoCstruct_DoSetField,    /* SetField */
+	NULL,                        NULL,                     /* GetItem */
+	NULL,                        NULL,                     /* SetItem */
+	NULL,                        NULL,                     /* Unary */
+	NULL,                        NULL,                     /* Binary */
+	NULL,                        NULL,                     /* Conversion */
+	NULL,                        NULL,                     /* ForEach */
+	NULL,                                                  /* Print */
+	NULL,                                                  /* Slice */
+	NULL,                                                  /* Compare */
+	NULL,                                                  /* Hash */
+	NULL,                                                  /* Create */
+	NULL,                                                  /* Copy */
+	(DaoDeleteFunction) DaoxDataQuery_Delete,              /* Delete */
+	DaoxDataQuery_HandleGC                                 /* HandleGC */
+};
+
+
+
 DAO_DLL int DaoDataframe_OnLoad( DaoVmSpace *vmSpace, DaoNamespace *ns )
 {
+#ifdef DAO_WITH_THREAD
+	DMutex_Init( & mutex_mapping );
+	DMutex_Init( & mutex_dictionary );
+#endif
 	DaoNamespace_WrapType( ns, & daoDataColumnCore, DAO_CSTRUCT, 0 );
 	DaoNamespace_WrapType( ns, & daoDataFrameCore, DAO_CSTRUCT, 0 );
+	DaoNamespace_WrapType( ns, & daoDataQueryCore, DAO_CSTRUCT, 0 );
 	DaoNamespace_DefineType( ns, "enum<row,column,depth>", "DataFrame_DimType" );
 	DaoNamespace_DefineType( ns, "none|int|string|tuple<none,none>|tuple<int,int>|tuple<string,string>|tuple<int|string,none>|tuple<none,int|string>", "DataFrame_IndexType" );
 	return 0;
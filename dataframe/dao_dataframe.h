@@ -31,8 +31,11 @@
 #include "dao.h"
 #include "daoStdtype.h"
 
-typedef struct DaoxDataColumn  DaoxDataColumn;
-typedef struct DaoxDataFrame   DaoxDataFrame;
+typedef struct DaoxDataColumn   DaoxDataColumn;
+typedef struct DaoxDataFrame    DaoxDataFrame;
+typedef struct DaoxDataQuery    DaoxDataQuery;
+typedef struct DaoxDataMapping  DaoxDataMapping;
+typedef struct DaoxDataDictionary  DaoxDataDictionary;
 
 enum DaoxDataFrameDims
 {
@@ -41,6 +44,33 @@ enum DaoxDataFrameDims
 	DAOX_DF_DEP 
 };
 
+enum DaoxDataAggregates
+{
+	DAOX_DF_SUM ,
+	DAOX_DF_MEAN ,
+	DAOX_DF_COUNT ,
+	DAOX_DF_MIN ,
+	DAOX_DF_MAX ,
+	DAOX_DF_FIRST
+};
+
+enum DaoxDataJoins
+{
+	DAOX_DF_INNER ,
+	DAOX_DF_LEFT ,
+	DAOX_DF_OUTER
+};
+
+enum DaoxDataComparisons
+{
+	DAOX_DF_EQ ,
+	DAOX_DF_NE ,
+	DAOX_DF_LT ,
+	DAOX_DF_LE ,
+	DAOX_DF_GT ,
+	DAOX_DF_GE
+};
+
 
 
 struct DaoxDataColumn
@@ -49,6 +79,9 @@ struct DaoxDataColumn
 
 	DaoType  *vatype;  // type of the cells;
 	DArray   *cells;   // DArray<daoint|float|double|complex|DString | DaoValue* >
+
+	DaoxDataMapping     *mapping;     // memory mapped file holding the cells;
+	DaoxDataDictionary  *dictionary;  // distinct strings for dictionary encoded string column;
 };
 
 DAO_DLL DaoxDataColumn* DaoxDataColumn_New( DaoVmSpace *vmspace, DaoType *type );
@@ -60,6 +93,8 @@ DAO_DLL void DaoxDataColumn_SetType( DaoxDataColumn *self, DaoType *type );
 DAO_DLL void DaoxDataColumn_SetCell( DaoxDataColumn *self, daoint i, DaoValue *value );
 DAO_DLL DaoValue* DaoxDataColumn_GetCell( DaoxDataColumn *self, daoint i, DaoValue *value );
 
+DAO_DLL int DaoxDataColumn_EncodeStrings( DaoxDataColumn *self, daoint maxcodes );
+
 
 
 struct DaoxDataFrame
@@ -92,7 +127,37 @@ DAO_DLL daoint DaoxDataFrame_GetIndex( DaoxDataFrame *self, int dim, const char
 
 DAO_DLL void DaoxDataFrame_Sliced( DaoxDataFrame *self );
 
-DAO_DLL void DaoxDataFrame_Encode( DaoxDataFrame *self, DString *output );
-DAO_DLL void DaoxDataFrame_Decode( DaoxDataFrame *self, DString *input );
+DAO_DLL int DaoxDataFrame_Encode( DaoxDataFrame *self, DString *output, int compress );
+DAO_DLL int DaoxDataFrame_Decode( DaoxDataFrame *self, DString *input );
+
+DAO_DLL int DaoxDataFrame_Save( DaoxDataFrame *self, const char *file, int compress );
+DAO_DLL int DaoxDataFrame_Load( DaoxDataFrame *self, const char *file, int mapping );
+
+DAO_DLL int DaoxDataFrame_ReadCsv( DaoxDataFrame *self, const char *file, char sep, int header, int types[], int ntype );
+
+DAO_DLL int DaoxDataFrame_GroupBy( DaoxDataFrame *self, DaoxDataFrame *result, daoint keys[], int nkey, daoint columns[], int methods[], int nagg );
+DAO_DLL int DaoxDataFrame_Join( DaoxDataFrame *self, DaoxDataFrame *other, DaoxDataFrame *result, daoint keys1[], daoint keys2[], int nkey, int how );
+
+DAO_DLL int DaoxDataFrame_SortBy( DaoxDataFrame *self, DaoxDataFrame *result, daoint keys[], int nkey, int descending );
+DAO_DLL int DaoxDataFrame_TopK( DaoxDataFrame *self, DaoxDataFrame *result, daoint column, daoint k );
+
+
+
+struct DaoxDataQuery
+{
+	DAO_CSTRUCT_COMMON;
+
+	DaoxDataFrame  *frame;  // the queried dataframe, or a slice of it;
+	DList          *steps;  // DList<DaoxDataStep*>: filtering, selection and aggregation steps;
+};
+
+DAO_DLL DaoxDataQuery* DaoxDataQuery_New( DaoxDataFrame *frame );
+DAO_DLL void DaoxDataQuery_Delete( DaoxDataQuery *self );
+
+DAO_DLL void DaoxDataQuery_AddFilter( DaoxDataQuery *self, DaoValue *column, int op, DaoValue *value );
+DAO_DLL void DaoxDataQuery_AddSelection( DaoxDataQuery *self, DList *columns );
+DAO_DLL void DaoxDataQuery_AddAggregation( DaoxDataQuery *self, DList *keys, DList *columns, int methods[] );
+
+DAO_DLL int DaoxDataQuery_Collect( DaoxDataQuery *self, DaoxDataFrame *result );
 
 #endif
@@ -26,10 +26,22 @@
 */
 
 #include<stdlib.h>
+#include<stdio.h>
+#include<ctype.h>
+#include<string.h>
+#include<stdint.h>
 #include<math.h>
 #include"daoValue.h"
 #include"daoNumtype.h"
+#include"daoString.h"
+#include"daoList.h"
+#include"daoMap.h"
 #include"daoProcess.h"
+#include"daoThread.h"
+
+#ifdef UNIX
+#include<unistd.h>
+#endif
 
 #ifdef _MSC_VER
 #define hypot _hypot
@@ -256,6 +268,1034 @@ static void MATH_min( DaoProcess *proc, DaoValue *p[], int N )
 
 
 
+/*
+// Element-wise array functions:
+//
+// The functions are applied by kernels over contiguous blocks of the arrays;
+// exp() and log() use branch-free polynomial kernels which the compiler can
+// vectorize (they select between results computed for all items, which needs
+// the flags in makefile.dao), the other functions are applied by the
+// C library per element. On x86-64 with GCC, the kernels are also compiled for
+// AVX2 and selected at runtime. Large arrays are split between parallel tasks.
+*/
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define DAO_MATH_KERNEL static __attribute__((target_clones("avx2","default")))
+#else
+#define DAO_MATH_KERNEL static
+#endif
+
+#define DAO_MATH_MAX_THREADS  16
+#define DAO_MATH_MIN_BLOCK    (1<<15)
+
+typedef void (*DaoMathKernel)( const double *x, double *y, daoint n );
+typedef void (*DaoMathKernel2)( const double *x, const double *y, daoint ystep, double *z, daoint n );
+typedef void (*DaoMathComplexKernel)( const dao_complex *x, dao_complex *y, daoint n );
+typedef void (*DaoMathComplexKernel2)( const dao_complex *x, double *y, daoint n );
+
+
+static double DaoMath_FromBits( uint64_t bits )
+{
+	double x;
+	memcpy( & x, & bits, sizeof(x) );
+	return x;
+}
+static uint64_t DaoMath_ToBits( double x )
+{
+	uint64_t bits;
+	memcpy( & bits, & x, sizeof(x) );
+	return bits;
+}
+
+/*
+// Small integers are converted between doubles and the exponent bits by adding
+// 1.5*2^52 (or 2^52), which only needs operations available in SSE2 vectors:
+*/
+#define DAO_MATH_SHIFTER  6755399441055744.0
+#define DAO_MATH_SHIFTER_BITS  0x4338000000000000ULL
+
+/*
+// exp(x) = 2^k * exp(r), with k = round(x/ln2) and |r| <= ln2/2; exp(r) is
+// approximated by its Taylor polynomial of degree 12 (relative error < 2e-16);
+// 2^k is applied as two factors so that results in the subnormal range and
+// overflows to infinity come out of the multiplications.
+*/
+DAO_MATH_KERNEL void DaoMath_ExpKernel( const double *x, double *y, daoint n )
+{
+	const double ln2hi = 6.93147180369123816490e-01;
+	const double ln2lo = 1.90821492927058770002e-10;
+	daoint i;
+	for(i=0; i<n; ++i){
+		int high = x[i] > 710.0, low = x[i] < -746.0, valid = x[i] == x[i];
+		double v = high ? 710.0 : (low ? -746.0 : x[i]);
+		double k = (v * 1.4426950408889634074 + DAO_MATH_SHIFTER) - DAO_MATH_SHIFTER;
+		double k1 = (k * 0.5 + DAO_MATH_SHIFTER) - DAO_MATH_SHIFTER;
+		double k2 = k - k1;
+		double r = (v - k * ln2hi) - k * ln2lo;
+		double p = 1.0/479001600.0;
+		p = p * r + 1.0/39916800.0;
+		p = p * r + 1.0/3628800.0;
+		p = p * r + 1.0/362880.0;
+		p = p * r + 1.0/40320.0;
+		p = p * r + 1.0/5040.0;
+		p = p * r + 1.0/720.0;
+		p = p * r + 1.0/120.0;
+		p = p * r + 1.0/24.0;
+		p = p * r + 1.0/6.0;
+		p = p * r + 0.5;
+		p = 1.0 + (r + r * r * p);
+		p *= DaoMath_FromBits( (DaoMath_ToBits( k1 + DAO_MATH_SHIFTER ) - DAO_MATH_SHIFTER_BITS + 1023) << 52 );
+		p *= DaoMath_FromBits( (DaoMath_ToBits( k2 + DAO_MATH_SHIFTER ) - DAO_MATH_SHIFTER_BITS + 1023) << 52 );
+		y[i] = valid ? p : x[i];
+	}
+}
+
+/*
+// log(x) = e*ln2 + log(m), with x = m * 2^e and sqrt(1/2) <= m < sqrt(2);
+// log(m) = 2*atanh(s) with s = (m-1)/(m+1), |s| < 0.172, approximated by
+// its odd series up to s^23; subnormal inputs are scaled by 2^54 first.
+*/
+DAO_MATH_KERNEL void DaoMath_LogKernel( const double *x, double *y, daoint n )
+{
+	const double ln2hi = 6.93147180369123816490e-01;
+	const double ln2lo = 1.90821492927058770002e-10;
+	daoint i;
+	for(i=0; i<n; ++i){
+		double v = x[i];
+		int small = v < 2.2250738585072014e-308, zero = v == 0.0, inf = v == HUGE_VAL;
+		int valid = (v > 0.0) & (v < HUGE_VAL);
+		double scaled = v * 18014398509481984.0;
+		double u = small ? scaled : v;
+		uint64_t bits = DaoMath_ToBits( u );
+		double e = DaoMath_FromBits( (bits >> 52) | 0x4330000000000000ULL ) - (4503599627370496.0 + 1023.0);
+		double m = DaoMath_FromBits( (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL );
+		double half = 0.5 * m;
+		int big = m > 1.41421356237309504880;
+		double f, s, z, hf, p, special;
+		e -= small ? 54.0 : 0.0;
+		e += big ? 1.0 : 0.0;
+		m = big ? half : m;
+		f = m - 1.0;
+		s = f / (m + 1.0);
+		z = s * s;
+		hf = 0.5 * f * f;
+		p = 1.0/23.0;
+		p = p * z + 1.0/21.0;
+		p = p * z + 1.0/19.0;
+		p = p * z + 1.0/17.0;
+		p = p * z + 1.0/15.0;
+		p = p * z + 1.0/13.0;
+		p = p * z + 1.0/11.0;
+		p = p * z + 1.0/9.0;
+		p = p * z + 1.0/7.0;
+		p = p * z + 1.0/5.0;
+		p = p * z + 1.0/3.0;
+		p = 2.0 * z * p;  /* log(m) = f - hf + s*(hf + p); */
+		p = e * ln2hi + (f - (hf - (s * (hf + p) + e * ln2lo)));
+		special = zero ? -HUGE_VAL : (inf ? HUGE_VAL : NAN);
+		y[i] = valid ? p : special;
+	}
+}
+
+DAO_MATH_KERNEL void DaoMath_SqrtKernel( const double *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = sqrt( x[i] );
+}
+DAO_MATH_KERNEL void DaoMath_AbsKernel( const double *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = fabs( x[i] );
+}
+DAO_MATH_KERNEL void DaoMath_FloorKernel( const double *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = floor( x[i] );
+}
+DAO_MATH_KERNEL void DaoMath_CeilKernel( const double *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = ceil( x[i] );
+}
+DAO_MATH_KERNEL void DaoMath_RoundKernel( const double *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = x[i] > 0 ? floor( x[i] + 0.5 ) : ceil( x[i] - 0.5 );
+}
+
+#define DAO_MATH_LIBM_KERNEL( name, func ) \
+static void DaoMath_##name##Kernel( const double *x, double *y, daoint n ) \
+{ \
+	daoint i; \
+	for(i=0; i<n; ++i) y[i] = func( x[i] ); \
+}
+
+DAO_MATH_LIBM_KERNEL( Acos, acos )
+DAO_MATH_LIBM_KERNEL( Asin, asin )
+DAO_MATH_LIBM_KERNEL( Atan, atan )
+DAO_MATH_LIBM_KERNEL( Cos, cos )
+DAO_MATH_LIBM_KERNEL( Cosh, cosh )
+DAO_MATH_LIBM_KERNEL( Sin, sin )
+DAO_MATH_LIBM_KERNEL( Sinh, sinh )
+DAO_MATH_LIBM_KERNEL( Tan, tan )
+DAO_MATH_LIBM_KERNEL( Tanh, tanh )
+
+#define DAO_MATH_LIBM_KERNEL2( name, func ) \
+static void DaoMath_##name##Kernel( const double *x, const double *y, daoint ystep, double *z, daoint n ) \
+{ \
+	daoint i; \
+	for(i=0; i<n; ++i) z[i] = func( x[i], y[i*ystep] ); \
+}
+
+DAO_MATH_LIBM_KERNEL2( Pow, pow )
+DAO_MATH_LIBM_KERNEL2( Hypot, hypot )
+DAO_MATH_LIBM_KERNEL2( Atan2, atan2 )
+DAO_MATH_LIBM_KERNEL2( Copysign, copysign )
+DAO_MATH_LIBM_KERNEL2( Max, fmax )
+DAO_MATH_LIBM_KERNEL2( Min, fmin )
+
+#define DAO_MATH_COMPLEX_KERNEL( name, func ) \
+static void DaoMath_##name##ComplexKernel( const dao_complex *x, dao_complex *y, daoint n ) \
+{ \
+	daoint i; \
+	for(i=0; i<n; ++i) y[i] = func( x[i] ); \
+}
+
+static dao_complex DaoMath_TanComplex( dao_complex com )
+{
+	dao_complex res, R = sin_c( com ), L = cos_c( com );
+	res.real = ( L.real*R.real + L.imag*R.imag ) / ( R.real*R.real + R.imag*R.imag );
+	res.imag = ( L.imag*R.real - L.real*R.imag ) / ( R.real*R.real + R.imag*R.imag );
+	return res;
+}
+static dao_complex DaoMath_TanhComplex( dao_complex com )
+{
+	dao_complex res, R = sinh_c( com ), L = cosh_c( com );
+	res.real = ( L.real*R.real + L.imag*R.imag ) / ( R.real*R.real + R.imag*R.imag );
+	res.imag = ( L.imag*R.real - L.real*R.imag ) / ( R.real*R.real + R.imag*R.imag );
+	return res;
+}
+
+DAO_MATH_COMPLEX_KERNEL( Cos, cos_c )
+DAO_MATH_COMPLEX_KERNEL( Cosh, cosh_c )
+DAO_MATH_COMPLEX_KERNEL( Exp, exp_c )
+DAO_MATH_COMPLEX_KERNEL( Log, log_c )
+DAO_MATH_COMPLEX_KERNEL( Sin, sin_c )
+DAO_MATH_COMPLEX_KERNEL( Sinh, sinh_c )
+DAO_MATH_COMPLEX_KERNEL( Sqrt, sqrt_c )
+DAO_MATH_COMPLEX_KERNEL( Tan, DaoMath_TanComplex )
+DAO_MATH_COMPLEX_KERNEL( Tanh, DaoMath_TanhComplex )
+
+static void DaoMath_AbsComplexKernel( const dao_complex *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = sqrt( x[i].real * x[i].real + x[i].imag * x[i].imag );
+}
+static void DaoMath_ArgComplexKernel( const dao_complex *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = arg_c( x[i] );
+}
+static void DaoMath_NormComplexKernel( const dao_complex *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = x[i].real * x[i].real + x[i].imag * x[i].imag;
+}
+static void DaoMath_RealComplexKernel( const dao_complex *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = x[i].real;
+}
+static void DaoMath_ImagComplexKernel( const dao_complex *x, double *y, daoint n )
+{
+	daoint i;
+	for(i=0; i<n; ++i) y[i] = x[i].imag;
+}
+
+
+/*
+// Fused expression evaluation:
+//
+// An element-wise expression over arrays and scalars is compiled once into a
+// postfix program, which is then run block by block over the operands. The
+// intermediate results of a block stay in the cache, and no temporary array
+// is allocated for the subexpressions. Each stack slot of the program holds
+// either a block of values or a single value to be broadcasted.
+*/
+
+#define DAO_MATH_EVAL_BLOCK  256
+#define DAO_MATH_EVAL_DEPTH  8     /* program stack depth of the buffers on the C stack; */
+#define DAO_MATH_EVAL_CACHE  64
+
+enum DaoMathOpcodes
+{
+	DAO_MATH_OP_VAR ,      /* push a variable; */
+	DAO_MATH_OP_CONST ,    /* push a constant; */
+	DAO_MATH_OP_NEG ,
+	DAO_MATH_OP_SQUARE ,
+	DAO_MATH_OP_ADD ,
+	DAO_MATH_OP_SUB ,
+	DAO_MATH_OP_MUL ,
+	DAO_MATH_OP_DIV ,
+	DAO_MATH_OP_CALL ,     /* apply an unary kernel; */
+	DAO_MATH_OP_CALL2      /* apply a binary kernel; */
+};
+
+typedef struct DaoMathInstr    DaoMathInstr;
+typedef struct DaoMathProgram  DaoMathProgram;
+typedef struct DaoMathParser   DaoMathParser;
+typedef struct DaoMathOperand  DaoMathOperand;
+typedef struct DaoMathSlot     DaoMathSlot;
+
+struct DaoMathInstr
+{
+	int      opcode;
+	int      index;    /* variable index; */
+	double   value;    /* constant value; */
+	void    *kernel;
+};
+
+struct DaoMathProgram
+{
+	DaoMathInstr  *codes;
+	int            count;
+	int            capacity;
+	int            depth;   /* maximum stack depth; */
+	DList         *names;   /* variable names; */
+};
+
+struct DaoMathParser
+{
+	DaoMathProgram  *program;
+	const char      *source;
+	const char      *pos;
+	const char      *error;
+	int              depth;
+};
+
+struct DaoMathOperand
+{
+	double  *data;
+	double   scalar;
+	int      step;    /* 1 for arrays, 0 for scalars; */
+};
+
+struct DaoMathSlot
+{
+	double  *data;
+	int      step;
+};
+
+static struct { const char *name; int arity; void *kernel; } dao_math_eval_functions[] =
+{
+	{ "abs",      1, DaoMath_AbsKernel },
+	{ "acos",     1, DaoMath_AcosKernel },
+	{ "asin",     1, DaoMath_AsinKernel },
+	{ "atan",     1, DaoMath_AtanKernel },
+	{ "ceil",     1, DaoMath_CeilKernel },
+	{ "cos",      1, DaoMath_CosKernel },
+	{ "cosh",     1, DaoMath_CoshKernel },
+	{ "exp",      1, DaoMath_ExpKernel },
+	{ "floor",    1, DaoMath_FloorKernel },
+	{ "log",      1, DaoMath_LogKernel },
+	{ "round",    1, DaoMath_RoundKernel },
+	{ "sin",      1, DaoMath_SinKernel },
+	{ "sinh",     1, DaoMath_SinhKernel },
+	{ "sqrt",     1, DaoMath_SqrtKernel },
+	{ "tan",      1, DaoMath_TanKernel },
+	{ "tanh",     1, DaoMath_TanhKernel },
+	{ "pow",      2, DaoMath_PowKernel },
+	{ "hypot",    2, DaoMath_HypotKernel },
+	{ "atan2",    2, DaoMath_Atan2Kernel },
+	{ "copysign", 2, DaoMath_CopysignKernel },
+	{ "max",      2, DaoMath_MaxKernel },
+	{ "min",      2, DaoMath_MinKernel },
+	{ NULL, 0, NULL }
+};
+
+static DaoMathProgram* DaoMathProgram_New()
+{
+	DaoMathProgram *self = (DaoMathProgram*) dao_calloc( 1, sizeof(DaoMathProgram) );
+	self->names = DList_New( DAO_DATA_STRING );
+	return self;
+}
+static void DaoMathProgram_Delete( DaoMathProgram *self )
+{
+	DList_Delete( self->names );
+	dao_free( self->codes );
+	dao_free( self );
+}
+
+static double DaoMath_Compute( DaoMathInstr *instr, double x, double y )
+{
+	double z = 0.0;
+	switch( instr->opcode ){
+	case DAO_MATH_OP_NEG    : z = - x; break;
+	case DAO_MATH_OP_SQUARE : z = x * x; break;
+	case DAO_MATH_OP_ADD    : z = x + y; break;
+	case DAO_MATH_OP_SUB    : z = x - y; break;
+	case DAO_MATH_OP_MUL    : z = x * y; break;
+	case DAO_MATH_OP_DIV    : z = x / y; break;
+	case DAO_MATH_OP_CALL   : ((DaoMathKernel) instr->kernel)( & x, & z, 1 ); break;
+	case DAO_MATH_OP_CALL2  : ((DaoMathKernel2) instr->kernel)( & x, & y, 0, & z, 1 ); break;
+	}
+	return z;
+}
+
+/* Append an instruction, folding the operations on constants: */
+static void DaoMathParser_Emit( DaoMathParser *self, int opcode, int index, double value, void *kernel )
+{
+	DaoMathProgram *program = self->program;
+	DaoMathInstr *codes = program->codes;
+	DaoMathInstr instr;
+	int n = program->count;
+
+	instr.opcode = opcode;
+	instr.index = index;
+	instr.value = value;
+	instr.kernel = kernel;
+	switch( opcode ){
+	case DAO_MATH_OP_VAR :
+	case DAO_MATH_OP_CONST :
+		self->depth += 1;
+		if( self->depth > program->depth ) program->depth = self->depth;
+		break;
+	case DAO_MATH_OP_NEG :
+	case DAO_MATH_OP_SQUARE :
+	case DAO_MATH_OP_CALL :
+		if( n >= 1 && codes[n-1].opcode == DAO_MATH_OP_CONST ){
+			codes[n-1].value = DaoMath_Compute( & instr, codes[n-1].value, 0.0 );
+			return;
+		}
+		break;
+	default :
+		self->depth -= 1;
+		if( n >= 2 && codes[n-1].opcode == DAO_MATH_OP_CONST && codes[n-2].opcode == DAO_MATH_OP_CONST ){
+			codes[n-2].value = DaoMath_Compute( & instr, codes[n-2].value, codes[n-1].value );
+			program->count -= 1;
+			return;
+		}
+		break;
+	}
+	if( program->count >= program->capacity ){
+		program->capacity = 2 * program->capacity + 8;
+		program->codes = (DaoMathInstr*) dao_realloc( codes, program->capacity * sizeof(DaoMathInstr) );
+	}
+	program->codes[ program->count ++ ] = instr;
+}
+
+static void DaoMathParser_SkipSpaces( DaoMathParser *self )
+{
+	while( isspace( (unsigned char) *self->pos ) ) self->pos += 1;
+}
+
+static int DaoMathParser_Expect( DaoMathParser *self, char ch )
+{
+	DaoMathParser_SkipSpaces( self );
+	if( *self->pos != ch ){
+		self->error = ch == ')' ? "expecting \")\"" : "expecting \",\"";
+		return 0;
+	}
+	self->pos += 1;
+	return 1;
+}
+
+static int DaoMathParser_ParseSum( DaoMathParser *self );
+static int DaoMathParser_ParseUnary( DaoMathParser *self );
+
+static int DaoMathParser_ParseCall( DaoMathParser *self, const char *name, int len )
+{
+	int i, arity;
+	for(i=0; dao_math_eval_functions[i].name; ++i){
+		const char *fname = dao_math_eval_functions[i].name;
+		if( strlen( fname ) == (size_t) len && strncmp( fname, name, len ) == 0 ) break;
+	}
+	if( dao_math_eval_functions[i].name == NULL ){
+		self->pos = name;
+		self->error = "unknown function";
+		return 0;
+	}
+	arity = dao_math_eval_functions[i].arity;
+	self->pos += 1; /* ( */
+	if( DaoMathParser_ParseSum( self ) == 0 ) return 0;
+	if( arity == 2 ){
+		if( DaoMathParser_Expect( self, ',' ) == 0 ) return 0;
+		if( DaoMathParser_ParseSum( self ) == 0 ) return 0;
+	}
+	if( DaoMathParser_Expect( self, ')' ) == 0 ) return 0;
+	arity = arity == 1 ? DAO_MATH_OP_CALL : DAO_MATH_OP_CALL2;
+	DaoMathParser_Emit( self, arity, 0, 0.0, dao_math_eval_functions[i].kernel );
+	return 1;
+}
+
+static int DaoMathParser_ParsePrimary( DaoMathParser *self )
+{
+	DaoMathProgram *program = self->program;
+	const char *start;
+	char *end;
+	int i;
+
+	DaoMathParser_SkipSpaces( self );
+	start = self->pos;
+	if( isdigit( (unsigned char) *start ) || (*start == '.' && isdigit( (unsigned char) start[1] )) ){
+		double value = strtod( start, & end );
+		self->pos = end;
+		DaoMathParser_Emit( self, DAO_MATH_OP_CONST, 0, value, NULL );
+		return 1;
+	}else if( isalpha( (unsigned char) *start ) || *start == '_' ){
+		DString name;
+		while( isalnum( (unsigned char) *self->pos ) || *self->pos == '_' ) self->pos += 1;
+		name = DString_WrapBytes( start, self->pos - start );
+		DaoMathParser_SkipSpaces( self );
+		if( *self->pos == '(' ) return DaoMathParser_ParseCall( self, start, name.size );
+		for(i=0; i<program->names->size; ++i){
+			if( DString_EQ( program->names->items.pString[i], & name ) ) break;
+		}
+		if( i == program->names->size ) DList_Append( program->names, & name );
+		DaoMathParser_Emit( self, DAO_MATH_OP_VAR, i, 0.0, NULL );
+		return 1;
+	}else if( *start == '(' ){
+		self->pos += 1;
+		if( DaoMathParser_ParseSum( self ) == 0 ) return 0;
+		return DaoMathParser_Expect( self, ')' );
+	}
+	self->error = *start ? "unexpected symbol" : "unexpected end";
+	return 0;
+}
+
+/* Power is right associative and binds tighter than the unary operators: */
+static int DaoMathParser_ParsePower( DaoMathParser *self )
+{
+	DaoMathInstr *last;
+
+	if( DaoMathParser_ParsePrimary( self ) == 0 ) return 0;
+	DaoMathParser_SkipSpaces( self );
+	if( self->pos[0] != '*' || self->pos[1] != '*' ) return 1;
+	self->pos += 2;
+	if( DaoMathParser_ParseUnary( self ) == 0 ) return 0;
+	last = self->program->codes + self->program->count - 1;
+	if( last->opcode == DAO_MATH_OP_CONST && (last->value == 2.0 || last->value == 0.5) ){
+		double value = last->value;
+		self->program->count -= 1;
+		self->depth -= 1;
+		if( value == 2.0 ){
+			DaoMathParser_Emit( self, DAO_MATH_OP_SQUARE, 0, 0.0, NULL );
+		}else{
+			DaoMathParser_Emit( self, DAO_MATH_OP_CALL, 0, 0.0, DaoMath_SqrtKernel );
+		}
+		return 1;
+	}
+	DaoMathParser_Emit( self, DAO_MATH_OP_CALL2, 0, 0.0, DaoMath_PowKernel );
+	return 1;
+}
+
+static int DaoMathParser_ParseUnary( DaoMathParser *self )
+{
+	DaoMathParser_SkipSpaces( self );
+	if( *self->pos == '+' ){
+		self->pos += 1;
+		return DaoMathParser_ParseUnary( self );
+	}else if( *self->pos == '-' ){
+		self->pos += 1;
+		if( DaoMathParser_ParseUnary( self ) == 0 ) return 0;
+		DaoMathParser_Emit( self, DAO_MATH_OP_NEG, 0, 0.0, NULL );
+		return 1;
+	}
+	return DaoMathParser_ParsePower( self );
+}
+
+static int DaoMathParser_ParseProduct( DaoMathParser *self )
+{
+	if( DaoMathParser_ParseUnary( self ) == 0 ) return 0;
+	while(1){
+		int opcode;
+		DaoMathParser_SkipSpaces( self );
+		if( self->pos[0] == '*' && self->pos[1] != '*' ){
+			opcode = DAO_MATH_OP_MUL;
+		}else if( self->pos[0] == '/' ){
+			opcode = DAO_MATH_OP_DIV;
+		}else{
+			break;
+		}
+		self->pos += 1;
+		if( DaoMathParser_ParseUnary( self ) == 0 ) return 0;
+		DaoMathParser_Emit( self, opcode, 0, 0.0, NULL );
+	}
+	return 1;
+}
+
+static int DaoMathParser_ParseSum( DaoMathParser *self )
+{
+	if( DaoMathParser_ParseProduct( self ) == 0 ) return 0;
+	while(1){
+		int opcode;
+		DaoMathParser_SkipSpaces( self );
+		if( *self->pos == '+' ){
+			opcode = DAO_MATH_OP_ADD;
+		}else if( *self->pos == '-' ){
+			opcode = DAO_MATH_OP_SUB;
+		}else{
+			break;
+		}
+		self->pos += 1;
+		if( DaoMathParser_ParseProduct( self ) == 0 ) return 0;
+		DaoMathParser_Emit( self, opcode, 0, 0.0, NULL );
+	}
+	return 1;
+}
+
+/*
+// Compile the expression; on failure, the error message is written into the
+// message buffer and zero is returned:
+*/
+static int DaoMathProgram_Compile( DaoMathProgram *self, DString *source, char *message, int size )
+{
+	DaoMathParser parser;
+
+	memset( & parser, 0, sizeof(DaoMathParser) );
+	parser.program = self;
+	parser.source = parser.pos = source->chars;
+	if( DaoMathParser_ParseSum( & parser ) ){
+		DaoMathParser_SkipSpaces( & parser );
+		if( *parser.pos == '\0' ) return 1;
+		parser.error = "unexpected symbol";
+	}
+	snprintf( message, size, "invalid expression, %s at position %i", parser.error, (int)(parser.pos - parser.source) );
+	return 0;
+}
+
+#define DAO_MATH_EVAL_ARITH( OP ) \
+	if( x->step && y->step ){ \
+		for(j=0; j<n; ++j) res[j] = a[j] OP b[j]; \
+	}else if( x->step ){ \
+		double bs = b[0]; \
+		for(j=0; j<n; ++j) res[j] = a[j] OP bs; \
+	}else if( y->step ){ \
+		double as = a[0]; \
+		for(j=0; j<n; ++j) res[j] = as OP b[j]; \
+	}else{ \
+		res[0] = a[0] OP b[0]; \
+	}
+
+/*
+// Run the program over the items [first,first+n) of the operands (n is at most
+// DAO_MATH_EVAL_BLOCK), and store the results in "out":
+*/
+DAO_MATH_KERNEL void DaoMathProgram_RunBlock( DaoMathProgram *self, DaoMathOperand *operands, DaoMathSlot *slots, double *buffer, daoint first, double *out, daoint n )
+{
+	DaoMathOperand *operand;
+	DaoMathSlot *x, *y;
+	const double *a, *b;
+	double *res;
+	daoint j, m;
+	int i, sp = 0;
+
+	for(i=0; i<self->count; ++i){
+		DaoMathInstr *instr = self->codes + i;
+		switch( instr->opcode ){
+		case DAO_MATH_OP_VAR :
+			operand = operands + instr->index;
+			slots[sp].data = operand->step ? operand->data + first : & operand->scalar;
+			slots[sp].step = operand->step;
+			sp += 1;
+			break;
+		case DAO_MATH_OP_CONST :
+			slots[sp].data = & instr->value;
+			slots[sp].step = 0;
+			sp += 1;
+			break;
+		case DAO_MATH_OP_NEG :
+		case DAO_MATH_OP_SQUARE :
+		case DAO_MATH_OP_CALL :
+			x = slots + sp - 1;
+			a = x->data;
+			res = buffer + (sp - 1) * DAO_MATH_EVAL_BLOCK;
+			m = x->step ? n : 1;
+			if( instr->opcode == DAO_MATH_OP_NEG ){
+				for(j=0; j<m; ++j) res[j] = - a[j];
+			}else if( instr->opcode == DAO_MATH_OP_SQUARE ){
+				for(j=0; j<m; ++j) res[j] = a[j] * a[j];
+			}else{
+				((DaoMathKernel) instr->kernel)( a, res, m );
+			}
+			x->data = res;
+			break;
+		case DAO_MATH_OP_CALL2 :
+			x = slots + sp - 2;
+			y = slots + sp - 1;
+			res = buffer + (sp - 2) * DAO_MATH_EVAL_BLOCK;
+			if( x->step == 0 && y->step ){
+				double as = x->data[0];
+				for(j=0; j<n; ++j) res[j] = as;
+				x->data = res;
+				x->step = 1;
+			}
+			m = x->step ? n : 1;
+			((DaoMathKernel2) instr->kernel)( x->data, y->data, y->step, res, m );
+			x->data = res;
+			sp -= 1;
+			break;
+		default :
+			x = slots + sp - 2;
+			y = slots + sp - 1;
+			a = x->data;
+			b = y->data;
+			res = buffer + (sp - 2) * DAO_MATH_EVAL_BLOCK;
+			switch( instr->opcode ){
+			case DAO_MATH_OP_ADD : DAO_MATH_EVAL_ARITH( + ); break;
+			case DAO_MATH_OP_SUB : DAO_MATH_EVAL_ARITH( - ); break;
+			case DAO_MATH_OP_MUL : DAO_MATH_EVAL_ARITH( * ); break;
+			case DAO_MATH_OP_DIV : DAO_MATH_EVAL_ARITH( / ); break;
+			}
+			x->data = res;
+			x->step |= y->step;
+			sp -= 1;
+			break;
+		}
+	}
+	if( slots[0].step ){
+		memmove( out, slots[0].data, n * sizeof(double) );
+	}else{
+		double value = slots[0].data[0];
+		for(j=0; j<n; ++j) out[j] = value;
+	}
+}
+
+static void DaoMathProgram_Run( DaoMathProgram *self, DaoMathOperand *operands, DaoMathSlot *slots, double *buffer, daoint first, double *out, daoint n )
+{
+	daoint i, m;
+	for(i=0; i<n; i+=m){
+		m = n - i;
+		if( m > DAO_MATH_EVAL_BLOCK ) m = DAO_MATH_EVAL_BLOCK;
+		DaoMathProgram_RunBlock( self, operands, slots, buffer, first + i, out + i, m );
+	}
+}
+
+
+enum DaoMathJobKinds
+{
+	DAO_MATH_UNARY ,         /* array<float> => array<float>; */
+	DAO_MATH_BINARY ,        /* array<float>, array<float>|float => array<float>; */
+	DAO_MATH_COMPLEX ,       /* array<complex> => array<complex>; */
+	DAO_MATH_COMPLEX_REAL ,  /* array<complex> => array<float>; */
+	DAO_MATH_EXPRESSION      /* compiled expression => array<float>; */
+};
+
+typedef struct DaoMathJob  DaoMathJob;
+typedef struct DaoMathTask DaoMathTask;
+
+struct DaoMathJob
+{
+	int        kind;
+	void      *kernel;
+	DaoArray  *x;       /* contiguous; */
+	DaoArray  *y;       /* contiguous, or NULL for the scalar operand; */
+	double     scalar;
+	DaoArray  *out;     /* possibly a slice; */
+	daoint     start;   /* work range of "out"; */
+	daoint     len;
+	daoint     step;
+
+	DaoMathProgram  *program;
+	DaoMathOperand  *operands;
+};
+
+struct DaoMathTask
+{
+	DaoMathJob  *job;
+	daoint       first;
+	daoint       end;
+};
+
+/* Apply the kernel to the items [first,end), run by run of the output slice: */
+static void DaoMathJob_Run( DaoMathJob *self, daoint first, daoint end )
+{
+	DaoMathSlot stackSlots[DAO_MATH_EVAL_DEPTH];
+	double stackBuffer[DAO_MATH_EVAL_DEPTH * DAO_MATH_EVAL_BLOCK];
+	DaoMathSlot *slots = stackSlots;
+	double *buffer = stackBuffer;
+	daoint i, n;
+
+	/* The rare programs of deeper stacks use buffers on the heap: */
+	if( self->kind == DAO_MATH_EXPRESSION && self->program->depth > DAO_MATH_EVAL_DEPTH ){
+		int depth = self->program->depth;
+		slots = (DaoMathSlot*) dao_malloc( depth * sizeof(DaoMathSlot) );
+		buffer = (double*) dao_malloc( depth * DAO_MATH_EVAL_BLOCK * sizeof(double) );
+	}
+	for(i=first; i<end; i+=n){
+		daoint j = self->start + (i / self->len) * self->step + (i % self->len);
+		n = self->len - (i % self->len);
+		if( n > end - i ) n = end - i;
+		switch( self->kind ){
+		case DAO_MATH_UNARY :
+			((DaoMathKernel) self->kernel)( self->x->data.f + i, self->out->data.f + j, n );
+			break;
+		case DAO_MATH_BINARY :
+			if( self->y ){
+				((DaoMathKernel2) self->kernel)( self->x->data.f + i, self->y->data.f + i, 1, self->out->data.f + j, n );
+			}else{
+				((DaoMathKernel2) self->kernel)( self->x->data.f + i, & self->scalar, 0, self->out->data.f + j, n );
+			}
+			break;
+		case DAO_MATH_COMPLEX :
+			((DaoMathComplexKernel) self->kernel)( self->x->data.c + i, self->out->data.c + j, n );
+			break;
+		case DAO_MATH_COMPLEX_REAL :
+			((DaoMathComplexKernel2) self->kernel)( self->x->data.c + i, self->out->data.f + j, n );
+			break;
+		case DAO_MATH_EXPRESSION :
+			DaoMathProgram_Run( self->program, self->operands, slots, buffer, i, self->out->data.f + j, n );
+			break;
+		}
+	}
+	if( slots != stackSlots ) dao_free( slots );
+	if( buffer != stackBuffer ) dao_free( buffer );
+}
+
+static void DaoMathTask_Run( void *p )
+{
+	DaoMathTask *task = (DaoMathTask*) p;
+	DaoMathJob_Run( task->job, task->first, task->end );
+}
+
+static int DaoMath_GetTaskCount( daoint count )
+{
+	daoint tasks = 1;
+#if defined(DAO_WITH_THREAD) && defined(UNIX)
+	tasks = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	if( tasks > DAO_MATH_MAX_THREADS ) tasks = DAO_MATH_MAX_THREADS;
+	if( count / DAO_MATH_MIN_BLOCK < tasks ) tasks = count / DAO_MATH_MIN_BLOCK;
+	return tasks < 1 ? 1 : tasks;
+}
+
+static void DaoMathJob_Execute( DaoMathJob *self, daoint count )
+{
+	DaoMathTask tasks[DAO_MATH_MAX_THREADS];
+#ifdef DAO_WITH_THREAD
+	DThread threads[DAO_MATH_MAX_THREADS];
+#endif
+	int i, ntask = DaoMath_GetTaskCount( count );
+	for(i=0; i<ntask; ++i){
+		tasks[i].job = self;
+		tasks[i].first = (count * i) / ntask;
+		tasks[i].end = (count * (i + 1)) / ntask;
+	}
+#ifdef DAO_WITH_THREAD
+	for(i=0; i<ntask-1; ++i){
+		DThread_Init( & threads[i] );
+		DThread_Start( & threads[i], DaoMathTask_Run, & tasks[i] );
+	}
+	DaoMathTask_Run( & tasks[ntask-1] );
+	for(i=0; i<ntask-1; ++i){
+		DThread_Join( & threads[i] );
+		DThread_Destroy( & threads[i] );
+	}
+#else
+	for(i=0; i<ntask; ++i) DaoMathTask_Run( & tasks[i] );
+#endif
+}
+
+/*
+// Set up the output of the job: the result is written into the "out" parameter
+// if it is an array, otherwise into a new array of the same shape as "shape":
+*/
+static int DaoMath_PrepareOutput( DaoProcess *proc, DaoMathJob *job, DaoValue *out, DaoArray *shape, int restype )
+{
+	DaoArray *res;
+	if( out->type == DAO_ARRAY ){
+		res = (DaoArray*) out;
+		if( DaoArray_GetWorkSize( res ) != shape->size ){
+			DaoProcess_RaiseError( proc, "Param", "output array size not matching" );
+			return 0;
+		}
+		job->start = DaoArray_GetWorkStart( res );
+		job->len = DaoArray_GetWorkIntervalSize( res );
+		job->step = DaoArray_GetWorkStep( res );
+		job->out = DaoArray_GetWorkArray( res );
+		DaoProcess_PutValue( proc, (DaoValue*) res );
+	}else{
+		res = DaoProcess_PutArray( proc );
+		DaoArray_SetNumType( res, restype );
+		DaoArray_ResizeArray( res, shape->dims, shape->ndim );
+		job->out = res;
+		job->start = 0;
+		job->len = job->step = res->size ? res->size : 1;
+	}
+	return 1;
+}
+
+/*
+// Apply the kernel to the array parameter, the result is written into the
+// "out" parameter (the last one) if it is not none, otherwise into a new array
+// of the same shape as the input:
+*/
+static void DaoMath_ApplyKernel( DaoProcess *proc, DaoValue *p[], int N, int kind, void *kernel )
+{
+	DaoMathJob job;
+	int restype = kind == DAO_MATH_COMPLEX ? DAO_COMPLEX : DAO_FLOAT;
+
+	memset( & job, 0, sizeof(DaoMathJob) );
+	job.kind = kind;
+	job.kernel = kernel;
+	job.x = (DaoArray*) p[0];
+	DaoArray_Sliced( job.x );
+	if( kind == DAO_MATH_BINARY ){
+		if( p[1]->type == DAO_ARRAY ){
+			job.y = (DaoArray*) p[1];
+			DaoArray_Sliced( job.y );
+			if( job.y->size != job.x->size ){
+				DaoProcess_RaiseError( proc, "Param", "array size not matching" );
+				return;
+			}
+		}else{
+			job.scalar = p[1]->xFloat.value;
+		}
+	}
+	if( DaoMath_PrepareOutput( proc, & job, p[N-1], job.x, restype ) == 0 ) return;
+	if( job.x->size ) DaoMathJob_Execute( & job, job.x->size );
+}
+
+#define DAO_MATH_ARRAY_FUNCTION( name, kind, kernel ) \
+static void MATH_##name##_a( DaoProcess *proc, DaoValue *p[], int N ) \
+{ \
+	DaoMath_ApplyKernel( proc, p, N, kind, kernel ); \
+}
+
+DAO_MATH_ARRAY_FUNCTION( abs,   DAO_MATH_UNARY, DaoMath_AbsKernel )
+DAO_MATH_ARRAY_FUNCTION( acos,  DAO_MATH_UNARY, DaoMath_AcosKernel )
+DAO_MATH_ARRAY_FUNCTION( asin,  DAO_MATH_UNARY, DaoMath_AsinKernel )
+DAO_MATH_ARRAY_FUNCTION( atan,  DAO_MATH_UNARY, DaoMath_AtanKernel )
+DAO_MATH_ARRAY_FUNCTION( ceil,  DAO_MATH_UNARY, DaoMath_CeilKernel )
+DAO_MATH_ARRAY_FUNCTION( cos,   DAO_MATH_UNARY, DaoMath_CosKernel )
+DAO_MATH_ARRAY_FUNCTION( cosh,  DAO_MATH_UNARY, DaoMath_CoshKernel )
+DAO_MATH_ARRAY_FUNCTION( exp,   DAO_MATH_UNARY, DaoMath_ExpKernel )
+DAO_MATH_ARRAY_FUNCTION( floor, DAO_MATH_UNARY, DaoMath_FloorKernel )
+DAO_MATH_ARRAY_FUNCTION( log,   DAO_MATH_UNARY, DaoMath_LogKernel )
+DAO_MATH_ARRAY_FUNCTION( round, DAO_MATH_UNARY, DaoMath_RoundKernel )
+DAO_MATH_ARRAY_FUNCTION( sin,   DAO_MATH_UNARY, DaoMath_SinKernel )
+DAO_MATH_ARRAY_FUNCTION( sinh,  DAO_MATH_UNARY, DaoMath_SinhKernel )
+DAO_MATH_ARRAY_FUNCTION( sqrt,  DAO_MATH_UNARY, DaoMath_SqrtKernel )
+DAO_MATH_ARRAY_FUNCTION( tan,   DAO_MATH_UNARY, DaoMath_TanKernel )
+DAO_MATH_ARRAY_FUNCTION( tanh,  DAO_MATH_UNARY, DaoMath_TanhKernel )
+
+DAO_MATH_ARRAY_FUNCTION( pow,      DAO_MATH_BINARY, DaoMath_PowKernel )
+DAO_MATH_ARRAY_FUNCTION( hypot,    DAO_MATH_BINARY, DaoMath_HypotKernel )
+DAO_MATH_ARRAY_FUNCTION( atan2,    DAO_MATH_BINARY, DaoMath_Atan2Kernel )
+DAO_MATH_ARRAY_FUNCTION( copysign, DAO_MATH_BINARY, DaoMath_CopysignKernel )
+DAO_MATH_ARRAY_FUNCTION( max,      DAO_MATH_BINARY, DaoMath_MaxKernel )
+DAO_MATH_ARRAY_FUNCTION( min,      DAO_MATH_BINARY, DaoMath_MinKernel )
+
+DAO_MATH_ARRAY_FUNCTION( cos_c,  DAO_MATH_COMPLEX, DaoMath_CosComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( cosh_c, DAO_MATH_COMPLEX, DaoMath_CoshComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( exp_c,  DAO_MATH_COMPLEX, DaoMath_ExpComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( log_c,  DAO_MATH_COMPLEX, DaoMath_LogComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( sin_c,  DAO_MATH_COMPLEX, DaoMath_SinComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( sinh_c, DAO_MATH_COMPLEX, DaoMath_SinhComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( sqrt_c, DAO_MATH_COMPLEX, DaoMath_SqrtComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( tan_c,  DAO_MATH_COMPLEX, DaoMath_TanComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( tanh_c, DAO_MATH_COMPLEX, DaoMath_TanhComplexKernel )
+
+DAO_MATH_ARRAY_FUNCTION( abs_c,  DAO_MATH_COMPLEX_REAL, DaoMath_AbsComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( arg_c,  DAO_MATH_COMPLEX_REAL, DaoMath_ArgComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( norm_c, DAO_MATH_COMPLEX_REAL, DaoMath_NormComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( real_c, DAO_MATH_COMPLEX_REAL, DaoMath_RealComplexKernel )
+DAO_MATH_ARRAY_FUNCTION( imag_c, DAO_MATH_COMPLEX_REAL, DaoMath_ImagComplexKernel )
+
+
+/* Compiled expressions are cached per process: */
+static void DaoMathPrograms_Delete( DMap *self )
+{
+	DNode *it;
+	for(it=DMap_First(self); it; it=DMap_Next(self,it)){
+		DaoMathProgram_Delete( (DaoMathProgram*) it->value.pVoid );
+	}
+	DMap_Delete( self );
+}
+
+static DaoMathProgram* DaoProcess_GetMathProgram( DaoProcess *proc, DString *source )
+{
+	DMap *programs = (DMap*) DaoProcess_GetAuxData( proc, DaoMathPrograms_Delete );
+	DaoMathProgram *program;
+	char message[128];
+	DNode *it;
+
+	if( programs == NULL ){
+		programs = DHash_New( DAO_DATA_STRING, 0 );
+		DaoProcess_SetAuxData( proc, DaoMathPrograms_Delete, programs );
+	}
+	it = DMap_Find( programs, source );
+	if( it ) return (DaoMathProgram*) it->value.pVoid;
+
+	program = DaoMathProgram_New();
+	if( DaoMathProgram_Compile( program, source, message, sizeof(message) ) == 0 ){
+		DaoProcess_RaiseError( proc, "Param", message );
+		DaoMathProgram_Delete( program );
+		return NULL;
+	}
+	if( programs->size >= DAO_MATH_EVAL_CACHE ){
+		for(it=DMap_First(programs); it; it=DMap_Next(programs,it)){
+			DaoMathProgram_Delete( (DaoMathProgram*) it->value.pVoid );
+		}
+		DMap_Clear( programs );
+	}
+	DMap_Insert( programs, source, program );
+	return program;
+}
+
+static void MATH_eval( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DString *source = DaoValue_TryGetString( p[0] );
+	DaoMap *vars = (DaoMap*) p[1];
+	DaoMathProgram *program = DaoProcess_GetMathProgram( proc, source );
+	DaoMathOperand *operands;
+	DaoArray *shape = NULL;
+	DaoMathJob job;
+	char message[128];
+	daoint i;
+
+	if( program == NULL ) return;
+	operands = (DaoMathOperand*) dao_calloc( program->names->size + 1, sizeof(DaoMathOperand) );
+	for(i=0; i<program->names->size; ++i){
+		DString *name = program->names->items.pString[i];
+		DaoValue *value = DaoMap_GetValueChars( vars, name->chars );
+		if( value == NULL ){
+			snprintf( message, sizeof(message), "variable \"%.64s\" not defined", name->chars );
+			DaoProcess_RaiseError( proc, "Param", message );
+			goto Done;
+		}
+		if( value->type == DAO_ARRAY ){
+			DaoArray *array = (DaoArray*) value;
+			DaoArray_Sliced( array );
+			if( shape == NULL ){
+				shape = array;
+			}else if( array->size != shape->size ){
+				DaoProcess_RaiseError( proc, "Param", "array size not matching" );
+				goto Done;
+			}
+			operands[i].data = array->data.f;
+			operands[i].step = 1;
+		}else{
+			operands[i].scalar = value->xFloat.value;
+		}
+	}
+	if( shape == NULL ){
+		DaoProcess_RaiseError( proc, "Param", "no array variable in the expression" );
+		goto Done;
+	}
+
+	memset( & job, 0, sizeof(DaoMathJob) );
+	job.kind = DAO_MATH_EXPRESSION;
+	job.program = program;
+	job.operands = operands;
+	if( DaoMath_PrepareOutput( proc, & job, p[N-1], shape, DAO_FLOAT ) == 0 ) goto Done;
+	if( shape->size ) DaoMathJob_Execute( & job, shape->size );
+Done:
+	dao_free( operands );
+}
+
+
+
 #if 0
 /* z = x * x + r */
 /* binary searching */
@@ -369,6 +1409,61 @@ static DaoFunctionEntry mathMeths[]=
 	{ MATH_pow_cr,    "pow( p1: complex, p2: float )=>complex" },
 	{ MATH_pow_cc,    "pow( p1: complex, p2: complex )=>complex" },
 
+	/*
+	// Element-wise functions over arrays; the result is stored in "out" if it
+	// is given (it may be the input array itself or a slice), otherwise in a
+	// new array of the same shape as "x":
+	*/
+	{ MATH_abs_a,    "abs( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_acos_a,   "acos( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_asin_a,   "asin( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_atan_a,   "atan( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_ceil_a,   "ceil( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_cos_a,    "cos( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_cosh_a,   "cosh( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_exp_a,    "exp( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_floor_a,  "floor( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_log_a,    "log( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_round_a,  "round( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_sin_a,    "sin( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_sinh_a,   "sinh( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_sqrt_a,   "sqrt( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_tan_a,    "tan( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_tanh_a,   "tanh( x: array<float>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_pow_a,    "pow( x: array<float>, y: array<float>|float, out: array<float>|none = none )=>array<float>" },
+	{ MATH_hypot_a,  "hypot( x: array<float>, y: array<float>|float, out: array<float>|none = none )=>array<float>" },
+	{ MATH_atan2_a,  "atan2( x: array<float>, y: array<float>|float, out: array<float>|none = none )=>array<float>" },
+	{ MATH_copysign_a,"copysign( x: array<float>, y: array<float>|float, out: array<float>|none = none )=>array<float>" },
+	{ MATH_max_a,    "max( x: array<float>, y: array<float>|float, out: array<float>|none = none )=>array<float>" },
+	{ MATH_min_a,    "min( x: array<float>, y: array<float>|float, out: array<float>|none = none )=>array<float>" },
+
+	{ MATH_cos_c_a,  "cos( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_cosh_c_a, "cosh( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_exp_c_a,  "exp( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_log_c_a,  "log( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_sin_c_a,  "sin( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_sinh_c_a, "sinh( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_sqrt_c_a, "sqrt( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_tan_c_a,  "tan( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_tanh_c_a, "tanh( x: array<complex>, out: array<complex>|none = none )=>array<complex>" },
+	{ MATH_abs_c_a,  "abs( x: array<complex>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_arg_c_a,  "arg( x: array<complex>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_norm_c_a, "norm( x: array<complex>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_real_c_a, "real( x: array<complex>, out: array<float>|none = none )=>array<float>" },
+	{ MATH_imag_c_a, "imag( x: array<complex>, out: array<float>|none = none )=>array<float>" },
+
+	/*
+	// Fused evaluation of an element-wise expression over arrays and scalars,
+	// with operators + - * / ** and the functions above. For example,
+	//     math.eval( "exp(-x*x/2)*a + b", { "x" => x, "a" => 2.0, "b" => b } )
+	// evaluates the expression in a single pass without temporary arrays.
+	// Compiled expressions are cached.
+	*/
+	{ MATH_eval,
+		"eval( expr: string, vars: map<string,array<float>|float>, out: array<float>|none = none )"
+			"=>array<float>"
+	},
+
 	//{ LONG_Sqrt, "sqrt( self:  long ) => tuple<long,long>" },
 
 	{ NULL, NULL }
@@ -27,26 +27,114 @@
 */
 
 #include<time.h>
+#include<string.h>
 #include"daoValue.h"
 #include"daoVmspace.h"
+#include"daoThread.h"
 #include"dao_random.h"
 
 #define DAO_MTCOUNT 624
+#define DAO_MTSHIFT 397
+#define DAO_ZIGLAYERS 256
+#define DAO_FILLBLOCK 256
 
 typedef struct DaoRandGenWrapper DaoRandGenWrapper;
 
 struct DaoRandGenerator
 {
-	uint_t  states[DAO_MTCOUNT];
+	uint_t  engine;
 	uint_t  index;
-	uint_t  iset;
-	float   gset;
+	union {
+		uint_t    mt[DAO_MTCOUNT];
+		uint64_t  xoshiro[4];
+		struct {
+			uint64_t  state[2];   /* High and low words; */
+			uint64_t  inc[2];
+		} pcg;
+		struct {
+			uint_t  counter[4];
+			uint_t  key[2];
+			uint_t  output[4];
+		} philox;
+	} states;
 };
 
 
+/*
+// Ziggurat tables for the normal and exponential distributions (Marsaglia and Tsang),
+// with the layer edges in decreasing order and their density values;
+// they are set up when the module is loaded.
+*/
+static double dao_normal_x[DAO_ZIGLAYERS+1];
+static double dao_normal_f[DAO_ZIGLAYERS+1];
+static double dao_expon_x[DAO_ZIGLAYERS+1];
+static double dao_expon_f[DAO_ZIGLAYERS+1];
+
+#define DAO_NORMAL_R  3.6541528853610088
+#define DAO_NORMAL_V  0.00492867323399
+#define DAO_EXPON_R   7.69711747013104972
+#define DAO_EXPON_V   0.0039496598225815571993
+
+static void DaoRandom_InitZiggurat()
+{
+	int i;
+	dao_normal_x[0] = DAO_NORMAL_V / exp( -0.5 * DAO_NORMAL_R * DAO_NORMAL_R );
+	dao_normal_x[1] = DAO_NORMAL_R;
+	dao_expon_x[0] = DAO_EXPON_V / exp( - DAO_EXPON_R );
+	dao_expon_x[1] = DAO_EXPON_R;
+	for(i=2; i<DAO_ZIGLAYERS; ++i){
+		double x = dao_normal_x[i-1];
+		dao_normal_x[i] = sqrt( -2.0 * log( DAO_NORMAL_V / x + exp( -0.5 * x * x ) ) );
+		x = dao_expon_x[i-1];
+		dao_expon_x[i] = - log( DAO_EXPON_V / x + exp( - x ) );
+	}
+	dao_normal_x[DAO_ZIGLAYERS] = 0.0;
+	dao_expon_x[DAO_ZIGLAYERS] = 0.0;
+	for(i=0; i<=DAO_ZIGLAYERS; ++i){
+		dao_normal_f[i] = exp( -0.5 * dao_normal_x[i] * dao_normal_x[i] );
+		dao_expon_f[i] = exp( - dao_expon_x[i] );
+	}
+}
+
+
+/* Full 64x64 bit multiplication: */
+static uint64_t DaoRandom_UMul64( uint64_t a, uint64_t b, uint64_t *high )
+{
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 m = (unsigned __int128) a * b;
+	*high = (uint64_t)(m >> 64);
+	return (uint64_t) m;
+#else
+	uint64_t a0 = (uint32_t) a, a1 = a >> 32, b0 = (uint32_t) b, b1 = b >> 32;
+	uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	uint64_t mid = (p00 >> 32) + (uint32_t) p01 + (uint32_t) p10;
+	*high = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+	return (mid << 32) | (uint32_t) p00;
+#endif
+}
+
+static uint64_t DaoRandom_SplitMix64( uint64_t *state )
+{
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static uint64_t DaoRandom_RotateLeft( uint64_t x, int k )
+{
+	return (x << k) | (x >> ((64 - k) & 63));
+}
+
+
 DaoRandGenerator* DaoRandGenerator_New( uint_t seed )
+{
+	return DaoRandGenerator_NewEngine( DAO_RAND_MT19937, seed );
+}
+DaoRandGenerator* DaoRandGenerator_NewEngine( int engine, uint_t seed )
 {
 	DaoRandGenerator *self = (DaoRandGenerator*) dao_malloc( sizeof(DaoRandGenerator) );
+	self->engine = engine;
 	DaoRandGenerator_Seed( self, seed );
 	return self;
 }
@@ -54,65 +142,441 @@ void DaoRandGenerator_Delete( DaoRandGenerator *self )
 {
 	dao_free( self );
 }
+
+static void DaoRandGenerator_StepPCG( DaoRandGenerator *self )
+{
+	uint64_t *state = self->states.pcg.state, *inc = self->states.pcg.inc;
+	uint64_t high, low = DaoRandom_UMul64( state[1], 0x4385df649fccf645ULL, & high );
+	high += state[1] * 0x2360ed051fc65da4ULL + state[0] * 0x4385df649fccf645ULL;
+	state[1] = low + inc[1];
+	state[0] = high + inc[0] + (state[1] < low);
+}
+static void DaoRandGenerator_SeedPCG( DaoRandGenerator *self, uint64_t seed[2], uint64_t seq[2] )
+{
+	uint64_t *state = self->states.pcg.state;
+	self->states.pcg.inc[0] = (seq[0] << 1) | (seq[1] >> 63);
+	self->states.pcg.inc[1] = (seq[1] << 1) | 1;
+	state[0] = state[1] = 0;
+	DaoRandGenerator_StepPCG( self );
+	state[1] += seed[1];
+	state[0] += seed[0] + (state[1] < seed[1]);
+	DaoRandGenerator_StepPCG( self );
+}
+
 void DaoRandGenerator_Seed( DaoRandGenerator *self, uint_t seed )
 {
+	uint64_t mix, seeds[2], seqs[2];
 	int i;
 	if( seed == 0 ) seed = time(NULL);
-	self->iset = 0;
-	self->gset = 0.0;
+	mix = seed;
 	self->index = 0;
-	self->states[0] = seed;
-	for(i=1; i<DAO_MTCOUNT; ++i){
-		uint_t prev = self->states[i-1];
-		self->states[i] = 0x6c078965 * (prev ^ (prev>>30)) + i;
+	switch( self->engine ){
+	case DAO_RAND_XOSHIRO256 :
+		for(i=0; i<4; ++i) self->states.xoshiro[i] = DaoRandom_SplitMix64( & mix );
+		break;
+	case DAO_RAND_PCG64 :
+		seeds[0] = DaoRandom_SplitMix64( & mix );
+		seeds[1] = DaoRandom_SplitMix64( & mix );
+		seqs[0] = DaoRandom_SplitMix64( & mix );
+		seqs[1] = DaoRandom_SplitMix64( & mix );
+		DaoRandGenerator_SeedPCG( self, seeds, seqs );
+		break;
+	case DAO_RAND_PHILOX :
+		mix = DaoRandom_SplitMix64( & mix );
+		memset( self->states.philox.counter, 0, 4*sizeof(uint_t) );
+		self->states.philox.key[0] = (uint_t) mix;
+		self->states.philox.key[1] = (uint_t)(mix >> 32);
+		self->index = 4;
+		break;
+	default :
+		self->engine = DAO_RAND_MT19937;
+		self->states.mt[0] = seed;
+		for(i=1; i<DAO_MTCOUNT; ++i){
+			uint_t prev = self->states.mt[i-1];
+			self->states.mt[i] = 0x6c078965 * (prev ^ (prev>>30)) + i;
+		}
+		break;
+	}
+}
+
+/* 128-bit multiplication (modulo 2^128), with the high word first: */
+static void DaoRandom_Mul128( const uint64_t a[2], const uint64_t b[2], uint64_t res[2] )
+{
+	uint64_t high, low = DaoRandom_UMul64( a[1], b[1], & high );
+	res[0] = high + a[1] * b[0] + a[0] * b[1];
+	res[1] = low;
+}
+static void DaoRandom_Add128( const uint64_t a[2], const uint64_t b[2], uint64_t res[2] )
+{
+	uint64_t low = a[1] + b[1];
+	res[0] = a[0] + b[0] + (low < a[1]);
+	res[1] = low;
+}
+
+/* Advance the PCG state by 2^shift steps in O(shift) time (Brown's algorithm): */
+static void DaoRandGenerator_AdvancePCG( DaoRandGenerator *self, int shift )
+{
+	uint64_t mult[2] = { 0x2360ed051fc65da4ULL, 0x4385df649fccf645ULL };
+	uint64_t plus[2], one[2] = { 0, 1 }, tmp[2];
+	int i;
+	plus[0] = self->states.pcg.inc[0];
+	plus[1] = self->states.pcg.inc[1];
+	for(i=0; i<shift; ++i){ /* plus = (mult + 1) * plus; mult = mult * mult; */
+		DaoRandom_Add128( mult, one, tmp );
+		DaoRandom_Mul128( tmp, plus, plus );
+		DaoRandom_Mul128( mult, mult, mult );
+	}
+	DaoRandom_Mul128( self->states.pcg.state, mult, tmp );
+	DaoRandom_Add128( tmp, plus, self->states.pcg.state );
+}
+
+static void DaoRandGenerator_JumpXoshiro( DaoRandGenerator *self )
+{
+	static const uint64_t jumps[4] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+	};
+	uint64_t *s = self->states.xoshiro, t[4] = { 0, 0, 0, 0 };
+	int i, b;
+	for(i=0; i<4; ++i){
+		for(b=0; b<64; ++b){
+			if( jumps[i] & ((uint64_t)1 << b) ){
+				t[0] ^= s[0];  t[1] ^= s[1];  t[2] ^= s[2];  t[3] ^= s[3];
+			}
+			DaoRandGenerator_GetInt64( self );
+		}
+	}
+	memcpy( s, t, sizeof(t) );
+}
+
+/*
+// Jump ahead to a stream which does not overlap with the current one in practice:
+// by 2^128 numbers for xoshiro256**, 2^64 numbers for PCG64 and 2^64 blocks for
+// Philox (the counter is increased by 2^64); Mersenne Twister has no cheap jump,
+// so its state is refilled from a SplitMix64 sequence seeded by its own output.
+*/
+void DaoRandGenerator_Jump( DaoRandGenerator *self )
+{
+	uint_t *counter = self->states.philox.counter;
+	uint64_t mix;
+	int i;
+	switch( self->engine ){
+	case DAO_RAND_XOSHIRO256 :
+		DaoRandGenerator_JumpXoshiro( self );
+		break;
+	case DAO_RAND_PCG64 :
+		DaoRandGenerator_AdvancePCG( self, 64 );
+		break;
+	case DAO_RAND_PHILOX :
+		if( ++counter[2] == 0 ) ++counter[3];
+		self->index = 4;
+		break;
+	default :
+		mix = DaoRandGenerator_GetInt64( self );
+		for(i=0; i<DAO_MTCOUNT; ++i) self->states.mt[i] = (uint_t) DaoRandom_SplitMix64( & mix );
+		self->index = 0;
+		break;
 	}
 }
+
+/* Set up a Philox generator for the stream (equal to the stream 0 jumped "stream" times): */
+static void DaoRandGenerator_SeedStream( DaoRandGenerator *self, uint64_t seed, uint64_t stream )
+{
+	uint64_t mix = seed;
+	self->engine = DAO_RAND_PHILOX;
+	self->index = 4;
+	mix = DaoRandom_SplitMix64( & mix );
+	self->states.philox.key[0] = (uint_t) mix;
+	self->states.philox.key[1] = (uint_t)(mix >> 32);
+	self->states.philox.counter[0] = 0;
+	self->states.philox.counter[1] = 0;
+	self->states.philox.counter[2] = (uint_t) stream;
+	self->states.philox.counter[3] = (uint_t)(stream >> 32);
+}
+
+#define DAO_MTMIX( x, y ) ( ((x) & 0x80000000) | ((y) & 0x7fffffff) )
+#define DAO_MTTWIST( v ) ( ((v) >> 1) ^ (-(int)((v) & 1) & 0x9908b0df) )
+
 static void DaoRandGenerator_GenerateMT( DaoRandGenerator *self )
 {
-	uint_t i, *mtnums = self->states;
-	for(i=1; i<DAO_MTCOUNT; ++i){
-		uint_t y = (mtnums[i] & 0x80000000) + (mtnums[(i+1)%DAO_MTCOUNT] & 0x7fffffff);
-		mtnums[i] = mtnums[(i+397)%DAO_MTCOUNT] ^ (y >> 1);
-		if( y % 2 ) mtnums[i] ^= 0x9908b0df;
+	uint_t i, *mtnums = self->states.mt;
+	for(i=0; i<DAO_MTCOUNT-DAO_MTSHIFT; ++i){
+		uint_t y = DAO_MTMIX( mtnums[i], mtnums[i+1] );
+		mtnums[i] = mtnums[i+DAO_MTSHIFT] ^ DAO_MTTWIST( y );
+	}
+	for(; i<DAO_MTCOUNT-1; ++i){
+		uint_t y = DAO_MTMIX( mtnums[i], mtnums[i+1] );
+		mtnums[i] = mtnums[i+DAO_MTSHIFT-DAO_MTCOUNT] ^ DAO_MTTWIST( y );
 	}
+	mtnums[i] = mtnums[DAO_MTSHIFT-1] ^ DAO_MTTWIST( DAO_MTMIX( mtnums[i], mtnums[0] ) );
 }
 static uint_t DaoRandGenerator_ExtractMT( DaoRandGenerator *self )
 {
 	uint_t y;
 	if( self->index == 0 ) DaoRandGenerator_GenerateMT( self );
-	y = self->states[ self->index ];
+	y = self->states.mt[ self->index ];
 	y ^= y>>11;
 	y ^= (y<<7) & 0x9d2c5680;
 	y ^= (y<<15) & 0xefc60000;
 	y ^= y>>18;
-	self->index = (self->index + 1) % DAO_MTCOUNT;
+	if( ++self->index == DAO_MTCOUNT ) self->index = 0;
 	return y;
 }
+
+/* Philox 4x32-10: encrypt the counter with the key, then increment the counter: */
+static void DaoRandom_Philox( uint_t counter[4], const uint_t key[2], uint_t output[4] )
+{
+	uint_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	uint_t k0 = key[0], k1 = key[1];
+	int i;
+	for(i=0; i<10; ++i){
+		uint64_t p0 = (uint64_t) 0xD2511F53 * c0;
+		uint64_t p1 = (uint64_t) 0xCD9E8D57 * c2;
+		c0 = (uint_t)(p1 >> 32) ^ c1 ^ k0;
+		c2 = (uint_t)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (uint_t) p1;
+		c3 = (uint_t) p0;
+		k0 += 0x9E3779B9;
+		k1 += 0xBB67AE85;
+	}
+	output[0] = c0;  output[1] = c1;  output[2] = c2;  output[3] = c3;
+	if( ++counter[0] == 0 && ++counter[1] == 0 && ++counter[2] == 0 ) ++counter[3];
+}
+
+/*
+// Philox blocks for consecutive counters are independent, so they are computed in
+// lanes with the rounds interleaved, which the compiler can vectorize:
+*/
+#define DAO_PHILOXLANES 8
+
+static void DaoRandom_PhiloxLanes( uint_t counter[4], const uint_t key[2], uint64_t *dest )
+{
+	uint_t c0[DAO_PHILOXLANES], c1[DAO_PHILOXLANES], c2[DAO_PHILOXLANES], c3[DAO_PHILOXLANES];
+	uint_t k0 = key[0], k1 = key[1];
+	int i, j;
+	for(j=0; j<DAO_PHILOXLANES; ++j){
+		c0[j] = counter[0];  c1[j] = counter[1];  c2[j] = counter[2];  c3[j] = counter[3];
+		if( ++counter[0] == 0 && ++counter[1] == 0 && ++counter[2] == 0 ) ++counter[3];
+	}
+	for(i=0; i<10; ++i){
+		for(j=0; j<DAO_PHILOXLANES; ++j){
+			uint64_t p0 = (uint64_t) 0xD2511F53 * c0[j];
+			uint64_t p1 = (uint64_t) 0xCD9E8D57 * c2[j];
+			c0[j] = (uint_t)(p1 >> 32) ^ c1[j] ^ k0;
+			c2[j] = (uint_t)(p0 >> 32) ^ c3[j] ^ k1;
+			c1[j] = (uint_t) p1;
+			c3[j] = (uint_t) p0;
+		}
+		k0 += 0x9E3779B9;
+		k1 += 0xBB67AE85;
+	}
+	for(j=0; j<DAO_PHILOXLANES; ++j){
+		dest[2*j] = ((uint64_t) c1[j] << 32) | c0[j];
+		dest[2*j+1] = ((uint64_t) c3[j] << 32) | c2[j];
+	}
+}
+
+uint64_t DaoRandGenerator_GetInt64( DaoRandGenerator *self )
+{
+	uint64_t *s, result, t, high, low;
+	switch( self->engine ){
+	case DAO_RAND_XOSHIRO256 :
+		s = self->states.xoshiro;
+		result = DaoRandom_RotateLeft( s[1] * 5, 7 ) * 9;
+		t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = DaoRandom_RotateLeft( s[3], 45 );
+		return result;
+	case DAO_RAND_PCG64 :
+		DaoRandGenerator_StepPCG( self );
+		high = self->states.pcg.state[0];
+		low = self->states.pcg.state[1];
+		t = high ^ low;
+		return (t >> (high >> 58)) | (t << ((64 - (high >> 58)) & 63));
+	case DAO_RAND_PHILOX :
+		if( self->index >= 4 ){
+			DaoRandom_Philox( self->states.philox.counter, self->states.philox.key, self->states.philox.output );
+			self->index = 0;
+		}
+		low = self->states.philox.output[ self->index++ ];
+		high = self->states.philox.output[ self->index++ ];
+		return (high << 32) | low;
+	default : break;
+	}
+	high = DaoRandGenerator_ExtractMT( self );
+	return (high << 32) | DaoRandGenerator_ExtractMT( self );
+}
+static uint_t DaoRandGenerator_GetInt32( DaoRandGenerator *self )
+{
+	if( self->engine == DAO_RAND_MT19937 ) return DaoRandGenerator_ExtractMT( self );
+	return DaoRandGenerator_GetInt64( self ) >> 32;
+}
 unsigned DaoRandGenerator_GetUniformInt( DaoRandGenerator *self, unsigned max )
 {
-	    return DaoRandGenerator_ExtractMT( self ) % (max + 1); 
+	    return DaoRandGenerator_GetInt32( self ) % ((uint64_t) max + 1);
 }
+
+/* Uniform in [0,1) with 53 random bits: */
+#define DAO_RAND_UNIT( bits ) ( ((bits) >> 11) * (1.0/9007199254740992.0) )
+
 double DaoRandGenerator_GetUniform( DaoRandGenerator *self )
 {
-	return DaoRandGenerator_ExtractMT( self ) / (double) 0xffffffff;
+	return DAO_RAND_UNIT( DaoRandGenerator_GetInt64( self ) );
+}
+
+/*
+// Ziggurat sampling: the lowest 8 bits of "bits" select a layer, bit 8 the sign (for
+// the normal distribution) and the highest 52 bits the position in the layer; "bits"
+// is accepted directly in about 99% of the cases, otherwise the wedge or the tail
+// is sampled with more random numbers from the generator.
+*/
+static double DaoRandGenerator_ZigguratNormal( DaoRandGenerator *self, uint64_t bits )
+{
+	while(1){
+		int layer = bits & 0xff;
+		double sign = bits & 0x100 ? -1.0 : 1.0;
+		double x = (bits >> 12) * (1.0/4503599627370496.0) * dao_normal_x[layer];
+		if( x < dao_normal_x[layer+1] ) return sign * x;
+		if( layer == 0 ){
+			double a, b;
+			do {
+				a = - log( 1.0 - DaoRandGenerator_GetUniform( self ) ) / DAO_NORMAL_R;
+				b = - log( 1.0 - DaoRandGenerator_GetUniform( self ) );
+			} while( b + b < a * a );
+			return sign * (DAO_NORMAL_R + a);
+		}
+		if( dao_normal_f[layer] + DaoRandGenerator_GetUniform( self ) * (dao_normal_f[layer+1] - dao_normal_f[layer]) < exp( -0.5 * x * x ) ){
+			return sign * x;
+		}
+		bits = DaoRandGenerator_GetInt64( self );
+	}
+	return 0.0;
+}
+static double DaoRandGenerator_ZigguratExponential( DaoRandGenerator *self, uint64_t bits )
+{
+	while(1){
+		int layer = bits & 0xff;
+		double x = (bits >> 12) * (1.0/4503599627370496.0) * dao_expon_x[layer];
+		if( x < dao_expon_x[layer+1] ) return x;
+		if( layer == 0 ) return DAO_EXPON_R - log( 1.0 - DaoRandGenerator_GetUniform( self ) );
+		if( dao_expon_f[layer] + DaoRandGenerator_GetUniform( self ) * (dao_expon_f[layer+1] - dao_expon_f[layer]) < exp( - x ) ){
+			return x;
+		}
+		bits = DaoRandGenerator_GetInt64( self );
+	}
+	return 0.0;
 }
 double DaoRandGenerator_GetNormal( DaoRandGenerator *self )
 {
-	float fac, rsq, v1, v2;
+	return DaoRandGenerator_ZigguratNormal( self, DaoRandGenerator_GetInt64( self ) );
+}
+double DaoRandGenerator_GetExponential( DaoRandGenerator *self )
+{
+	return DaoRandGenerator_ZigguratExponential( self, DaoRandGenerator_GetInt64( self ) );
+}
 
-	if( self->iset ){
-		self->iset = 0;
-		return self->gset;
+/*
+// Bulk generation of raw 64-bit numbers: the engine state is kept in local variables
+// in the loops, and full Philox blocks are generated directly into the destination.
+*/
+static void DaoRandGenerator_FillBits( DaoRandGenerator *self, uint64_t *dest, daoint count )
+{
+	daoint i = 0;
+	if( self->engine == DAO_RAND_XOSHIRO256 ){
+		uint64_t *s = self->states.xoshiro;
+		uint64_t s0 = s[0], s1 = s[1], s2 = s[2], s3 = s[3];
+		for(; i<count; ++i){
+			uint64_t t = s1 << 17;
+			dest[i] = DaoRandom_RotateLeft( s1 * 5, 7 ) * 9;
+			s2 ^= s0;
+			s3 ^= s1;
+			s1 ^= s2;
+			s0 ^= s3;
+			s2 ^= t;
+			s3 = DaoRandom_RotateLeft( s3, 45 );
+		}
+		s[0] = s0;  s[1] = s1;  s[2] = s2;  s[3] = s3;
+	}else if( self->engine == DAO_RAND_PHILOX ){
+		uint_t *counter = self->states.philox.counter;
+		for(; i<count && self->index < 4; ++i) dest[i] = DaoRandGenerator_GetInt64( self );
+		for(; i+2*DAO_PHILOXLANES<=count; i+=2*DAO_PHILOXLANES){
+			DaoRandom_PhiloxLanes( counter, self->states.philox.key, dest + i );
+		}
+		for(; i<count; ++i) dest[i] = DaoRandGenerator_GetInt64( self );
+	}else{
+		for(; i<count; ++i) dest[i] = DaoRandGenerator_GetInt64( self );
+	}
+}
+
+void DaoRandGenerator_Fill( DaoRandGenerator *self, double *dest, daoint count, int dist )
+{
+	uint64_t bits[DAO_FILLBLOCK];
+	daoint i, k;
+	for(i=0; i<count; i+=DAO_FILLBLOCK){
+		daoint n = count - i < DAO_FILLBLOCK ? count - i : DAO_FILLBLOCK;
+		double *values = dest + i;
+		DaoRandGenerator_FillBits( self, bits, n );
+		switch( dist ){
+		case DAO_RAND_NORMAL :
+			for(k=0; k<n; ++k){
+				int layer = bits[k] & 0xff;
+				double x = (bits[k] >> 12) * (1.0/4503599627370496.0) * dao_normal_x[layer];
+				if( x < dao_normal_x[layer+1] ){
+					values[k] = bits[k] & 0x100 ? -x : x;
+				}else{
+					values[k] = DaoRandGenerator_ZigguratNormal( self, bits[k] );
+				}
+			}
+			break;
+		case DAO_RAND_EXPONENTIAL :
+			for(k=0; k<n; ++k){
+				int layer = bits[k] & 0xff;
+				double x = (bits[k] >> 12) * (1.0/4503599627370496.0) * dao_expon_x[layer];
+				if( x < dao_expon_x[layer+1] ){
+					values[k] = x;
+				}else{
+					values[k] = DaoRandGenerator_ZigguratExponential( self, bits[k] );
+				}
+			}
+			break;
+		default :
+			for(k=0; k<n; ++k) values[k] = DAO_RAND_UNIT( bits[k] );
+			break;
+		}
+	}
+}
+
+/*
+// Fill with uniform integers in [min,max] (Lemire's multiply-and-reject method);
+// the range is computed in unsigned arithmetic, and the full 64-bit range
+// (where it wraps to zero) takes the raw output:
+*/
+void DaoRandGenerator_FillInt( DaoRandGenerator *self, dao_integer *dest, daoint count, dao_integer min, dao_integer max )
+{
+	uint64_t bits[DAO_FILLBLOCK];
+	uint64_t range = (uint64_t) max - (uint64_t) min + 1;
+	uint64_t threshold = range ? (0 - range) % range : 0;
+	daoint i, k;
+	for(i=0; i<count; i+=DAO_FILLBLOCK){
+		daoint n = count - i < DAO_FILLBLOCK ? count - i : DAO_FILLBLOCK;
+		DaoRandGenerator_FillBits( self, bits, n );
+		for(k=0; k<n; ++k){
+			uint64_t high, low, x = bits[k];
+			if( range == 0 ){
+				dest[i+k] = (dao_integer) x;
+				continue;
+			}
+			low = DaoRandom_UMul64( x, range, & high );
+			while( low < threshold ){
+				x = DaoRandGenerator_GetInt64( self );
+				low = DaoRandom_UMul64( x, range, & high );
+			}
+			dest[i+k] = (dao_integer)( (uint64_t) min + high );
+		}
 	}
-	do {
-		v1 = 2.0 * DaoRandGenerator_GetUniform( self ) -1.0;
-		v2 = 2.0 * DaoRandGenerator_GetUniform( self ) -1.0;
-		rsq = v1*v1 + v2*v2 ;
-	} while( rsq >= 1.0 || rsq == 0.0 );
-	fac = sqrt( -2.0 * log( rsq ) / rsq );
-	self->gset = v1 * fac;
-	self->iset = 1;
-	return v2 * fac;
 }
 
 
@@ -129,11 +593,12 @@ extern DaoTypeCore daoRandGeneratorCore;
 
 
 
-DaoRandGenWrapper* DaoRandGenWrapper_New( DaoVmSpace *vms, uint_t seed )
+DaoRandGenWrapper* DaoRandGenWrapper_New( DaoVmSpace *vms, int engine, uint_t seed )
 {
 	DaoRandGenWrapper *self = (DaoRandGenWrapper*) dao_calloc(1, sizeof(DaoRandGenWrapper));
 	DaoType *type = DaoVmSpace_GetType( vms, & daoRandGeneratorCore );
 	DaoCstruct_Init( (DaoCstruct*)self, type );
+	self->generator.engine = engine;
 	DaoRandGenerator_Seed( & self->generator, seed );
 	return self;
 }
@@ -149,7 +614,8 @@ void DaoRandGenWrapper_Delete( DaoRandGenWrapper *self )
 static void GEN_New( DaoProcess *proc, DaoValue *p[], int N )
 {
 	uint_t seed = N ? p[0]->xInteger.value : time(NULL);
-	DaoRandGenWrapper *self = DaoRandGenWrapper_New( proc->vmSpace, seed );
+	int engine = N > 1 ? p[1]->xEnum.value : DAO_RAND_MT19937;
+	DaoRandGenWrapper *self = DaoRandGenWrapper_New( proc->vmSpace, engine, seed );
 	DaoProcess_PutValue( proc, (DaoValue*) self );
 }
 static void GEN_GetUniform( DaoProcess *proc, DaoValue *p[], int N )
@@ -217,9 +683,67 @@ static void GEN_GetNormal2( DaoProcess *proc, DaoValue *p[], int N )
 	DaoProcess_PutFloat( proc, mean + stdev * random );
 }
 
+static void GEN_Fill( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoRandGenWrapper *self = (DaoRandGenWrapper*) p[0];
+	DaoArray *dest = (DaoArray*) p[1];
+	daoint size = DaoArray_GetWorkSize( dest );
+	daoint start = DaoArray_GetWorkStart( dest );
+	daoint len = DaoArray_GetWorkIntervalSize( dest );
+	daoint step = DaoArray_GetWorkStep( dest );
+	dao_integer min = 0, max = 0;
+	int dist = dest->etype == DAO_FLOAT ? p[2]->xEnum.value : DAO_RAND_UNIFORM;
+	daoint i;
+	if( dest->etype == DAO_INTEGER ){
+		if( N > 3 ){
+			min = p[2]->xInteger.value;
+			max = p[3]->xInteger.value;
+			if( min > max ){
+				DaoProcess_RaiseError( proc, "Param", "invalid range" );
+				return;
+			}
+		}else if( p[2]->xInteger.value < 0 ){
+			min = p[2]->xInteger.value;
+		}else{
+			max = p[2]->xInteger.value;
+		}
+	}
+	dest = DaoArray_GetWorkArray( dest );
+	for(i=0; i<size; i+=len){
+		daoint j = start + (i / len) * step;
+		if( dest->etype == DAO_FLOAT ){
+			DaoRandGenerator_Fill( & self->generator, dest->data.f + j, len, dist );
+		}else{
+			DaoRandGenerator_FillInt( & self->generator, dest->data.i + j, len, min, max );
+		}
+	}
+}
+
+static void GEN_Jump( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoRandGenWrapper *self = (DaoRandGenWrapper*) p[0];
+	DaoRandGenerator_Jump( & self->generator );
+}
+static void GEN_Split( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoRandGenWrapper *self = (DaoRandGenWrapper*) p[0];
+	DaoList *list = DaoProcess_PutList( proc );
+	dao_integer i, n = p[1]->xInteger.value;
+	if( n < 0 ){
+		DaoProcess_RaiseError( proc, "Param", "invalid stream number" );
+		return;
+	}
+	for(i=0; i<n; ++i){
+		DaoRandGenWrapper *stream = DaoRandGenWrapper_New( proc->vmSpace, self->generator.engine, 1 );
+		stream->generator = self->generator;
+		DaoRandGenerator_Jump( & self->generator );
+		DaoList_Append( list, (DaoValue*) stream );
+	}
+}
+
 static DaoFunctionEntry daoRandGeneratorMeths[]=
 {
-	{ GEN_New,             "Generator( seed = 0 )" },
+	{ GEN_New,             "Generator( seed = 0, engine: enum<mt19937,xoshiro256,pcg64,philox> = $mt19937 )" },
 
 	{ GEN_GetUniform,      "GetUniform( self: Generator, max = 1.0 ) => float" },
 	{ GEN_GetUniform2,     "GetUniform( self: Generator, min: float, max: float ) => float" },
@@ -233,6 +757,23 @@ static DaoFunctionEntry daoRandGeneratorMeths[]=
 	{ GEN_GetNormal,       "GetNormal( self: Generator, stdev = 1.0 ) => float" },
 	{ GEN_GetNormal2,      "GetNormal( self: Generator, mean: float, stdev: float ) => float" },
 
+	/*
+	// Fill the whole array (or slice) with random numbers from the distribution,
+	// or with integers uniformly distributed between zero and "max" (inclusive),
+	// or between "min" and "max" (inclusive):
+	*/
+	{ GEN_Fill,            "Fill( self: Generator, dest: array<float>, dist: enum<uniform,normal,exponential> = $uniform )" },
+	{ GEN_Fill,            "Fill( self: Generator, dest: array<int>, max: int )" },
+	{ GEN_Fill,            "Fill( self: Generator, dest: array<int>, min: int, max: int )" },
+
+	/*
+	// Jump() advances the generator to a non-overlapping stream;
+	// Split() returns "n" generators for the current stream and the streams
+	// after each of the next "n-1" jumps, and leaves this generator after "n" jumps.
+	*/
+	{ GEN_Jump,            "Jump( self: Generator )" },
+	{ GEN_Split,           "Split( self: Generator, n: int ) => list<Generator>" },
+
 	{ NULL, NULL }
 };
 
@@ -265,11 +806,39 @@ DaoTypeCore daoRandGeneratorCore =
 
 
 
-static DaoRandGenerator* DaoProcess_GetRandCache( DaoProcess *self, uint_t seeding )
+/*
+// The default generators of the processes are Philox generators for consecutive
+// streams of a common root seed, so that concurrent processes (threads) draw from
+// independent streams without sharing any state after their creation:
+*/
+static uint64_t dao_random_seed = 0;
+static uint64_t dao_random_stream = 0;
+
+#ifdef DAO_WITH_THREAD
+static DMutex dao_random_mutex;
+#endif
+
+static uint64_t DaoRandom_NextStream( uint64_t *seed )
+{
+	uint64_t stream;
+#ifdef DAO_WITH_THREAD
+	DMutex_Lock( & dao_random_mutex );
+#endif
+	*seed = dao_random_seed;
+	stream = dao_random_stream ++;
+#ifdef DAO_WITH_THREAD
+	DMutex_Unlock( & dao_random_mutex );
+#endif
+	return stream;
+}
+
+static DaoRandGenerator* DaoProcess_GetRandCache( DaoProcess *self )
 {
 	void *randgen = DaoProcess_GetAuxData( self, DaoRandGenerator_Delete );
 	if( randgen == NULL ){
-		randgen = DaoRandGenerator_New( seeding ? seeding : (uint_t)time(NULL) );
+		uint64_t seed, stream = DaoRandom_NextStream( & seed );
+		randgen = DaoRandGenerator_NewEngine( DAO_RAND_PHILOX, 1 );
+		DaoRandGenerator_SeedStream( (DaoRandGenerator*) randgen, seed, stream );
 		DaoProcess_SetAuxData( self, DaoRandGenerator_Delete, randgen );
 	}
 	return (DaoRandGenerator*) randgen;
@@ -278,26 +847,40 @@ static DaoRandGenerator* DaoProcess_GetRandCache( DaoProcess *self, uint_t seedi
 static void RAND_Swap( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoRandGenWrapper *self = (DaoRandGenWrapper*) p[0];
-	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc, 0 );
+	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc );
 	DaoRandGenerator tmp = *generator;
 	*generator = self->generator;
 	self->generator = tmp;
 }
 static void RAND_SRand( DaoProcess *proc, DaoValue *p[], int N )
 {
-	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc, 0 );
+	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc );
 	uint_t seed = (uint_t)p[0]->xInteger.value;
 	DaoRandGenerator_Seed( generator, seed );
 }
+static void RAND_Seed( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc );
+	uint64_t seed = (uint64_t) p[0]->xInteger.value;
+#ifdef DAO_WITH_THREAD
+	DMutex_Lock( & dao_random_mutex );
+#endif
+	dao_random_seed = seed;
+	dao_random_stream = 1;
+#ifdef DAO_WITH_THREAD
+	DMutex_Unlock( & dao_random_mutex );
+#endif
+	DaoRandGenerator_SeedStream( generator, seed, 0 );
+}
 static void RAND_Rand( DaoProcess *proc, DaoValue *p[], int N )
 {
-	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc, 0 );
+	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc );
 	double max = p[0]->xFloat.value;
 	DaoProcess_PutFloat( proc, max * DaoRandGenerator_GetUniform( generator ) );
 }
 static void RAND_Rand2( DaoProcess *proc, DaoValue *p[], int N )
 {
-	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc, 0 );
+	DaoRandGenerator *generator = DaoProcess_GetRandCache( proc );
 	dao_integer max = p[0]->xInteger.value;
 	unsigned random;
 	if( max < 0 ){
@@ -313,6 +896,11 @@ static void RAND_Rand2( DaoProcess *proc, DaoValue *p[], int N )
 // The following global methods in the random module use a process-private
 // buffer for random number generation.
 //
+// Each process gets a new stream of the root seed for its buffer, the seed()
+// method sets the root seed, uses its first stream for the current process,
+// and restarts the stream numbering for the processes that get their buffers
+// afterwards; srand() only reseeds the buffer of the current process.
+//
 // Note:
 // The process-private buffer is cleared every the process is released
 // back to the VM space by DaoVmSpace_ReleaseProcess(), in order to
@@ -324,6 +912,7 @@ static DaoFunctionEntry randomMeths[]=
 {
 	{ RAND_Swap,      "swap( randgen: Generator )" },
 	{ RAND_SRand,     "srand( seed: int )" },
+	{ RAND_Seed,      "seed( seed: int )" },
 	{ RAND_Rand,      "rand( max = 1.0 ) => float" },
 	{ RAND_Rand2,     "rand( max: int ) => int" },
 	{ NULL, NULL }
@@ -339,6 +928,11 @@ static DaoFunctionEntry randomMeths[]=
 DAO_DLL_EXPORT int DaoRandom_OnLoad( DaoVmSpace *vmSpace, DaoNamespace *ns )
 {
 	DaoNamespace *randomns = DaoNamespace_GetNamespace( ns, "random" );
+	DaoRandom_InitZiggurat();
+	dao_random_seed = time(NULL);
+#ifdef DAO_WITH_THREAD
+	DMutex_Init( & dao_random_mutex );
+#endif
 	DaoNamespace_WrapType( randomns, & daoRandGeneratorCore, DAO_CSTRUCT, 0 );
 	DaoNamespace_WrapFunctions( randomns, randomMeths );
 
@@ -41,8 +41,24 @@
 #define __DAO_RANDOM_H__
 
 #include<stdlib.h>
+#include<stdint.h>
 #include<math.h>
 
+enum DaoRandEngines
+{
+	DAO_RAND_MT19937 ,    /* Mersenne Twister, the default engine; */
+	DAO_RAND_XOSHIRO256 , /* xoshiro256**; */
+	DAO_RAND_PCG64 ,      /* PCG XSL-RR 128/64; */
+	DAO_RAND_PHILOX       /* Philox 4x32-10, counter-based; */
+};
+
+enum DaoRandDistributions
+{
+	DAO_RAND_UNIFORM ,
+	DAO_RAND_NORMAL ,
+	DAO_RAND_EXPONENTIAL
+};
+
 typedef struct DaoRandGenerator DaoRandGenerator;
 #endif
 
@@ -52,6 +68,12 @@ DAO_API( RANDOM, void, DaoRandGenerator_Seed, (DaoRandGenerator *self, uint_t se
 DAO_API( RANDOM, unsigned, DaoRandGenerator_GetUniformInt, (DaoRandGenerator *self, unsigned max) );
 DAO_API( RANDOM, double, DaoRandGenerator_GetUniform, (DaoRandGenerator *self) );
 DAO_API( RANDOM, double, DaoRandGenerator_GetNormal, (DaoRandGenerator *self) );
+DAO_API( RANDOM, DaoRandGenerator*, DaoRandGenerator_NewEngine, (int engine, uint_t seed) );
+DAO_API( RANDOM, uint64_t, DaoRandGenerator_GetInt64, (DaoRandGenerator *self) );
+DAO_API( RANDOM, double, DaoRandGenerator_GetExponential, (DaoRandGenerator *self) );
+DAO_API( RANDOM, void, DaoRandGenerator_Fill, (DaoRandGenerator *self, double *dest, daoint count, int dist) );
+DAO_API( RANDOM, void, DaoRandGenerator_Jump, (DaoRandGenerator *self) );
+DAO_API( RANDOM, void, DaoRandGenerator_FillInt, (DaoRandGenerator *self, dao_integer *dest, daoint count, dao_integer min, dao_integer max) );
 
 /*
 %s/DAO_DLL \(.*\) \(\w\+\)( \(.*\) )/DAO_API( RANDOM, \1, \2, (\3) )/g
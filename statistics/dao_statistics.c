@@ -28,9 +28,119 @@
 
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 #include "dao.h"
 #include "daoNumtype.h"
 #include "daoValue.h"
+#include "daoThread.h"
+
+#ifdef UNIX
+#include <unistd.h>
+#endif
+
+
+/*
+// Work range of an array (or an array slice); the items of the range are
+// stored in intervals of "len" contiguous items separated by "step" items.
+*/
+typedef struct StatWork StatWork;
+
+struct StatWork
+{
+	DaoArray  *array;  /* work array holding the items; */
+	daoint     size;
+	daoint     start;
+	daoint     len;
+	daoint     step;
+};
+
+void StatWork_Init( StatWork *self, DaoArray *arr )
+{
+	self->size = DaoArray_GetWorkSize( arr );
+	self->start = DaoArray_GetWorkStart( arr );
+	self->len = DaoArray_GetWorkIntervalSize( arr );
+	self->step = DaoArray_GetWorkStep( arr );
+	self->array = DaoArray_GetWorkArray( arr );
+	if ( self->len <= 0 )
+		self->len = self->size ? self->size : 1;
+}
+
+/* Return the number of contiguous items starting from the i-th item, and their position in "*j": */
+daoint StatWork_GetRun( StatWork *self, daoint i, daoint end, daoint *j )
+{
+	daoint offset = i % self->len;
+	daoint count = self->len - offset;
+	*j = self->start + (i / self->len) * self->step + offset;
+	return count < end - i ? count : end - i;
+}
+
+
+/*
+// Parallel tasks over contiguous blocks of items; the last block is processed
+// by the calling thread. Without thread support, the blocks run in sequence.
+*/
+#define STAT_MAX_THREADS  16
+#define STAT_MIN_BLOCK    (1<<16)
+
+typedef struct StatTask StatTask;
+
+struct StatTask
+{
+	void    (*function)( StatTask *task );
+	void     *context;
+	daoint    first;
+	daoint    end;
+	int       index;
+};
+
+int GetTaskCount( daoint count, daoint minblock )
+{
+	daoint tasks = 1;
+#if defined(DAO_WITH_THREAD) && defined(UNIX)
+	tasks = sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+	if ( tasks > STAT_MAX_THREADS )
+		tasks = STAT_MAX_THREADS;
+	if ( count / minblock < tasks )
+		tasks = count / minblock;
+	return tasks < 1 ? 1 : tasks;
+}
+
+static void RunTask( void *p )
+{
+	StatTask *task = (StatTask*) p;
+	task->function( task );
+}
+
+void RunTasks( StatTask tasks[], void (*function)( StatTask* ), void *context, daoint count, int ntask )
+{
+#ifdef DAO_WITH_THREAD
+	DThread threads[STAT_MAX_THREADS];
+#endif
+	int i;
+	for( i = 0; i < ntask; i++ ){
+		tasks[i].function = function;
+		tasks[i].context = context;
+		tasks[i].first = (count * i) / ntask;
+		tasks[i].end = (count * (i + 1)) / ntask;
+		tasks[i].index = i;
+	}
+#ifdef DAO_WITH_THREAD
+	for( i = 0; i < ntask - 1; i++ ){
+		DThread_Init( &threads[i] );
+		DThread_Start( &threads[i], RunTask, &tasks[i] );
+	}
+	RunTask( &tasks[ntask - 1] );
+	for( i = 0; i < ntask - 1; i++ ){
+		DThread_Join( &threads[i] );
+		DThread_Destroy( &threads[i] );
+	}
+#else
+	for( i = 0; i < ntask; i++ )
+		RunTask( &tasks[i] );
+#endif
+}
+
 
 double Mean( DaoArray *arr )
 {
@@ -57,7 +167,7 @@ double Mean( DaoArray *arr )
 		}
 		break;
 	}
-	return sum/arr->size;
+	return sum/size;
 }
 
 double Variance( DaoArray *arr, double mean, int sample )
@@ -133,11 +243,6 @@ double CorrelationPearson( DaoArray *arr1, DaoArray *arr2, double mean1, double
 	return sum/size1/dev1/dev2;
 }
 
-int CompareDoubles( const void *x, const void *y )
-{
-	return *(double*)x > *(double*)y;
-}
-
 void CopyToDouble( DaoArray *src, DaoArray *dest )
 {
 	daoint size = DaoArray_GetWorkSize( src );
@@ -163,46 +268,254 @@ void CopyToDouble( DaoArray *src, DaoArray *dest )
 	}
 }
 
-void ValuesToRanks( DaoArray *arr )
+typedef struct StatRankItem StatRankItem;
+
+struct StatRankItem
 {
-	daoint i;
-	if ( arr->etype != DAO_FLOAT)
-		return;
-	for ( i = 0; i < arr->size; ){
-		daoint j, count = 1, rank = i + 1;
-		for ( j = i + 1; j < arr->size && arr->data.f[i] == arr->data.f[j]; j++ ){
-			rank += j + 1;
-			count++;
+	double  value;
+	daoint  index;
+};
+
+/* Map a double to an unsigned integer of the same order: */
+static uint64_t SortableBits( double value )
+{
+	uint64_t bits;
+	memcpy( &bits, &value, sizeof(bits) );
+	return bits & ((uint64_t)1 << 63) ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+/* Stable LSD radix sort on 8-bit digits, skipping the digits shared by all items: */
+void SortRankItems( StatRankItem *items, StatRankItem *temp, daoint count )
+{
+	daoint counts[256];
+	daoint i, k;
+	int shift;
+	for ( shift = 0; shift < 64; shift += 8 ){
+		daoint offset = 0;
+		memset( counts, 0, sizeof(counts) );
+		for ( i = 0; i < count; i++ )
+			counts[ (SortableBits( items[i].value ) >> shift) & 0xff ] += 1;
+		if ( counts[ (SortableBits( items[0].value ) >> shift) & 0xff ] == count )
+			continue;
+		for ( k = 0; k < 256; k++ ){
+			daoint n = counts[k];
+			counts[k] = offset;
+			offset += n;
 		}
-		for ( j = i; j < i + count; j++ )
-			arr->data.f[j] = rank/(double)count;
-		i += count;
+		for ( i = 0; i < count; i++ )
+			temp[ counts[ (SortableBits( items[i].value ) >> shift) & 0xff ]++ ] = items[i];
+		for ( i = 0; i < count; i++ )
+			items[i] = temp[i];
+	}
+}
+
+/*
+// Replace the "count" values spaced by "stride" with their ranks (starting from 1),
+// tied values get the average of their ranks; "buffer" holds "2*count" items:
+*/
+void ValuesToRanks( double *values, daoint count, daoint stride, StatRankItem *buffer )
+{
+	daoint i, j;
+	if ( count == 0 )
+		return;
+	for ( i = 0; i < count; i++ ){
+		buffer[i].value = values[i*stride];
+		buffer[i].index = i;
+	}
+	SortRankItems( buffer, buffer + count, count );
+	for ( i = 0; i < count; i = j ){
+		double rank;
+		for ( j = i + 1; j < count && buffer[j].value == buffer[i].value; j++ );
+		rank = 0.5*( i + j + 1 );
+		for ( ; i < j; i++ )
+			values[ buffer[i].index*stride ] = rank;
 	}
 }
 
 double CorrelationSpearman( DaoArray *arr1, DaoArray *arr2 )
 {
-	daoint size = arr1->size;
+	daoint size = DaoArray_GetWorkSize( arr1 );
 	DaoArray *ranks1, *ranks2;
+	StatRankItem *buffer;
 	double res;
-	if ( arr2->size != size )
+	if ( DaoArray_GetWorkSize( arr2 ) != size )
 		return 0;
 	if ( !size || arr1->etype != arr2->etype )
 		return 0;
 	ranks1 = DaoArray_New( DAO_FLOAT );
 	ranks2 = DaoArray_New( DAO_FLOAT );
+	buffer = (StatRankItem*) dao_malloc( 2*size*sizeof(StatRankItem) );
 	CopyToDouble( arr1, ranks1 );
 	CopyToDouble( arr2, ranks2 );
-	qsort( ranks1->data.p, size, sizeof(double), CompareDoubles );
-	qsort( ranks2->data.p, size, sizeof(double), CompareDoubles );
-	ValuesToRanks( ranks1 );
-	ValuesToRanks( ranks2 );
+	ValuesToRanks( ranks1->data.f, size, 1, buffer );
+	ValuesToRanks( ranks2->data.f, size, 1, buffer );
 	res = CorrelationPearson( ranks1, ranks2, Mean( ranks1 ), Mean( ranks2 ) );
+	dao_free( buffer );
 	DaoArray_Delete( ranks1 );
 	DaoArray_Delete( ranks2 );
 	return res;
 }
 
+/*
+// Correlation matrix:
+//
+// The columns of the row-major "rows" x "cols" matrix are standardized in place
+// (centered and scaled to unit norm, after being replaced by ranks for Spearman's
+// coefficient), so that the correlation matrix is the product of the transposed
+// matrix and the matrix. The product is accumulated for tiles of column pairs over
+// blocks of rows to keep the operands in cache; the row blocks are split between
+// parallel tasks, each of which sums its own partial upper triangle.
+// The diagonal is always one; a constant column (of zero variance) has no
+// defined correlation with the other columns, which is NaN.
+*/
+#define STAT_CORR_TILE    32
+#define STAT_CORR_BLOCK   256
+#define STAT_CORR_MEMORY  (1<<23)  /* Maximum number of items in partial products; */
+
+typedef struct StatCorrelation StatCorrelation;
+
+struct StatCorrelation
+{
+	double  *matrix;
+	daoint   rows;
+	daoint   cols;
+	double  *sums;   /* partial products of the tasks; */
+};
+
+void StatCorrelation_Standardize( StatCorrelation *self, int spearman )
+{
+	double *matrix = self->matrix;
+	daoint rows = self->rows, cols = self->cols;
+	double *means = (double*) dao_calloc( 2*cols, sizeof(double) );
+	double *norms = means + cols;
+	char *constant = (char*) dao_malloc( cols );
+	daoint i, k;
+	if ( spearman ){
+		StatRankItem *buffer = (StatRankItem*) dao_malloc( 2*rows*sizeof(StatRankItem) );
+		for ( k = 0; k < cols; k++ )
+			ValuesToRanks( matrix + k, rows, cols, buffer );
+		dao_free( buffer );
+	}
+	memset( constant, 1, cols );
+	for ( i = 0; i < rows; i++ ){
+		double *row = matrix + i*cols;
+		for ( k = 0; k < cols; k++ ){
+			means[k] += row[k];
+			if ( row[k] != matrix[k] )
+				constant[k] = 0;
+		}
+	}
+	for ( k = 0; k < cols; k++ )
+		means[k] /= rows;
+	for ( i = 0; i < rows; i++ ){
+		double *row = matrix + i*cols;
+		for ( k = 0; k < cols; k++ ){
+			row[k] -= means[k];
+			norms[k] += row[k]*row[k];
+		}
+	}
+	/* Constant columns are checked exactly, since their centered items may not be zero: */
+	for ( k = 0; k < cols; k++ )
+		norms[k] = constant[k] ? NAN : 1.0/sqrt( norms[k] );
+	for ( i = 0; i < rows; i++ ){
+		double *row = matrix + i*cols;
+		for ( k = 0; k < cols; k++ )
+			row[k] *= norms[k];
+	}
+	dao_free( constant );
+	dao_free( means );
+}
+
+/*
+// Add the products of the columns over the rows [first,end) to the upper triangle of "sums";
+// each block of rows is transposed into "panel", so that the products are dot products
+// of contiguous vectors, computed for four column pairs at once:
+*/
+void StatCorrelation_AddProducts( StatCorrelation *self, double *sums, double *panel, daoint first, daoint end )
+{
+	daoint cols = self->cols;
+	daoint i, j, k, r, b, n, t1, t2;
+	for ( b = first; b < end; b += STAT_CORR_BLOCK ){
+		n = b + STAT_CORR_BLOCK < end ? STAT_CORR_BLOCK : end - b;
+		for ( r = 0; r < n; r++ ){
+			const double *row = self->matrix + (b + r)*cols;
+			for ( k = 0; k < cols; k++ )
+				panel[k*STAT_CORR_BLOCK + r] = row[k];
+		}
+		for ( t1 = 0; t1 < cols; t1 += STAT_CORR_TILE ){
+			daoint e1 = t1 + STAT_CORR_TILE < cols ? t1 + STAT_CORR_TILE : cols;
+			for ( t2 = t1; t2 < cols; t2 += STAT_CORR_TILE ){
+				daoint e2 = t2 + STAT_CORR_TILE < cols ? t2 + STAT_CORR_TILE : cols;
+				for ( i = t1; i < e1; i++ ){
+					const double *x = panel + i*STAT_CORR_BLOCK;
+					double *sum = sums + i*cols;
+					for ( j = i > t2 ? i : t2; j + 4 <= e2; j += 4 ){
+						const double *y0 = panel + j*STAT_CORR_BLOCK;
+						const double *y1 = y0 + STAT_CORR_BLOCK;
+						const double *y2 = y1 + STAT_CORR_BLOCK;
+						const double *y3 = y2 + STAT_CORR_BLOCK;
+						double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+						for ( r = 0; r < n; r++ ){
+							s0 += x[r]*y0[r];
+							s1 += x[r]*y1[r];
+							s2 += x[r]*y2[r];
+							s3 += x[r]*y3[r];
+						}
+						sum[j] += s0;
+						sum[j+1] += s1;
+						sum[j+2] += s2;
+						sum[j+3] += s3;
+					}
+					for ( ; j < e2; j++ ){
+						const double *y = panel + j*STAT_CORR_BLOCK;
+						double s0 = 0.0;
+						for ( r = 0; r < n; r++ )
+							s0 += x[r]*y[r];
+						sum[j] += s0;
+					}
+				}
+			}
+		}
+	}
+}
+
+static void StatCorrelation_RunTask( StatTask *task )
+{
+	StatCorrelation *self = (StatCorrelation*) task->context;
+	double *sums = self->sums + task->index*self->cols*self->cols;
+	double *panel = (double*) dao_malloc( self->cols*STAT_CORR_BLOCK*sizeof(double) );
+	StatCorrelation_AddProducts( self, sums, panel, task->first, task->end );
+	dao_free( panel );
+}
+
+/* Compute the "cols" x "cols" correlation matrix of the columns of "self->matrix" into "result": */
+void CorrelationMatrix( StatCorrelation *self, int spearman, double *result )
+{
+	StatTask tasks[STAT_MAX_THREADS];
+	daoint cols = self->cols, area = cols*cols;
+	daoint i, j, k;
+	int ntask;
+	StatCorrelation_Standardize( self, spearman );
+	ntask = GetTaskCount( self->rows*cols, STAT_MIN_BLOCK );
+	if ( ntask > 1 && ntask*area > STAT_CORR_MEMORY )
+		ntask = STAT_CORR_MEMORY/area > 1 ? STAT_CORR_MEMORY/area : 1;
+	self->sums = (double*) dao_calloc( ntask*area, sizeof(double) );
+	RunTasks( tasks, StatCorrelation_RunTask, self, self->rows, ntask );
+	for ( i = 0; i < cols; i++ ){
+		for ( j = i; j < cols; j++ ){
+			double sum = 0.0;
+			for ( k = 0; k < ntask; k++ )
+				sum += self->sums[k*area + i*cols + j];
+			if ( sum > 1.0 ) sum = 1.0;
+			if ( sum < -1.0 ) sum = -1.0;
+			result[i*cols + j] = result[j*cols + i] = sum;
+		}
+		result[i*cols + i] = 1.0;
+	}
+	dao_free( self->sums );
+	self->sums = NULL;
+}
+
 double Moment( DaoArray *arr, int kurtosis, double mean )
 {
 	daoint size = DaoArray_GetWorkSize( arr );
@@ -226,7 +539,7 @@ double Moment( DaoArray *arr, int kurtosis, double mean )
 	case DAO_FLOAT:
 		for( i = 0; i < size; i++ ){
 			daoint j = start + (i / len) * step + (i % len);
-			daoint x = arr->data.f[j];
+			double x = arr->data.f[j];
 			sum += pow( ( x - mean )/dev, pw );
 		}
 		break;
@@ -234,6 +547,722 @@ double Moment( DaoArray *arr, int kurtosis, double mean )
 	return sum/size - ( kurtosis? 3 : 0 );
 }
 
+/*
+// Selection of order statistics:
+//
+// The k-th smallest item is placed at position k by introselect: Hoare
+// partitioning around a median-of-three pivot, narrowed to the side that
+// holds k, falling back to heap sort when the partitioning degenerates.
+// Several order statistics are selected in one recursive partitioning:
+// the middle requested rank is selected first, then the smaller ranks are
+// selected on its left side and the larger ones on its right side.
+// The functions are defined for both integer and float items.
+*/
+#define STAT_SELECTION( Prefix, Type ) \
+static void Prefix##SiftDown( Type *x, daoint n, daoint i ) \
+{ \
+	Type item = x[i]; \
+	while( 2*i + 1 < n ){ \
+		daoint child = 2*i + 1; \
+		if ( child + 1 < n && x[child] < x[child + 1] ) child += 1; \
+		if ( !( item < x[child] ) ) break; \
+		x[i] = x[child]; \
+		i = child; \
+	} \
+	x[i] = item; \
+} \
+static void Prefix##HeapSort( Type *x, daoint n ) \
+{ \
+	daoint i; \
+	for( i = n/2 - 1; i >= 0; i-- ) Prefix##SiftDown( x, n, i ); \
+	for( i = n - 1; i > 0; i-- ){ \
+		Type item = x[0]; \
+		x[0] = x[i]; \
+		x[i] = item; \
+		Prefix##SiftDown( x, i, 0 ); \
+	} \
+} \
+static void Prefix##InsertionSort( Type *x, daoint n ) \
+{ \
+	daoint i, j; \
+	for( i = 1; i < n; i++ ){ \
+		Type item = x[i]; \
+		for( j = i; j > 0 && item < x[j - 1]; j-- ) x[j] = x[j - 1]; \
+		x[j] = item; \
+	} \
+} \
+static void Prefix##Select( Type *x, daoint lo, daoint hi, daoint k ) \
+{ \
+	daoint depth = 0, size; \
+	for( size = hi - lo + 1; size > 1; size >>= 1 ) depth += 2; \
+	while( hi - lo > 16 ){ \
+		daoint mid = lo + (hi - lo) / 2, i = lo - 1, j = hi + 1; \
+		Type a = x[lo], b = x[mid], c = x[hi], pivot, item; \
+		if ( depth-- <= 0 ){ \
+			Prefix##HeapSort( x + lo, hi - lo + 1 ); \
+			return; \
+		} \
+		pivot = a < b ? ( b < c ? b : ( a < c ? c : a ) ) : ( a < c ? a : ( b < c ? c : b ) ); \
+		while( 1 ){ \
+			do i++; while( x[i] < pivot ); \
+			do j--; while( pivot < x[j] ); \
+			if ( i >= j ) break; \
+			item = x[i]; \
+			x[i] = x[j]; \
+			x[j] = item; \
+		} \
+		if ( k <= j ) hi = j; else lo = j + 1; \
+	} \
+	Prefix##InsertionSort( x + lo, hi - lo + 1 ); \
+} \
+void Prefix##MultiSelect( Type *x, daoint lo, daoint hi, daoint *ranks, int count ) \
+{ \
+	int mid = count / 2; \
+	daoint k; \
+	if ( count <= 0 || lo >= hi ) return; \
+	k = ranks[mid]; \
+	Prefix##Select( x, lo, hi, k ); \
+	Prefix##MultiSelect( x, lo, k - 1, ranks, mid ); \
+	Prefix##MultiSelect( x, k + 1, hi, ranks + mid + 1, count - mid - 1 ); \
+}
+
+STAT_SELECTION( Integers, dao_integer )
+STAT_SELECTION( Floats, double )
+
+int CompareRanks( const void *x, const void *y )
+{
+	daoint a = *(daoint*)x, b = *(daoint*)y;
+	return a == b ? 0 : ( a < b ? -1 : 1 );
+}
+
+/* Move NaN items to the end, and return the number of other items: */
+daoint FloatsDropNaN( double *x, daoint n )
+{
+	daoint i, m = 0;
+	for( i = 0; i < n; i++ ){
+		if ( x[i] == x[i] ){
+			double item = x[m];
+			x[m++] = x[i];
+			x[i] = item;
+		}
+	}
+	return m;
+}
+
+/*
+// Compute the quantiles at "percentages" of "n" integer or float items,
+// and store them in "result"; a quantile between two order statistics is
+// interpolated linearly. The items are reordered.
+*/
+void Quantiles( DaoArray *arr, daoint n, double *percentages, double *result, int count )
+{
+	daoint *ranks = (daoint*) dao_malloc( (2*count + 1) * sizeof(daoint) );
+	int i, count2, nrank = 0;
+	for( i = 0; i < count; i++ ){
+		double h = (n - 1) * percentages[i] / 100;
+		daoint k = floor( h );
+		ranks[nrank++] = k;
+		if ( k + 1 < n && h > k )
+			ranks[nrank++] = k + 1;
+	}
+	qsort( ranks, nrank, sizeof(daoint), CompareRanks );
+	for( i = 1, count2 = 1; i < nrank; i++ ){
+		if ( ranks[i] != ranks[count2 - 1] )
+			ranks[count2++] = ranks[i];
+	}
+	nrank = nrank ? count2 : 0;
+	if ( arr->etype == DAO_INTEGER )
+		IntegersMultiSelect( arr->data.i, 0, n - 1, ranks, nrank );
+	else
+		FloatsMultiSelect( arr->data.f, 0, n - 1, ranks, nrank );
+	for( i = 0; i < count; i++ ){
+		double h = (n - 1) * percentages[i] / 100;
+		daoint k = floor( h );
+		double a, b;
+		if ( arr->etype == DAO_INTEGER ){
+			a = arr->data.i[k];
+			b = k + 1 < n ? arr->data.i[k + 1] : a;
+		}
+		else {
+			a = arr->data.f[k];
+			b = k + 1 < n ? arr->data.f[k + 1] : a;
+		}
+		result[i] = h > k ? a + ( h - k ) * ( b - a ) : a;
+	}
+	dao_free( ranks );
+}
+
+/*
+// Single pass moments:
+//
+// The items are accumulated in blocks: the mean, minimum and maximum of a block
+// are computed in a first pass over the block (which stays in cache), and the
+// sums of the powers of the deviations from the block mean in a second pass.
+// The block moments are then merged into the running moments with the pairwise
+// update formulas of Chan and Terriberry (generalized by Pebay), which are also
+// used to merge the moments of the parallel tasks. Both block passes use four
+// independent accumulators, so that they can be vectorized.
+*/
+#define STAT_MOMENT_BLOCK  1024
+
+typedef struct StatMoments StatMoments;
+
+struct StatMoments
+{
+	double       count;
+	double       mean;
+	double       m2;    /* Σ(x - mean)^2; */
+	double       m3;    /* Σ(x - mean)^3; */
+	double       m4;    /* Σ(x - mean)^4; */
+	double       fmin;
+	double       fmax;
+	dao_integer  imin;
+	dao_integer  imax;
+};
+
+void StatMoments_Init( StatMoments *self )
+{
+	memset( self, 0, sizeof(StatMoments) );
+}
+
+void StatMoments_Merge( StatMoments *self, StatMoments *other )
+{
+	double na = self->count, nb = other->count, n = na + nb;
+	double d, d2;
+	if ( nb == 0 )
+		return;
+	if ( na == 0 ){
+		*self = *other;
+		return;
+	}
+	d = other->mean - self->mean;
+	d2 = d * d;
+	self->m4 += other->m4 + d2 * d2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+		+ 6 * d2 * (na * na * other->m2 + nb * nb * self->m2) / (n * n)
+		+ 4 * d * (na * other->m3 - nb * self->m3) / n;
+	self->m3 += other->m3 + d2 * d * na * nb * (na - nb) / (n * n)
+		+ 3 * d * (na * other->m2 - nb * self->m2) / n;
+	self->m2 += other->m2 + d2 * na * nb / n;
+	self->mean += d * nb / n;
+	self->count = n;
+	if ( other->fmin < self->fmin ) self->fmin = other->fmin;
+	if ( other->fmax > self->fmax ) self->fmax = other->fmax;
+	if ( other->imin < self->imin ) self->imin = other->imin;
+	if ( other->imax > self->imax ) self->imax = other->imax;
+}
+
+void StatMoments_AddBlock( StatMoments *self, const double *x, daoint n )
+{
+	StatMoments block;
+	double sum[4] = {0.0, 0.0, 0.0, 0.0};
+	double s2[4] = {0.0, 0.0, 0.0, 0.0};
+	double s3[4] = {0.0, 0.0, 0.0, 0.0};
+	double s4[4] = {0.0, 0.0, 0.0, 0.0};
+	double min[4], max[4];
+	daoint i, m = n & ~(daoint)3;
+	int l;
+	if ( n == 0 )
+		return;
+	for( l = 0; l < 4; l++ )
+		min[l] = max[l] = x[0];
+	for( i = 0; i < m; i += 4 ){
+		for( l = 0; l < 4; l++ ){
+			sum[l] += x[i + l];
+			min[l] = x[i + l] < min[l] ? x[i + l] : min[l];
+			max[l] = x[i + l] > max[l] ? x[i + l] : max[l];
+		}
+	}
+	for( ; i < n; i++ ){
+		sum[0] += x[i];
+		min[0] = x[i] < min[0] ? x[i] : min[0];
+		max[0] = x[i] > max[0] ? x[i] : max[0];
+	}
+	StatMoments_Init( &block );
+	block.count = n;
+	block.mean = ((sum[0] + sum[1]) + (sum[2] + sum[3])) / n;
+	block.fmin = min[0];
+	block.fmax = max[0];
+	for( l = 1; l < 4; l++ ){
+		if ( min[l] < block.fmin ) block.fmin = min[l];
+		if ( max[l] > block.fmax ) block.fmax = max[l];
+	}
+	for( i = 0; i < m; i += 4 ){
+		for( l = 0; l < 4; l++ ){
+			double d = x[i + l] - block.mean, dd = d * d;
+			s2[l] += dd;
+			s3[l] += dd * d;
+			s4[l] += dd * dd;
+		}
+	}
+	for( ; i < n; i++ ){
+		double d = x[i] - block.mean, dd = d * d;
+		s2[0] += dd;
+		s3[0] += dd * d;
+		s4[0] += dd * dd;
+	}
+	block.m2 = (s2[0] + s2[1]) + (s2[2] + s2[3]);
+	block.m3 = (s3[0] + s3[1]) + (s3[2] + s3[3]);
+	block.m4 = (s4[0] + s4[1]) + (s4[2] + s4[3]);
+	block.imin = self->imin;
+	block.imax = self->imax;
+	StatMoments_Merge( self, &block );
+}
+
+void StatMoments_AddRange( StatMoments *self, StatWork *work, daoint first, daoint end )
+{
+	double buffer[STAT_MOMENT_BLOCK];
+	daoint i, j, k, n;
+	for( i = first; i < end; i += n ){
+		n = StatWork_GetRun( work, i, end, &j );
+		if ( work->array->etype == DAO_FLOAT ){
+			for( k = 0; k < n; k += STAT_MOMENT_BLOCK )
+				StatMoments_AddBlock( self, work->array->data.f + j + k, n - k < STAT_MOMENT_BLOCK ? n - k : STAT_MOMENT_BLOCK );
+			continue;
+		}
+		for( k = 0; k < n; k += STAT_MOMENT_BLOCK ){
+			dao_integer *ints = work->array->data.i + j + k;
+			daoint b, m = n - k < STAT_MOMENT_BLOCK ? n - k : STAT_MOMENT_BLOCK;
+			dao_integer min = ints[0], max = ints[0];
+			for( b = 0; b < m; b++ ){
+				buffer[b] = ints[b];
+				min = ints[b] < min ? ints[b] : min;
+				max = ints[b] > max ? ints[b] : max;
+			}
+			if ( self->count == 0 || min < self->imin ) self->imin = min;
+			if ( self->count == 0 || max > self->imax ) self->imax = max;
+			StatMoments_AddBlock( self, buffer, m );
+		}
+	}
+}
+
+typedef struct StatMomentsJob StatMomentsJob;
+
+struct StatMomentsJob
+{
+	StatWork     work;
+	StatMoments  parts[STAT_MAX_THREADS];
+};
+
+static void StatMoments_RunTask( StatTask *task )
+{
+	StatMomentsJob *job = (StatMomentsJob*) task->context;
+	StatMoments *self = job->parts + task->index;
+	StatMoments_Init( self );
+	StatMoments_AddRange( self, &job->work, task->first, task->end );
+}
+
+/* Compute the moments of "arr" in one pass, with parallel tasks for large arrays: */
+void Moments( DaoArray *arr, StatMoments *result )
+{
+	StatTask tasks[STAT_MAX_THREADS];
+	StatMomentsJob job;
+	int i, ntask;
+	StatWork_Init( &job.work, arr );
+	ntask = GetTaskCount( job.work.size, STAT_MIN_BLOCK );
+	RunTasks( tasks, StatMoments_RunTask, &job, job.work.size, ntask );
+	StatMoments_Init( result );
+	for( i = 0; i < ntask; i++ )
+		StatMoments_Merge( result, job.parts + i );
+}
+
+double MomentsVariance( StatMoments *self, int sample )
+{
+	if ( self->count == 0 || ( sample && self->count == 1 ) )
+		return 0;
+	return self->m2 / ( self->count - ( sample? 1 : 0 ) );
+}
+
+double MomentsSkewness( StatMoments *self )
+{
+	if ( self->m2 == 0 )
+		return 0;
+	return sqrt( self->count ) * self->m3 / pow( self->m2, 1.5 );
+}
+
+double MomentsKurtosis( StatMoments *self )
+{
+	if ( self->m2 == 0 )
+		return 0;
+	return self->count * self->m4 / ( self->m2 * self->m2 ) - 3;
+}
+
+/*
+// Streaming quantile sketch (merging t-digest):
+//
+// The digest summarizes the items by a bounded number of centroids (mean and
+// weight) sorted by mean. New items are appended to a buffer, and the buffer
+// is merged with the centroids when it is full or when the digest is queried:
+// all the points are sorted by mean, and adjacent points are merged as long as
+// the merged centroid spans at most one unit of the logistic scale function
+// k(q) (see below), which keeps the centroids small near the tails. The number
+// of centroids is bounded by a small multiple of the compression (up to about
+// 2.9 times), within the fixed capacity shared with the buffer.
+// Digests are merged by adding the centroids of one digest to the other.
+*/
+typedef struct StatCentroid StatCentroid;
+typedef struct StatDigest   StatDigest;
+
+struct StatCentroid
+{
+	double  mean;
+	double  weight;
+};
+
+struct StatDigest
+{
+	DAO_CSTRUCT_COMMON;
+
+	double         compression;
+	double         min;
+	double         max;
+	double         total;      /* total weight of the centroids; */
+	daoint         count;      /* number of centroids; */
+	daoint         buffered;   /* number of buffered points after the centroids; */
+	daoint         capacity;   /* maximum number of centroids and buffered points; */
+	StatCentroid  *points;
+};
+
+extern DaoTypeCore statDigestCore;
+
+StatDigest* StatDigest_New( DaoType *type, double compression )
+{
+	StatDigest *self = (StatDigest*) dao_calloc( 1, sizeof(StatDigest) );
+	DaoCstruct_Init( (DaoCstruct*) self, type );
+	self->compression = compression;
+	self->min = INFINITY;
+	self->max = -INFINITY;
+	self->capacity = 5 * (daoint) ceil( compression ) + 2;
+	self->points = (StatCentroid*) dao_malloc( self->capacity * sizeof(StatCentroid) );
+	return self;
+}
+
+void StatDigest_Delete( StatDigest *self )
+{
+	DaoCstruct_Free( (DaoCstruct*) self );
+	dao_free( self->points );
+	dao_free( self );
+}
+
+int CompareCentroids( const void *x, const void *y )
+{
+	double a = ((StatCentroid*)x)->mean, b = ((StatCentroid*)y)->mean;
+	return a == b ? 0 : ( a < b ? -1 : 1 );
+}
+
+/*
+// Scale function k(q) = compression / z * log(q / (1 - q)), where z depends on the total
+// weight; and its inverse function:
+*/
+double StatDigest_Normalizer( StatDigest *self, double total )
+{
+	double n = total > self->compression ? total : self->compression;
+	return 4 * log( n / self->compression ) + 24;
+}
+
+double StatDigest_Scale( StatDigest *self, double q, double z )
+{
+	if ( q <= 1E-15 ) q = 1E-15;
+	if ( q >= 1 - 1E-15 ) q = 1 - 1E-15;
+	return self->compression / z * log( q / ( 1 - q ) );
+}
+
+double StatDigest_InverseScale( StatDigest *self, double k, double z )
+{
+	return 1 / ( 1 + exp( - k * z / self->compression ) );
+}
+
+void StatDigest_Compress( StatDigest *self )
+{
+	StatCentroid *points = self->points;
+	daoint i, n = self->count + self->buffered, m = 0;
+	double total = 0, sofar = 0, limit, z;
+	if ( self->buffered == 0 )
+		return;
+	for( i = 0; i < n; i++ )
+		total += points[i].weight;
+	qsort( points, n, sizeof(StatCentroid), CompareCentroids );
+	z = StatDigest_Normalizer( self, total );
+	limit = total * StatDigest_InverseScale( self, StatDigest_Scale( self, 0, z ) + 1, z );
+	for( i = 1; i < n; i++ ){
+		StatCentroid *cur = points + m;
+		if ( sofar + cur->weight + points[i].weight <= limit ){
+			cur->weight += points[i].weight;
+			cur->mean += ( points[i].mean - cur->mean ) * points[i].weight / cur->weight;
+			continue;
+		}
+		sofar += cur->weight;
+		limit = total * StatDigest_InverseScale( self, StatDigest_Scale( self, sofar / total, z ) + 1, z );
+		points[++m] = points[i];
+	}
+	self->count = m + 1;
+	self->buffered = 0;
+	self->total = total;
+}
+
+void StatDigest_AddWeighted( StatDigest *self, double value, double weight )
+{
+	StatCentroid *point;
+	if ( value != value || weight <= 0 )
+		return;
+	if ( self->count + self->buffered >= self->capacity )
+		StatDigest_Compress( self );
+	if ( self->count >= self->capacity ){ /* Not expected; */
+		self->capacity *= 2;
+		self->points = (StatCentroid*) dao_realloc( self->points, self->capacity * sizeof(StatCentroid) );
+	}
+	point = self->points + self->count + self->buffered++;
+	point->mean = value;
+	point->weight = weight;
+	if ( value < self->min ) self->min = value;
+	if ( value > self->max ) self->max = value;
+}
+
+void StatDigest_AddArray( StatDigest *self, DaoArray *arr )
+{
+	StatWork work;
+	daoint i, j, k, n;
+	StatWork_Init( &work, arr );
+	for( i = 0; i < work.size; i += n ){
+		n = StatWork_GetRun( &work, i, work.size, &j );
+		for( k = j; k < j + n; k++ ){
+			double value = work.array->etype == DAO_INTEGER ? work.array->data.i[k] : work.array->data.f[k];
+			StatDigest_AddWeighted( self, value, 1.0 );
+		}
+	}
+}
+
+void StatDigest_Merge( StatDigest *self, StatDigest *other )
+{
+	daoint i, n;
+	if ( self == other ){ /* Merging a digest with itself doubles the weights: */
+		StatDigest_Compress( self );
+		for( i = 0; i < self->count; i++ )
+			self->points[i].weight *= 2;
+		self->total *= 2;
+		return;
+	}
+	n = other->count + other->buffered;
+	for( i = 0; i < n; i++ )
+		StatDigest_AddWeighted( self, other->points[i].mean, other->points[i].weight );
+	if ( other->min < self->min ) self->min = other->min;
+	if ( other->max > self->max ) self->max = other->max;
+}
+
+/* The quantile at "q" (in [0, 1]), interpolated between the centroid means: */
+double StatDigest_Quantile( StatDigest *self, double q )
+{
+	StatCentroid *points = self->points;
+	double index, left = 0, total;
+	daoint i, n;
+	StatDigest_Compress( self );
+	n = self->count;
+	total = self->total;
+	if ( n == 0 )
+		return NAN;
+	if ( q <= 0 )
+		return self->min;
+	if ( q >= 1 )
+		return self->max;
+	if ( n == 1 )
+		return points[0].mean;
+	index = q * total;
+	if ( index < points[0].weight / 2 )
+		return self->min + ( points[0].mean - self->min ) * index / ( points[0].weight / 2 );
+	for( i = 0; i < n - 1; i++ ){
+		double a = left + points[i].weight / 2;
+		double b = left + points[i].weight + points[i+1].weight / 2;
+		if ( index < b )
+			return points[i].mean + ( points[i+1].mean - points[i].mean ) * ( index - a ) / ( b - a );
+		left += points[i].weight;
+	}
+	index -= total - points[n-1].weight / 2;
+	return points[n-1].mean + ( self->max - points[n-1].mean ) * index / ( points[n-1].weight / 2 );
+}
+
+/* The fraction of the items not greater than "x", interpolated between the centroid means: */
+double StatDigest_Cdf( StatDigest *self, double x )
+{
+	StatCentroid *points = self->points;
+	double left = 0, total;
+	daoint i, n;
+	StatDigest_Compress( self );
+	n = self->count;
+	total = self->total;
+	if ( n == 0 )
+		return NAN;
+	if ( x < self->min )
+		return 0;
+	if ( x >= self->max )
+		return 1;
+	if ( x < points[0].mean )
+		return ( x - self->min ) / ( points[0].mean - self->min ) * points[0].weight / 2 / total;
+	for( i = 0; i < n - 1; i++ ){
+		if ( x < points[i+1].mean ){
+			double a = left + points[i].weight / 2;
+			double b = left + points[i].weight + points[i+1].weight / 2;
+			return ( a + ( b - a ) * ( x - points[i].mean ) / ( points[i+1].mean - points[i].mean ) ) / total;
+		}
+		left += points[i].weight;
+	}
+	left = total - points[n-1].weight / 2;
+	return ( left + ( x - points[n-1].mean ) / ( self->max - points[n-1].mean ) * points[n-1].weight / 2 ) / total;
+}
+
+/*
+// Histogram:
+//
+// The items within [low, high] are counted into bins of equal width, or into
+// bins delimited by sorted edges (found by binary search). Each bin includes
+// its lower edge, and the last bin also includes the upper edge; other items
+// and NaN are not counted. Large arrays are counted by parallel tasks into
+// separate partial histograms, which are then summed; the tasks are limited so
+// that each one counts at least as many items as there are bins, and so that
+// the partial histograms stay within STAT_HIST_MEMORY counts. Dense histograms of
+// integer keys count each key from "offset" in its own bin, in integer
+// arithmetic, so that keys beyond 2^53 are not rounded together.
+*/
+#define STAT_HIST_MEMORY  (1<<23)  /* Maximum number of counts in partial histograms; */
+
+typedef struct StatHistogram StatHistogram;
+
+struct StatHistogram
+{
+	StatWork   work;
+	double    *edges;   /* bins + 1 sorted bin edges, or NULL for bins of equal width; */
+	double     low;
+	double     high;
+	double     width;
+	daoint     bins;
+	daoint    *counts;  /* partial histograms of the tasks; */
+	int        dense;   /* integer keys from "offset", one bin per key; */
+	dao_integer offset;
+};
+
+daoint StatHistogram_FindBin( StatHistogram *self, double x )
+{
+	daoint lo = 0, hi = self->bins;
+	if ( self->edges == NULL ){
+		daoint bin = ( x - self->low ) / self->width;
+		return bin < self->bins ? bin : self->bins - 1;
+	}
+	while ( lo + 1 < hi ){ /* edges[lo] <= x < edges[hi]; */
+		daoint mid = ( lo + hi ) / 2;
+		if ( x < self->edges[mid] )
+			hi = mid;
+		else
+			lo = mid;
+	}
+	return lo;
+}
+
+void StatHistogram_Count( StatHistogram *self, daoint *counts, daoint first, daoint end )
+{
+	DaoArray *array = self->work.array;
+	double low = self->low, high = self->high;
+	daoint i, j, k, n;
+	for( i = first; i < end; i += n ){
+		n = StatWork_GetRun( &self->work, i, end, &j );
+		if ( array->etype == DAO_INTEGER && self->dense ){
+			dao_integer *items = array->data.i + j;
+			uint64_t bins = self->bins;
+			for( k = 0; k < n; k++ ){
+				uint64_t bin = (uint64_t) items[k] - (uint64_t) self->offset;
+				if ( bin < bins )
+					counts[bin] += 1;
+			}
+		}
+		else if ( array->etype == DAO_INTEGER ){
+			dao_integer *items = array->data.i + j;
+			for( k = 0; k < n; k++ ){
+				double x = items[k];
+				if ( x >= low && x <= high )
+					counts[ StatHistogram_FindBin( self, x ) ] += 1;
+			}
+		}
+		else {
+			dao_float *items = array->data.f + j;
+			for( k = 0; k < n; k++ ){
+				double x = items[k];
+				if ( x >= low && x <= high )
+					counts[ StatHistogram_FindBin( self, x ) ] += 1;
+			}
+		}
+	}
+}
+
+static void StatHistogram_RunTask( StatTask *task )
+{
+	StatHistogram *self = (StatHistogram*) task->context;
+	StatHistogram_Count( self, self->counts + task->index * self->bins, task->first, task->end );
+}
+
+/* Count the items of "arr" into "result" (of "self->bins" items): */
+void Histogram( StatHistogram *self, DaoArray *arr, daoint *result )
+{
+	StatTask tasks[STAT_MAX_THREADS];
+	daoint i, k;
+	int ntask;
+	StatWork_Init( &self->work, arr );
+	ntask = GetTaskCount( self->work.size, STAT_MIN_BLOCK );
+	if ( ntask > 1 && ntask*self->bins > self->work.size )
+		ntask = self->work.size/self->bins > 1 ? self->work.size/self->bins : 1;
+	if ( ntask > 1 && ntask*self->bins > STAT_HIST_MEMORY )
+		ntask = STAT_HIST_MEMORY/self->bins > 1 ? STAT_HIST_MEMORY/self->bins : 1;
+	self->counts = (daoint*) dao_calloc( ntask * self->bins, sizeof(daoint) );
+	RunTasks( tasks, StatHistogram_RunTask, self, self->work.size, ntask );
+	for( k = 0; k < self->bins; k++ ){
+		result[k] = 0;
+		for( i = 0; i < ntask; i++ )
+			result[k] += self->counts[i * self->bins + k];
+	}
+	dao_free( self->counts );
+	self->counts = NULL;
+}
+
+/* Find the minimum and maximum of the non-NaN items; return zero if there is none: */
+int FindRange( DaoArray *arr, double *min, double *max )
+{
+	StatWork work;
+	daoint i, j, k, n, found = 0;
+	StatWork_Init( &work, arr );
+	for( i = 0; i < work.size; i += n ){
+		n = StatWork_GetRun( &work, i, work.size, &j );
+		for( k = j; k < j + n; k++ ){
+			double x = work.array->etype == DAO_INTEGER ? work.array->data.i[k] : work.array->data.f[k];
+			if ( x != x )
+				continue;
+			if ( !found || x < *min ) *min = x;
+			if ( !found || x > *max ) *max = x;
+			found = 1;
+		}
+	}
+	return found;
+}
+
+/* Find the minimum and maximum of the integer items; return zero if there is none: */
+int FindIntRange( DaoArray *arr, dao_integer *min, dao_integer *max )
+{
+	StatWork work;
+	daoint i, j, k, n, found = 0;
+	StatWork_Init( &work, arr );
+	for( i = 0; i < work.size; i += n ){
+		n = StatWork_GetRun( &work, i, work.size, &j );
+		for( k = j; k < j + n; k++ ){
+			dao_integer x = work.array->data.i[k];
+			if ( !found || x < *min ) *min = x;
+			if ( !found || x > *max ) *max = x;
+			found = 1;
+		}
+	}
+	return found;
+}
+
+/*
+// Histograms of integer keys (or interval indices) are dense if the key range is
+// not much larger than the number of items:
+*/
+#define STAT_DENSE_RANGE( size )  ( 4*(size) + 1024 < (1<<24) ? 4*(size) + 1024 : (1<<24) )
+
 static void DaoStat_Mean( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoArray *arr = &p[0]->xArray;
@@ -261,19 +1290,23 @@ static void DaoStat_Variance( DaoProcess *proc, DaoValue *p[], int N )
 		DaoProcess_RaiseError( proc, "Value", "Calculating sample variance on a single-element sample" );
 		return;
 	}
-	if ( N > 1 && p[1]->type == DAO_FLOAT )
+	if ( N > 1 && p[1]->type == DAO_FLOAT ){
 		mean =  p[1]->xFloat.value;
-	else
-		mean = Mean( arr );
-	DaoProcess_PutFloat( proc, Variance( arr, mean, sample ) );
+		DaoProcess_PutFloat( proc, Variance( arr, mean, sample ) );
+	}
+	else {
+		StatMoments moments;
+		Moments( arr, &moments );
+		DaoProcess_PutFloat( proc, MomentsVariance( &moments, sample ) );
+	}
 }
 
 static void DaoStat_Percentile( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoArray *arr = &p[0]->xArray;
-	daoint i, j, count;
+	daoint count, ranks[2];
 	double perc = N == 1? 50.0 : p[1]->xFloat.value;
-	int odd;
+	int odd, nrank;
 	DaoArray_Sliced( arr );
 	if ( !arr->size ){
 		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
@@ -303,38 +1336,65 @@ static void DaoStat_Percentile( DaoProcess *proc, DaoValue *p[], int N )
 			}
 		}
 	}
+	ranks[0] = count - 2;
+	ranks[1] = count - 1;
+	nrank = odd? 1 : 2;
 	switch ( arr->etype ){
 	case DAO_INTEGER:
-		for ( i = 0; i < count; i++ ){
-			dao_integer min = arr->data.i[i];
-			daoint index = i;
-			for ( j = i + 1; j < arr->size; j++ )
-				if ( arr->data.i[j] < min ){
-					min = arr->data.i[j];
-					index = j;
-				}
-			arr->data.i[i] = arr->data.i[index];
-			arr->data.i[index] = min;
-		}
+		IntegersMultiSelect( arr->data.i, 0, arr->size - 1, ranks + 2 - nrank, nrank );
 		DaoProcess_PutFloat( proc, odd? (double)arr->data.i[count - 1] : ( (double)arr->data.i[count - 1] + arr->data.i[count - 2] )/2 );
 		break;
 	case DAO_FLOAT:
-		for ( i = 0; i < count; i++ ){
-			double min = arr->data.f[i];
-			daoint index = i;
-			for ( j = i + 1; j < arr->size; j++ )
-				if ( arr->data.f[j] < min ){
-					min = arr->data.f[j];
-					index = j;
-				}
-			arr->data.f[i] = arr->data.f[index];
-			arr->data.f[index] = min;
-		}
+		FloatsMultiSelect( arr->data.f, 0, arr->size - 1, ranks + 2 - nrank, nrank );
 		DaoProcess_PutFloat( proc, odd? (double)arr->data.f[count - 1] : ( (double)arr->data.f[count - 1] + arr->data.f[count - 2] )/2 );
 		break;
 	}
 }
 
+static void DaoStat_Quantiles( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *arr = &p[0]->xArray;
+	DaoList *percs = &p[1]->xList;
+	DaoList *res = DaoProcess_PutList( proc );
+	DaoArray *items = arr;
+	daoint i, n, count = DaoList_Size( percs );
+	double *percentages, *quantiles;
+	int copy = N < 3 || p[2]->xBoolean.value;
+	if ( !DaoArray_GetWorkSize( arr ) ){
+		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
+		return;
+	}
+	percentages = (double*) dao_malloc( (2*count + 1) * sizeof(double) );
+	quantiles = percentages + count;
+	for ( i = 0; i < count; i++ ){
+		percentages[i] = DaoList_GetItem( percs, i )->xFloat.value;
+		if ( !( percentages[i] >= 0 && percentages[i] <= 100 ) ){
+			DaoProcess_RaiseError( proc, "Param", "Invalid percentage" );
+			dao_free( percentages );
+			return;
+		}
+	}
+	if ( copy ){
+		items = DaoArray_New( DAO_FLOAT );
+		CopyToDouble( arr, items );
+	}
+	else
+		DaoArray_Sliced( arr );
+	n = items->etype == DAO_FLOAT ? FloatsDropNaN( items->data.f, items->size ) : items->size;
+	if ( n == 0 )
+		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
+	else {
+		Quantiles( items, n, percentages, quantiles, count );
+		for ( i = 0; i < count; i++ ){
+			DaoFloat value = {DAO_FLOAT, 0, 0, 0, 0, quantiles[i]};
+			DaoList_Append( res, (DaoValue*)&value );
+		}
+	}
+	if ( copy )
+		DaoArray_Delete( items );
+	dao_free( percentages );
+}
+
 static void DaoStat_Mode( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoArray *arr = &p[0]->xArray;
@@ -425,6 +1485,18 @@ static void DaoStat_MinMax( DaoProcess *proc, DaoValue *p[], int N )
 	}
 }
 
+/* Insert the nonzero counts of the bins into "hash" with keys from "offset": */
+static void PutDenseCounts( DaoMap *hash, daoint *counts, daoint bins, dao_integer offset )
+{
+	daoint k;
+	for ( k = 0; k < bins; k++ ){
+		DaoInteger key = {DAO_INTEGER, 0, 0, 0, 0, offset + k};
+		DaoInteger val = {DAO_INTEGER, 0, 0, 0, 0, counts[k]};
+		if ( counts[k] )
+			DaoMap_Insert( hash, (DaoValue*)&key, (DaoValue*)&val );
+	}
+}
+
 static void DaoStat_Distribution( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoArray *arr = &p[0]->xArray;
@@ -434,11 +1506,24 @@ static void DaoStat_Distribution( DaoProcess *proc, DaoValue *p[], int N )
 	daoint step = DaoArray_GetWorkStep( arr );
 	daoint i;
 	DaoMap *hash = DaoProcess_PutMap( proc, 1 );
-	arr = DaoArray_GetWorkArray( arr );
+	DaoArray *work = DaoArray_GetWorkArray( arr );
+	dao_integer min, max;
 	if ( !size ){
 		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
 		return;
 	}
+	if ( work->etype == DAO_INTEGER && FindIntRange( arr, &min, &max )
+			&& (uint64_t) max - (uint64_t) min < STAT_DENSE_RANGE( size ) ){
+		StatHistogram histogram = {{NULL, 0, 0, 0, 0}, NULL, 0.0, 0.0, 1.0, 0, NULL, 1, min};
+		daoint *counts;
+		histogram.bins = (daoint)( (uint64_t) max - (uint64_t) min ) + 1;
+		counts = (daoint*) dao_malloc( histogram.bins * sizeof(daoint) );
+		Histogram( &histogram, arr, counts );
+		PutDenseCounts( hash, counts, histogram.bins, min );
+		dao_free( counts );
+		return;
+	}
+	arr = work;
 	switch ( arr->etype ){
 	case DAO_INTEGER:
 		for ( i = 0; i < size; i++ ){
@@ -458,7 +1543,7 @@ static void DaoStat_Distribution( DaoProcess *proc, DaoValue *p[], int N )
 			DaoInteger val = {DAO_INTEGER, 0, 0, 0, 0, 1};
 			DaoValue *value = DaoMap_GetValue( hash, (DaoValue*)&key );
 			if ( value )
-				val.value = value->xFloat.value + 1;
+				val.value = value->xInteger.value + 1;
 			DaoMap_Insert( hash, (DaoValue*)&key, (DaoValue*)&val );
 		}
 		break;
@@ -474,8 +1559,9 @@ static void DaoStat_DistribGroup( DaoProcess *proc, DaoValue *p[], int N )
 	daoint step = DaoArray_GetWorkStep( arr );
 	daoint i;
 	double stval = p[2]->xFloat.value, interval = p[1]->xFloat.value;
+	double min, max;
 	DaoMap *hash = DaoProcess_PutMap( proc, 1 );
-	arr = DaoArray_GetWorkArray( arr );
+	DaoArray *work = DaoArray_GetWorkArray( arr );
 	if ( !size ){
 		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
 		return;
@@ -484,6 +1570,20 @@ static void DaoStat_DistribGroup( DaoProcess *proc, DaoValue *p[], int N )
 		DaoProcess_RaiseError( proc, "Param", "Zero interval" );
 		return;
 	}
+	if ( interval > 0 && FindRange( arr, &min, &max ) ){
+		double span = max >= stval ? ( max - stval )/interval : -1.0;
+		if ( span < STAT_DENSE_RANGE( size ) ){
+			daoint bins = (daoint) span + 1;
+			StatHistogram histogram = {{NULL, 0, 0, 0, 0}, NULL, stval, max, interval, bins, NULL};
+			daoint *counts = (daoint*) dao_malloc( (bins + 1) * sizeof(daoint) );
+			if ( bins )
+				Histogram( &histogram, arr, counts );
+			PutDenseCounts( hash, counts, bins, 0 );
+			dao_free( counts );
+			return;
+		}
+	}
+	arr = work;
 	for ( i = 0; i < size; i++ ){
 		daoint j = start + (i / len) * step + (i % len);
 		DaoInteger key = {DAO_INTEGER, 0, 0, 0, 0, 0};
@@ -504,6 +1604,64 @@ static void DaoStat_DistribGroup( DaoProcess *proc, DaoValue *p[], int N )
 	}
 }
 
+static void DaoStat_Histogram( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *arr = &p[0]->xArray;
+	DaoArray *res = DaoProcess_PutArray( proc );
+	StatHistogram histogram = {{NULL, 0, 0, 0, 0}, NULL, 0.0, 0.0, 1.0, 0, NULL};
+	DaoArray *edges = NULL;
+	daoint i, *counts;
+	DaoArray_SetNumType( res, DAO_INTEGER );
+	if ( p[1]->type == DAO_ARRAY ){
+		edges = &p[1]->xArray;
+		DaoArray_Sliced( edges );
+		for ( i = 1; i < edges->size; i++ ){
+			if ( !( edges->data.f[i - 1] < edges->data.f[i] ) ){
+				DaoProcess_RaiseError( proc, "Param", "Bin edges must be increasing" );
+				return;
+			}
+		}
+		if ( edges->size < 2 ){
+			DaoProcess_RaiseError( proc, "Param", "Invalid bins" );
+			return;
+		}
+		histogram.edges = edges->data.f;
+		histogram.bins = edges->size - 1;
+		histogram.low = edges->data.f[0];
+		histogram.high = edges->data.f[edges->size - 1];
+	}
+	else {
+		histogram.bins = p[1]->xInteger.value;
+		if ( histogram.bins <= 0 ){
+			DaoProcess_RaiseError( proc, "Param", "Invalid bins" );
+			return;
+		}
+		if ( N > 2 ){
+			histogram.low = p[2]->xTuple.values[0]->xFloat.value;
+			histogram.high = p[2]->xTuple.values[1]->xFloat.value;
+		}
+		else if ( !FindRange( arr, &histogram.low, &histogram.high ) ){
+			histogram.low = 0.0;
+			histogram.high = 1.0;
+		}
+		if ( histogram.high == histogram.low ){
+			histogram.low -= 0.5;
+			histogram.high += 0.5;
+		}
+		if ( !( histogram.low < histogram.high ) || isinf( histogram.high - histogram.low ) ){
+			DaoProcess_RaiseError( proc, "Param", "Invalid range" );
+			return;
+		}
+		histogram.width = ( histogram.high - histogram.low ) / histogram.bins;
+	}
+	DaoArray_ResizeVector( res, histogram.bins );
+	counts = (daoint*) dao_malloc( histogram.bins * sizeof(daoint) );
+	Histogram( &histogram, arr, counts );
+	for ( i = 0; i < histogram.bins; i++ )
+		res->data.i[i] = counts[i];
+	dao_free( counts );
+}
+
 static void DaoStat_Correlation( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoArray *arr1 = &p[0]->xArray;
@@ -533,6 +1691,33 @@ static void DaoStat_Correlation( DaoProcess *proc, DaoValue *p[], int N )
 		DaoProcess_PutFloat( proc, CorrelationSpearman( arr1, arr2 ));
 }
 
+static void DaoStat_CorrelationMatrix( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *arr = &p[0]->xArray;
+	DaoArray *res = DaoProcess_PutArray( proc );
+	StatCorrelation corr = {NULL, 0, 0, NULL};
+	daoint i, dims[2];
+	DaoArray_SetNumType( res, DAO_FLOAT );
+	DaoArray_Sliced( arr );
+	if ( arr->ndim != 2 ){
+		DaoProcess_RaiseError( proc, "Param", "Not a matrix" );
+		return;
+	}
+	corr.rows = arr->dims[0];
+	corr.cols = arr->dims[1];
+	if ( corr.rows < 2 ){
+		DaoProcess_RaiseError( proc, "Value", "Not enough observations" );
+		return;
+	}
+	dims[0] = dims[1] = corr.cols;
+	DaoArray_ResizeArray( res, dims, 2 );
+	corr.matrix = (double*) dao_malloc( arr->size*sizeof(double) );
+	for ( i = 0; i < arr->size; i++ )
+		corr.matrix[i] = arr->etype == DAO_INTEGER ? arr->data.i[i] : arr->data.f[i];
+	CorrelationMatrix( &corr, p[1]->xEnum.value == 1, res->data.f );
+	dao_free( corr.matrix );
+}
+
 static void DaoStat_Kurtosis( DaoProcess *proc, DaoValue *p[], int N )
 {
 	DaoArray *arr = &p[0]->xArray;
@@ -541,11 +1726,15 @@ static void DaoStat_Kurtosis( DaoProcess *proc, DaoValue *p[], int N )
 		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
 		return;
 	}
-	if ( N == 2 )
+	if ( N == 2 ){
 		mean = p[1]->xFloat.value;
-	else
-		mean = Mean( arr );
-	DaoProcess_PutFloat( proc, Moment( arr, 1, mean ) );
+		DaoProcess_PutFloat( proc, Moment( arr, 1, mean ) );
+	}
+	else {
+		StatMoments moments;
+		Moments( arr, &moments );
+		DaoProcess_PutFloat( proc, MomentsKurtosis( &moments ) );
+	}
 }
 
 static void DaoStat_Skewness( DaoProcess *proc, DaoValue *p[], int N )
@@ -556,11 +1745,43 @@ static void DaoStat_Skewness( DaoProcess *proc, DaoValue *p[], int N )
 		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
 		return;
 	}
-	if ( N == 2 )
+	if ( N == 2 ){
 		mean = p[1]->xFloat.value;
-	else
-		mean = Mean( arr );
-	DaoProcess_PutFloat( proc, Moment( arr, 0, mean ) );
+		DaoProcess_PutFloat( proc, Moment( arr, 0, mean ) );
+	}
+	else {
+		StatMoments moments;
+		Moments( arr, &moments );
+		DaoProcess_PutFloat( proc, MomentsSkewness( &moments ) );
+	}
+}
+
+static void DaoStat_Moments( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *arr = &p[0]->xArray;
+	StatMoments moments;
+	DaoTuple *tup;
+	if ( !DaoArray_GetWorkSize( arr ) ){
+		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
+		return;
+	}
+	Moments( arr, &moments );
+	tup = DaoProcess_PutTuple( proc, 7 );
+	tup->values[0]->xInteger.value = moments.count;
+	tup->values[1]->xFloat.value = moments.mean;
+	tup->values[2]->xFloat.value = MomentsVariance( &moments, 1 );
+	tup->values[3]->xFloat.value = MomentsSkewness( &moments );
+	tup->values[4]->xFloat.value = MomentsKurtosis( &moments );
+	switch ( DaoArray_GetWorkArray( arr )->etype ){
+	case DAO_INTEGER:
+		tup->values[5]->xInteger.value = moments.imin;
+		tup->values[6]->xInteger.value = moments.imax;
+		break;
+	case DAO_FLOAT:
+		tup->values[5]->xFloat.value = moments.fmin;
+		tup->values[6]->xFloat.value = moments.fmax;
+		break;
+	}
 }
 
 static DaoFunctionEntry statMeths[] =
@@ -582,6 +1803,11 @@ static DaoFunctionEntry statMeths[] =
 	 * \a percentage must be in range (0; 100) */
 	{ DaoStat_Percentile,	"percentile(data: array<@T<int|float>>, percentage: float) => float" },
 
+	/*! Returns quantiles of \a data at each of \a percentages (in range [0; 100]), interpolating linearly between the nearest order statistics.
+	 * All the quantiles are found by one selection pass. If \a copy is true, \a data is left untouched, otherwise it is partially reordered.
+	 * NaN values are ignored */
+	{ DaoStat_Quantiles,	"quantiles(data: array<@T<int|float>>, percentages: list<float>, copy = true) => list<float>" },
+
 	/*! Returns mode (most common value) of \a data */
 	{ DaoStat_Mode,			"mode(invar data: array<@T<int|float>>) => @T" },
 
@@ -599,6 +1825,13 @@ static DaoFunctionEntry statMeths[] =
 	 * \c frequency is the number of values which fall in the range. The values lesser then \a start are not included in the resulting statistics */
 	{ DaoStat_DistribGroup,	"distribution(invar data: array<@T<int|float>>, interval: float, start = 0.0) => map<int,int>" },
 
+	/*! Returns histogram of \a data with \a bins of equal width over \a range (by default, from the minimum to the maximum of \a data),
+	 * or with bins delimited by the increasing \a edges. Each bin includes its lower edge, the last bin also includes its upper edge.
+	 * The values outside of the bins and NaN are not counted */
+	{ DaoStat_Histogram,	"histogram(invar data: array<@T<int|float>>, bins: int, range: tuple<low: float, high: float>) => array<int>" },
+	{ DaoStat_Histogram,	"histogram(invar data: array<@T<int|float>>, bins: int) => array<int>" },
+	{ DaoStat_Histogram,	"histogram(invar data: array<@T<int|float>>, edges: array<float>) => array<int>" },
+
 	/*! Returns correlation \a coefficient between \a data1 and \a data2. Pearson coefficient measures linear dependence,
 	 * Spearman's rank coefficient measures monotonic dependence. If \a mean1 and \a mean2 are given, they are used for calculating Pearson
 	 * coefficient.
@@ -610,6 +1843,11 @@ static DaoFunctionEntry statMeths[] =
 	{ DaoStat_Correlation,	"correlation(invar data1: array<@T<int|float>>, "
 										"invar data2: array<@T>, coefficient: enum<pearson,spearman>, mean1: float, mean2: float) => float" },
 
+	/*! Returns correlation matrix of the columns of \a data, where each row is one observation of all variables. The ranks of the
+	 * columns for Spearman's coefficient are computed once, the products of the columns are accumulated in parallel over blocks of rows.
+	 * The diagonal is always 1; the correlations of a constant column with the other columns are NaN */
+	{ DaoStat_CorrelationMatrix,	"correlationMatrix(invar data: array<@T<int|float>>, coefficient: enum<pearson,spearman> = $pearson) => array<float>" },
+
 	/*! Returns skewness (measure of asymmetry) of \a data. Uses \a mean if it is given.
 	 * γ1[X] = E[((x - E[X]) / σ)^3] */
 	{ DaoStat_Skewness,		"skewness(invar data: array<@T<int|float>>) => float" },
@@ -619,13 +1857,176 @@ static DaoFunctionEntry statMeths[] =
 	 * γ2[X] = E[((x - E[X]) / σ)^4] - 3 */
 	{ DaoStat_Kurtosis,		"kurtosis(invar data: array<@T<int|float>>) => float" },
 	{ DaoStat_Kurtosis,		"kurtosis(invar data: array<@T<int|float>>, mean: float) => float" },
+
+	/*! Returns size, mean, sample variance, skewness, kurtosis, minimum and maximum of \a data computed in a single pass */
+	{ DaoStat_Moments,		"moments(invar data: array<@T<int|float>>) => "
+										"tuple<n: int, mean: float, variance: float, skewness: float, kurtosis: float, min: @T, max: @T>" },
+	{ NULL, NULL }
+};
+
+static void DaoDigest_New( DaoProcess *proc, DaoValue *p[], int N )
+{
+	double compression = p[0]->xFloat.value;
+	StatDigest *self;
+	if ( !( compression >= 10 && compression <= 1E6 ) ){
+		DaoProcess_RaiseError( proc, "Param", "Invalid compression" );
+		return;
+	}
+	self = StatDigest_New( DaoProcess_GetReturnType( proc ), compression );
+	DaoProcess_PutValue( proc, (DaoValue*) self );
+}
+
+static void DaoDigest_New2( DaoProcess *proc, DaoValue *p[], int N )
+{
+	DaoArray *arr = &p[0]->xArray;
+	StatDigest *self;
+	daoint i;
+	DaoArray_Sliced( arr );
+	if ( arr->size < 3 || arr->size % 2 == 0 || !( arr->data.f[0] >= 10 && arr->data.f[0] <= 1E6 ) ){
+		DaoProcess_RaiseError( proc, "Param", "Invalid serialized digest" );
+		return;
+	}
+	self = StatDigest_New( DaoProcess_GetReturnType( proc ), arr->data.f[0] );
+	DaoProcess_PutValue( proc, (DaoValue*) self );
+	for ( i = 3; i < arr->size; i += 2 )
+		StatDigest_AddWeighted( self, arr->data.f[i], arr->data.f[i+1] );
+	StatDigest_Compress( self );
+	self->min = arr->data.f[1];
+	self->max = arr->data.f[2];
+}
+
+static void DaoDigest_Add( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest *self = (StatDigest*) p[0];
+	double weight = N > 2 ? p[2]->xFloat.value : 1.0;
+	if ( p[1]->type == DAO_INTEGER )
+		StatDigest_AddWeighted( self, p[1]->xInteger.value, weight );
+	else
+		StatDigest_AddWeighted( self, p[1]->xFloat.value, weight );
+}
+
+static void DaoDigest_AddArray( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest_AddArray( (StatDigest*) p[0], &p[1]->xArray );
+}
+
+static void DaoDigest_Merge( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest_Merge( (StatDigest*) p[0], (StatDigest*) p[1] );
+}
+
+static void DaoDigest_Size( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest *self = (StatDigest*) p[0];
+	StatDigest_Compress( self );
+	DaoProcess_PutFloat( proc, self->total );
+}
+
+static void DaoDigest_Quantile( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest *self = (StatDigest*) p[0];
+	double q = p[1]->xFloat.value;
+	if ( !( q >= 0 && q <= 1 ) ){
+		DaoProcess_RaiseError( proc, "Param", "Invalid quantile" );
+		return;
+	}
+	if ( self->count + self->buffered == 0 ){
+		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
+		return;
+	}
+	DaoProcess_PutFloat( proc, StatDigest_Quantile( self, q ) );
+}
+
+static void DaoDigest_Cdf( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest *self = (StatDigest*) p[0];
+	if ( self->count + self->buffered == 0 ){
+		DaoProcess_RaiseError( proc, "Value", "Empty sample" );
+		return;
+	}
+	DaoProcess_PutFloat( proc, StatDigest_Cdf( self, p[1]->xFloat.value ) );
+}
+
+static void DaoDigest_Serialize( DaoProcess *proc, DaoValue *p[], int N )
+{
+	StatDigest *self = (StatDigest*) p[0];
+	DaoArray *res = DaoProcess_PutArray( proc );
+	daoint i;
+	StatDigest_Compress( self );
+	DaoArray_SetNumType( res, DAO_FLOAT );
+	DaoArray_ResizeVector( res, 3 + 2*self->count );
+	res->data.f[0] = self->compression;
+	res->data.f[1] = self->min;
+	res->data.f[2] = self->max;
+	for ( i = 0; i < self->count; i++ ){
+		res->data.f[3 + 2*i] = self->points[i].mean;
+		res->data.f[4 + 2*i] = self->points[i].weight;
+	}
+}
+
+static DaoFunctionEntry statDigestMeths[] =
+{
+	/*! Creates empty digest with the given \a compression, which bounds the number of centroids
+	 * (larger compression gives more accurate quantiles) */
+	{ DaoDigest_New,		"Digest(compression = 100.0)" },
+
+	/*! Creates digest from its serialized form \a data, as returned by serialize() */
+	{ DaoDigest_New2,		"Digest(invar data: array<float>)" },
+
+	/*! Adds \a value with the given \a weight */
+	{ DaoDigest_Add,		"add(self: Digest, value: int|float, weight = 1.0)" },
+
+	/*! Adds all values of \a data */
+	{ DaoDigest_AddArray,	"add(self: Digest, invar data: array<@T<int|float>>)" },
+
+	/*! Merges \a other digest into this one */
+	{ DaoDigest_Merge,		"merge(self: Digest, invar other: Digest)" },
+
+	/*! Returns the total weight of the added values */
+	{ DaoDigest_Size,		"size(self: Digest) => float" },
+
+	/*! Returns estimated quantile \a q (in range [0; 1]) of the added values */
+	{ DaoDigest_Quantile,	"quantile(self: Digest, q: float) => float" },
+
+	/*! Returns estimated fraction of the added values which are not greater than \a x */
+	{ DaoDigest_Cdf,		"cdf(self: Digest, x: float) => float" },
+
+	/*! Returns the digest in serialized form: compression, minimum and maximum value followed by the mean and weight of each centroid */
+	{ DaoDigest_Serialize,	"serialize(self: Digest) => array<float>" },
 	{ NULL, NULL }
 };
 
+DaoTypeCore statDigestCore =
+{
+	"Digest",                                          /* name */
+	sizeof(StatDigest),                                /* size */
+	{ NULL },                                          /* bases */
+	{ NULL },                                          /* casts */
+	NULL,                                              /* numbers */
+	statDigestMeths,                                   /* methods */
+	DaoCstruct_CheckGetField,  DaoCstruct_DoGetField,  /* GetField */
+	NULL,                      NULL,                   /* SetField */
+	NULL,                      NULL,                   /* GetItem */
+	NULL,                      NULL,                   /* SetItem */
+	NULL,                      NULL,                   /* Unary */
+	NULL,                      NULL,                   /* Binary */
+	NULL,                      NULL,                   /* Conversion */
+	NULL,                      NULL,                   /* ForEach */
+	NULL,                                              /* Print */
+	NULL,                                              /* Slice */
+	NULL,                                              /* Compare */
+	NULL,                                              /* Hash */
+	NULL,                                              /* Create */
+	NULL,                                              /* Copy */
+	(DaoDeleteFunction) StatDigest_Delete,             /* Delete */
+	NULL                                               /* HandleGC */
+};
+
 DAO_DLL int DaoStatistics_OnLoad( DaoVmSpace *vmSpace, DaoNamespace *ns )
 {
 	DaoNamespace *statns;
 	statns = DaoNamespace_GetNamespace( ns, "stat" );
 	DaoNamespace_WrapFunctions( statns, statMeths );
+	DaoNamespace_WrapType( statns, &statDigestCore, DAO_CSTRUCT, 0 );
 	return 0;
 }